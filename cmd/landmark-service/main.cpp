@@ -0,0 +1,157 @@
+// Local stand-in of the PixelMux animation-data service.
+// Replays the bundled landmarks-data clips over a UNIX socket using the LandmarkProtocol line format,
+// so the plugin can be exercised end to end without the real portrait + audio backend.
+// With --calibrate it instead derives the per AU thresholds of the plugin (auThresholds.json) from the same clips.
+
+#include "HeadPoseAligner.h"
+#include "LandmarkProtocol.h"
+#include "LandmarkReplayServer.h"
+#include "MetricsRegistry.h"
+#include "StartupLoader.h"
+#include "ThresholdCalibrator.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<bool> g_stopRequested{false};
+
+static void onSignal(int)
+{
+    g_stopRequested.store(true);
+}
+
+static void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--socket <path>] [--data <landmarks-data dir>] [--fps <frames per second>]"
+              << " [--metrics <file.json|file.prom>]\n"
+              << "       " << program << " --calibrate <auThresholds.json> [--tables <rig data dir>] [--data <landmarks-data dir>]"
+              << " [--clip <frames.json>]...\n";
+}
+
+// The 51 landmarks of the rig out of a 478 landmark frame
+static bool selectLandmarks(const std::vector<glm::vec3>& frame, const std::vector<int>& pixelIndex, std::vector<glm::vec3>& landmarks)
+{
+    landmarks.clear();
+    for (int index : pixelIndex)
+    {
+        if (index < 0 || index >= static_cast<int>(frame.size())) return false;
+        landmarks.push_back(frame[index]);
+    }
+    return true;
+}
+
+// Runs the threshold calibration over the clips and writes the thresholds the plugin loads at startup
+static bool calibrate(const std::string& tablesDir, const std::string& neutralJson,
+                      const std::vector<std::string>& clips, const std::string& outputPath)
+{
+    // the thresholds only need the landmark tables, the AU deltas may still be missing
+    StartupLoader loader;
+    loader.start(tablesDir, {"deltaTransfer.json"});
+    std::shared_ptr<const CompiledFaceRig> rig = loader.rig().get();
+    if (!rig || rig->landmarksPixelIndex().empty()) {
+        std::cerr << "[LandmarkService] Cannot load the rig tables of " << tablesDir << "\n";
+        return false;
+    }
+    const std::vector<int>& pixelIndex = rig->landmarksPixelIndex();
+
+    std::vector<std::vector<glm::vec3>> neutralFrames;
+    std::vector<glm::vec3> neutral;
+    if (!LandmarkProtocol::loadFramesFromJSON(neutralJson, neutralFrames) || neutralFrames.empty() ||
+        !selectLandmarks(neutralFrames.front(), pixelIndex, neutral)) {
+        std::cerr << "[LandmarkService] Cannot read the neutral frame: " << neutralJson << "\n";
+        return false;
+    }
+
+    // distances are measured with the head pose removed, as the plugin does before evaluating a frame
+    HeadPoseAligner headPose;
+    headPose.setReference(neutral, HeadPoseAligner::stableLandmarks(pixelIndex));
+
+    std::vector<std::vector<glm::vec3>> frames;
+    for (const std::string& clip : clips)
+    {
+        std::vector<std::vector<glm::vec3>> clipFrames;
+        if (!LandmarkProtocol::loadFramesFromJSON(clip, clipFrames)) continue;
+        for (const auto& frame : clipFrames)
+        {
+            std::vector<glm::vec3> landmarks;
+            if (!selectLandmarks(frame, pixelIndex, landmarks)) continue;
+            if (headPose.isValid()) headPose.align(landmarks.data(), landmarks.size());
+            frames.push_back(std::move(landmarks));
+        }
+    }
+
+    // a few poses give every slot the same rank for both quantiles, which would turn the intensity into a step
+    if (frames.size() < ThresholdCalibrator::kMinSamples) {
+        std::cerr << "[LandmarkService] " << frames.size() << " frames are not enough to calibrate, at least "
+                  << ThresholdCalibrator::kMinSamples << " are needed (the bundled poses are one frame each)\n";
+        return false;
+    }
+
+    const std::vector<AUThreshold> thresholds = ThresholdCalibrator::calibrateFrames(rig, neutral, frames).computeThresholds();
+    if (thresholds.empty()) {
+        std::cerr << "[LandmarkService] No AU could be calibrated from " << frames.size() << " frames\n";
+        return false;
+    }
+    if (!ThresholdCalibrator::saveCalibration(outputPath.c_str(), thresholds)) {
+        std::cerr << "[LandmarkService] Cannot write " << outputPath << "\n";
+        return false;
+    }
+    std::cout << "[LandmarkService] Calibrated " << thresholds.size() << " AU/side pairs over " << frames.size()
+              << " frames into " << outputPath << "\n";
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string socketPath = "/tmp/pixelmux-landmarks.sock";
+    std::string dataDir = "landmarks-data";
+    double frameRate = 30.0;
+    std::string metricsPath;
+    std::string calibrationPath;
+    std::string tablesDir = "data";
+    std::vector<std::string> calibrationClips;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if ((arg == "--socket" || arg == "-s") && i + 1 < argc) socketPath = argv[++i];
+        else if ((arg == "--data" || arg == "-d") && i + 1 < argc) dataDir = argv[++i];
+        else if ((arg == "--fps" || arg == "-f") && i + 1 < argc) frameRate = std::atof(argv[++i]);
+        else if ((arg == "--metrics" || arg == "-m") && i + 1 < argc) metricsPath = argv[++i];
+        else if ((arg == "--calibrate" || arg == "-c") && i + 1 < argc) calibrationPath = argv[++i];
+        else if ((arg == "--tables" || arg == "-t") && i + 1 < argc) tablesDir = argv[++i];
+        else if (arg == "--clip" && i + 1 < argc) calibrationClips.push_back(argv[++i]);
+        else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    // The neutral capture is the actor's reference, the poses make up the replayed clip
+    std::vector<std::string> clips = {dataDir + "/Pose1.json", dataDir + "/Pose2.json"};
+    // the bundled poses are one frame each, a calibration needs recorded clips (--clip, repeatable)
+    if (!calibrationPath.empty()) {
+        if (!calibrationClips.empty()) clips = calibrationClips;
+        return calibrate(tablesDir, dataDir + "/NeutralFace.json", clips, calibrationPath) ? 0 : 1;
+    }
+
+    LandmarkReplayServer server(clips, frameRate);
+    if (!server.start(socketPath)) return 1;
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    while (!g_stopRequested.load()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    server.stop();
+    // JSON for a .json path, Prometheus text otherwise
+    if (!metricsPath.empty() && MetricsRegistry::global().writeFile(metricsPath))
+        std::cout << "[LandmarkService] Metrics written to " << metricsPath << "\n";
+    std::cout << "[LandmarkService] Stopped\n";
+    return 0;
+}
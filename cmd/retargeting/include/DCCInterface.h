@@ -9,8 +9,17 @@
 #include "ActionUnit.h"
 #include "FacialLandmark.h"
 #include "MathUtils.h"
+#include "TopologyCorrespondence.h"
+#include "AUSolver.h"
+#include "ThresholdCalibrator.h"
+#include "NeutralProfile.h"
+#include "CompiledFaceRig.h"
+#include "FrameEvaluator.h"
+#include "HeadPoseAligner.h"
+#include "MemoryFootprint.h"
 #include <maya/MGlobal.h>
 #include <maya/MString.h>
+#include <map>
 #include <unordered_map>
 #include <vector>
 #include "Side.h"
@@ -27,27 +36,13 @@
  * This class acts as the bridge between the UI (PixelMuxWindow) and the animation backend.
  * It handles mesh processing, landmark extraction, and muscle mapping, and prepares data for animation generation.
  */
-struct landmarksDistanceData 
-{
-  int auId;
-  std::string side;
-  std::vector<int> landmarkIndices;
-  float baseDistance = 0.0f;
-  float currentDistance = 0.0f;
-  float activationThreshold = 1.0f;
-  bool isActive = false;
-  float intensity = 0.0f;
-};
 class DCCInterface 
 {
     public:
     /**
-    * @brief Constructs the DCCInterface with references to core animation components.
-    * @param actionUnit Pointer to the ActionUnit instance for managing facial expressions.
-    * @param facialLandmark Pointer to the FacialLandmark instance for landmark detection and mapping.
+    * @brief Default constructor; the template tables come from setRigSnapshot().
     */
-    DCCInterface(ActionUnit* actionUnit, FacialLandmark* facialLandmark)
-        : m_actionUnit(actionUnit), m_facialLandmark(facialLandmark) {}
+    DCCInterface() = default;
 
     /**
      * @brief Converts a Qt QString path to a standard std::string.
@@ -62,6 +57,23 @@ class DCCInterface
     */
     void processInputMesh(const std::string &path); // Call the functions to process the input Model
     
+    /**
+    * @brief Maps the input mesh onto the template when their topologies differ.
+    *
+    * Meshes with the template vertex count and triangle list are used as they are. Any other mesh gets a closest point correspondence,
+    * loaded from (or written to) a binary sidecar in cacheDir keyed by the mesh hash, and the muscle and landmark
+    * vertex ids are remapped through it.
+    * @param templatePath Path to TargetTemplate.obj.
+    * @param cacheDir Directory for the correspondence sidecars.
+    * @return True if the input mesh can be indexed with the template tables.
+    */
+    bool prepareTopology(const std::string& templatePath, const std::string& cacheDir);
+
+    /**
+    * @brief Returns the correspondence of the input mesh, or nullptr when it already has the template topology.
+    */
+    const TopologyCorrespondence* topologyCorrespondence() const;
+
     /**
     * @brief Prints mesh vertex data for debugging or inspection.
     * @param vector Vector of mesh vertices.
@@ -70,15 +82,30 @@ class DCCInterface
     void printMeshVertices(std::vector<glm::vec3> &vector, size_t &num);
 
     /**
-    * @brief Extracts muscle vertex data from the mesh.
+     * @brief Pins the template tables (muscle map, landmark index tables) read by the next generation.
+     *
+     * Hot-reloaded tables are published as new rigs; a generation sets the snapshot it started with so a reload in
+     * the middle of it cannot mix two versions. The steps that read the template tables fail until a snapshot is set.
+     * @param templateRig Rig compiled on the template topology (not resampled; the remapping is done here).
+     */
+    void setRigSnapshot(std::shared_ptr<const CompiledFaceRig> templateRig) { m_rigSnapshot = std::move(templateRig); }
+
+    /**
+     * @brief Returns the template rig of the running or last generation (null before the first one).
+     */
+    std::shared_ptr<const CompiledFaceRig> rigSnapshot() const { return m_rigSnapshot; }
+
+    /**
+    * @brief Maps the muscle patches onto the input mesh and computes their per-muscle aggregates.
+    *
+    * The patches stay vertex indices (CSR); use musclePatches().gather() to read a muscle's positions.
     */
     void getMeshMuscles(); 
-    
+
     /**
-     * @brief Prints the muscle vertex map for debugging.
-     * @param map Mapping of muscle indices to vertex groups.
+     * @brief Returns the muscle patches of the input mesh prepared by getMeshMuscles().
      */
-    void printMapMuscles(std::unordered_map<int, std::vector<glm::vec3>>& map);
+    const MusclePatchStore& musclePatches() const { return m_musclePatches; }
     
     /**
      * @brief Extracts 51 landmark vertices from the mesh.
@@ -100,6 +127,13 @@ class DCCInterface
      */
     bool processCurrentFaceData(const char* landmarksDataJson);
 
+    /**
+     * @brief Sets the current face landmarks from a frame streamed by the animation-data service.
+     * @param landmarks The 478 landmarks of the frame (replaces processCurrentFaceData for streamed clips).
+     * @return False if the frame is empty.
+     */
+    bool setCurrentFaceLandmarks(const std::vector<glm::vec3>& landmarks);
+
     /**
      * @brief Extracts 51 pixel-based landmark vertices for the neutral face.
 
@@ -108,29 +142,72 @@ class DCCInterface
 
     /**
    * @brief Extracts 51 pixel-based landmark vertices for the current face.
+   *
+   * Once prepareFrameEvaluator() set up the head pose reference, the landmarks are rigidly aligned to the neutral
+   * ones (rotation, translation and scale), so head motion does not leak into the AU distances and displacements.
    */
     void get51SetLandmarksCurrentFace();
 
     /**
-   * @brief Computes landmark distances for the neutral face using the provided Action Unit (AU) map.
-   * @param landmarksAUMap A map where the key is an integer AU identifier and the value is a vector of corresponding landmarks.
-   */
-    void computeLandmarksNeutralDistanceData(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap);
-    
+     * @brief Loads the cached neutral profile of the actor captured in neutralJson.
+     *
+     * On success the neutral 51 landmarks and distances come from the profile, so processNeutralFaceData and
+     * get51SetLandmarksNeutralFace can be skipped for every clip of that actor.
+     * @param landmarksAUMap Landmark/AU map of the rig tables the profile was measured with.
+     * @param neutralJson Path to the neutral frame landmarks file (identifies the actor).
+     * @param cacheDir Directory of the profile files.
+     * @return False if there is no valid profile for this capture and these tables yet.
+     */
+    bool loadNeutralProfile(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap, const std::string& neutralJson, const std::string& cacheDir);
+
     /**
-     * @brief Computes landmark distances for the current face using the provided Action Unit (AU) map.
+     * @brief Builds the neutral profile from the current neutral 51 landmarks and saves it for later clips.
      * @param landmarksAUMap A map where the key is an integer AU identifier and the value is a vector of corresponding landmarks.
+     * @param neutralJson Path to the neutral frame landmarks file (identifies the actor).
+     * @param cacheDir Directory of the profile files.
+     * @return True if the profile could be computed.
      */
-    void computeLandmarksCurrentDistanceData(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap);
+    bool buildNeutralProfile(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap, const std::string& neutralJson, const std::string& cacheDir);
+
+    /**
+     * @brief Sets up the frame evaluator of the rig snapshot: neutral distance and thresholds of every AU slot.
+     *
+     * Neutral distances come from the neutral profile when one is loaded, otherwise they are measured on the
+     * neutral 51 landmarks. The stable neutral landmarks also become the head pose reference of the current frames.
+     * Call it once per clip, after the neutral baseline is known.
+     * @return False if there is no rig to evaluate.
+     */
+    bool prepareFrameEvaluator();
     
     /**
-     * @brief Evaluates which Action Units (AUs) are activated based on computed distances and threshold values.
-     * @param thresholdMin Minimum threshold for AU activation.
-     * @param thresholdMax Maximum threshold for AU activation.
+     * @brief Loads per-AU activation thresholds produced by ThresholdCalibrator.
+     * @param calibrationJson Path to the calibration file.
+     * @return True if the file was loaded; otherwise evaluateActivatedAUs keeps using the values it is given.
+     */
+    bool loadThresholdCalibration(const char* calibrationJson);
+
+    /**
+     * @brief Evaluates which Action Units (AUs) are activated on the current 51 landmarks.
+     * Calibrated thresholds (loadThresholdCalibration) take precedence for the AUs they cover. The per-AU records are
+     * written to a frame arena that is reset on every call, so evaluating a frame does not allocate.
+     * @param thresholdMin Minimum threshold for AU activation of AUs without calibration.
+     * @param thresholdMax Maximum threshold for AU activation of AUs without calibration.
      * @return Optional landmarksDistanceData object containing evaluated AU information, if any.
      */
     std::optional<landmarksDistanceData> evaluateActivatedAUs(float thresholdMin, float thresholdMax);
 
+    /**
+     * @brief Solves the weights of all Action Units together from the current frame landmarks.
+     *
+     * The displacement of the 51 generated landmarks from the neutral frame is mapped from image space into the
+     * rig's mesh space (y up, facing +z) and scaled into mesh units by AUSolver::imageToMeshDisplacement, then
+     * handed to the solver.
+     * @param solver Solver built on the rig used for the input mesh.
+     * @param weights In: previous frame weights (warm start). Out: one weight per rig slot.
+     * @return False if the landmark sets are missing or do not match the solver.
+     */
+    bool solveActionUnitWeights(const AUSolver& solver, std::vector<float>& weights);
+
     /**
    * @brief Calculates the intensity of an Action Unit activation based on distance values and thresholds.
    * @param thresholdMin Minimum threshold distance.
@@ -148,31 +225,37 @@ class DCCInterface
     std::vector<glm::vec3> returnInputMeshLandmarks3D(); // to be used in the skinning part in MayaMesh
 
     /**
-     * @brief Returns a map of muscle vertex positions.
-     * @return A map where the key is an integer muscle ID and the value is a vector of associated 3D vertices.
+     * @brief Returns the heap bytes held for the current model and clip: mesh and landmark buffers, muscle patches,
+     * correspondence, neutral profile, frame evaluator and arena. The rig snapshot is reported by its owner.
      */
-    std::unordered_map<int, std::vector<glm::vec3>> returnMapMuscleVertices();
+    MemoryFootprint memoryFootprint() const;
     private:
+    /**
+     * @brief Returns true if a rig snapshot is set, otherwise reports that the step cannot run.
+     */
+    bool hasRigSnapshot(const char* step) const;
 
     // Mesh and landmark data containers
     std::vector<glm::vec3> m_meshInputVertices;                             ///< Store the input mesh vertices recieved from the UI (5898 vertices)
-    std::unordered_map<int, std::vector<glm::vec3>> m_mapMuscleVertices;    ///< Muscle vertex mapping
+    std::vector<unsigned int> m_meshInputTriangles;                         ///< Flat triangle index list of the input mesh
+    MusclePatchStore m_musclePatches;                                       ///< Muscle patches of the input mesh, with cached aggregates
     std::vector<glm::vec3> m_inputMeshLandmarks3D;                          ///< 3D landmarks extracted from the input mesh
 
     std::vector<glm::vec3> m_generatedNeutralLandmarks;    ///< 3D landmarks from the neutral frame of the generated video (478 Landmarks)
     std::vector<glm::vec3> m_generatedCurrentLandmarks;      ///< 3D landmarks from a specific pose/frame in the generated video
 
-    std::unordered_map<int, std::vector<glm::vec3>> m_mapLandmarksActionUnitVertices;    ///< landmarks to action unit vertex ma    std::unordered_map<int, std::vector<glm::vec3>> returnMapLandmarksActionUnitVertices(); 
-
-    std::vector<landmarksDistanceData> m_landmarksDistanceNeutraResults;   ///< Stores the computed landmark distance results for the neutral face.
-    std::vector<landmarksDistanceData> m_landmarksDistanceCurrentResults;  ///< Stores the computed landmark distance results for the current (active) face.
+    std::unique_ptr<FrameEvaluator> m_frameEvaluator;      ///< Per-slot neutral distances and thresholds of the clip
+    FrameArena m_frameArena;                               ///< Scratch of the current frame evaluation
+    HeadPoseAligner m_headPose;                            ///< Aligns the current landmarks to the neutral ones
 
     std::vector<glm::vec3> m_neutralFaceVertices;        ///< Subset of 51 pixel landmarks used for animation
     std::vector<glm::vec3> m_currentFaceVertices;        ///< Subset of 51 pixel landmarks used for animation
    
+    NeutralProfile m_neutralProfile;                        ///< Per actor neutral baseline (distances, 51 landmarks, scale)
+    std::map<std::pair<int, int>, std::pair<float, float>> m_auThresholds; ///< Calibrated (min, max) per (AU id, side)
+    TopologyCorrespondence m_correspondence;                ///< Input mesh to template map (empty when topologies match)
     FacialMesh m_facialMesh;                                ///< Facial mesh processor
-    ActionUnit* m_actionUnit;                               ///< Pointer to facial action unit manager
-    FacialLandmark* m_facialLandmark;                       ///< Pointer to facial landmark manager
+    std::shared_ptr<const CompiledFaceRig> m_rigSnapshot;   ///< Template tables of the running generation
     MathUtils m_mathUtils;
     QString m_modelPath;                                    ///< Path to the input model (Qt format)
 };
@@ -19,6 +19,7 @@
 #include <maya/MDoubleArray.h>
 #include <maya/MDagPath.h>
 #include <maya/MDagPathArray.h>
+#include <functional>
 #include <optional>
 #include <unordered_map>
 #include <DCCInterface.h>
@@ -27,6 +28,10 @@
 #include <maya/MTypes.h> 
 #include <maya/MFloatPointArray.h>   
 #include <maya/MFloatVector.h>
+#include <maya/MIntArray.h>
+#include "ProximityWrap.h"
+#include "AppliedOffsets.h"
+#include "CompiledFaceRig.h"
 
 /**
  * @class MayaMesh
@@ -65,6 +70,9 @@ public:
 
     /**
      * @brief Loads a Maya muscle object from the given file path.
+     *
+     * The imported shape is at rest, so the offsets applied to a previous import are forgotten.
+     *
      * @param objPath Path to the object file (e.g., .obj or .fbx) to load the muscle.
      * @return MStatus representing the success or failure of the operation.
      */
@@ -94,6 +102,11 @@ public:
      */
     MObject getMayaMuscle();
 
+    /**
+     * @brief Returns true while the imported muscle and skin meshes are in the scene and bound to each other.
+     */
+    bool isAssetBound() const;
+
     /**
      * @brief Creates a joint at the specified position with the given name.
      * @param position The 3D position in space where the joint should be created.
@@ -117,6 +130,7 @@ public:
      * @brief Prepares the mesh for skinning based on 3D landmark positions.
      * 
      * This method prepares the input mesh for the skinning process by providing the 3D landmarks.
+     * The joints and the skinCluster are created once per imported muscle mesh, later calls keep them.
      * 
      * @param m_inputMeshLandmarks3D A vector of glm::vec3 objects representing the 3D landmarks of the mesh.
      * @return MStatus representing the success or failure of the operation.
@@ -124,16 +138,74 @@ public:
     MStatus prepareMeshSkinning(std::vector<glm::vec3> m_inputMeshLandmarks3D);
 
     /**
-     * @brief Deforms the muscle mesh based on the specified Action Unit deltas and active Action Units.
-     * 
-     * This method applies muscle deformations based on the AU deltas, modifying the muscle shape
-     * based on facial expressions and the distance data from the activated AUs.
-     * 
-     * @param auDeltaTable A table mapping AU IDs to their corresponding ActionUnitDelta vectors.
+     * @brief Deforms the muscle mesh with the strongest active Action Unit of the frame.
+     *
+     * Reads the flattened per-slot delta arrays of a shared compiled rig, so no copy of the tables is made per
+     * call and several characters can share one rig.
+     *
+     * @param rig Compiled rig shared by every character.
      * @param activeAU_opt An optional landmarksDistanceData object representing the active AU, if available.
      * @return MStatus representing the success or failure of the operation.
      */
-    MStatus muscleDeformation(const std::unordered_map<int, std::vector<ActionUnitDelta>>& auDeltaTable, const std::optional<landmarksDistanceData>& activeAU_opt);
+    MStatus muscleDeformation(const CompiledFaceRig& rig, const std::optional<landmarksDistanceData>& activeAU_opt);
+
+    /**
+     * @brief Deforms the muscle mesh with several Action Units blended at once.
+     * @param rig Compiled rig of the muscle mesh.
+     * @param slotWeights One weight per rig slot (e.g. from AUSolver).
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus muscleDeformation(const CompiledFaceRig& rig, const std::vector<float>& slotWeights);
+
+    /**
+     * @brief Reads the muscle mesh at rest (current points without the accumulated AU deformation).
+     * @param vertices Output rest positions in world space.
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus getMuscleRestPoints(std::vector<glm::vec3>& vertices);
+
+    /**
+     * @brief Shows a deformed vertex buffer computed outside Maya (e.g. by the playback scheduler).
+     * @param vertices Deformed muscle positions in world space, one per muscle vertex.
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus setMusclePoints(const std::vector<glm::vec3>& vertices);
+
+    /**
+     * @brief Binds the skin mesh to the muscle mesh for proximity wrap deformation.
+     *
+     * Runs once per asset with both meshes at rest: every skin vertex is attached to its closest
+     * muscle triangle (barycentric weights plus a normal offset).
+     *
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus bindSkinToMuscle();
+
+    /**
+     * @brief Transfers the current muscle deformation to the skin mesh through the precomputed binding.
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus applyProximityWrap();
+
+    /**
+     * @brief Creates the preview proxy mesh and hides the muscle and skin meshes it stands in for.
+     * @param vertices Proxy rest positions on the muscle mesh.
+     * @param triangles Three proxy vertex ids per triangle.
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus showPreviewProxy(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& triangles);
+
+    /**
+     * @brief Moves the preview proxy vertices, ignored once the proxy is removed.
+     * @param vertices One position per proxy vertex.
+     * @return MStatus representing the success or failure of the operation.
+     */
+    MStatus setPreviewProxyPoints(const std::vector<glm::vec3>& vertices);
+
+    /**
+     * @brief Deletes the preview proxy mesh and shows the muscle and skin meshes again.
+     */
+    void removePreviewProxy();
 
     /**
      * @brief Imports an OBJ mesh and retrieves its transform and shape nodes.
@@ -172,7 +244,20 @@ private:
     MObject _skullTransform{ MObject::kNullObj };
     MObject _skullShape{ MObject::kNullObj };
 
-    MVectorArray _prevAccums;   // stores last frame's accumulations
+    /**
+     * @brief Replaces the AU offsets applied to the muscle mesh by new ones.
+     * @param accumulate Fills the offset from rest of every muscle vertex (zero initialised).
+     * @return MStatus of reading or writing the muscle points.
+     */
+    MStatus applyMuscleOffsets(const std::function<void(std::vector<glm::vec3>& offsets)>& accumulate);
+
+    AppliedOffsets _appliedOffsets; // AU offsets last written to the muscle mesh, reset when it is imported again
+
+    ProximityWrap _proximityWrap; // skin to muscle binding, computed once per asset
+    bool _landmarkSkinned = false; // landmark joints and skinCluster created for the imported muscle
+
+    MObject _proxyTransform{ MObject::kNullObj }; // live preview proxy, only present while the preview runs
+    MObject _proxyShape{ MObject::kNullObj };
 };
 
 #endif
\ No newline at end of file
@@ -6,16 +6,16 @@
 
 #include <QTimer>
 #include <QMessageBox>
+#include <QMetaObject>
 #include <QDebug>
 #include <QString>
+#include <cstdlib>
 #include <filesystem>
 
 PixelMuxWindow::PixelMuxWindow(const std::string& pluginDir, QWidget* parent)
     : QMainWindow(parent), m_pluginDir(pluginDir) {
     m_MayaMesh = std::make_unique<MayaMesh>(); // to initialize the pointer to MayaMesh class
-    m_ActionUnit = std::make_unique<ActionUnit>(); // to initialize the pointer to ActionUnit class
-    m_FacialLandmark = std::make_unique<FacialLandmark>(); // to initialize the pointer to Facial Landmarks
-    m_DCCInterface = std::make_unique<DCCInterface>(m_ActionUnit.get(), m_FacialLandmark.get()); // to initialize the pointer to the DCC Class
+    m_DCCInterface = std::make_unique<DCCInterface>(); // to initialize the pointer to the DCC Class
 
     setWindowTitle("PixelMux Retargeting Plug-in");
     resize(450, 150);
@@ -43,33 +43,106 @@ PixelMuxWindow::PixelMuxWindow(const std::string& pluginDir, QWidget* parent)
     mainLayout->addLayout(uploadLayout);
 
     // Generate button 
-    QPushButton* generateBtn = new QPushButton("Generate Animation Data");
-    connect(generateBtn, &QPushButton::clicked, this, &PixelMuxWindow::onGenerate);
-    mainLayout->addWidget(generateBtn);
+    m_generateButton = new QPushButton("Generate Animation Data");
+    connect(m_generateButton, &QPushButton::clicked, this, &PixelMuxWindow::onGenerate);
+    mainLayout->addWidget(m_generateButton);
 
     setCentralWidget(central);
 
 // ---- Initialization proces ---- //
-    std::string musclePathStr = m_pluginDir + "/retargeting/data/musclePatches.json";
-    const char* musclePath = musclePathStr.c_str();
+    // The tables parse on background threads; the window shows now and Generate waits for the rig
+    m_generateButton->setEnabled(false);
+    m_generateButton->setText("Loading data...");
+    m_startupLoader = std::make_unique<StartupLoader>();
+    // deltaTransfer.json comes from the pre-processing and may be dropped in later, the watcher then loads it
+    m_startupLoader->start(m_pluginDir + "/retargeting/data", {"deltaTransfer.json"});
+    m_startupTimer = new QTimer(this);
+    m_startupTimer->setInterval(50);
+    connect(m_startupTimer, &QTimer::timeout, this, &PixelMuxWindow::checkStartup);
+    m_startupTimer->start();
+
+    // Per AU thresholds derived from clip statistics (optional, generated offline with ThresholdCalibrator)
+    std::string calibrationPathStr = m_pluginDir + "/retargeting/data/auThresholds.json";
+    if (std::filesystem::exists(calibrationPathStr)) {
+        m_DCCInterface->loadThresholdCalibration(calibrationPathStr.c_str());
+    }
 
-    std::string deltaPathStr = m_pluginDir + "/retargeting/data/deltaTransfer.json";
-    const char* deltaPath = deltaPathStr.c_str();
+    // One worker is enough: generations are serialised and their kernels fan out through parallelFor
+    m_workerPool = std::make_unique<WorkerPool>(1);
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(50);
+    connect(m_progressTimer, &QTimer::timeout, this, &PixelMuxWindow::updateGenerateProgress);
+}
 
-    std::string landmarksMeshPathStr = m_pluginDir + "/retargeting/data/landmarksMeshIndex.json";
-    const char* landmarksMeshPath = landmarksMeshPathStr.c_str();
-    
-    std::string landmarksPixelPathStr = m_pluginDir + "/retargeting/data/landmarksPixelIndex.json";
-    const char* landmarksPixelPath = landmarksPixelPathStr.c_str();
+PixelMuxWindow::~PixelMuxWindow() {
+    stopLivePreview();
+    if (m_liveTables) m_liveTables->stopWatching();
+    if (m_generateJob && m_generateJob->state() == JobState::Running) {
+        m_generateJob->cancel();
+        m_generateJob->wait();
+    }
+    if (m_lodJob && m_lodJob->state() == JobState::Running) {
+        m_lodJob->cancel();
+        m_lodJob->wait();
+    }
+}
+
+void PixelMuxWindow::checkStartup() {
+    if (!m_startupLoader->isFinished()) return;
+    m_startupTimer->stop();
 
-    std::string landmarksActionUnitStr = m_pluginDir + "/retargeting/data/landmarksActionUnits.json";
-    const char* landmarksActionUnit = landmarksActionUnitStr.c_str();
+    for (const StartupTable& table : m_startupLoader->tables()) {
+        std::cout << "[PIXELMUXWINDOW] " << table.fileName << " loaded in " << table.result.get().seconds * 1000.0 << " ms\n";
+    }
+    std::shared_ptr<const CompiledFaceRig> rig = m_startupLoader->rig().get();
+    if (!rig) {
+        m_generateButton->setText("Data tables could not be loaded");
+        MGlobal::displayError("PixelMux data tables are missing or invalid, see the script editor output.");
+        return;
+    }
+
+    // Flatten the static tables; every character and frame reads this shared copy until a table file is saved again
+    m_liveTables = std::make_unique<LiveRigTables>(m_startupLoader->tableSet().get(), rig);
+    std::string dataDirStr = m_pluginDir + "/retargeting/data";
+    m_liveTables->watch(dataDirStr, [this](const std::string& fileName, bool accepted) {
+        // reloads run on the watcher thread, report them from the main thread
+        QString message = QString::fromStdString(fileName);
+        QMetaObject::invokeMethod(this, [message, accepted]() {
+            if (accepted) MGlobal::displayInfo(MString("Reloaded ") + message.toUtf8().constData());
+            else MGlobal::displayWarning(MString("Rejected invalid ") + message.toUtf8().constData() + ", keeping the previous version");
+        }, Qt::QueuedConnection);
+    });
+
+    m_generateButton->setText("Generate Animation Data");
+    m_generateButton->setEnabled(true);
+
+    // The live preview deforms a decimated proxy; its correspondence is cached, so only the first run pays for it
+    startPreviewLODs(rig);
+}
+
+void PixelMuxWindow::startPreviewLODs(std::shared_ptr<const CompiledFaceRig> templateRig) {
+    m_lodJob = BackgroundJob::create("Preview LODs");
+    m_lodJob->addStep("Building preview proxies", 1.0f, [this, templateRig](JobContext& ctx) {
+        std::string templatePathStr = m_pluginDir + "/retargeting/models/TargetTemplate.obj";
+        std::string lodCacheStr = m_pluginDir + "/retargeting/cache/lod";
+        FacialMesh templateMesh;
+        std::vector<glm::vec3> templateVertices = templateMesh.loadModel(templatePathStr.c_str());
+        std::vector<uint32_t> templateTriangles = templateMesh.loadModelTriangles(templatePathStr.c_str());
+        if (templateVertices.empty() || templateTriangles.empty() || ctx.cancelled()) return false;
+
+        m_previewLODs = MeshLODBuilder::build(*templateRig, templateVertices, templateTriangles, lodCacheStr);
+        m_previewLODRig = templateRig;
+        return !m_previewLODs.empty();
+    });
+    // queued on the generation worker: a Generate clicked meanwhile starts once the proxies are built
+    m_lodJob->start(*m_workerPool);
+}
 
-    uploadingMusclePatches(musclePath);
-    uploadingDeltaTransfer(deltaPath); 
-    uploadingLandmarksMeshIndex(landmarksMeshPath); // This is the landmark index data for the 3D mesh 
-    uploadingLandmarksPixelIndex(landmarksPixelPath); // This is the landmark index data for pixel-mux system
-    uploadinglandmarksActionUnitsMapping(landmarksActionUnit); // This is the data to mapping landmarks pair and action units
+const MeshLOD* PixelMuxWindow::previewLOD() const {
+    if (!m_lodJob || m_lodJob->state() != JobState::Finished) return nullptr;
+    // a generation that started after a table reload reads other deltas than the proxies
+    if (m_previewLODRig != m_DCCInterface->rigSnapshot()) return nullptr;
+    return &m_previewLODs.front();
 }
 
 void PixelMuxWindow::onUploadPortrait() {
@@ -92,117 +165,338 @@ void PixelMuxWindow::onGenerate() {
         QMessageBox::warning(this, "Input files missing", "Please upload the model, portrait and the audio before press generate.");
         return;
     }
+    if (!m_liveTables || (m_generateJob && m_generateJob->state() == JobState::Running)) return;
 
-   // ---- Main processing steps: model loading, mesh preparation, landmark extraction, landmark evaluation, animation driver---- //
+    // the job reuses the DCC interface and the stream client of the preview
+    stopLivePreview();
 
-    // Convert the model path to MString and load it in the Maya viewport (muscle template reference)
-    m_modelPathMString = m_MayaMesh->convertModelPathToMString(m_modelPath);    
-    m_MayaMesh->loadMayaMuscle(m_modelPathMString);
+   // ---- Main processing steps: model loading, mesh preparation, landmark extraction, landmark evaluation, animation driver---- //
 
-    // Convert the model path to a standard C++ string
+    // Scene import stays on the main thread: the Maya API must not be called from the worker
+    // Convert the model path to a standard C++ string and to MString
     m_modelPathString = m_DCCInterface->convertModelPathToString(m_modelPath);
+    m_modelPathMString = m_MayaMesh->convertModelPathToMString(m_modelPath);
+
+    // Import the muscle and skin meshes and bind them while both are at rest, once per asset: generating again
+    // for the same model reuses the nodes and the binding instead of piling up copies in the scene
+    if (m_sceneModelPath != m_modelPathString || !m_MayaMesh->isAssetBound()) {
+        m_sceneModelPath.clear();
+        m_MayaMesh->loadMayaMuscle(m_modelPathMString); // muscle template reference
+        m_MayaMesh->loadMayaSkin(m_modelPathMString);
+        if (m_MayaMesh->bindSkinToMuscle() == MS::kSuccess) m_sceneModelPath = m_modelPathString;
+    }
 
-    // Load input mesh vertices into m_meshInputVertices
-    m_DCCInterface->processInputMesh(m_modelPathString);
-
-    // Map muscle IDs to their corresponding vertices in the input mesh
-    m_DCCInterface->getMeshMuscles();
-
-    // Extract 3D landmark vertices (51 total) from the input mesh (stored in m_inputMeshLandmarks3D)
-    m_DCCInterface->getInputMeshLandmarks3D();
-
-    // Get 478-point landmarks from the neutral frame (stored in m_generatedNeutralLandmarks)
-
-    std::string NeutralFaceDataJsonStr = m_pluginDir + "/retargeting/landmarks-data/NeutralFace.json"; //this can be fixed just moving the folder to the build plugin one as data!!! 
-    const char* NeutralFaceDataJson = NeutralFaceDataJsonStr.c_str();
-    m_DCCInterface->processNeutralFaceData(NeutralFaceDataJson);
+    // Everything up to the AU weights only touches DCCInterface and pkg data, run it off the main thread
+    m_generateJob = createGenerateJob();
+    m_generateJob->setCompletionCallback([this](JobState state) {
+        QMetaObject::invokeMethod(this, [this, state]() { onGenerateFinished(state); }, Qt::QueuedConnection);
+    });
 
-    // 51-point subset landmarks from the neutral frame (stored in m_neutralLandmarks51)
-    m_DCCInterface->get51SetLandmarksNeutralFace();
-    
-    // Get the landmarks to action unit map
-    const auto& landmarksAuMap = m_FacialLandmark->getLandmarksActionUnitMap(); // map that contains the relation between landmarks and action units
+    m_generateButton->setEnabled(false);
+    showProcessingDialog();
+    m_generateJob->start(*m_workerPool);
+    m_progressTimer->start();
+}
 
-    // Get the euclidian distance between landmarks in neutral face (I need to check the ones with tree entries)
-    m_DCCInterface->computeLandmarksNeutralDistanceData(landmarksAuMap);
+std::shared_ptr<BackgroundJob> PixelMuxWindow::createGenerateJob() {
+    auto job = BackgroundJob::create("Generate");
+
+    // The whole generation reads the tables published when it starts, even if one is reloaded meanwhile
+    std::shared_ptr<const CompiledFaceRig> templateRig = m_liveTables->rig();
+    m_DCCInterface->setRigSnapshot(templateRig);
+
+    job->addStep("Loading model", 2.0f, [this](JobContext& ctx) {
+        // Load input mesh vertices into m_meshInputVertices
+        m_DCCInterface->processInputMesh(m_modelPathString);
+        if (ctx.cancelled()) return false;
+
+        // Map meshes with a different topology onto the template (cached per mesh in a binary sidecar)
+        std::string templatePathStr = m_pluginDir + "/retargeting/models/TargetTemplate.obj";
+        std::string topologyCacheStr = m_pluginDir + "/retargeting/cache/topology";
+        m_DCCInterface->prepareTopology(templatePathStr, topologyCacheStr);
+        return true;
+    });
+
+    job->addStep("Preparing character rig", 2.0f, [this, templateRig](JobContext& ctx) {
+        // Resample the template deltas once for this mesh when its topology differs
+        m_characterRig = templateRig;
+        if (const TopologyCorrespondence* correspondence = m_DCCInterface->topologyCorrespondence())
+        {
+            auto resampledRig = templateRig->resampled(*correspondence);
+            if (resampledRig) m_characterRig = resampledRig;
+        }
+        if (ctx.cancelled()) return false;
+
+        // The solver basis is sampled at the landmark vertices of this rig
+        m_auSolver.build(*m_characterRig);
+        m_auWeights.clear();
+        ctx.setStepProgress(0.5f);
+
+        // Map muscle IDs to their corresponding vertices in the input mesh
+        m_DCCInterface->getMeshMuscles();
+
+        // Extract 3D landmark vertices (51 total) from the input mesh (stored in m_inputMeshLandmarks3D)
+        m_DCCInterface->getInputMeshLandmarks3D();
+        return true;
+    });
+
+    job->addStep("Neutral baseline", 2.0f, [this, templateRig](JobContext&) {
+        // Get the landmarks to action unit map
+        const auto& landmarksAuMap = templateRig->landmarksActionUnitMap(); // map that contains the relation between landmarks and action units
+
+        // Neutral baseline: reuse the actor's cached profile, parse NeutralFace.json only the first time
+        std::string NeutralFaceDataJsonStr = m_pluginDir + "/retargeting/landmarks-data/NeutralFace.json"; //this can be fixed just moving the folder to the build plugin one as data!!! 
+        std::string neutralProfileDirStr = m_pluginDir + "/retargeting/cache/neutral";
+        if (!m_DCCInterface->loadNeutralProfile(landmarksAuMap, NeutralFaceDataJsonStr, neutralProfileDirStr))
+        {
+            // Get 478-point landmarks from the neutral frame (stored in m_generatedNeutralLandmarks)
+            m_DCCInterface->processNeutralFaceData(NeutralFaceDataJsonStr.c_str());
+
+            // 51-point subset landmarks from the neutral frame (stored in m_neutralLandmarks51)
+            m_DCCInterface->get51SetLandmarksNeutralFace();
+
+            m_DCCInterface->buildNeutralProfile(landmarksAuMap, NeutralFaceDataJsonStr, neutralProfileDirStr);
+        }
+
+        // Neutral distance and thresholds per AU slot (read from the profile), set up once for the clip
+        return m_DCCInterface->prepareFrameEvaluator();
+    });
+
+    job->addStep("Current frame", 2.0f, [this](JobContext& ctx) {
+        if (requestLandmarkStream())
+        {
+            // Retarget as soon as the first frame arrives; the rest of the clip keeps streaming into the client
+            LandmarkFrame firstFrame;
+            bool received = false;
+            for (int waited = 0; !received && waited < 10000 && !ctx.cancelled(); waited += 100)
+                received = m_landmarkClient->nextFrame(firstFrame, 100);
+            if (!received) {
+                std::cerr << "[PIXELMUXWINDOW] No frame from the animation-data service: " << m_landmarkClient->error() << "\n";
+                return false;
+            }
+            if (!m_DCCInterface->setCurrentFaceLandmarks(firstFrame.landmarks)) return false;
+        }
+        else
+        {
+            // No service running: get 478-point landmarks from the pre-baked pose (stored in m_generatedCurrentLandmarks)
+            std::string CurrentFaceDataJsonStr = m_pluginDir + "/retargeting/landmarks-data/Pose1.json";
+            if (!m_DCCInterface->processCurrentFaceData(CurrentFaceDataJsonStr.c_str())) return false;
+        }
+
+        // 51-point subset landmarks from the current frame (stored in m_currentFaceVertices)
+        m_DCCInterface->get51SetLandmarksCurrentFace();
+        return true;
+    });
+
+    job->addStep("Evaluating action units", 1.0f, [this](JobContext&) {
+        float minThreshold = 0.4f; // minimun value to detect activation, used for AUs missing from auThresholds.json
+        float maxThreshold = 0.6f; // maximum value of activation, used for AUs missing from auThresholds.json
+
+        // Evaluate the distance of the current face and the neutral face to identify what action units is being activate it
+        m_currentAUActivate = m_DCCInterface->evaluateActivatedAUs(minThreshold, maxThreshold);
+        m_inputMeshLandmarks = m_DCCInterface->returnInputMeshLandmarks3D();
+
+        // Solve every AU weight together; the main thread falls back to the single strongest AU when this fails
+        m_useSolverWeights = m_auSolver.isBuilt() && m_DCCInterface->solveActionUnitWeights(m_auSolver, m_auWeights);
+        return true;
+    });
+
+    return job;
+}
 
-    // Get 478-point landmarks from the pose/current frame (stored in m_generatedCurrentLandmarks)
-    std::string CurrentFaceDataJsonStr = m_pluginDir + "/retargeting/landmarks-data/Pose1.json";
-    const char* CurrentFaceDataJson = CurrentFaceDataJsonStr.c_str();
-    auto currentFaceData = m_DCCInterface->processCurrentFaceData(CurrentFaceDataJson);
+bool PixelMuxWindow::requestLandmarkStream() {
+    // Same default as cmd/landmark-service; PIXELMUX_LANDMARK_SOCKET points the plugin at another service
+    const char* socketEnv = std::getenv("PIXELMUX_LANDMARK_SOCKET");
+    std::string socketPath = socketEnv ? socketEnv : "/tmp/pixelmux-landmarks.sock";
+    if (!std::filesystem::exists(socketPath)) return false;
+
+    // a new request drops whatever is left of the previous clip
+    m_landmarkClient = std::make_unique<LandmarkStreamClient>();
+    if (!m_landmarkClient->connect(socketPath)) return false;
+
+    LandmarkRequest request;
+    request.id = m_nextRequestId++;
+    request.portraitPath = m_portraitPath.toStdString();
+    request.audioPath = m_audioPath.toStdString();
+    return m_landmarkClient->request(request);
+}
 
-    // 51-point subset landmarks from the current frame (stored in m_currentFaceVertices)
-    m_DCCInterface->get51SetLandmarksCurrentFace();
-    
-    // Evaluate what is the distance between pair of landmarks 
-    m_DCCInterface->computeLandmarksCurrentDistanceData(landmarksAuMap);
+void PixelMuxWindow::onGenerateFinished(JobState state) {
+    m_progressTimer->stop();
+    if (m_progressDialog) {
+        // closing emits canceled(), detach first so a finished job is not reported as cancelling
+        QProgressDialog* dialog = m_progressDialog;
+        m_progressDialog = nullptr;
+        dialog->disconnect(this);
+        dialog->close();
+        dialog->deleteLater();
+    }
+    m_generateButton->setEnabled(true);
 
-    float minThreshold = 0.4f; // minimun value to detect activation (TODO: should be identified based on data and dynamically)
-    float maxThreshold = 0.6f; // maximum value of activation (TODO: should be identified based on data and dynamically)
+    if (state == JobState::Cancelled) {
+        MGlobal::displayInfo("Generation cancelled.");
+        return;
+    }
+    if (state != JobState::Finished) {
+        MGlobal::displayError(MString("Generation failed during: ") + m_generateJob->currentStep().c_str());
+        return;
+    }
 
-    // Evaluate the distance of the current face and the neutral face to identify what action units is being activate it
-    auto currentAUActivate = m_DCCInterface->evaluateActivatedAUs(minThreshold, maxThreshold);
+    // ---- Scene mutations, back on the main thread ---- //
     std::cout << "[PIXELMUXWINDOW] the current AU acticate is:  " << "\n";
-    std::cout << "AU Id: "     << currentAUActivate->auId  << "  Intensity: " << currentAUActivate->intensity << "\n";
-
-    auto inputMeshLandmarks = m_DCCInterface->returnInputMeshLandmarks3D();
-    std::cout << "[PIXELMUXWINDOW] The size of the input Mesh Landmarks 3D is: " << inputMeshLandmarks.size() << "landmarks entries." << "\n";
+    if (m_currentAUActivate) {
+        std::cout << "AU Id: "     << m_currentAUActivate->auId  << "  Intensity: " << m_currentAUActivate->intensity << "\n";
+    }
+    std::cout << "[PIXELMUXWINDOW] The size of the input Mesh Landmarks 3D is: " << m_inputMeshLandmarks.size() << "landmarks entries." << "\n";
 
     // Do the skinning process and joint based on the landmarks capture in the input mesh 
-    m_MayaMesh->prepareMeshSkinning(inputMeshLandmarks);
+    m_MayaMesh->prepareMeshSkinning(m_inputMeshLandmarks);
     
     //-------- Animation driving approach -------//
-    // get the map relation between au and delta transfer
-    auto auDeltaTable = m_ActionUnit->getAuDeltaTable(); 
-    
-    // Deform the muscle mesh based on intensity and delta transfer of the active and passive muscles of the current Active Action Unit)    
-    std::cout << "[PIXELMUXWINDOW] muscle deformation before"; 
-    m_MayaMesh->muscleDeformation(auDeltaTable, currentAUActivate);
+    if (m_useSolverWeights)
+    {
+        m_MayaMesh->muscleDeformation(*m_characterRig, m_auWeights);
+    }
+    else
+    {
+        // Deform the muscle mesh based on intensity and delta transfer of the active and passive muscles of the current Active Action Unit)
+        // The compiled rig is shared, so no copy of the delta table is made per generation
+        m_MayaMesh->muscleDeformation(*m_characterRig, m_currentAUActivate);
+    }
 
-    //TODO: Import the skin mesh
-    //TODO: Apply proxmity transfer from muscle rig to skin mesh
+    // Apply proximity transfer from muscle rig to skin mesh
+    m_MayaMesh->applyProximityWrap();
+
+    // The rest of the streamed clip plays at the target rate
+    if (m_landmarkClient && m_useSolverWeights) startLivePreview();
 
-    showProcessingDialog();
     simulateAPICall();
 }
 
-void PixelMuxWindow::showProcessingDialog() {
-    QMessageBox* processing = new QMessageBox(QMessageBox::Information,
-                                               "Processing",
-                                               "Generating animation data from PixelAPI...",
-                                               QMessageBox::NoButton,
-                                               this);
-    processing->show();
-    QTimer::singleShot(2000, processing, &QMessageBox::accept); // simulation window
+void PixelMuxWindow::startLivePreview() {
+    std::vector<glm::vec3> restVertices;
+    if (m_MayaMesh->getMuscleRestPoints(restVertices) != MS::kSuccess) return;
+
+    // Preview evaluates the proxy rig and shows the proxy in place of the muscle and skin, so a frame costs O(proxy);
+    // Generate and export keep m_characterRig and the full meshes
+    const MeshLOD* lod = previewLOD();
+    auto placement = std::make_shared<MeshLODPlacement>();
+    if (lod && (!MeshLODBuilder::place(*lod, restVertices, m_DCCInterface->topologyCorrespondence(), *placement) ||
+                m_MayaMesh->showPreviewProxy(placement->rest, lod->triangles) != MS::kSuccess))
+        lod = nullptr;
+
+    if (lod) {
+        std::cout << "[PIXELMUXWINDOW] Live preview on the " << lod->vertices.size() << " vertex proxy\n";
+        m_preview = std::make_unique<PlaybackScheduler>(lod->rig, lod->vertices);
+    } else {
+        m_preview = std::make_unique<PlaybackScheduler>(m_characterRig, std::move(restVertices));
+    }
+    m_previewFrameQueued = false;
+
+    // AU weights are solved on the playback thread; the Maya scene only receives ready buffers on the main thread
+    auto evaluate = [this](const LandmarkFrame& frame, std::vector<float>& weights) {
+        std::lock_guard<std::mutex> lock(m_frameStateMutex);
+        if (!m_DCCInterface->setCurrentFaceLandmarks(frame.landmarks)) return false;
+        m_DCCInterface->get51SetLandmarksCurrentFace();
+        return m_DCCInterface->solveActionUnitWeights(m_auSolver, weights);
+    };
+    auto present = [this, lod, placement](const PlaybackFrame& frame) {
+        // a buffer still waiting for the main thread is not queued behind another one
+        if (m_previewFrameQueued.exchange(true)) return;
+        if (lod) {
+            // proxy motion in user mesh units, still on the playback thread
+            auto points = std::make_shared<std::vector<glm::vec3>>();
+            if (!MeshLODBuilder::moveProxy(*lod, *placement, *frame.vertices, *points)) {
+                m_previewFrameQueued = false;
+                return;
+            }
+            QMetaObject::invokeMethod(this, [this, points]() {
+                m_MayaMesh->setPreviewProxyPoints(*points);
+                m_previewFrameQueued = false;
+            }, Qt::QueuedConnection);
+            return;
+        }
+        std::shared_ptr<const std::vector<glm::vec3>> vertices = frame.vertices;
+        QMetaObject::invokeMethod(this, [this, vertices]() {
+            m_MayaMesh->setMusclePoints(*vertices);
+            m_MayaMesh->applyProximityWrap();
+            m_previewFrameQueued = false;
+        }, Qt::QueuedConnection);
+    };
+    if (!m_preview->start(PlaybackSource::fromStream(*m_landmarkClient), evaluate, present)) {
+        m_preview.reset();
+        m_MayaMesh->removePreviewProxy();
+    }
 }
 
-void PixelMuxWindow::simulateAPICall() {
-    // Call and update Maya
-    MGlobal::displayInfo("Data ready!");
+void PixelMuxWindow::stopLivePreview() {
+    if (!m_preview) return;
+    m_preview->stop();
+
+    const PlaybackStats stats = m_preview->stats();
+    std::cout << "[PIXELMUXWINDOW] Live preview: " << stats.framesPresented << " frames at " << stats.achievedFrameRate
+              << " fps, latency p50/p95/p99 " << stats.latencyP50Ms << "/" << stats.latencyP95Ms << "/" << stats.latencyP99Ms
+              << " ms, " << stats.deadlinesMissed << " missed and " << stats.ticksSkipped << " skipped deadlines"
+              << (stats.holdsFrameRate ? " (holds the frame rate)" : " (does not hold the frame rate)") << "\n";
+    m_preview.reset();
+    m_MayaMesh->removePreviewProxy();
 }
 
-void PixelMuxWindow::uploadingMusclePatches(const char* musclesJson) {
-    m_ActionUnit->loadMuscleIndexMapFromJSON(musclesJson);
+void PixelMuxWindow::updateGenerateProgress() {
+    if (!m_generateJob || !m_progressDialog) return;
+    m_progressDialog->setValue(static_cast<int>(m_generateJob->progress() * 100.0f));
+    m_progressDialog->setLabelText(QString::fromStdString(m_generateJob->currentStep() + "..."));
 }
 
-void PixelMuxWindow::uploadingModelsPath(const char* modelsJson, const char* basePath) {
-    // this should be run one time in the pre-processing to generate the data we are going to use in the deltaTransfer
-    m_ActionUnit->loadModelPathsFromJSON(modelsJson, basePath);
+void PixelMuxWindow::showProcessingDialog() {
+    m_progressDialog = new QProgressDialog("Generating animation data...", "Cancel", 0, 100, this);
+    m_progressDialog->setWindowTitle("Processing");
+    m_progressDialog->setWindowModality(Qt::WindowModal);
+    m_progressDialog->setMinimumDuration(0);
+    m_progressDialog->setAutoClose(false);
+    m_progressDialog->setAutoReset(false);
+    m_progressDialog->setValue(0);
+
+    // The running step finishes, the remaining ones are skipped; onGenerateFinished closes the dialog
+    std::weak_ptr<BackgroundJob> job = m_generateJob;
+    connect(m_progressDialog, &QProgressDialog::canceled, this, [this, job]() {
+        if (auto running = job.lock()) running->cancel();
+        if (m_progressDialog) m_progressDialog->setLabelText("Cancelling...");
+    });
 }
 
-void PixelMuxWindow::uploadingDeltaTransfer(const char* deltaTransferJson) {
-    m_ActionUnit->loadDeltaTransfersFromJSON(deltaTransferJson);
+void PixelMuxWindow::simulateAPICall() {
+    // Call and update Maya
+    MGlobal::displayInfo("Data ready!");
 }
 
-void PixelMuxWindow::uploadingLandmarksMeshIndex(const char* landmarksMeshJson) {
-    m_FacialLandmark->loadLandmarksMeshIndexFromJSON(landmarksMeshJson);
-}
+MemoryFootprint PixelMuxWindow::memoryFootprint() const
+{
+    // the published tables and rig are immutable snapshots, safe to read from the main thread
+    MemoryFootprint footprint;
+    std::shared_ptr<const RigTableSet> tables = m_liveTables ? m_liveTables->tables() : nullptr;
+    if (tables) footprint.add("rigTables", tables->memoryFootprint());
+    std::shared_ptr<const CompiledFaceRig> templateRig = m_liveTables ? m_liveTables->rig() : nullptr;
+    if (templateRig) footprint.add("templateRig", templateRig->memoryFootprint());
+    // the proxies are written once by their job and only read after it finished
+    if (m_lodJob && m_lodJob->state() == JobState::Finished) {
+        for (size_t level = 0; level < m_previewLODs.size(); ++level) {
+            const MeshLOD& lod = m_previewLODs[level];
+            const std::string owner = "previewLOD" + std::to_string(level);
+            footprint.add(owner + ".mesh", heapBytes(lod.vertices) + heapBytes(lod.triangles) + heapBytes(lod.sourceVertex) + heapBytes(lod.clusterOf));
+            footprint.add(owner + ".correspondence", lod.correspondence.memoryFootprint());
+            footprint.add(owner + ".rig", lod.rig->memoryFootprint());
+        }
+    }
 
-void PixelMuxWindow::uploadingLandmarksPixelIndex(const char* landmarksPixelJson) {
-    m_FacialLandmark->loadLandmarksPixelIndexFromJSON(landmarksPixelJson);
+    if (m_generateJob && m_generateJob->state() == JobState::Running) return footprint;
+    // a generation keeps the rig it started with even if the tables were reloaded since
+    std::shared_ptr<const CompiledFaceRig> generationRig = m_DCCInterface->rigSnapshot();
+    if (generationRig && generationRig != templateRig) footprint.add("generationRig", generationRig->memoryFootprint());
+    if (m_characterRig && m_characterRig != templateRig && m_characterRig != generationRig)
+        footprint.add("characterRig", m_characterRig->memoryFootprint());
+    footprint.add("auSolver", m_auSolver.memoryFootprint());
+    std::lock_guard<std::mutex> lock(m_frameStateMutex);
+    footprint.add("dccInterface", m_DCCInterface->memoryFootprint());
+    return footprint;
 }
-
-void PixelMuxWindow::uploadinglandmarksActionUnitsMapping(const char* landmarksAUJson)
-{
-    m_FacialLandmark->loadLandmarksActionUnitsMappingFromJson(landmarksAUJson);
-}
\ No newline at end of file
@@ -9,11 +9,22 @@
 #include <QHBoxLayout>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QTimer>
 #include "DCCInterface.h"
-#include "FacialLandmark.h"
 #include "MayaMesh.h"
-#include "ActionUnit.h"
+#include "CompiledFaceRig.h"
+#include "LiveRigTables.h"
+#include "MeshLODBuilder.h"
+#include "MemoryFootprint.h"
+#include "BackgroundJob.h"
+#include "WorkerPool.h"
+#include "LandmarkStreamClient.h"
+#include "PlaybackScheduler.h"
+#include "StartupLoader.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <filesystem>
 #include <Side.h>
 
@@ -36,6 +47,20 @@ public:
      */
     explicit PixelMuxWindow(const std::string& pluginDir, QWidget* parent = nullptr);
 
+    /**
+     * @brief Cancels a running generation or LOD build and waits for its worker before the data it uses is destroyed.
+     */
+    ~PixelMuxWindow() override;
+
+    /**
+     * @brief Returns the heap bytes held by the plugin, by owner and table ("rigTables.deltaTransfer.auDeltaTable", ...).
+     *
+     * The rig tables and the compiled rig are the snapshots currently published by the live tables, the preview proxies
+     * are reported once their job finished. The per-model tables (generation and character rigs, solver, DCCInterface)
+     * are left out while a generation is running, since its worker is writing them; the DCCInterface frame state is read between two live preview frames.
+     */
+    MemoryFootprint memoryFootprint() const;
+
 private slots:
     /**
     * @brief Triggered when the user uploads a 3D model.
@@ -54,10 +79,26 @@ private slots:
 
     /**
      * @brief Triggered when the user clicks the "Generate" button.
-     * Initiates the facial animation generation process.
+     * Imports the meshes, then runs the Maya-independent processing as a background job.
      */
     void onGenerate();
 
+    /**
+     * @brief Called on the main thread when the generation job ends; applies the results to the Maya scene.
+     * @param state Final state of the job.
+     */
+    void onGenerateFinished(JobState state);
+
+    /**
+     * @brief Polls the generation job and updates the progress dialog.
+     */
+    void updateGenerateProgress();
+
+    /**
+     * @brief Polls the startup loader; publishes the tables and enables Generate once the rig is compiled.
+     */
+    void checkStartup();
+
 private:
     // File paths selected by the user
     QString m_portraitPath;     ///< Path to the uploaded portrait image
@@ -67,25 +108,46 @@ private:
     // Internal representations of the model path
     std::string m_modelPathString; ///< Used by pkg/retargeting/FacialMesh for internal processing
     MString m_modelPathMString;    ///< Used by cmd/retargeting/MayaMesh to update Maya viewport
+    std::string m_sceneModelPath;  ///< Model whose muscle and skin are imported and bound in the scene (empty if none)
 
     std::string m_pluginDir; ///< Directory where the plugin is compiled realtive to build folder
 
     // Core processing components
     std::unique_ptr<DCCInterface> m_DCCInterface;       ///< Interface to the Digital Content Creation environment
     std::unique_ptr<MayaMesh> m_MayaMesh;               ///< Handles mesh operations in Maya
-    std::unique_ptr<ActionUnit>m_ActionUnit;            ///< Manages facial action units for animation
-    std::unique_ptr<FacialLandmark>m_FacialLandmark;    ///< Handles facial landmark detection data
+    std::unique_ptr<StartupLoader> m_startupLoader;       ///< Background load of the data tables
+    QTimer* m_startupTimer = nullptr;                     ///< Polls the startup loader
+    std::unique_ptr<LiveRigTables> m_liveTables;          ///< Compiled data tables, hot reloaded when data/ changes (null until loaded)
+    std::shared_ptr<const CompiledFaceRig> m_characterRig; ///< Rig used for the current model (resampled if its topology differs)
+    AUSolver m_auSolver;                                  ///< Least-squares AU solver on the landmark basis of m_characterRig
+    std::vector<float> m_auWeights;                       ///< Last solved AU weights (warm start of the next frame)
+
+    // Background generation (results are written by the job and read on the main thread once it ends)
+    std::unique_ptr<WorkerPool> m_workerPool;             ///< Runs generation jobs off Maya's main thread
+    std::shared_ptr<BackgroundJob> m_generateJob;         ///< Running or last generation job
+    QProgressDialog* m_progressDialog = nullptr;          ///< Progress and cancel of the running job
+    QTimer* m_progressTimer = nullptr;                    ///< Polls the job progress
+    QPushButton* m_generateButton = nullptr;              ///< Disabled while a job runs
+    std::optional<landmarksDistanceData> m_currentAUActivate; ///< Strongest active AU of the frame
+    std::vector<glm::vec3> m_inputMeshLandmarks;          ///< 51 landmarks of the input mesh, used by the skinning
+    bool m_useSolverWeights = false;                      ///< True when m_auWeights holds a valid solve
+    std::unique_ptr<LandmarkStreamClient> m_landmarkClient; ///< Connection to the animation-data service
+    uint64_t m_nextRequestId = 1;                         ///< Id of the next service request
+    std::unique_ptr<PlaybackScheduler> m_preview;         ///< Live preview of the streamed clip at the target frame rate
+    std::atomic<bool> m_previewFrameQueued{false};        ///< A preview buffer waits for the main thread
+    std::shared_ptr<BackgroundJob> m_lodJob;              ///< Builds the preview levels of detail at startup
+    std::vector<MeshLOD> m_previewLODs;                   ///< Decimated template with its resampled rigs, finest first (written by m_lodJob)
+    std::shared_ptr<const CompiledFaceRig> m_previewLODRig; ///< Template rig the levels were resampled from
+    mutable std::mutex m_frameStateMutex;                 ///< Guards the DCCInterface frame state the preview evaluates on its thread
 
     // Internal helper methods
-    void showProcessingDialog(); ///< Displays a modal dialog indicating processing is underway
+    std::shared_ptr<BackgroundJob> createGenerateJob(); ///< Builds the Maya-independent steps of a generation
+    void showProcessingDialog(); ///< Displays the progress dialog of the running job
+    bool requestLandmarkStream(); ///< Asks the animation-data service for the clip of the uploaded portrait and audio
+    void startPreviewLODs(std::shared_ptr<const CompiledFaceRig> templateRig); ///< Builds the preview proxies of the template off the main thread
+    const MeshLOD* previewLOD() const; ///< Proxy the live preview can run on, null to preview at full resolution
+    void startLivePreview();    ///< Plays the rest of the streamed clip on the muscle mesh
+    void stopLivePreview();     ///< Stops the live preview and reports whether it held the frame rate
     void simulateAPICall();     ///< Simulates an API call (placeholder for actual backend integration)
-      
-    // Uploading helper methods for various JSON configurations
-    void uploadingModelsPath(const char* modelsJson, const char* basePath);
-    void uploadingMusclePatches(const char* musclesJson);
-    void uploadingDeltaTransfer(const char* deltaTransferJson); 
-    void uploadingLandmarksMeshIndex(const char* landmarksMeshJson);
-    void uploadingLandmarksPixelIndex(const char* landmarksPixelJson);
-    void uploadinglandmarksActionUnitsMapping(const char* landmarksAUJson);
 };
 #endif
\ No newline at end of file
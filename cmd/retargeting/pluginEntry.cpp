@@ -11,6 +11,8 @@
 // Qt Interface
 #include <QtCore/QPointer>
 #include "interface/widgets/PixelMuxPluginWindow.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
 #include <filesystem>
 
 #define kFlagModel      "-m"
@@ -19,6 +21,10 @@
 #define kFlagLongAudio  "--audio"
 #define kFlagImage      "-i"
 #define kFlagLongImage  "--image"
+#define kFlagJson       "-j"
+#define kFlagLongJson   "-json"
+#define kFlagFile       "-f"
+#define kFlagLongFile   "-file"
 
 static QPointer<PixelMuxWindow> plugin_window;  
 
@@ -32,6 +38,27 @@ public:
     bool isUndoable() const override { return false; }
 };
 
+// pixelMuxMetrics [-json] [-file <path>]: prints the metrics registry (Prometheus text, or JSON with -json) and
+// optionally writes it to a file (JSON for a .json path, Prometheus text otherwise)
+class pixelMuxMetrics : public MPxCommand
+{
+public:
+    static void* creator() { return new pixelMuxMetrics(); }
+    static MSyntax newSyntax();
+    MStatus doIt(const MArgList& args) override;
+    bool isUndoable() const override { return false; }
+};
+
+// pixelMuxMemory: prints the heap bytes held by the open plugin window per table (JSON); the live heap per subsystem
+// stays disabled inside Maya, the tracking allocator is only linked into the headless executables
+class pixelMuxMemory : public MPxCommand
+{
+public:
+    static void* creator() { return new pixelMuxMemory(); }
+    MStatus doIt(const MArgList& args) override;
+    bool isUndoable() const override { return false; }
+};
+
 class PluginContext {
 
 public:
@@ -57,6 +84,43 @@ MStatus buildUIPanel::doIt(const MArgList&) {
     return MS::kSuccess;
 }
 
+MSyntax pixelMuxMetrics::newSyntax() {
+    MSyntax syntax;
+    syntax.addFlag(kFlagJson, kFlagLongJson);
+    syntax.addFlag(kFlagFile, kFlagLongFile, MSyntax::kString);
+    return syntax;
+}
+
+MStatus pixelMuxMetrics::doIt(const MArgList& args) {
+    MStatus status;
+    MArgDatabase argData(syntax(), args, &status);
+    if (!status) return status;
+
+    const MetricsRegistry& registry = MetricsRegistry::global();
+    if (argData.isFlagSet(kFlagFile)) {
+        MString path;
+        argData.getFlagArgument(kFlagFile, 0, path);
+        if (!registry.writeFile(path.asChar())) {
+            MGlobal::displayError(MString("pixelMuxMetrics: cannot write ") + path);
+            return MS::kFailure;
+        }
+    }
+
+    const std::string text = argData.isFlagSet(kFlagJson) ? registry.toJSON() : registry.toPrometheus();
+    MGlobal::displayInfo(text.c_str());
+    setResult(MString(text.c_str()));
+    return MS::kSuccess;
+}
+
+MStatus pixelMuxMemory::doIt(const MArgList&) {
+    if (MemoryTracker::enabled()) MemoryTracker::publishMetrics();
+    const std::string footprint = plugin_window ? plugin_window->memoryFootprint().toJSON() : MemoryFootprint().toJSON();
+    const std::string text = "{\"footprint\": " + footprint + ",\n\"heap\": " + MemoryTracker::toJSON() + "}";
+    MGlobal::displayInfo(text.c_str());
+    setResult(MString(text.c_str()));
+    return MS::kSuccess;
+}
+
 MStatus initializePlugin(MObject obj)
 {
     MFnPlugin plugin(obj, "PixelMux Retargeting Plug-in", "1.0", "Any");
@@ -66,6 +130,8 @@ MStatus initializePlugin(MObject obj)
     PluginContext::setPluginDir(pluginDir);
 
     plugin.registerCommand("buildUIPanel", buildUIPanel::creator);
+    plugin.registerCommand("pixelMuxMetrics", pixelMuxMetrics::creator, pixelMuxMetrics::newSyntax);
+    plugin.registerCommand("pixelMuxMemory", pixelMuxMemory::creator);
     return MS::kSuccess;
 }
 
@@ -73,5 +139,7 @@ MStatus uninitializePlugin(MObject obj)
 {
     MFnPlugin plugin(obj);
     plugin.deregisterCommand("buildUIPanel");
+    plugin.deregisterCommand("pixelMuxMetrics");
+    plugin.deregisterCommand("pixelMuxMemory");
     return MS::kSuccess;
 }
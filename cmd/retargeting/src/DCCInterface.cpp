@@ -1,5 +1,7 @@
 #include <iostream>
 #include "DCCInterface.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
 
 std::string DCCInterface::convertModelPathToString(QString &path)
 {
@@ -14,6 +16,7 @@ std::string DCCInterface::convertModelPathToString(QString &path)
 
 void DCCInterface::processInputMesh(const std::string &path)
 {
+    MemoryScope memory(MemorySubsystem::dccInterface);
     std::cout << "[DCCInterface] Validating mesh input file path: " << path << std::endl;
 
     if (!std::filesystem::exists(path)) {
@@ -28,6 +31,7 @@ void DCCInterface::processInputMesh(const std::string &path)
 
     // Load the mesh vertices from the given file path
     m_meshInputVertices = m_facialMesh.loadModel(path.c_str());
+    m_meshInputTriangles = m_facialMesh.loadModelTriangles(path.c_str());
 
     // Print the first 5 vertices for verification
     size_t numToPrint = 5;
@@ -35,6 +39,41 @@ void DCCInterface::processInputMesh(const std::string &path)
 }
 
 
+bool DCCInterface::prepareTopology(const std::string& templatePath, const std::string& cacheDir)
+{
+    m_correspondence.clear();
+
+    std::vector<glm::vec3> templateVertices = m_facialMesh.loadModel(templatePath.c_str());
+    if (templateVertices.empty()) {
+        std::cerr << "[DCCInterface][ERROR] Failed to load the template mesh: " << templatePath << "\n";
+        return false;
+    }
+
+    // the same vertex count is not enough, a different mesh must also be told apart by its triangles
+    std::vector<unsigned int> templateTriangles = m_facialMesh.loadModelTriangles(templatePath.c_str());
+    if (templateVertices.size() == m_meshInputVertices.size() &&
+        TopologyCorrespondence::hashTriangles(templateTriangles) == TopologyCorrespondence::hashTriangles(m_meshInputTriangles)) {
+        std::cout << "[DCCInterface] Input mesh has the template topology, no correspondence needed\n";
+        return true;
+    }
+
+    std::cout << "[DCCInterface] Input mesh has " << m_meshInputVertices.size() << " vertices, the template has "
+              << templateVertices.size() << ". Mapping it onto the template.\n";
+    return m_correspondence.loadOrBuild(cacheDir, m_meshInputVertices, templateVertices, templateTriangles);
+}
+
+const TopologyCorrespondence* DCCInterface::topologyCorrespondence() const
+{
+    return m_correspondence.isValid() ? &m_correspondence : nullptr;
+}
+
+bool DCCInterface::hasRigSnapshot(const char* step) const
+{
+    if (m_rigSnapshot) return true;
+    std::cerr << "[DCCInterface][ERROR] " << step << " needs the template tables: no rig snapshot is set\n";
+    return false;
+}
+
 void DCCInterface::printMeshVertices(std::vector<glm::vec3> &vector, size_t &num)
 {
     std::cout << "[DCCInterface] printing the first : " << num << " vertices in the input mesh" << "\n";
@@ -46,62 +85,52 @@ void DCCInterface::printMeshVertices(std::vector<glm::vec3> &vector, size_t &num
 
 void DCCInterface::getMeshMuscles()
 {
-    // Clear the existing map to avoid using outdated or corrupted data
-    m_mapMuscleVertices.clear();
-
-    // Retrieve the mapping from muscle IDs to vertex indices
-    std::unordered_map<int, std::vector<int>> musclesMap = m_actionUnit->getMuscleIndexMap();
+    MemoryScope memory(MemorySubsystem::dccInterface);
+    // Retrieve the muscle patches of the template
+    if (!hasRigSnapshot("getMeshMuscles")) return;
+    MusclePatchStore templatePatches = m_rigSnapshot->musclePatches();
 
-    if (musclesMap.empty()) {
-        std::cout << "[DCCInterface] Muscle index map from ActionUnit is empty.\n";
+    if (templatePatches.muscleCount() == 0) {
+        std::cout << "[DCCInterface] Muscle index map of the rig snapshot is empty.\n";
     }
 
-    for (const auto& [muscleKey, vertexIndices] : musclesMap)
-    {
-        std::vector<glm::vec3> muscleVertices;
-
-        for (int index : vertexIndices)
-        {
-            if (index >= 0 && index < static_cast<int>(m_meshInputVertices.size()))
-            {
-                muscleVertices.push_back(m_meshInputVertices[index]);
-            }
-            else
-            {
-                std::cerr << "[ERROR] Muscle vertex index out of range: " << index << "\n";
-            }
-        }
-
-        m_mapMuscleVertices[muscleKey] = std::move(muscleVertices);
-        std::cout << "[DCCInterface] Muscle ID " << muscleKey 
-                  << " has " << m_mapMuscleVertices[muscleKey].size() 
-                  << " associated vertices.\n";
-    }
-}
+    // template vertex ids only address the input mesh directly when the topologies match
+    m_musclePatches = m_correspondence.isValid() ? templatePatches.remapped(m_correspondence) : std::move(templatePatches);
 
-
-void DCCInterface::printMapMuscles(std::unordered_map<int, std::vector<glm::vec3>>& map)
-{
-    for (auto& value: map)
-    {
-        std::cout << "The muscles number: "<< value.first << " have this vertices: " << "\n";
-        for (auto second: value.second) { std::cout << second.x << "," << second.y << "," << second.z << ")" << "\n";}
+    if (!m_musclePatches.computeStats(m_meshInputVertices)) {
+        std::cerr << "[ERROR] Muscle vertex index out of range: the patches need " << m_musclePatches.requiredVertexCount()
+                  << " vertices, the input mesh has " << m_meshInputVertices.size() << "\n";
+        return;
     }
+    std::cout << "[DCCInterface] " << m_musclePatches.muscleCount() << " muscles with "
+              << m_musclePatches.vertices().size() << " patch vertices.\n";
 }
 
 void DCCInterface::getInputMeshLandmarks3D()
 {
+    MemoryScope memory(MemorySubsystem::dccInterface);
     m_inputMeshLandmarks3D.clear();
 
     // get mesh landmarks indices 
-    std::vector<int> landmarksIndex = m_facialLandmark->getLandmarksMeshIndex();
+    if (!hasRigSnapshot("getInputMeshLandmarks3D")) return;
+    std::vector<int> landmarksIndex = m_rigSnapshot->landmarksMeshIndex();
     if(landmarksIndex.empty())
     {
         std::cout << "[DCCInterface][ERROR]: The landmarks index vector is empty" << "\n";
     }
 
+    if (m_correspondence.isValid())
+    {
+        landmarksIndex = m_correspondence.remapIndices(landmarksIndex);
+    }
+
     for(auto index: landmarksIndex)
     {
+        if (index < 0 || index >= static_cast<int>(m_meshInputVertices.size()))
+        {
+            std::cerr << "[ERROR] Landmark vertex index out of range: " << index << "\n";
+            continue;
+        }
         glm::vec3 verticesxindex = m_meshInputVertices[index];
         m_inputMeshLandmarks3D.push_back(verticesxindex);
     }
@@ -110,8 +139,11 @@ void DCCInterface::getInputMeshLandmarks3D()
 
 bool DCCInterface::processNeutralFaceData(const char* landmarksDataJson)
 {
+    MemoryScope memory(MemorySubsystem::dccInterface);
     m_generatedNeutralLandmarks.clear();
 
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(landmarksDataJson));
     std::string filePathStr = std::string(landmarksDataJson);
     std::ifstream file(filePathStr);
     if (!file.is_open()) {
@@ -145,8 +177,11 @@ bool DCCInterface::processNeutralFaceData(const char* landmarksDataJson)
 
 void DCCInterface::get51SetLandmarksNeutralFace()
 {
+    m_neutralFaceVertices.clear();
+
     // get pixel landmarks indices 
-    std::vector<int> landmarksIndex = m_facialLandmark->getLandmarksPixelIndex();
+    if (!hasRigSnapshot("get51SetLandmarksNeutralFace")) return;
+    std::vector<int> landmarksIndex = m_rigSnapshot->landmarksPixelIndex();
     if(landmarksIndex.empty())
     {
         std::cout << "[DCCInterface][ERROR]: The vector landmarks pixel index is empty" << "\n";
@@ -169,8 +204,11 @@ void DCCInterface::get51SetLandmarksNeutralFace()
 
 bool DCCInterface::processCurrentFaceData(const char* landmarksDataJson)
 {
+    MemoryScope memory(MemorySubsystem::dccInterface);
     m_generatedCurrentLandmarks.clear();
 
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(landmarksDataJson));
     std::string filePathStr = std::string(landmarksDataJson);
     std::ifstream file(filePathStr);
     if (!file.is_open()) {
@@ -202,10 +240,24 @@ bool DCCInterface::processCurrentFaceData(const char* landmarksDataJson)
     return true;
 }
 
+bool DCCInterface::setCurrentFaceLandmarks(const std::vector<glm::vec3>& landmarks)
+{
+    MemoryScope memory(MemorySubsystem::dccInterface);
+    if (landmarks.empty()) {
+        std::cerr << "[DCCInterface] Streamed frame has no landmarks\n";
+        return false;
+    }
+    m_generatedCurrentLandmarks = landmarks;
+    return true;
+}
+
 void DCCInterface::get51SetLandmarksCurrentFace()
 {
+    m_currentFaceVertices.clear();
+
     // get pixel landmarks indices 
-    std::vector<int> landmarksIndex = m_facialLandmark->getLandmarksPixelIndex();
+    if (!hasRigSnapshot("get51SetLandmarksCurrentFace")) return;
+    std::vector<int> landmarksIndex = m_rigSnapshot->landmarksPixelIndex();
     if(landmarksIndex.empty())
     {
         std::cout << "[DCCInterface][ERROR]: The vector landmarks pixel index is empty" << "\n";
@@ -222,162 +274,146 @@ void DCCInterface::get51SetLandmarksCurrentFace()
         glm::vec3 verticesxindex = m_generatedCurrentLandmarks[index];
         m_currentFaceVertices.push_back(verticesxindex);
     }
+
+    PipelineMetrics::framesProcessed().add();
+
+    // remove head motion and scale before any distance is measured
+    if (m_headPose.isValid() && !m_headPose.align(m_currentFaceVertices.data(), m_currentFaceVertices.size())) {
+        std::cerr << "[DCCInterface] Could not estimate the head pose of the current frame\n";
+    }
     std::cout << "[DCCInterface]: The subset vector for current face have : " << m_currentFaceVertices.size() << " landmarks entries. "<< "\n";
 }
 
-void DCCInterface::computeLandmarksNeutralDistanceData(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap)
+bool DCCInterface::loadNeutralProfile(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap, const std::string& neutralJson, const std::string& cacheDir)
 {
-    for (const auto& [auId, landmarkUnits] : landmarksAUMap)
-    {
-        for (const auto& unit : landmarkUnits)
-        {
-            std::cout << "[DCCInterface]: [DEBUG] Checking AU " << auId << ", side: " << sideToString(unit.side) << ", landmarks: " << unit.landmarkIndices.size() << "\n";
-        }
+    std::string path = NeutralProfile::profilePath(cacheDir, NeutralProfile::profileKey(neutralJson, landmarksAUMap));
+    if (!std::filesystem::exists(path) || !m_neutralProfile.load(path)) {
+        PipelineMetrics::neutralProfileMisses().add();
+        return false;
     }
+    PipelineMetrics::neutralProfileHits().add();
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(path.c_str()));
 
-    for (const auto& [auId, auGroup] : landmarksAUMap)
-    {
-        for (const auto& landmarksAU : auGroup)
-        {
-            const auto& indices = landmarksAU.landmarkIndices;
-            if (indices.size() < 2) continue;
-
-            landmarksDistanceData result;
-            result.auId = landmarksAU.auId;
-            result.side = sideToString(landmarksAU.side);
-            result.landmarkIndices = indices;
-
-            if (indices.size() % 2 == 0)
-            {
-                for (size_t i = 0; i < indices.size() - 1; i += 2)
-                {
-                    size_t indexA = indices[i];
-                    size_t indexB = indices[i + 1];
-
-                    if (indexA >= m_neutralFaceVertices.size() || indexB >= m_neutralFaceVertices.size()) {
-                        std::cout << "[WARNING] Invalid landmark index: " << indexA << " or " << indexB << "\n";
-                        continue;
-                    }
-
-                    glm::vec3 vertexA = m_neutralFaceVertices[indexA];
-                    glm::vec3 vertexB = m_neutralFaceVertices[indexB];
-
-                    float distance = m_mathUtils.calculateEuclidianDistance(vertexA, vertexB);
-         
-                    std::cout << "[DCCInterface]: AU " << result.auId << " - Distance between " << indexA << " and " << indexB << ": " << distance << "\n";
-                }
-            }
-            else
-            {
-                std::cout << "[DCCInterface]: [INFO] Landmark group has odd number of points: AU " << result.auId << ", side: " << result.side << "\n";
-            }
+    m_neutralFaceVertices = m_neutralProfile.landmarks();
+    std::cout << "[DCCInterface] Reusing the neutral profile " << path << " (" << m_neutralProfile.entries().size() << " AU pairs)\n";
+    return true;
+}
 
-            m_landmarksDistanceNeutraResults.push_back(result);
-        }
+bool DCCInterface::buildNeutralProfile(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap, const std::string& neutralJson, const std::string& cacheDir)
+{
+    if (!m_neutralProfile.compute(landmarksAUMap, m_neutralFaceVertices)) {
+        return false;
     }
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDir, error);
+    std::string path = NeutralProfile::profilePath(cacheDir, NeutralProfile::profileKey(neutralJson, landmarksAUMap));
+    if (!m_neutralProfile.save(path)) {
+        std::cerr << "[DCCInterface] Could not save the neutral profile: " << path << "\n";
+    }
+    return true;
 }
 
-void DCCInterface::computeLandmarksCurrentDistanceData(const std::unordered_map<int,std::vector<landmarksActionUnit>>& landmarksAUMap)
+bool DCCInterface::prepareFrameEvaluator()
 {
-    for (const auto& [auId, landmarkUnits] : landmarksAUMap)
+    MemoryScope memory(MemorySubsystem::dccInterface);
+    if (!hasRigSnapshot("prepareFrameEvaluator")) {
+        m_frameEvaluator.reset();
+        return false;
+    }
+    std::shared_ptr<const CompiledFaceRig> rig = m_rigSnapshot;
+    if (!rig || rig->slotCount() == 0) {
+        std::cerr << "[DCCInterface][ERROR] No AU slot to evaluate\n";
+        m_frameEvaluator.reset();
+        return false;
+    }
+    m_frameEvaluator = std::make_unique<FrameEvaluator>(rig);
+
+    // the profile already holds the neutral distances, otherwise measure them on the 51 neutral landmarks
+    if (m_neutralProfile.isValid())
     {
-        for (const auto& unit : landmarkUnits)
+        for (size_t slot = 0; slot < rig->slotCount(); ++slot)
         {
-            std::cout << "[DCCInterface]: [DEBUG] Checking AU " << auId << ", side: " << sideToString(unit.side) << ", landmarks: " << unit.landmarkIndices.size() << "\n";
+            const AUSlot& au = rig->slots()[slot];
+            if (au.pairBegin == au.pairEnd) continue;
+            float distance = m_neutralProfile.distance(au.auId, au.side);
+            if (distance >= 0.0f) {
+                m_frameEvaluator->setBaseDistance(slot, distance);
+            } else {
+                std::cout << "[WARNING] No neutral distance for AU " << au.auId << ", side: " << sideToString(au.side) << "\n";
+            }
         }
     }
+    else
+    {
+        m_frameEvaluator->setNeutralLandmarks(m_neutralFaceVertices);
+    }
 
-    for (const auto& [auId, auGroup] : landmarksAUMap)
+    for (const auto& [key, range] : m_auThresholds)
     {
-        for (const auto& landmarksAU : auGroup)
-        {
-            const auto& indices = landmarksAU.landmarkIndices;
-            if (indices.size() < 2) continue;
-
-            landmarksDistanceData result;
-            result.auId = landmarksAU.auId;
-            result.side = sideToString(landmarksAU.side);
-            result.landmarkIndices = indices;
-
-            if (indices.size() % 2 == 0)
-            {
-                for (size_t i = 0; i < indices.size() - 1; i += 2)
-                {
-                    size_t indexA = indices[i];
-                    size_t indexB = indices[i + 1];
-
-                    if (indexA >= m_generatedCurrentLandmarks.size() || indexB >= m_generatedCurrentLandmarks.size()) {
-                        std::cout << "[WARNING] Invalid landmark index: " << indexA << " or " << indexB << "\n";
-                        continue;
-                    }
-
-                    glm::vec3 vertexA = m_generatedCurrentLandmarks[indexA];
-                    glm::vec3 vertexB = m_generatedCurrentLandmarks[indexB];
-
-                    float distance = m_mathUtils.calculateEuclidianDistance(vertexA, vertexB);
-                    result.currentDistance = distance;
-         
-                    std::cout << "[DCCInterface]: AU " << result.auId << " - Distance between " << indexA << " and " << indexB << ": " << distance << "\n";
-                }
-            }
-            else
-            {
-                std::cout << "[DCCInterface]: [INFO] Landmark group has odd number of points: AU " << result.auId << ", side: " << result.side << "\n";
-            }
+        int slot = rig->findSlot(key.first, static_cast<Side>(key.second));
+        if (slot >= 0) m_frameEvaluator->setThresholds(static_cast<size_t>(slot), range.first, range.second);
+    }
 
-            m_landmarksDistanceCurrentResults.push_back(result);
-        }
+    // head pose reference: the landmarks expressions barely move; without it the raw coordinates are evaluated
+    if (!m_headPose.setReference(m_neutralFaceVertices, HeadPoseAligner::stableLandmarks(rig->landmarksPixelIndex()))) {
+        std::cout << "[WARNING] No head pose reference, the current landmarks are evaluated as generated\n";
     }
+    return true;
 }
 
-std::optional<landmarksDistanceData> DCCInterface::evaluateActivatedAUs(float thresholdMin, float thresholdMax)
+bool DCCInterface::loadThresholdCalibration(const char* calibrationJson)
 {
-    float maxDelta = -std::numeric_limits<float>::infinity(); // to store max
-    size_t maxIndex = 0;
+    m_auThresholds.clear();
+
+    std::vector<AUThreshold> thresholds;
+    if (!ThresholdCalibrator::loadCalibration(calibrationJson, thresholds)) {
+        return false;
+    }
 
-    if (m_landmarksDistanceNeutraResults.size() == m_landmarksDistanceCurrentResults.size())
+    for (const auto& threshold : thresholds)
     {
-        for (size_t index = 0; index < m_landmarksDistanceNeutraResults.size(); index++)
-        {
-            float neutralDistance = m_landmarksDistanceNeutraResults[index].baseDistance;
-            float currentDistance = m_landmarksDistanceCurrentResults[index].currentDistance;
-            float delta = currentDistance - neutralDistance;
-
-            if (delta > thresholdMin) // identifying the minimun activation 
-            {
-                std::cout << "The action unit at index " << index 
-                          << " (AU id " << m_landmarksDistanceCurrentResults[index].auId << ") "
-                          << " has a delta of " << delta
-                          << " which exceeds the threshold minimum of: " << thresholdMin << "\n";
-
-                if (delta > maxDelta) // just testing this with one action unit trigger
-                {
-                    maxDelta = delta;
-                    maxIndex = index;
-                }
-            }
-        }
+        m_auThresholds[{threshold.auId, static_cast<int>(threshold.side)}] = {threshold.minThreshold, threshold.maxThreshold};
+    }
+    std::cout << "[DCCInterface] Loaded calibrated thresholds for " << m_auThresholds.size() << " AU/side pairs\n";
+    return true;
+}
 
-        if (maxDelta > thresholdMin)
-        {
-            auto& resultMaxAU = m_landmarksDistanceCurrentResults[maxIndex];
-            float neutralDistance = m_landmarksDistanceNeutraResults[maxIndex].baseDistance;
-            float currentDistance = m_landmarksDistanceCurrentResults[maxIndex].currentDistance;
-            
-            float intensity = calculateIntensity(thresholdMin, thresholdMax, currentDistance, neutralDistance);
-
-            resultMaxAU.intensity = intensity;
-            resultMaxAU.isActive = true;
-
-            std::cout << "\n==> Max activated AU:\n" 
-            << "Index: " << maxIndex << "\n" 
-            << "AU id: " << resultMaxAU.auId << "\n" 
-            << "isActive: " << resultMaxAU.isActive << "\n" 
-            << "AU intensity: " << resultMaxAU.intensity << "\n";
-            return resultMaxAU;
-        }
+std::optional<landmarksDistanceData> DCCInterface::evaluateActivatedAUs(float thresholdMin, float thresholdMax)
+{
+    if (!m_frameEvaluator) {
+        std::cerr << "[DCCInterface][ERROR] prepareFrameEvaluator was not called\n";
+        return std::nullopt;
+    }
+
+    MetricTimer timer(PipelineMetrics::evaluateSeconds());
+    // the records of the previous frame are no longer referenced
+    m_frameArena.reset();
+    FrameEvaluation evaluation = m_frameEvaluator->evaluate(m_currentFaceVertices.data(), m_currentFaceVertices.size(),
+                                                            thresholdMin, thresholdMax, m_frameArena);
+    if (evaluation.strongest < 0) return std::nullopt;
+
+    const landmarksDistanceData& resultMaxAU = evaluation.records[evaluation.strongest];
+    std::cout << "\n==> Max activated AU:\n"
+    << "Slot: " << resultMaxAU.slot << "\n"
+    << "AU id: " << resultMaxAU.auId << " (" << sideToString(resultMaxAU.side) << ")\n"
+    << "isActive: " << resultMaxAU.isActive << "\n"
+    << "AU intensity: " << resultMaxAU.intensity << "\n";
+    return resultMaxAU;
+}
+
+bool DCCInterface::solveActionUnitWeights(const AUSolver& solver, std::vector<float>& weights)
+{
+    if (m_neutralFaceVertices.size() != solver.landmarkCount() || m_currentFaceVertices.size() != solver.landmarkCount()) {
+        std::cerr << "[DCCInterface][ERROR] Landmark sets do not match the AU solver: neutral " << m_neutralFaceVertices.size()
+                  << ", current " << m_currentFaceVertices.size() << ", solver " << solver.landmarkCount() << "\n";
+        return false;
     }
-    return std::nullopt;
+
+    MetricTimer timer(PipelineMetrics::evaluateSeconds());
+    // generated landmarks are normalised image coordinates, bring the displacement into the rig's mesh space
+    std::vector<glm::vec3> displacement = AUSolver::imageToMeshDisplacement(m_neutralFaceVertices, m_currentFaceVertices, m_inputMeshLandmarks3D);
+    return solver.solve(displacement, weights);
 }
 
 float DCCInterface::calculateIntensity(float thresholdMin, float thresholdMax, float currentDistance, float baseDistance)
@@ -390,7 +426,20 @@ float DCCInterface::calculateIntensity(float thresholdMin, float thresholdMax, f
     return m_inputMeshLandmarks3D;
  }
 
- std::unordered_map<int, std::vector<glm::vec3>> DCCInterface::returnMapMuscleVertices()
+MemoryFootprint DCCInterface::memoryFootprint() const
 {
-    return m_mapLandmarksActionUnitVertices;
-}
\ No newline at end of file
+    MemoryFootprint footprint;
+    footprint.add("meshInputVertices", heapBytes(m_meshInputVertices));
+    footprint.add("meshInputTriangles", heapBytes(m_meshInputTriangles));
+    footprint.add("inputMeshLandmarks", heapBytes(m_inputMeshLandmarks3D));
+    footprint.add("generatedLandmarks", heapBytes(m_generatedNeutralLandmarks) + heapBytes(m_generatedCurrentLandmarks));
+    footprint.add("faceLandmarks", heapBytes(m_neutralFaceVertices) + heapBytes(m_currentFaceVertices));
+    footprint.add("auThresholds", heapBytes(m_auThresholds));
+    footprint.add("musclePatches", m_musclePatches.memoryFootprint());
+    footprint.add("correspondence", m_correspondence.memoryFootprint());
+    footprint.add("neutralProfile", m_neutralProfile.memoryFootprint());
+    if (m_frameEvaluator) footprint.add("frameEvaluator", m_frameEvaluator->memoryFootprint());
+    footprint.add("frameArena", m_frameArena.memoryFootprint());
+    footprint.add("headPose", m_headPose.memoryFootprint());
+    return footprint;
+}
@@ -7,9 +7,34 @@
 #include <maya/MFnDependencyNode.h>
 #include <maya/MStringArray.h>
 #include <maya/MDagModifier.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
 #include "MayaMesh.h"
 #include <maya/MVector.h>
 
+static MStatus readMeshPoints(const MObject& shape, std::vector<glm::vec3>& pointsOut, MFnMesh& meshFnOut)
+{
+    MStatus status;
+    MDagPath dagPath;
+    status = MDagPath::getAPathTo(shape, dagPath);
+    if (status != MS::kSuccess) return status;
+    status = dagPath.extendToShape();
+    if (status != MS::kSuccess) return status;
+
+    status = meshFnOut.setObject(dagPath);
+    if (status != MS::kSuccess) return status;
+
+    MFloatPointArray points;
+    status = meshFnOut.getPoints(points, MSpace::kWorld);
+    if (status != MS::kSuccess) return status;
+
+    pointsOut.resize(points.length());
+    for (unsigned i = 0; i < points.length(); ++i) {
+        pointsOut[i] = glm::vec3(points[i].x, points[i].y, points[i].z);
+    }
+    return MS::kSuccess;
+}
+
 MString MayaMesh::convertModelPathToMString(const QString& path)
 {
     QString cleaned = path;
@@ -59,6 +84,10 @@ MStatus MayaMesh::loadMayaMuscle(const MString& objPath)
     MStatus status = importObjMesh(objPath, _muscleTransform, _muscleShape, _name);
     if (status != MS::kSuccess)
         MGlobal::displayError("Error importing OBJ: " + objPath);
+    else {
+        _appliedOffsets.reset(); // a new shape is at rest, the offsets of the previous one do not apply to it
+        _landmarkSkinned = false;
+    }
 
     return status;
 }
@@ -112,6 +141,12 @@ MObject MayaMesh::getMayaMuscle()
     return _muscleShape;
 }
 
+bool MayaMesh::isAssetBound() const
+{
+    // the user may have deleted the nodes since they were imported
+    return _proximityWrap.isBound() && MObjectHandle(_muscleShape).isValid() && MObjectHandle(_skinShape).isValid();
+}
+
 MObject MayaMesh::createJoint(const MVector& position, const std::string& name) 
 {
     MStatus status;
@@ -135,6 +170,8 @@ MStatus MayaMesh::prepareMeshSkinning(std::vector<glm::vec3> m_inputMeshLandmark
         MGlobal::displayError("Muscle mesh is invalid.");
         return MS::kFailure;
     }
+    // the joints and the skinCluster are created once per imported muscle
+    if (_landmarkSkinned) return MS::kSuccess;
 
     MObjectArray jointObjects;
 
@@ -150,7 +187,7 @@ MStatus MayaMesh::prepareMeshSkinning(std::vector<glm::vec3> m_inputMeshLandmark
         jointObjects.append(joint);
     }
 
-    createSkinCluster(jointObjects, muscle);
+    if (createSkinCluster(jointObjects, muscle) == MS::kSuccess) _landmarkSkinned = true;
     
     return MS::kSuccess;
 }
@@ -186,87 +223,249 @@ MStatus MayaMesh::createSkinCluster(const MObjectArray& joints, const MObject& s
     return MS::kSuccess;
 }
 
-MStatus MayaMesh::muscleDeformation( const std::unordered_map<int,std::vector<ActionUnitDelta>>& auDeltaTable, const std::optional<landmarksDistanceData>& activeAU_opt)
+MStatus MayaMesh::applyMuscleOffsets(const std::function<void(std::vector<glm::vec3>& offsets)>& accumulate)
 {
+    if (_muscleShape == MObject::kNullObj)
+        return MS::kFailure;
 
-    std::cout << "inside the muscle deformation";
+    MFnMesh meshFn;
+    std::vector<glm::vec3> current;
+    MStatus status = readMeshPoints(_muscleShape, current, meshFn);
+    if (status != MS::kSuccess) return status;
+
+    const unsigned vertCount = static_cast<unsigned>(current.size());
+    std::vector<glm::vec3> offsets(vertCount, glm::vec3(0.0f));
+    accumulate(offsets);
+
+    // the new offsets replace the ones applied last
+    _appliedOffsets.toRest(current);
+    MFloatPointArray points(vertCount);
+    for (unsigned i = 0; i < vertCount; ++i) {
+        const glm::vec3 p = current[i] + offsets[i];
+        points[i] = MFloatPoint(p.x, p.y, p.z);
+    }
+
+    status = meshFn.setPoints(points, MSpace::kWorld);
+    if (status == MS::kSuccess) {
+        _appliedOffsets.record(std::move(offsets));
+    }
+    return status;
+}
+
+MStatus MayaMesh::muscleDeformation(const CompiledFaceRig& rig, const std::optional<landmarksDistanceData>& activeAU_opt)
+{
     if (!activeAU_opt.has_value())
         return MS::kSuccess;
 
-    int   auId      = activeAU_opt->auId;
-    std::cout << "auId  : " << auId;
-    float intensity = activeAU_opt->intensity;
-    std::cout << "intensity : " << intensity;
+    const int   auId      = activeAU_opt->auId;
+    const float intensity = activeAU_opt->intensity;
+
+    // every side of the AU contributes, scaled by the intensity of the frame
+    return applyMuscleOffsets([&](std::vector<glm::vec3>& offsets) {
+        const auto& deltaVertices = rig.deltaVertices();
+        const auto& deltaValues = rig.deltaValues();
+        for (const AUSlot& slot : rig.slots())
+        {
+            if (slot.auId != auId) continue;
+            for (uint32_t i = slot.deltaBegin; i < slot.deltaEnd; ++i)
+            {
+                const uint32_t idx = deltaVertices[i];
+                if (idx >= offsets.size()) continue;
+                offsets[idx] += deltaValues[i] * intensity;
+            }
+        }
+    });
+}
 
+MStatus MayaMesh::muscleDeformation(const CompiledFaceRig& rig, const std::vector<float>& slotWeights)
+{
+    if (slotWeights.size() != rig.slotCount())
+        return MS::kInvalidParameter;
+
+    // weighted sum of every slot, the intensity is already part of each weight; vertex tiles are
+    // accumulated on all cores without locks and tiles of zero-weight AUs are skipped
+    return applyMuscleOffsets([&](std::vector<glm::vec3>& offsets) {
+        rig.deltaTiles().accumulate(slotWeights, offsets.data(), offsets.size(), 0);
+    });
+}
+
+MStatus MayaMesh::getMuscleRestPoints(std::vector<glm::vec3>& vertices)
+{
     if (_muscleShape == MObject::kNullObj)
         return MS::kFailure;
 
-    // 1) Build MFnMesh
-    MStatus status;
-    MDagPath dagPath;
-    status = MDagPath::getAPathTo(_muscleShape, dagPath);
+    MFnMesh meshFn;
+    MStatus status = readMeshPoints(_muscleShape, vertices, meshFn);
     if (status != MS::kSuccess) return status;
-    status = dagPath.extendToShape();
+
+    // the AU deformation applied last is tracked in _appliedOffsets
+    _appliedOffsets.toRest(vertices);
+    return MS::kSuccess;
+}
+
+MStatus MayaMesh::setMusclePoints(const std::vector<glm::vec3>& vertices)
+{
+    if (_muscleShape == MObject::kNullObj)
+        return MS::kFailure;
+
+    MFnMesh meshFn;
+    std::vector<glm::vec3> current;
+    MStatus status = readMeshPoints(_muscleShape, current, meshFn);
     if (status != MS::kSuccess) return status;
+    if (vertices.size() != current.size())
+        return MS::kInvalidParameter;
+
+    // keep the offsets from rest recorded, so muscleDeformation() still composes with the buffer
+    _appliedOffsets.toRest(current);
+    MFloatPointArray points(static_cast<unsigned>(vertices.size()));
+    std::vector<glm::vec3> offsets(vertices.size());
+    for (unsigned i = 0; i < points.length(); ++i) {
+        points[i] = MFloatPoint(vertices[i].x, vertices[i].y, vertices[i].z);
+        offsets[i] = vertices[i] - current[i];
+    }
 
-    MFnMesh meshFn(dagPath, &status);
+    status = meshFn.setPoints(points, MSpace::kWorld);
+    if (status == MS::kSuccess) {
+        _appliedOffsets.record(std::move(offsets));
+    }
+    return status;
+}
+
+MStatus MayaMesh::bindSkinToMuscle()
+{
+    if (_muscleShape.isNull() || _skinShape.isNull()) {
+        MGlobal::displayError("Muscle and skin meshes must be loaded before binding.");
+        return MS::kFailure;
+    }
+
+    MStatus status;
+    MFnMesh muscleFn;
+    std::vector<glm::vec3> muscleVertices;
+    status = readMeshPoints(_muscleShape, muscleVertices, muscleFn);
     if (status != MS::kSuccess) return status;
 
-    std::cout <<  "read points part ";
-    // 2) Read points
-    MFloatPointArray points;
-    status = meshFn.getPoints(points, MSpace::kWorld);
+    MIntArray triangleCounts;
+    MIntArray triangleVertices;
+    status = muscleFn.getTriangles(triangleCounts, triangleVertices);
     if (status != MS::kSuccess) return status;
 
-    // 3) Number of verts
-    const unsigned vertCount = points.length();
+    std::vector<unsigned int> muscleTriangles(triangleVertices.length());
+    for (unsigned i = 0; i < triangleVertices.length(); ++i) {
+        muscleTriangles[i] = static_cast<unsigned int>(triangleVertices[i]);
+    }
 
-    // 4) Prepare prevAccums buffer
-    _prevAccums.setLength(vertCount);
-    for (unsigned i = 0; i < vertCount; ++i) {
-        _prevAccums[i] = MVector(0.0, 0.0, 0.0);
+    MFnMesh skinFn;
+    std::vector<glm::vec3> skinVertices;
+    status = readMeshPoints(_skinShape, skinVertices, skinFn);
+    if (status != MS::kSuccess) return status;
+
+    if (!_proximityWrap.bind(skinVertices, muscleVertices, muscleTriangles)) {
+        MGlobal::displayError("Failed to bind the skin mesh to the muscle mesh.");
+        return MS::kFailure;
     }
 
-    // 5) Build currAccums
-    MVectorArray currAccums;
-    currAccums.setLength(vertCount);
-    for (unsigned i = 0; i < vertCount; ++i) {
-        currAccums[i] = MVector(0.0, 0.0, 0.0);
+    MGlobal::displayInfo("Proximity wrap binding created.");
+    return MS::kSuccess;
+}
+
+MStatus MayaMesh::applyProximityWrap()
+{
+    if (!_proximityWrap.isBound()) {
+        MGlobal::displayError("Proximity wrap is not bound.");
+        return MS::kFailure;
     }
 
-    // 6) Accumulate
-    auto it = auDeltaTable.find(auId);
-    if (it != auDeltaTable.end()) {
-        const auto& auList = it->second;
-        auto accumulateMuscles = [&](auto const& muscles) {
-            for (auto const& m : muscles) {
-                for (auto const& vd : m.deltas) {
-                    int idx = vd.vertexIndex;
-                    if (idx < 0 || idx >= (int)vertCount) continue;
-                    currAccums[idx] += MVector(vd.delta.x,
-                                               vd.delta.y,
-                                               vd.delta.z);
-                }
-            }
-        };
-        for (auto const& au : auList) {
-            accumulateMuscles(au.activeMuscles);
-            accumulateMuscles(au.passiveMuscles);
-        }
+    MStatus status;
+    MFnMesh muscleFn;
+    std::vector<glm::vec3> muscleVertices;
+    status = readMeshPoints(_muscleShape, muscleVertices, muscleFn);
+    if (status != MS::kSuccess) return status;
+
+    std::vector<glm::vec3> skinVertices;
+    if (!_proximityWrap.apply(muscleVertices, skinVertices)) return MS::kFailure;
+
+    MFloatPointArray skinPoints(static_cast<unsigned>(skinVertices.size()));
+    for (unsigned i = 0; i < skinPoints.length(); ++i) {
+        skinPoints.set(i, skinVertices[i].x, skinVertices[i].y, skinVertices[i].z);
     }
 
-    // 7) Apply delta-of-delta
-    for (unsigned i = 0; i < vertCount; ++i) {
-        MVector diff = currAccums[i] - _prevAccums[i];
-        points[i].x += diff.x * intensity;
-        points[i].y += diff.y * intensity;
-        points[i].z += diff.z * intensity;
+    MFnMesh skinFn;
+    MDagPath skinPath;
+    status = MDagPath::getAPathTo(_skinShape, skinPath);
+    if (status != MS::kSuccess) return status;
+    status = skinPath.extendToShape();
+    if (status != MS::kSuccess) return status;
+    status = skinFn.setObject(skinPath);
+    if (status != MS::kSuccess) return status;
+
+    return skinFn.setPoints(skinPoints, MSpace::kWorld);
+}
+
+// Shows or hides the transform of a mesh, skipping nodes the user deleted.
+static void setMeshVisible(const MObject& transform, bool visible)
+{
+    if (!MObjectHandle(transform).isValid()) return;
+    MFnDagNode fn(transform);
+    MPlug visibility = fn.findPlug("visibility", true);
+    if (!visibility.isNull()) visibility.setBool(visible);
+}
+
+MStatus MayaMesh::showPreviewProxy(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& triangles)
+{
+    removePreviewProxy();
+
+    MFloatPointArray points(static_cast<unsigned>(vertices.size()));
+    for (unsigned i = 0; i < points.length(); ++i) {
+        points.set(i, vertices[i].x, vertices[i].y, vertices[i].z);
+    }
+    MIntArray polygonCounts(static_cast<unsigned>(triangles.size() / 3), 3);
+    MIntArray polygonConnects(static_cast<unsigned>(triangles.size()));
+    for (unsigned i = 0; i < polygonConnects.length(); ++i) {
+        polygonConnects[i] = static_cast<int>(triangles[i]);
     }
 
-    // 8) Write back (reuse existing 'status')
-    status = meshFn.setPoints(points, MSpace::kWorld);
-    if (status == MS::kSuccess) {
-        _prevAccums = currAccums;
+    MStatus status;
+    MFnMesh meshFn;
+    _proxyTransform = meshFn.create(points.length(), polygonCounts.length(), points, polygonCounts, polygonConnects,
+                                    MObject::kNullObj, &status);
+    if (status != MS::kSuccess) {
+        MGlobal::displayError("Failed to create the preview proxy mesh.");
+        _proxyTransform = MObject::kNullObj;
+        return status;
     }
-    return status;
-}
\ No newline at end of file
+    _proxyShape = meshFn.object();
+    renameMesh(_proxyTransform, MString((_name + "PreviewProxy").c_str()));
+    MGlobal::executeCommand("sets -e -forceElement initialShadingGroup " + MFnDagNode(_proxyTransform).fullPathName());
+
+    setMeshVisible(_muscleTransform, false);
+    setMeshVisible(_skinTransform, false);
+    return MS::kSuccess;
+}
+
+MStatus MayaMesh::setPreviewProxyPoints(const std::vector<glm::vec3>& vertices)
+{
+    // frames queued before the preview stopped may arrive after the proxy is gone
+    if (!MObjectHandle(_proxyShape).isValid())
+        return MS::kFailure;
+
+    MFnMesh meshFn(_proxyShape);
+    if (static_cast<size_t>(meshFn.numVertices()) != vertices.size())
+        return MS::kInvalidParameter;
+
+    MFloatPointArray points(static_cast<unsigned>(vertices.size()));
+    for (unsigned i = 0; i < points.length(); ++i) {
+        points.set(i, vertices[i].x, vertices[i].y, vertices[i].z);
+    }
+    return meshFn.setPoints(points, MSpace::kObject);
+}
+
+void MayaMesh::removePreviewProxy()
+{
+    if (MObjectHandle(_proxyTransform).isValid())
+        MGlobal::deleteNode(_proxyTransform);
+    _proxyTransform = MObject::kNullObj;
+    _proxyShape = MObject::kNullObj;
+
+    setMeshVisible(_muscleTransform, true);
+    setMeshVisible(_skinTransform, true);
+}
@@ -0,0 +1,126 @@
+#ifndef AUSOLVER_H_
+#define AUSOLVER_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "CompiledFaceRig.h"
+#include "MemoryFootprint.h"
+
+/**
+ * @struct AUSolverOptions
+ * @brief Tuning parameters of the AU weight solver.
+ */
+struct AUSolverOptions {
+    float regularization = 1e-4f;   ///< Ridge term added to the Gram diagonal (relative to its mean diagonal)
+    float lowerBound = 0.0f;        ///< Minimum AU weight
+    float upperBound = 1.0f;        ///< Maximum AU weight
+    int maxIterations = 64;         ///< Projected Gauss-Seidel sweeps when a bound is active
+    float tolerance = 1e-6f;        ///< Stop when no weight changes more than this in a sweep
+};
+
+/**
+ * @class AUSolver
+ * @brief Solves all AU weights of a frame together from the landmark displacements.
+ *
+ * The basis holds, for every AU slot of the rig, the displacement of the 51 landmark vertices (landmarksMeshIndex)
+ * at full intensity. A frame is solved as bounded least squares:
+ *
+ *     min |B w - d|^2 + lambda |w|^2   subject to lowerBound <= w <= upperBound
+ *
+ * The Gram matrix B^T B and its Cholesky factor are computed once in build(). Per frame only B^T d is formed; the
+ * unconstrained solution comes from two triangular solves and, if it leaves the box, projected Gauss-Seidel sweeps
+ * on the Gram matrix refine it starting from the previous frame's weights.
+ */
+class AUSolver {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    AUSolver() = default;
+
+    /**
+     * @brief Samples the landmark basis from the rig and prefactors its Gram matrix.
+     * @param rig Compiled rig providing the AU slots, deltas and landmark mesh indices.
+     * @param options Solver options.
+     * @return False if the rig has no slots or no landmarks.
+     */
+    bool build(const CompiledFaceRig& rig, const AUSolverOptions& options = AUSolverOptions());
+
+    /**
+     * @brief Solves one frame.
+     * @param displacement Displacement of every landmark from the neutral pose, in mesh space.
+     * @param weights In: warm start (resized and zeroed if it has the wrong size). Out: one weight per slot.
+     * @return False if the solver is not built or the displacement has the wrong size.
+     */
+    bool solve(const std::vector<glm::vec3>& displacement, std::vector<float>& weights) const;
+
+    /**
+     * @brief Solves a whole clip.
+     *
+     * Frames are split into contiguous runs that are solved in parallel; inside a run every frame is warm-started
+     * from the weights of the frame before it. In ReductionMode::deterministic the runs have a fixed length, so the
+     * weights do not depend on the worker count.
+     * @param displacements Landmark displacements per frame.
+     * @param weights Output weights per frame.
+     * @param workerCount Number of worker threads (0 uses all hardware threads).
+     * @return False if the solver is not built or a frame has the wrong size.
+     */
+    bool solveClip(const std::vector<std::vector<glm::vec3>>& displacements,
+                   std::vector<std::vector<float>>& weights,
+                   unsigned int workerCount = 0) const;
+
+    /**
+     * @brief Converts the image space motion of the generated landmarks into the mesh space displacement solve() takes.
+     *
+     * Generated landmarks are MediaPipe normalised image coordinates: x to the right, y down and z growing away
+     * from the camera. The rig is y up and faces +z, so y and z are negated, then the displacement is scaled by the
+     * ratio of the bounding box diagonals of the mesh landmarks and the neutral landmarks.
+     * @param neutralLandmarks Landmarks of the neutral frame (image space).
+     * @param currentLandmarks Landmarks of the current frame, head pose removed (image space).
+     * @param meshLandmarks The same landmarks on the rig's rest mesh (mesh space), used for the scale.
+     * @return One displacement per landmark, empty if the neutral and current sets differ in size.
+     */
+    static std::vector<glm::vec3> imageToMeshDisplacement(const std::vector<glm::vec3>& neutralLandmarks,
+                                                          const std::vector<glm::vec3>& currentLandmarks,
+                                                          const std::vector<glm::vec3>& meshLandmarks);
+
+    /**
+     * @brief Returns the number of AU slots (unknowns).
+     */
+    size_t slotCount() const { return m_slotCount; }
+
+    /**
+     * @brief Returns the number of landmarks in the basis.
+     */
+    size_t landmarkCount() const { return m_landmarkCount; }
+
+    /**
+     * @brief Returns the basis, row major with 3 * landmarkCount() rows and slotCount() columns.
+     */
+    const std::vector<float>& basis() const { return m_basis; }
+
+    /**
+     * @brief Returns true once build() succeeded.
+     */
+    bool isBuilt() const { return m_slotCount > 0; }
+
+    /**
+     * @brief Returns the heap bytes of the landmark basis and of the factorized normal equations.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    void project(const glm::vec3* displacement, double* rhs) const;
+    void solveNormal(const double* rhs, float* weights, double* scratch) const;  ///< scratch: slotCount() doubles
+
+    AUSolverOptions m_options;          ///< Options used by build()
+    size_t m_slotCount = 0;             ///< Number of unknowns
+    size_t m_landmarkCount = 0;         ///< Number of landmarks
+    std::vector<float> m_basis;         ///< (3L x K) row major basis
+    std::vector<double> m_gram;         ///< Regularised Gram matrix (K x K)
+    std::vector<double> m_cholesky;     ///< Lower triangular Cholesky factor of m_gram (K x K)
+};
+
+#endif
@@ -9,8 +9,10 @@
 #include <nlohmann/json.hpp>
 
 #include "FacialMesh.h"
+#include "MemoryFootprint.h"
 #include "MathUtils.h"
 #include "Side.h"
+#include "SymmetryMap.h"
 
 /**
  * @struct VertexDelta
@@ -44,8 +46,15 @@ struct ActionUnitDelta {
     Side side;                  ///< Side of the face (e.g., "left", "right", "center")
     std::vector<MuscleDelta> activeMuscles;   ///< Muscles actively contributing to the AU
     std::vector<MuscleDelta> passiveMuscles;  ///< Muscles passively affected by the AU
+    bool mirrored = false;                    ///< The mirrorSide() entry is not stored, it is synthesized from this one
 };
 
+/**
+ * Heap bytes of an AU delta table: "auDeltaTable" for the per-AU and per-muscle vectors, "auDeltaEntries" for the
+ * vertex delta entries.
+ */
+MemoryFootprint auDeltaTableFootprint(const std::unordered_map<int, std::vector<ActionUnitDelta>>& table);
+
 /**
  * @class ActionUnit
  * @brief Manages facial deformation data based on Action Units (AUs).
@@ -71,6 +80,19 @@ public:
      */
     bool loadModelPathsFromJSON(const char* pathsJson, const char* basePath);
 
+    /**
+     * @brief Enables mirrored preprocessing: loadModelPathsFromJSON() then builds (or reuses) the symmetry map of the
+     * neutral face and skips the right-hand blendshape of every mirrored pair, whose deltas are synthesized from the
+     * left-hand one when the rig is compiled.
+     * @param cachePath Symmetry map cache file; an empty path disables mirroring.
+     */
+    void setSymmetryCachePath(const std::string& cachePath) { m_symmetryCachePath = cachePath; }
+
+    /**
+     * @brief Returns the symmetry map of the template, or nullptr if the table has no mirrored entry.
+     */
+    std::shared_ptr<const SymmetryMap> getSymmetryMap() const { return m_symmetryMap; }
+
     /**
      * @brief Loads the muscle index map from a JSON file.
      * @param musclesJson JSON string containing muscle-to-vertex mappings.
@@ -165,6 +187,12 @@ public:
      */
     std::unordered_map<int, std::vector<int>> getMuscleIndexMap();
 
+    /**
+     * @brief Returns the heap bytes held by the tables: the AU delta table (per-AU and per-muscle vectors, then the
+     * vertex delta entries), the muscle map, the cached neutral vertices and the symmetry map built here.
+     */
+    MemoryFootprint memoryFootprint() const;
+
 private:
     std::unique_ptr<FacialMesh> m_facialMesh;                             ///< Facial mesh utility for loading and processing mesh data
     std::unique_ptr<MathUtils> m_mathUtils;                               ///< Utility for computing delta transfers
@@ -172,6 +200,8 @@ private:
     std::unordered_map<int, std::vector<int>> m_muscleIndexMap;           ///< Muscle-to-vertex mapping
     std::vector<glm::vec3> m_neutralFaceVertices;                         ///< Cached neutral face vertices
     VertexDelta m_vertexDelta;                                            ///< Temporary vertex delta container
+    std::string m_symmetryCachePath;                                      ///< Symmetry map cache, empty when mirroring is off
+    std::shared_ptr<const SymmetryMap> m_symmetryMap;                     ///< Mirror table of the template
 };
 
 #endif 
@@ -0,0 +1,50 @@
+#ifndef APPLIEDOFFSETS_H_
+#define APPLIEDOFFSETS_H_
+
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @class AppliedOffsets
+ * @brief Offsets from rest last written to a mesh that is deformed in place.
+ *
+ * The DCC mesh only holds its current points, so the rest pose is recovered by subtracting the offsets written last.
+ * A freshly imported mesh is at rest: reset() must be called then, or the offsets of the previous import would be
+ * subtracted from it. Offsets recorded for another vertex count are ignored.
+ */
+class AppliedOffsets {
+public:
+    /**
+     * @brief Forgets the recorded offsets; the mesh is at rest.
+     */
+    void reset() { m_offsets.clear(); }
+
+    /**
+     * @brief Returns true if offsets are recorded for a mesh of this many vertices.
+     */
+    bool tracks(size_t vertexCount) const { return !m_offsets.empty() && m_offsets.size() == vertexCount; }
+
+    /**
+     * @brief Turns the current points of the mesh into its rest pose.
+     * @param points Current points, replaced by the rest points.
+     */
+    void toRest(std::vector<glm::vec3>& points) const;
+
+    /**
+     * @brief Records the offsets now written to the mesh.
+     * @param offsets Offset from rest of every vertex.
+     */
+    void record(std::vector<glm::vec3> offsets) { m_offsets = std::move(offsets); }
+
+    /**
+     * @brief Returns the recorded offsets (empty at rest).
+     */
+    const std::vector<glm::vec3>& offsets() const { return m_offsets; }
+
+private:
+    std::vector<glm::vec3> m_offsets;   ///< Offset from rest of every vertex, empty at rest
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef ATOMICTABLE_H_
+#define ATOMICTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class AtomicTable
+ * @brief Published read-only snapshot of a table, replaced as a whole by an atomic pointer swap.
+ *
+ * Readers take a reference-counted snapshot with load() and keep using it for as long as they need, even if a newer
+ * version is published meanwhile; they never wait for a writer. Writers build the new table aside and publish it
+ * with store(). The version counter lets readers notice that a newer snapshot exists.
+ */
+template <typename T>
+class AtomicTable {
+public:
+    /**
+     * @brief Creates an empty table (load() returns nullptr until the first store()).
+     */
+    AtomicTable() = default;
+
+    /**
+     * @brief Creates a table holding an initial snapshot.
+     */
+    explicit AtomicTable(std::shared_ptr<const T> initial) : m_table(std::move(initial)) {}
+
+    AtomicTable(const AtomicTable&) = delete;
+    AtomicTable& operator=(const AtomicTable&) = delete;
+
+    /**
+     * @brief Returns the current snapshot.
+     */
+    std::shared_ptr<const T> load() const { return std::atomic_load(&m_table); }
+
+    /**
+     * @brief Publishes a new snapshot; readers holding the previous one keep it alive until they drop it.
+     */
+    void store(std::shared_ptr<const T> table)
+    {
+        std::atomic_store(&m_table, std::move(table));
+        m_version.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns the number of store() calls so far.
+     */
+    uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<const T> m_table;   ///< Current snapshot, only accessed through std::atomic_load/store
+    std::atomic<uint64_t> m_version{0}; ///< Publication counter
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef BACKGROUNDJOB_H_
+#define BACKGROUNDJOB_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "WorkerPool.h"
+
+/**
+ * @enum JobState
+ * @brief Lifecycle of a BackgroundJob.
+ */
+enum class JobState {
+    Pending,    ///< Not started yet
+    Running,    ///< Steps are executing on a worker
+    Finished,   ///< Every step succeeded
+    Cancelled,  ///< cancel() was called before the last step completed
+    Failed      ///< A step returned false or threw
+};
+
+/**
+ * @class JobContext
+ * @brief Handle given to a running step to report progress and observe cancellation.
+ */
+class JobContext {
+public:
+    /**
+     * @brief Returns true once cancellation was requested; long steps should poll it and return early.
+     */
+    bool cancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Reports the progress of the current step.
+     * @param fraction Completed fraction of the step, clamped to [0, 1].
+     */
+    void setStepProgress(float fraction);
+
+private:
+    friend class BackgroundJob;
+    JobContext(const std::atomic<bool>& cancelled, std::atomic<float>& progress)
+        : m_cancelled(cancelled), m_progress(progress) {}
+
+    const std::atomic<bool>& m_cancelled;   ///< Owning job's cancel flag
+    std::atomic<float>& m_progress;         ///< Owning job's step progress
+    float m_stepBegin = 0.0f;               ///< Overall progress when the step started
+    float m_stepWeight = 0.0f;              ///< Share of the overall progress owned by the step
+};
+
+/**
+ * @class BackgroundJob
+ * @brief Sequence of named steps run off the calling thread, with weighted progress and cooperative cancellation.
+ *
+ * Steps run in order on one worker of a WorkerPool; progress() and currentStep() can be polled from any thread.
+ * The completion callback is invoked on the worker thread, callers owning UI state must marshal it back themselves.
+ * Jobs are created through create() because the running task keeps the job alive.
+ */
+class BackgroundJob : public std::enable_shared_from_this<BackgroundJob> {
+public:
+    using Step = std::function<bool(JobContext&)>;
+    using CompletionCallback = std::function<void(JobState)>;
+
+    /**
+     * @brief Creates an empty job.
+     */
+    static std::shared_ptr<BackgroundJob> create(std::string name);
+
+    /**
+     * @brief Appends a step. Must be called before start().
+     * @param name Label reported by currentStep() while the step runs.
+     * @param weight Relative share of the overall progress.
+     * @param step Work to run; returning false fails the job.
+     */
+    void addStep(std::string name, float weight, Step step);
+
+    /**
+     * @brief Sets the callback invoked once when the job ends, whatever the final state.
+     */
+    void setCompletionCallback(CompletionCallback callback);
+
+    /**
+     * @brief Queues the job on a pool.
+     * @return False if the job was already started.
+     */
+    bool start(WorkerPool& pool);
+
+    /**
+     * @brief Requests cancellation; the running step finishes or polls cancelled(), the remaining ones are skipped.
+     */
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Blocks until the job has ended.
+     * @return The final state.
+     */
+    JobState wait();
+
+    /**
+     * @brief Returns the overall progress in [0, 1].
+     */
+    float progress() const { return m_progress.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the name of the running step, or of the last one run.
+     */
+    std::string currentStep() const;
+
+    /**
+     * @brief Returns the current state.
+     */
+    JobState state() const { return m_state.load(); }
+
+    /**
+     * @brief Returns the job name.
+     */
+    const std::string& name() const { return m_name; }
+
+private:
+    struct NamedStep {
+        std::string name;
+        float weight;
+        Step run;
+    };
+
+    explicit BackgroundJob(std::string name) : m_name(std::move(name)) {}
+    void run();
+    void finish(JobState state);
+
+    std::string m_name;                         ///< Job label
+    std::vector<NamedStep> m_steps;             ///< Steps in execution order
+    CompletionCallback m_onComplete;            ///< Invoked when the job ends
+    std::atomic<bool> m_cancelled{false};       ///< Cancellation request
+    std::atomic<float> m_progress{0.0f};        ///< Overall progress
+    std::atomic<JobState> m_state{JobState::Pending};
+    mutable std::mutex m_mutex;                 ///< Guards m_currentStep and the end-of-job signal
+    std::condition_variable m_done;             ///< Signalled when the job ends
+    std::string m_currentStep;                  ///< Name of the running step
+};
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef COMPILEDFACERIG_H_
+#define COMPILEDFACERIG_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "ActionUnit.h"
+#include "DeltaTilePartition.h"
+#include "FacialLandmark.h"
+#include "MemoryFootprint.h"
+#include "RigTableSet.h"
+#include "Side.h"
+#include "TopologyCorrespondence.h"
+
+/**
+ * @struct AUSlot
+ * @brief One Action Unit / side pair of the compiled rig and its ranges in the flattened tables.
+ */
+struct AUSlot {
+    int auId;               ///< Action Unit identifier
+    Side side;              ///< Side of the face
+    uint32_t deltaBegin;    ///< First entry in deltaVertices()/deltaValues()
+    uint32_t deltaEnd;      ///< One past the last delta entry
+    uint32_t pairBegin;     ///< First landmark pair in landmarkPairs() (pair index, not element index)
+    uint32_t pairEnd;       ///< One past the last landmark pair
+};
+
+/**
+ * @class CompiledFaceRig
+ * @brief Immutable, shareable snapshot of the static retargeting data.
+ *
+ * Flattens the AU delta table (active and passive muscles merged and summed per vertex), the muscle map and the
+ * landmark maps into contiguous arrays addressed by slot. It is only ever handed out as
+ * std::shared_ptr<const CompiledFaceRig>, so any number of characters and threads can read one copy concurrently.
+ */
+class CompiledFaceRig {
+public:
+    /**
+     * @brief Compiles the tables loaded in an ActionUnit and a FacialLandmark instance.
+     * @param actionUnit Source of the AU delta table and the muscle index map.
+     * @param facialLandmark Source of the landmark index tables and the landmark/AU map.
+     * @return Shared read-only rig.
+     */
+    static std::shared_ptr<const CompiledFaceRig> compile(ActionUnit& actionUnit, FacialLandmark& facialLandmark);
+
+    /**
+     * @brief Compiles a set of parsed tables (used when a single table is reloaded).
+     *
+     * AU entries flagged as mirrored also fill the slot of their mirror side, reflected through the set's symmetry
+     * map, unless that side is stored explicitly.
+     * @param tables Parsed data tables; missing tables are treated as empty.
+     * @return Shared read-only rig.
+     */
+    static std::shared_ptr<const CompiledFaceRig> compile(const RigTableSet& tables);
+
+    /**
+     * @brief Resamples the rig onto a user mesh with a different topology.
+     *
+     * Deltas are interpolated with the correspondence weights (and converted to user mesh units), muscle patches
+     * are remapped as regions and the landmark mesh indices to the closest user vertex. Landmark pairs index the
+     * 51-landmark set and are kept as they are.
+     * @param correspondence Map from the user mesh onto this rig's template.
+     * @return Shared read-only rig for the user mesh, or nullptr if the correspondence does not match.
+     */
+    std::shared_ptr<const CompiledFaceRig> resampled(const TopologyCorrespondence& correspondence) const;
+
+    /**
+     * @brief Returns all AU slots, sorted by AU id and side.
+     */
+    const std::vector<AUSlot>& slots() const { return m_slots; }
+
+    /**
+     * @brief Returns the number of AU slots.
+     */
+    size_t slotCount() const { return m_slots.size(); }
+
+    /**
+     * @brief Finds the slot of an AU/side pair.
+     * @return Slot index, or -1 if the rig has no such pair.
+     */
+    int findSlot(int auId, Side side) const;
+
+    /**
+     * @brief Returns the vertex index of every delta entry (grouped by slot, ascending inside a slot).
+     */
+    const std::vector<uint32_t>& deltaVertices() const { return m_deltaVertices; }
+
+    /**
+     * @brief Returns the displacement of every delta entry at full intensity.
+     */
+    const std::vector<glm::vec3>& deltaValues() const { return m_deltaValues; }
+
+    /**
+     * @brief Returns the delta table bucketed by vertex tile, for conflict-free parallel accumulation.
+     */
+    const DeltaTilePartition& deltaTiles() const { return m_deltaTiles; }
+
+    /**
+     * @brief Returns the landmark pairs (two indices into the 51-landmark set per pair), grouped by slot.
+     */
+    const std::vector<uint32_t>& landmarkPairs() const { return m_landmarkPairs; }
+
+    /**
+     * @brief Returns the muscle patches (CSR, dense muscle indices).
+     */
+    const MusclePatchStore& musclePatches() const { return m_musclePatches; }
+
+    /**
+     * @brief Returns the mesh vertex index of each of the 51 landmarks.
+     */
+    const std::vector<int>& landmarksMeshIndex() const { return m_landmarksMeshIndex; }
+
+    /**
+     * @brief Returns the generated-landmark index of each of the 51 landmarks.
+     */
+    const std::vector<int>& landmarksPixelIndex() const { return m_landmarksPixelIndex; }
+
+    /**
+     * @brief Returns the landmark/AU map the landmark pairs were compiled from.
+     */
+    const std::unordered_map<int, std::vector<landmarksActionUnit>>& landmarksActionUnitMap() const { return m_landmarksAUMap; }
+
+    /**
+     * @brief Returns one past the highest vertex index referenced by the delta table.
+     */
+    uint32_t requiredVertexCount() const { return m_requiredVertexCount; }
+
+    /**
+     * @brief Appends the delta vertices of every slot with a nonzero weight (may contain duplicates).
+     *
+     * These are the only vertices a deformation moves, so they are the ones to mark dirty in an IndexedMesh. When the
+     * weights change between frames, pass both the previous and the current weights: a slot that went back to zero
+     * moves its vertices back to rest.
+     */
+    void touchedVertices(const std::vector<float>& slotWeights, std::vector<uint32_t>& vertices) const;
+
+    /**
+     * @brief Returns the heap bytes of the flattened tables, the muscle patches and the tile partition.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    CompiledFaceRig() = default;
+
+    std::vector<AUSlot> m_slots;                                    ///< AU/side slots
+    std::vector<uint32_t> m_deltaVertices;                          ///< Delta entry vertex indices
+    std::vector<glm::vec3> m_deltaValues;                           ///< Delta entry displacements
+    std::vector<uint32_t> m_landmarkPairs;                          ///< Flattened landmark pairs
+    MusclePatchStore m_musclePatches;                               ///< Muscle patches
+    std::vector<int> m_landmarksMeshIndex;                          ///< Landmark mesh vertex indices
+    std::vector<int> m_landmarksPixelIndex;                         ///< Landmark generated-data indices
+    std::unordered_map<int, std::vector<landmarksActionUnit>> m_landmarksAUMap; ///< Source landmark/AU map
+    uint32_t m_requiredVertexCount = 0;                             ///< Minimum mesh size the deltas need
+    DeltaTilePartition m_deltaTiles;                                ///< Delta table by vertex tile
+};
+
+/**
+ * @class CharacterDeformState
+ * @brief Per-character deformation state on top of a shared CompiledFaceRig.
+ *
+ * Holds only what differs between characters: the rest vertices, the current AU weights and the deformed buffer.
+ * Different states can be evaluated concurrently because the rig is never modified.
+ */
+class CharacterDeformState {
+public:
+    /**
+     * @brief Creates a state for one character.
+     * @param rig Shared compiled rig.
+     * @param restVertices Character mesh at rest (template topology).
+     */
+    CharacterDeformState(std::shared_ptr<const CompiledFaceRig> rig, std::vector<glm::vec3> restVertices);
+
+    /**
+     * @brief Sets the weight of an AU/side pair.
+     * @return False if the rig has no such pair.
+     */
+    bool setWeight(int auId, Side side, float weight);
+
+    /**
+     * @brief Sets the weight of a slot by index.
+     * @return False if the rig has no such slot.
+     */
+    bool setSlotWeight(size_t slot, float weight);
+
+    /**
+     * @brief Resets all AU weights to zero.
+     */
+    void clearWeights();
+
+    /**
+     * @brief Sets the number of threads evaluate() spreads the vertex tiles over (default 1, 0 uses all hardware threads).
+     *
+     * Keep 1 when several characters are evaluated in parallel with evaluateCharacters().
+     */
+    void setWorkerCount(unsigned int workerCount) { m_workerCount = workerCount; }
+
+    /**
+     * @brief Recomputes the deformed vertices: rest plus every weighted slot delta.
+     *
+     * Vertex tiles are accumulated independently; tiles whose slots all have a zero weight are skipped.
+     * @return False if the rest mesh is too small for the rig's delta table.
+     */
+    bool evaluate();
+
+    /**
+     * @brief Returns the current AU weights (one per slot).
+     */
+    const std::vector<float>& weights() const { return m_weights; }
+
+    /**
+     * @brief Returns the rest vertices.
+     */
+    const std::vector<glm::vec3>& restVertices() const { return m_restVertices; }
+
+    /**
+     * @brief Returns the vertices computed by the last evaluate().
+     */
+    const std::vector<glm::vec3>& deformedVertices() const { return m_deformedVertices; }
+
+    /**
+     * @brief Returns the shared rig.
+     */
+    const std::shared_ptr<const CompiledFaceRig>& rig() const { return m_rig; }
+
+    /**
+     * @brief Returns the heap bytes of the per-character buffers (the shared rig is reported by its owner).
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    std::shared_ptr<const CompiledFaceRig> m_rig;   ///< Shared static data
+    std::vector<glm::vec3> m_restVertices;          ///< Character rest mesh
+    std::vector<glm::vec3> m_deformedVertices;      ///< Output buffer
+    std::vector<float> m_weights;                   ///< Weight per slot
+    unsigned int m_workerCount = 1;                 ///< Threads used by evaluate()
+};
+
+/**
+ * @brief Evaluates several characters in parallel, one character per task.
+ * @param states Character states (they may share the same rig).
+ * @param workerCount Number of worker threads (0 uses all hardware threads).
+ * @return False if any character failed to evaluate.
+ */
+bool evaluateCharacters(std::vector<CharacterDeformState>& states, unsigned int workerCount = 0);
+
+#endif
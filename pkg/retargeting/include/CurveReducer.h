@@ -0,0 +1,84 @@
+#ifndef CURVEREDUCER_H_
+#define CURVEREDUCER_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct AUKeyframe
+ * @brief Key of an AU weight curve with Hermite tangents.
+ */
+struct AUKeyframe {
+    double time = 0.0;          ///< Key time in seconds
+    float value = 0.0f;         ///< AU weight at the key
+    float inTangent = 0.0f;     ///< Slope arriving at the key, in weight per second
+    float outTangent = 0.0f;    ///< Slope leaving the key, in weight per second
+};
+
+/**
+ * @struct AUCurve
+ * @brief Keyframed weight of one rig slot; cubic Hermite between keys, constant outside them.
+ */
+struct AUCurve {
+    size_t slot = 0;                ///< Rig slot the curve drives
+    std::vector<AUKeyframe> keys;   ///< Keys sorted by time
+
+    /**
+     * @brief Evaluates the curve at a time.
+     */
+    float evaluate(double time) const;
+
+    /**
+     * @brief Returns true if the curve holds a single value (one key).
+     */
+    bool isConstant() const { return keys.size() <= 1; }
+};
+
+/**
+ * @struct CurveReductionOptions
+ * @brief Settings of CurveReducer.
+ */
+struct CurveReductionOptions {
+    float tolerance = 1e-3f;        ///< Largest weight error allowed at any source frame
+    unsigned int workerCount = 0;   ///< Threads over the channels (0 uses all hardware threads)
+};
+
+/**
+ * @class CurveReducer
+ * @brief Turns per-frame AU weight streams into minimal keyframe sets.
+ *
+ * Ramer-Douglas-Peucker on Hermite segments: a channel starts with its first and last frame as keys and the
+ * segment is split at the frame of largest error until every source frame is reproduced within the tolerance.
+ * The tangents at both ends of a segment are the slopes of the dense stream measured inside the segment (one-sided,
+ * second order), so a key on a corner gets broken in and out tangents and each split only refines its own segment.
+ * Flat stretches and ramps collapse to their end keys, and a channel that never moves keeps a single key. Channels
+ * are independent and reduced in parallel.
+ */
+class CurveReducer {
+public:
+    /**
+     * @brief Reduces one channel.
+     * @param times Frame times in seconds, increasing.
+     * @param values Weight per frame.
+     * @param slot Slot stored in the curve.
+     * @param tolerance Largest error allowed at any frame.
+     * @return The keyed curve; empty if the inputs are empty or their sizes differ.
+     */
+    static AUCurve reduceChannel(const std::vector<double>& times, const std::vector<float>& values, size_t slot, float tolerance);
+
+    /**
+     * @brief Reduces every slot of a per-frame weight stream.
+     * @param times Frame times in seconds, increasing.
+     * @param frameWeights Slot weights per frame (e.g. AUSolver output), all of the same size.
+     * @param options Tolerance and thread count.
+     * @return One curve per slot; empty if the frames are inconsistent.
+     */
+    static std::vector<AUCurve> reduce(const std::vector<double>& times, const std::vector<std::vector<float>>& frameWeights, const CurveReductionOptions& options = CurveReductionOptions());
+
+    /**
+     * @brief Returns the number of keys of a set of curves.
+     */
+    static size_t keyCount(const std::vector<AUCurve>& curves);
+};
+
+#endif
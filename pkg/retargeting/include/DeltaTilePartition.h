@@ -0,0 +1,102 @@
+#ifndef DELTATILEPARTITION_H_
+#define DELTATILEPARTITION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+#include "MemoryFootprint.h"
+
+class CompiledFaceRig;
+
+/**
+ * @struct DeltaTileRun
+ * @brief The entries of one AU slot inside one tile.
+ */
+struct DeltaTileRun {
+    uint32_t slot;      ///< AU slot whose weight scales the run
+    uint32_t begin;     ///< First entry in DeltaTilePartition::vertices()/deltas()
+    uint32_t end;       ///< One past the last entry
+};
+
+/**
+ * @struct DeltaTile
+ * @brief A contiguous vertex range and the runs of every slot that moves a vertex in it.
+ */
+struct DeltaTile {
+    uint32_t vertexBegin;   ///< First vertex of the tile
+    uint32_t vertexEnd;     ///< One past the last vertex of the tile
+    uint32_t runBegin;      ///< First run in DeltaTilePartition::runs()
+    uint32_t runEnd;        ///< One past the last run
+};
+
+/**
+ * @class DeltaTilePartition
+ * @brief The delta table of a rig re-bucketed by vertex tile for lock-free parallel accumulation.
+ *
+ * Muscle patches overlap, so two slots may move the same vertex and a parallel loop over slots would race. Here
+ * every (slot, vertex, delta) entry lives in the tile owning its vertex, grouped by slot inside the tile. A thread
+ * that takes a tile is the only writer of that vertex range, and a tile whose slots all have a zero weight is
+ * skipped without touching its entries. Tiles without entries are not stored.
+ */
+class DeltaTilePartition {
+public:
+    static constexpr uint32_t kDefaultTileSize = 1024; ///< Vertices per tile
+
+    /**
+     * @brief Buckets the delta table of a rig.
+     * @param rig Compiled rig.
+     * @param tileSize Vertices per tile.
+     */
+    static DeltaTilePartition build(const CompiledFaceRig& rig, uint32_t tileSize = kDefaultTileSize);
+
+    /**
+     * @brief Adds every weighted delta to out.
+     * @param weights One weight per rig slot.
+     * @param out Vertex buffer (vertexCount entries).
+     * @param vertexCount Size of out; entries beyond it are ignored.
+     * @param workerCount Number of threads (0 uses all hardware threads, 1 runs on the caller).
+     * @return Number of tiles that had a nonzero weight.
+     */
+    size_t accumulate(const std::vector<float>& weights, glm::vec3* out, size_t vertexCount, unsigned int workerCount = 0) const;
+
+    /**
+     * @brief Returns the non-empty tiles, ascending by vertex.
+     */
+    const std::vector<DeltaTile>& tiles() const { return m_tiles; }
+
+    /**
+     * @brief Returns the slot runs of all tiles.
+     */
+    const std::vector<DeltaTileRun>& runs() const { return m_runs; }
+
+    /**
+     * @brief Returns the vertex of every entry.
+     */
+    const std::vector<uint32_t>& vertices() const { return m_vertices; }
+
+    /**
+     * @brief Returns the full-intensity delta of every entry.
+     */
+    const std::vector<glm::vec3>& deltas() const { return m_deltas; }
+
+    /**
+     * @brief Returns the number of vertices per tile.
+     */
+    uint32_t tileSize() const { return m_tileSize; }
+
+    /**
+     * @brief Returns the heap bytes of the tile, run and entry arrays.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    uint32_t m_tileSize = kDefaultTileSize;     ///< Vertices per tile
+    std::vector<DeltaTile> m_tiles;             ///< Non-empty tiles
+    std::vector<DeltaTileRun> m_runs;           ///< Slot runs, grouped by tile
+    std::vector<uint32_t> m_vertices;           ///< Entry vertices, grouped by tile then slot
+    std::vector<glm::vec3> m_deltas;            ///< Entry deltas, same order
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define FACIALLANDMARK_H_
 
 #include "MathUtils.h"
+#include "MemoryFootprint.h"
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -16,6 +17,11 @@ struct landmarksActionUnit {
     std::vector<int> landmarkIndices; 
 };
 
+/**
+ * Heap bytes of a landmark/AU map: its nodes, the mappings of every AU and their landmark index lists.
+ */
+size_t landmarksActionUnitMapBytes(const std::unordered_map<int, std::vector<landmarksActionUnit>>& map);
+
 class FacialLandmark
 {
 public:
@@ -61,6 +67,11 @@ public:
 
     const std::unordered_map <int, std::vector<landmarksActionUnit>> getLandmarksActionUnitMap();
 
+    /**
+     * Returns the heap bytes held by the mesh index, pixel index and AU mapping tables.
+     */
+    MemoryFootprint memoryFootprint() const;
+
     private:
     std::vector<int> m_landmarksMeshIndex;
     std::vector<int> m_landmarksPixelIndex;
@@ -50,6 +50,13 @@ public:
      * @return Vector of vertex positions extracted from the model.
      */
     std::vector<glm::vec3> loadModel(const char* modelPath);
+
+    /**
+     * @brief Loads the triangle list of an OBJ file.
+     * @param modelPath Path to the OBJ file.
+     * @return Flat list of vertex indices, three per triangle (polygons are triangulated on load).
+     */
+    std::vector<unsigned int> loadModelTriangles(const char* modelPath);
 };
 
 #endif
\ No newline at end of file
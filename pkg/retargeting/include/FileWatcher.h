@@ -0,0 +1,62 @@
+#ifndef FILEWATCHER_H_
+#define FILEWATCHER_H_
+
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * @class FileWatcher
+ * @brief Watches a directory with inotify and reports the files written in it on a background thread.
+ *
+ * A file is reported once it is closed after writing or moved into the directory (editors that save through a
+ * temporary file and a rename). Events are debounced: a file saved several times in a burst is reported once, after
+ * the directory has been quiet for the debounce delay. Only available on Linux; start() fails elsewhere.
+ */
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::string& fileName)>;
+
+    /**
+     * @brief Default constructor.
+     */
+    FileWatcher() = default;
+
+    /**
+     * @brief Stops the watcher.
+     */
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Starts watching.
+     * @param directory Directory to watch (not recursive).
+     * @param onChanged Called on the watcher thread with the name (not the path) of every changed file.
+     * @param debounceMs Quiet period before a burst of events is reported.
+     * @return False if the directory cannot be watched.
+     */
+    bool start(const std::string& directory, Callback onChanged, int debounceMs = 150);
+
+    /**
+     * @brief Stops watching and joins the thread; a callback in progress completes first.
+     */
+    void stop();
+
+    /**
+     * @brief Returns true between a successful start() and stop().
+     */
+    bool isRunning() const { return m_thread.joinable(); }
+
+private:
+    void run();
+
+    Callback m_onChanged;           ///< Change callback
+    int m_debounceMs = 150;         ///< Quiet period
+    int m_inotifyFd = -1;           ///< inotify instance
+    int m_wakePipe[2] = {-1, -1};   ///< Written by stop() to wake the poll
+    std::thread m_thread;           ///< Watcher thread
+};
+
+#endif
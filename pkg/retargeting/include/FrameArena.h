@@ -0,0 +1,80 @@
+#ifndef FRAMEARENA_H_
+#define FRAMEARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "MemoryFootprint.h"
+
+/**
+ * @class FrameArena
+ * @brief Bump allocator for per-frame scratch memory, released all at once by reset().
+ *
+ * Allocations that do not fit the block go to overflow blocks; the next reset() replaces the block with one
+ * large enough for the peak, so once the frame size is stable a frame performs no heap allocation at all.
+ * Only trivially destructible types may be placed in the arena since nothing is ever destroyed.
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Creates an arena with an initial block.
+     * @param initialBytes Size of the initial block.
+     */
+    explicit FrameArena(size_t initialBytes = 64 * 1024);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief Returns uninitialized memory valid until the next reset().
+     * @param bytes Size of the allocation.
+     * @param alignment Power of two alignment.
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Returns an uninitialized array of count elements valid until the next reset().
+     */
+    template <typename T>
+    T* allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * @brief Releases every allocation; grows the block to the peak usage if the last frame overflowed.
+     */
+    void reset();
+
+    /**
+     * @brief Returns the bytes handed out since the last reset().
+     */
+    size_t used() const { return m_offset + m_overflowBytes; }
+
+    /**
+     * @brief Returns the size of the block.
+     */
+    size_t capacity() const { return m_capacity; }
+
+    /**
+     * @brief Returns the largest used() seen so far.
+     */
+    size_t highWater() const { return m_highWater; }
+
+    /**
+     * @brief Returns the heap bytes of the main block and of the overflow blocks of the current frame.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    std::unique_ptr<unsigned char[]> m_block;                   ///< Main block
+    size_t m_capacity = 0;                                      ///< Size of m_block
+    size_t m_offset = 0;                                        ///< Next free byte of m_block
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflow;   ///< Blocks allocated after m_block filled up
+    size_t m_overflowBytes = 0;                                 ///< Bytes handed out from m_overflow
+    size_t m_highWater = 0;                                     ///< Peak of used()
+};
+
+#endif
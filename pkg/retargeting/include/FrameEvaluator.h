@@ -0,0 +1,111 @@
+#ifndef FRAMEEVALUATOR_H_
+#define FRAMEEVALUATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "CompiledFaceRig.h"
+#include "FrameArena.h"
+#include "MemoryFootprint.h"
+#include "Side.h"
+
+/**
+ * @struct landmarksDistanceData
+ * @brief Evaluation of one AU slot for one frame. Plain data: the landmark pairs are read from the rig by slot.
+ */
+struct landmarksDistanceData
+{
+    int auId = 0;                   ///< Action Unit identifier (copied from the slot)
+    Side side = Side::center;       ///< Side of the face (copied from the slot)
+    uint32_t slot = 0;              ///< Slot in the CompiledFaceRig
+    float baseDistance = 0.0f;      ///< Mean landmark pair distance on the neutral face
+    float currentDistance = 0.0f;   ///< Mean landmark pair distance on the current frame
+    float activation = 0.0f;        ///< Distance change relative to the slot's threshold range (0 when below the minimum)
+    bool isActive = false;          ///< True for the strongest AU of the frame
+    float intensity = 0.0f;         ///< Clamped intensity of the strongest AU
+};
+
+static_assert(std::is_trivially_copyable<landmarksDistanceData>::value, "landmarksDistanceData must stay plain data");
+
+/**
+ * @struct FrameEvaluation
+ * @brief Result of FrameEvaluator::evaluate(); records live in the arena until its next reset().
+ */
+struct FrameEvaluation
+{
+    const landmarksDistanceData* records = nullptr; ///< One record per rig slot, indexed by slot
+    size_t count = 0;                               ///< Number of records
+    int strongest = -1;                             ///< Slot of the strongest active AU, -1 if none
+};
+
+/**
+ * @class FrameEvaluator
+ * @brief Detects the active AU of a frame from the landmark pair distances of a compiled rig.
+ *
+ * Everything that depends only on the rig and the actor (neutral distances, calibrated thresholds) is set up
+ * once; evaluate() then only reads those arrays and writes its records to a FrameArena, so the per-frame path
+ * does no heap allocation.
+ */
+class FrameEvaluator {
+public:
+    /**
+     * @brief Creates an evaluator for a rig; every slot starts with a zero neutral distance and default thresholds.
+     */
+    explicit FrameEvaluator(std::shared_ptr<const CompiledFaceRig> rig);
+
+    /**
+     * @brief Measures the neutral distance of every slot on the neutral 51 landmarks.
+     * @return False if a slot's landmark pairs cannot be measured on these landmarks.
+     */
+    bool setNeutralLandmarks(const std::vector<glm::vec3>& neutralLandmarks);
+
+    /**
+     * @brief Overrides the neutral distance of a slot (e.g. from a NeutralProfile).
+     */
+    void setBaseDistance(size_t slot, float distance);
+
+    /**
+     * @brief Sets calibrated thresholds for a slot; slots without calibration use the defaults given to evaluate().
+     */
+    void setThresholds(size_t slot, float thresholdMin, float thresholdMax);
+
+    /**
+     * @brief Evaluates one frame.
+     * @param landmarks Current 51 landmarks.
+     * @param landmarkCount Number of landmarks.
+     * @param defaultMin Minimum distance change that activates an uncalibrated slot.
+     * @param defaultMax Distance change at full intensity for an uncalibrated slot.
+     * @param arena Arena that receives the records.
+     */
+    FrameEvaluation evaluate(const glm::vec3* landmarks, size_t landmarkCount, float defaultMin, float defaultMax, FrameArena& arena) const;
+
+    /**
+     * @brief Returns the rig the slots refer to.
+     */
+    const std::shared_ptr<const CompiledFaceRig>& rig() const { return m_rig; }
+
+    /**
+     * @brief Returns the neutral distance of a slot.
+     */
+    float baseDistance(size_t slot) const { return m_baseDistances[slot]; }
+
+    /**
+     * @brief Returns the heap bytes of the per-slot tables (the rig is reported by its owner).
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    float meanPairDistance(size_t slot, const glm::vec3* landmarks, size_t landmarkCount) const;
+
+    std::shared_ptr<const CompiledFaceRig> m_rig;   ///< Compiled tables the records refer to
+    std::vector<float> m_baseDistances;             ///< Neutral distance per slot
+    std::vector<float> m_thresholdMin;              ///< Calibrated minimum per slot
+    std::vector<float> m_thresholdMax;              ///< Calibrated maximum per slot
+    std::vector<char> m_calibrated;                 ///< Per slot: thresholds were set
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef HEADPOSEALIGNER_H_
+#define HEADPOSEALIGNER_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/vec3.hpp>
+#include "MemoryFootprint.h"
+
+/**
+ * @struct HeadPose
+ * @brief Similarity transform that maps the landmarks of a frame onto the neutral landmarks.
+ */
+struct HeadPose {
+    glm::mat3 rotation = glm::mat3(1.0f);       ///< Proper rotation (determinant +1)
+    glm::vec3 translation = glm::vec3(0.0f);    ///< Applied after rotation and scale
+    float scale = 1.0f;                         ///< Uniform scale
+    float rmsError = 0.0f;                      ///< RMS distance of the aligned stable landmarks to the neutral ones
+};
+
+/**
+ * @class HeadPoseAligner
+ * @brief Removes head motion and scale from the generated landmarks before the AUs are evaluated.
+ *
+ * The stable landmarks of a frame (points that expressions barely move: forehead, eye corners, nose bridge, face
+ * sides) are aligned to the same landmarks of the neutral face with the closed-form Umeyama solution, whose 3x3 SVD
+ * is computed with a few Jacobi sweeps. The transform is then applied to every landmark of the frame, so landmark
+ * pair distances and displacements only keep the facial motion. Everything that depends on the neutral face is
+ * centered once in setReference(); a frame costs one pass over its stable landmarks and one over all of them.
+ * Frames that are calibrated together (ThresholdCalibrator) should be aligned the same way as the evaluated ones.
+ */
+class HeadPoseAligner {
+public:
+    /**
+     * @brief Default constructor; align() fails until setReference() succeeded.
+     */
+    HeadPoseAligner() = default;
+
+    /**
+     * @brief Sets the neutral landmarks the frames are aligned to.
+     * @param neutralLandmarks The 51 landmarks of the neutral frame.
+     * @param stableIndices Landmarks used to estimate the pose (empty uses every landmark).
+     * @return False if fewer than three stable landmarks are in range or they are all at the same place.
+     */
+    bool setReference(const std::vector<glm::vec3>& neutralLandmarks, const std::vector<int>& stableIndices = {});
+
+    /**
+     * @brief Returns true once setReference() succeeded.
+     */
+    bool isValid() const { return !m_stableIndices.empty(); }
+
+    /**
+     * @brief Estimates the pose of one frame and aligns its landmarks in place.
+     * @param landmarks Landmarks of the frame (same layout as the neutral landmarks).
+     * @param landmarkCount Number of landmarks.
+     * @param pose Optional output pose.
+     * @return False if the frame has fewer landmarks than the reference or its stable landmarks are degenerate.
+     */
+    bool align(glm::vec3* landmarks, size_t landmarkCount, HeadPose* pose = nullptr) const;
+
+    /**
+     * @brief Aligns a whole clip in place, frames spread over worker threads.
+     * @param frames Landmarks of every frame; frames that cannot be aligned are left as they are.
+     * @param poses Optional output pose per frame (identity for the frames left as they are).
+     * @param workerCount Number of worker threads (0 uses all hardware threads).
+     * @return Number of aligned frames.
+     */
+    size_t alignFrames(std::vector<std::vector<glm::vec3>>& frames, std::vector<HeadPose>* poses = nullptr,
+                       unsigned int workerCount = 0) const;
+
+    /**
+     * @brief Estimates the similarity transform that maps source onto target (Umeyama).
+     * @param source Points of the frame.
+     * @param target Matching points of the reference.
+     * @param count Number of point pairs (at least 3).
+     * @param pose Output pose: target ~ scale * rotation * source + translation.
+     * @return False if the source points are all at the same place.
+     */
+    static bool estimate(const glm::vec3* source, const glm::vec3* target, size_t count, HeadPose& pose);
+
+    /**
+     * @brief Positions of the stable MediaPipe landmarks inside a 51 landmark subset.
+     * @param landmarksPixelIndex MediaPipe index of every landmark of the subset (landmarksPixelIndex.json).
+     */
+    static std::vector<int> stableLandmarks(const std::vector<int>& landmarksPixelIndex);
+
+    /**
+     * @brief Returns the stable landmarks used to estimate the pose.
+     */
+    const std::vector<int>& stableIndices() const { return m_stableIndices; }
+
+    /**
+     * @brief Returns the heap bytes of the stable landmark list and of the centered reference.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    bool estimateFrame(const glm::vec3* landmarks, HeadPose& pose) const;
+
+    std::vector<int> m_stableIndices;                   ///< Landmarks the pose is estimated on
+    std::vector<glm::vec3> m_centeredReference;         ///< Neutral stable landmarks minus their centroid
+    glm::vec3 m_referenceCentroid = glm::vec3(0.0f);    ///< Centroid of the neutral stable landmarks
+    double m_referenceVariance = 0.0;                   ///< Mean squared norm of m_centeredReference
+    size_t m_landmarkCount = 0;                         ///< Landmarks per frame
+};
+
+#endif
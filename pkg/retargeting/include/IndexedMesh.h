@@ -0,0 +1,147 @@
+#ifndef INDEXEDMESH_H_
+#define INDEXEDMESH_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @class IndexedMesh
+ * @brief Triangle mesh with CSR adjacency and per-vertex normals that can be updated incrementally.
+ *
+ * FacialMesh only keeps the vertex positions; this type keeps the triangles too and builds, in parallel:
+ * - vertex to face adjacency (faces around each vertex, ascending),
+ * - vertex to vertex adjacency (one-ring neighbours, ascending),
+ * both in CSR form (an offsets array of vertexCount + 1 entries into one flat index array).
+ *
+ * Vertex normals are the normalized sum of the area-weighted normals of the incident faces. After a deformation
+ * only the vertices that moved need to be marked dirty: updateDirtyNormals() recomputes the faces around them and
+ * the normals of those faces' vertices, which gives the same result as a full recompute.
+ */
+class IndexedMesh {
+public:
+    /**
+     * @brief Default constructor (empty mesh).
+     */
+    IndexedMesh() = default;
+
+    /**
+     * @brief Sets the geometry, builds the adjacency and computes all normals.
+     * @param vertices Vertex positions.
+     * @param triangles Three vertex indices per triangle.
+     * @param workerCount Number of threads (0 uses all hardware threads).
+     * @return False if the triangle list is not a multiple of three or indexes a missing vertex.
+     */
+    bool build(std::vector<glm::vec3> vertices, std::vector<uint32_t> triangles, unsigned int workerCount = 0);
+
+    /**
+     * @brief Loads an OBJ file (polygons are triangulated) and builds the mesh.
+     * @return False if the file cannot be loaded.
+     */
+    bool loadOBJ(const char* modelPath, unsigned int workerCount = 0);
+
+    /**
+     * @brief Replaces the positions of some vertices and marks them dirty.
+     * @param indices Vertices to move.
+     * @param positions New positions, one per index.
+     */
+    void setPositions(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions);
+
+    /**
+     * @brief Replaces all positions; only the listed vertices are marked dirty.
+     * @param vertices New positions (same vertex count).
+     * @param movedVertices Vertices whose position may differ from the previous one.
+     * @return False if the vertex count differs.
+     */
+    bool setAllPositions(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& movedVertices);
+
+    /**
+     * @brief Marks vertices whose normals must be recomputed. Duplicates and out of range indices are ignored.
+     */
+    void markDirty(const std::vector<uint32_t>& vertices);
+
+    /**
+     * @brief Recomputes every face and vertex normal.
+     */
+    void computeNormals(unsigned int workerCount = 0);
+
+    /**
+     * @brief Recomputes the normals affected by the dirty vertices and clears the dirty set.
+     * @return Number of vertex normals recomputed.
+     */
+    size_t updateDirtyNormals(unsigned int workerCount = 0);
+
+    /**
+     * @brief Returns the number of dirty vertices.
+     */
+    size_t dirtyCount() const { return m_dirtyList.size(); }
+
+    /**
+     * @brief Returns the vertex positions.
+     */
+    const std::vector<glm::vec3>& vertices() const { return m_vertices; }
+
+    /**
+     * @brief Returns the triangle indices (three per face).
+     */
+    const std::vector<uint32_t>& triangles() const { return m_triangles; }
+
+    /**
+     * @brief Returns the per-vertex unit normals.
+     */
+    const std::vector<glm::vec3>& normals() const { return m_normals; }
+
+    /**
+     * @brief Returns the per-face area-weighted normals (cross product of two edges, not normalized).
+     */
+    const std::vector<glm::vec3>& faceNormals() const { return m_faceNormals; }
+
+    /**
+     * @brief Returns the number of vertices.
+     */
+    size_t vertexCount() const { return m_vertices.size(); }
+
+    /**
+     * @brief Returns the number of triangles.
+     */
+    size_t faceCount() const { return m_triangles.size() / 3; }
+
+    /**
+     * @brief Vertex to face CSR offsets (vertexCount + 1 entries).
+     */
+    const std::vector<uint32_t>& vertexFaceOffsets() const { return m_vertexFaceOffsets; }
+
+    /**
+     * @brief Vertex to face CSR indices.
+     */
+    const std::vector<uint32_t>& vertexFaces() const { return m_vertexFaces; }
+
+    /**
+     * @brief Vertex to vertex CSR offsets (vertexCount + 1 entries).
+     */
+    const std::vector<uint32_t>& vertexNeighborOffsets() const { return m_vertexNeighborOffsets; }
+
+    /**
+     * @brief Vertex to vertex CSR indices.
+     */
+    const std::vector<uint32_t>& vertexNeighbors() const { return m_vertexNeighbors; }
+
+private:
+    void buildAdjacency(unsigned int workerCount);
+    glm::vec3 faceNormal(size_t face) const;
+    glm::vec3 vertexNormal(size_t vertex) const;
+
+    std::vector<glm::vec3> m_vertices;              ///< Vertex positions
+    std::vector<uint32_t> m_triangles;              ///< Three vertex indices per face
+    std::vector<glm::vec3> m_faceNormals;           ///< Area-weighted face normals
+    std::vector<glm::vec3> m_normals;               ///< Unit vertex normals
+    std::vector<uint32_t> m_vertexFaceOffsets;      ///< CSR offsets of m_vertexFaces
+    std::vector<uint32_t> m_vertexFaces;            ///< Faces around each vertex
+    std::vector<uint32_t> m_vertexNeighborOffsets;  ///< CSR offsets of m_vertexNeighbors
+    std::vector<uint32_t> m_vertexNeighbors;        ///< One-ring neighbours of each vertex
+    std::vector<char> m_dirtyFlag;                  ///< Per vertex: already in m_dirtyList
+    std::vector<uint32_t> m_dirtyList;              ///< Dirty vertices
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef LANDMARKPROTOCOL_H_
+#define LANDMARKPROTOCOL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @struct LandmarkRequest
+ * @brief Client request: generate the landmark frames of a portrait driven by an audio clip.
+ */
+struct LandmarkRequest {
+    uint64_t id = 0;            ///< Client chosen id, echoed in every reply
+    std::string portraitPath;   ///< Portrait image
+    std::string audioPath;      ///< Driving audio
+};
+
+/**
+ * @struct LandmarkFrame
+ * @brief One generated frame of 478 MediaPipe landmarks.
+ */
+struct LandmarkFrame {
+    uint64_t requestId = 0;             ///< Request the frame belongs to
+    uint32_t index = 0;                 ///< Frame number inside the clip
+    double time = 0.0;                  ///< Frame time in seconds
+    std::vector<glm::vec3> landmarks;   ///< Normalized landmark positions
+};
+
+/**
+ * @enum LandmarkMessageType
+ * @brief Kind of a protocol line.
+ */
+enum class LandmarkMessageType {
+    Request,    ///< {"type":"generate","id","portrait","audio"}
+    Frame,      ///< {"type":"frame","id","index","time","landmarks":[x,y,z,...]}
+    End,        ///< {"type":"end","id","frames"}
+    Error,      ///< {"type":"error","id","message"}
+    Invalid     ///< Line that could not be parsed
+};
+
+/**
+ * @struct LandmarkMessage
+ * @brief Decoded protocol line; only the fields of its type are meaningful.
+ */
+struct LandmarkMessage {
+    LandmarkMessageType type = LandmarkMessageType::Invalid;
+    LandmarkRequest request;    ///< Request
+    LandmarkFrame frame;        ///< Frame
+    uint64_t requestId = 0;     ///< End and Error
+    uint32_t frameCount = 0;    ///< End: number of frames sent
+    std::string error;          ///< Error message, or the parse error of an Invalid line
+};
+
+/**
+ * @class LandmarkProtocol
+ * @brief Line-delimited JSON protocol between the plugin and the animation-data service.
+ *
+ * Every message is one JSON object on a single line terminated by '\n'. The client sends one "generate" request per
+ * clip; the service answers with the frames in order as soon as each is produced, then "end" (or "error").
+ * Landmarks are a flat [x, y, z, ...] array to keep frames compact.
+ */
+class LandmarkProtocol {
+public:
+    /**
+     * @brief Encodes a request line (with the trailing newline).
+     */
+    static std::string encodeRequest(const LandmarkRequest& request);
+
+    /**
+     * @brief Encodes a frame line (with the trailing newline).
+     */
+    static std::string encodeFrame(const LandmarkFrame& frame);
+
+    /**
+     * @brief Encodes the end-of-clip line (with the trailing newline).
+     */
+    static std::string encodeEnd(uint64_t requestId, uint32_t frameCount);
+
+    /**
+     * @brief Encodes an error line (with the trailing newline).
+     */
+    static std::string encodeError(uint64_t requestId, const std::string& message);
+
+    /**
+     * @brief Decodes one line (without its newline).
+     */
+    static LandmarkMessage decode(const std::string& line);
+
+    /**
+     * @brief Reads the frames of a landmarks-data JSON file ({"data": [[{"x","y","z"}, ...], ...]}).
+     * @return False if the file is missing or malformed.
+     */
+    static bool loadFramesFromJSON(const std::string& path, std::vector<std::vector<glm::vec3>>& frames);
+};
+
+/**
+ * @class LineBuffer
+ * @brief Reassembles newline-terminated lines from arbitrarily split socket reads.
+ */
+class LineBuffer {
+public:
+    /**
+     * @brief Appends received bytes.
+     */
+    void append(const char* data, size_t size) { m_buffer.append(data, size); }
+
+    /**
+     * @brief Extracts the next complete line, without its newline.
+     * @return False if no complete line is buffered yet.
+     */
+    bool nextLine(std::string& line);
+
+    /**
+     * @brief Returns the number of buffered bytes not yet returned as a line.
+     */
+    size_t pending() const { return m_buffer.size() - m_consumed; }
+
+private:
+    std::string m_buffer;   ///< Received bytes
+    size_t m_consumed = 0;  ///< Bytes already returned as lines
+};
+
+#endif
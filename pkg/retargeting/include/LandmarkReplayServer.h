@@ -0,0 +1,77 @@
+#ifndef LANDMARKREPLAYSERVER_H_
+#define LANDMARKREPLAYSERVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @class LandmarkReplayServer
+ * @brief Local stand-in for the portrait + audio to landmark-frames service.
+ *
+ * Listens on a UNIX domain socket and answers every "generate" request (see LandmarkProtocol) by replaying the
+ * frames of the bundled landmarks-data files in order, paced at a fixed frame rate, then an "end" line.
+ * Each connection is served by its own thread; requests on one connection are answered one after the other.
+ */
+class LandmarkReplayServer {
+public:
+    /**
+     * @brief Creates a server replaying the given clips.
+     * @param clipFiles landmarks-data JSON files, concatenated in order into one clip.
+     * @param frameRate Frames per second of the replay (0 sends every frame immediately).
+     */
+    explicit LandmarkReplayServer(std::vector<std::string> clipFiles, double frameRate = 30.0);
+
+    /**
+     * @brief Stops the server if it is running.
+     */
+    ~LandmarkReplayServer();
+
+    LandmarkReplayServer(const LandmarkReplayServer&) = delete;
+    LandmarkReplayServer& operator=(const LandmarkReplayServer&) = delete;
+
+    /**
+     * @brief Loads the clips and starts listening.
+     * @param socketPath Path of the UNIX socket; a stale socket file at that path is replaced.
+     * @return False if no frame could be loaded or the socket could not be bound.
+     */
+    bool start(const std::string& socketPath);
+
+    /**
+     * @brief Closes the listening socket and every connection, then joins the threads.
+     */
+    void stop();
+
+    /**
+     * @brief Returns true between a successful start() and stop().
+     */
+    bool isRunning() const { return m_running.load(); }
+
+    /**
+     * @brief Returns the number of frames replayed per request.
+     */
+    size_t frameCount() const { return m_frames.size(); }
+
+private:
+    void acceptLoop();
+    void serveClient(int clientFd);
+    bool replay(int clientFd, uint64_t requestId);
+
+    std::vector<std::string> m_clipFiles;               ///< Replayed files
+    double m_frameRate;                                 ///< Replay pacing
+    std::vector<std::vector<glm::vec3>> m_frames;       ///< Frames of every clip, in order
+    std::string m_socketPath;                           ///< Bound socket path
+    int m_listenFd = -1;                                ///< Listening socket
+    std::atomic<bool> m_running{false};                 ///< Cleared by stop()
+    std::thread m_acceptThread;                         ///< Accepts connections
+    std::mutex m_clientsMutex;                          ///< Guards the client lists
+    std::vector<std::thread> m_clientThreads;           ///< One thread per connection
+    std::vector<int> m_clientFds;                       ///< Open connections, shut down by stop()
+};
+
+#endif
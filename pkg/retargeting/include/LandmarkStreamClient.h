@@ -0,0 +1,100 @@
+#ifndef LANDMARKSTREAMCLIENT_H_
+#define LANDMARKSTREAMCLIENT_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "LandmarkProtocol.h"
+
+/**
+ * @class LandmarkStreamClient
+ * @brief Asynchronous client of the animation-data service.
+ *
+ * request() sends a "generate" line and returns at once; a reader thread decodes the reply lines and queues every
+ * frame as it arrives, so the caller can start retargeting on the first frame while the rest of the clip is still
+ * being produced. Frames are consumed with nextFrame() or observed through the optional callback (called on the
+ * reader thread).
+ */
+class LandmarkStreamClient {
+public:
+    using FrameCallback = std::function<void(const LandmarkFrame&)>;
+
+    /**
+     * @brief Default constructor.
+     */
+    LandmarkStreamClient() = default;
+
+    /**
+     * @brief Closes the connection and joins the reader thread.
+     */
+    ~LandmarkStreamClient();
+
+    LandmarkStreamClient(const LandmarkStreamClient&) = delete;
+    LandmarkStreamClient& operator=(const LandmarkStreamClient&) = delete;
+
+    /**
+     * @brief Connects to the service.
+     * @param socketPath Path of the service's UNIX socket.
+     * @return False if the service is not reachable.
+     */
+    bool connect(const std::string& socketPath);
+
+    /**
+     * @brief Sends a request and starts streaming its frames. One request can be in flight at a time.
+     * @param request Portrait and audio to animate.
+     * @param onFrame Optional callback invoked on the reader thread for every frame, before it is queued.
+     * @return False if not connected, a request is already streaming, or the send failed.
+     */
+    bool request(const LandmarkRequest& request, FrameCallback onFrame = {});
+
+    /**
+     * @brief Pops the next received frame, waiting for it if needed.
+     * @param frame Receives the frame.
+     * @param timeoutMs Maximum wait in milliseconds.
+     * @return False on timeout, or when the stream has ended and every frame was consumed.
+     */
+    bool nextFrame(LandmarkFrame& frame, int timeoutMs);
+
+    /**
+     * @brief Returns true once the service sent "end" or "error", or the connection was lost.
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Returns the error reported by the service or the connection, empty if none.
+     */
+    std::string error() const;
+
+    /**
+     * @brief Returns the number of frames received for the current request.
+     */
+    uint32_t framesReceived() const;
+
+    /**
+     * @brief Closes the connection; a streaming request ends with an error.
+     */
+    void close();
+
+private:
+    void readLoop();
+    void finish(const std::string& error);
+
+    int m_fd = -1;                          ///< Connected socket
+    std::thread m_reader;                   ///< Decodes reply lines
+    mutable std::mutex m_mutex;             ///< Guards the fields below
+    std::condition_variable m_frameReady;   ///< Signalled on every frame and at the end of the stream
+    std::deque<LandmarkFrame> m_frames;     ///< Received, not yet consumed frames
+    FrameCallback m_onFrame;                ///< Per-frame callback of the current request
+    uint64_t m_requestId = 0;               ///< Current request id
+    uint32_t m_received = 0;                ///< Frames received for the current request
+    bool m_streaming = false;               ///< A request is in flight
+    bool m_finished = false;                ///< The current stream has ended
+    std::string m_error;                    ///< Error of the current stream
+};
+
+#endif
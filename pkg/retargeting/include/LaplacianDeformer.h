@@ -0,0 +1,83 @@
+#ifndef LAPLACIANDEFORMER_H_
+#define LAPLACIANDEFORMER_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "IndexedMesh.h"
+#include "SkylineCholesky.h"
+
+/**
+ * @class LaplacianDeformer
+ * @brief Dense mesh deformation driven by a few soft handle vertices (e.g. the 51 landmark vertices).
+ *
+ * The displacement field d minimizes ||L^k d||^2 + w * sum_h ||d_h - (target_h - rest_h)||^2, where L is the
+ * uniform graph Laplacian of the mesh and k the order (1: membrane, 2: thin plate, smoother). The system
+ * matrix only depends on the mesh, the handle set and the weight, so it is analyzed and factorized once in
+ * setup(); every frame is then one forward and back substitution, and a clip solves all frames in one batch.
+ */
+class LaplacianDeformer {
+public:
+    /**
+     * @brief Builds and factorizes the system for a mesh and a handle set.
+     * @param mesh Rest mesh (positions and adjacency).
+     * @param handles Handle vertex indices; a vertex may appear more than once.
+     * @param handleWeight How strongly the handles pull towards their targets.
+     * @param order 1 for the membrane energy, 2 for the thin plate energy.
+     * @return False if a handle is out of range, the order is not 1 or 2, or the factorization fails.
+     */
+    bool setup(const IndexedMesh& mesh, const std::vector<uint32_t>& handles, float handleWeight = 10.0f, int order = 2);
+
+    /**
+     * @brief Changes the handle weight; only the numeric factorization runs again.
+     */
+    bool setHandleWeight(float handleWeight);
+
+    /**
+     * @brief Deforms the rest mesh for one frame.
+     * @param handleTargets Target position of every handle, in setup() order.
+     * @param vertices Output deformed vertices.
+     * @return False if the deformer is not set up or the target count differs.
+     */
+    bool deform(const std::vector<glm::vec3>& handleTargets, std::vector<glm::vec3>& vertices) const;
+
+    /**
+     * @brief Deforms the rest mesh for many frames with one multi right-hand side solve.
+     * @param handleTargets Handle targets per frame.
+     * @param frames Output deformed vertices per frame.
+     * @param workerCount Number of threads (0 uses all hardware threads).
+     */
+    bool deformBatch(const std::vector<std::vector<glm::vec3>>& handleTargets, std::vector<std::vector<glm::vec3>>& frames,
+                     unsigned int workerCount = 0) const;
+
+    /**
+     * @brief Returns true once setup() succeeded.
+     */
+    bool isReady() const { return m_solver.isFactorized(); }
+
+    /**
+     * @brief Returns the handle vertex indices.
+     */
+    const std::vector<uint32_t>& handles() const { return m_handles; }
+
+    /**
+     * @brief Returns the factorization, e.g. to inspect its envelope size.
+     */
+    const SkylineCholesky& solver() const { return m_solver; }
+
+private:
+    bool buildRightHandSides(const std::vector<std::vector<glm::vec3>>& handleTargets, std::vector<double>& rhs) const;
+
+    std::vector<glm::vec3> m_restVertices;      ///< Rest positions
+    std::vector<uint32_t> m_handles;            ///< Handle vertices
+    std::vector<uint32_t> m_rowOffsets;         ///< System matrix CSR offsets
+    std::vector<uint32_t> m_columns;            ///< System matrix CSR columns
+    std::vector<double> m_energyValues;         ///< Laplacian energy part of the matrix values
+    std::vector<uint32_t> m_diagonal;           ///< CSR entry of each diagonal
+    float m_handleWeight = 0.0f;                ///< Current handle weight
+    SkylineCholesky m_solver;                   ///< Factorized system
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef LINEARBLENDSKINNING_H_
+#define LINEARBLENDSKINNING_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+/**
+ * @struct JointInfluence
+ * @brief Sparse skin weight entry: how much a joint drives a vertex.
+ */
+struct JointInfluence {
+    int vertexIndex;    ///< Index of the vertex in the mesh
+    int jointIndex;     ///< Index of the joint (landmark joint number)
+    float weight;       ///< Skin weight of the joint on the vertex
+};
+
+/**
+ * @class LinearBlendSkinning
+ * @brief CPU linear blend skinning evaluator for the landmark joints.
+ *
+ * Replaces Maya's skinCluster for headless evaluation; the plugin itself still binds through the skinCluster. Sparse weights are packed into a fixed number of
+ * influences per vertex (zero padded), so the kernel runs the same branch-free loop for every vertex and the
+ * per-joint matrices are blended as flat 3x4 rows, a layout the compiler can vectorise.
+ */
+class LinearBlendSkinning {
+public:
+    static constexpr int kMaxInfluences = 4;   ///< Influences kept per vertex (the strongest ones)
+
+    /**
+     * @brief Default constructor.
+     */
+    LinearBlendSkinning() = default;
+
+    /**
+     * @brief Sets the joint bind poses (joint to world matrices at bind time).
+     *
+     * Weights set before must be set again if the joint count changes.
+     *
+     * @param bindPoses One matrix per joint.
+     * @return False if the list is empty.
+     */
+    bool setBindPoses(const std::vector<glm::mat4>& bindPoses);
+
+    /**
+     * @brief Packs sparse per-vertex joint weights into the fixed influence layout.
+     *
+     * Only the kMaxInfluences strongest weights of each vertex are kept and they are renormalised to sum to one.
+     * Vertices without influences stay at their rest position.
+     *
+     * @param vertexCount Number of vertices in the skinned mesh.
+     * @param influences Sparse weight entries (any order, several per vertex).
+     * @return False if the bind poses are not set yet or an entry references a vertex or joint out of range.
+     */
+    bool setWeights(size_t vertexCount, const std::vector<JointInfluence>& influences);
+
+    /**
+     * @brief Deforms the rest vertices with the current joint transforms.
+     * @param restVertices Mesh vertices at bind time.
+     * @param jointTransforms Current joint to world matrices (same order as the bind poses).
+     * @param deformedVertices Output positions (resized to the vertex count).
+     * @param workerCount Number of threads used over the vertices (1 runs serially, 0 uses all hardware threads).
+     * @return False if the buffers do not match the bound joints or vertices, or the joint count changed since setWeights.
+     */
+    bool deform(const std::vector<glm::vec3>& restVertices,
+                const std::vector<glm::mat4>& jointTransforms,
+                std::vector<glm::vec3>& deformedVertices,
+                unsigned int workerCount = 1) const;
+
+    /**
+     * @brief Computes inverse-distance weights for each vertex from its closest joints.
+     *
+     * Headless equivalent of skinCluster's default closest-joint binding, used when no painted weights exist.
+     *
+     * @param vertices Mesh vertices at bind time.
+     * @param jointPositions Joint positions (e.g. the 51 landmarks on the input mesh).
+     * @param maxInfluences Number of closest joints kept per vertex.
+     * @return Sparse weight entries.
+     */
+    static std::vector<JointInfluence> computeDistanceWeights(const std::vector<glm::vec3>& vertices,
+                                                              const std::vector<glm::vec3>& jointPositions,
+                                                              int maxInfluences = kMaxInfluences);
+
+    /**
+     * @brief Builds translation-only joint matrices, matching the joints created from landmarks.
+     * @param positions Joint positions.
+     * @return One matrix per position.
+     */
+    static std::vector<glm::mat4> translationPoses(const std::vector<glm::vec3>& positions);
+
+    /**
+     * @brief Returns the number of joints of the bind pose.
+     */
+    size_t jointCount() const { return m_inverseBindPoses.size(); }
+
+    /**
+     * @brief Returns the number of vertices with packed weights.
+     */
+    size_t vertexCount() const { return m_vertexCount; }
+
+private:
+    std::vector<glm::mat4> m_inverseBindPoses;   ///< Inverse of each joint bind pose
+    std::vector<int> m_jointIndices;             ///< kMaxInfluences joint indices per vertex (padding uses joint 0)
+    std::vector<float> m_weights;                ///< kMaxInfluences weights per vertex (padding weight is 0)
+    size_t m_vertexCount = 0;                    ///< Number of vertices the weights were packed for
+    size_t m_weightJointCount = 0;               ///< Number of bind poses the joint indices were checked against
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef LIVERIGTABLES_H_
+#define LIVERIGTABLES_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "AtomicTable.h"
+#include "CompiledFaceRig.h"
+#include "FileWatcher.h"
+#include "RigTableSet.h"
+
+/**
+ * @class LiveRigTables
+ * @brief Hot-reloadable static data: the parsed tables and their CompiledFaceRig, republished when a file changes.
+ *
+ * When a table file of the watched directory is saved, only that table is parsed again (on the watcher thread),
+ * validated against the other tables, compiled with them into a new rig and published by an atomic pointer swap.
+ * Evaluation and deformation read through rig() and never wait on a reload; a generation keeps the snapshot it
+ * started with. A file that fails to parse or validate is rejected and the previous tables stay published.
+ */
+class LiveRigTables {
+public:
+    using ReloadCallback = std::function<void(const std::string& fileName, bool accepted)>;
+
+    /**
+     * @brief Publishes the initial tables and their compiled rig.
+     */
+    explicit LiveRigTables(const RigTableSet& initial);
+
+    /**
+     * @brief Publishes tables whose rig was already compiled (e.g. by StartupLoader).
+     */
+    LiveRigTables(std::shared_ptr<const RigTableSet> tables, std::shared_ptr<const CompiledFaceRig> rig);
+
+    /**
+     * @brief Stops watching.
+     */
+    ~LiveRigTables();
+
+    LiveRigTables(const LiveRigTables&) = delete;
+    LiveRigTables& operator=(const LiveRigTables&) = delete;
+
+    /**
+     * @brief Returns the current compiled rig; lock free for readers.
+     */
+    std::shared_ptr<const CompiledFaceRig> rig() const { return m_rig.load(); }
+
+    /**
+     * @brief Returns the current parsed tables.
+     */
+    std::shared_ptr<const RigTableSet> tables() const { return m_tables.load(); }
+
+    /**
+     * @brief Returns the number of rigs published so far (1 after construction).
+     */
+    uint64_t version() const { return m_rig.version(); }
+
+    /**
+     * @brief Starts reloading the tables of a directory when their files change.
+     * @param dataDir Directory holding the table files.
+     * @param onReload Optional callback (watcher thread) called after every reload attempt.
+     * @return False if the directory cannot be watched.
+     */
+    bool watch(const std::string& dataDir, ReloadCallback onReload = {});
+
+    /**
+     * @brief Stops watching; the current tables stay published.
+     */
+    void stopWatching() { m_watcher.stop(); }
+
+    /**
+     * @brief Reloads one table file, recompiles and publishes the rig.
+     * @param fileName Table file name, selects the table to replace.
+     * @param path Path of the file to parse.
+     * @return False if the file was rejected.
+     */
+    bool reloadFile(const std::string& fileName, const std::string& path);
+
+private:
+    AtomicTable<RigTableSet> m_tables;      ///< Published parsed tables
+    AtomicTable<CompiledFaceRig> m_rig;     ///< Published rig compiled from m_tables
+    std::mutex m_writerMutex;               ///< Serialises reloads (readers never take it)
+    FileWatcher m_watcher;                  ///< Data directory watcher
+};
+
+#endif
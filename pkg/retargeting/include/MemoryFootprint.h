@@ -0,0 +1,237 @@
+#ifndef MEMORYFOOTPRINT_H_
+#define MEMORYFOOTPRINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct MemoryTable
+ * @brief Heap bytes held by one table of an object.
+ */
+struct MemoryTable {
+    std::string name;   ///< Table name, prefixed with its owner for nested objects ("rig.deltaValues")
+    size_t bytes = 0;   ///< Heap bytes held
+};
+
+/**
+ * @class MemoryFootprint
+ * @brief Heap bytes held by an object, broken down by table.
+ *
+ * Owning classes report their tables through a memoryFootprint() method. Contiguous buffers are counted from their
+ * capacity, so vectors and strings are exact; hash maps and maps are counted with the libstdc++ node layout. Tables
+ * shared through a shared_ptr are reported by the object that builds them, not by every holder.
+ */
+class MemoryFootprint {
+public:
+    /**
+     * @brief Adds bytes to a table; a table added twice accumulates.
+     */
+    void add(const std::string& table, size_t bytes);
+
+    /**
+     * @brief Adds the tables of a nested object, each named "<owner>.<table>".
+     */
+    void add(const std::string& owner, const MemoryFootprint& nested);
+
+    /**
+     * @brief Returns the bytes of one table, 0 if it was not reported.
+     */
+    size_t bytes(const std::string& table) const;
+
+    /**
+     * @brief Returns the bytes of all tables.
+     */
+    size_t totalBytes() const;
+
+    /**
+     * @brief Returns the tables in the order they were reported.
+     */
+    const std::vector<MemoryTable>& tables() const { return m_tables; }
+
+    /**
+     * @brief JSON snapshot: {"totalBytes": n, "tables": {"<name>": bytes, ...}}.
+     */
+    std::string toJSON() const;
+
+private:
+    std::vector<MemoryTable> m_tables;  ///< Reported tables
+};
+
+/**
+ * @brief Heap bytes of a vector's buffer (not of what its elements own).
+ */
+template <typename T, typename A>
+size_t heapBytes(const std::vector<T, A>& vector)
+{
+    return vector.capacity() * sizeof(T);
+}
+
+/**
+ * @brief Heap bytes of a string, 0 while it fits the small string buffer.
+ */
+inline size_t heapBytes(const std::string& text)
+{
+    const char* data = text.data();
+    const char* object = reinterpret_cast<const char*>(&text);
+    if (data >= object && data < object + sizeof(text)) return 0;
+    return text.capacity() + 1;
+}
+
+/**
+ * @brief Heap bytes of a hash map's nodes and bucket array (not of what its values own).
+ */
+template <typename K, typename V, typename H, typename E, typename A>
+size_t heapBytes(const std::unordered_map<K, V, H, E, A>& map)
+{
+    // a node is the next pointer and the pair; a single bucket lives inside the map
+    using Value = typename std::unordered_map<K, V, H, E, A>::value_type;
+    const size_t buckets = map.bucket_count() > 1 ? map.bucket_count() * sizeof(void*) : 0;
+    return map.size() * (sizeof(void*) + sizeof(Value)) + buckets;
+}
+
+/**
+ * @brief Heap bytes of an ordered map's nodes (not of what its values own).
+ */
+template <typename K, typename V, typename C, typename A>
+size_t heapBytes(const std::map<K, V, C, A>& map)
+{
+    // a red-black node is the colour and three links, then the pair
+    using Value = typename std::map<K, V, C, A>::value_type;
+    return map.size() * (4 * sizeof(void*) + sizeof(Value));
+}
+
+/**
+ * @brief Heap bytes of a hash map of vectors: nodes, buckets and the buffer of every vector.
+ */
+template <typename K, typename T, typename H, typename E, typename A>
+size_t heapBytesOfVectorMap(const std::unordered_map<K, std::vector<T>, H, E, A>& map)
+{
+    size_t bytes = heapBytes(map);
+    for (const auto& entry : map) bytes += heapBytes(entry.second);
+    return bytes;
+}
+
+/**
+ * @enum MemorySubsystem
+ * @brief Owner that the tracking allocator charges an allocation to.
+ */
+enum class MemorySubsystem {
+    other,          ///< Anything outside a MemoryScope
+    actionUnit,     ///< AU delta and muscle tables
+    facialLandmark, ///< Landmark index tables
+    facialMesh,     ///< Loaded mesh buffers
+    rig,            ///< Compiled rigs and solvers
+    caches,         ///< Topology correspondences, symmetry maps, neutral profiles
+    dccInterface,   ///< Per clip state of the plugin
+    count           ///< Number of subsystems
+};
+
+/**
+ * @class MemoryTracker
+ * @brief Live heap bytes per subsystem, when the executable links the tracking allocator.
+ *
+ * With PIXELMUX_TRACK_ALLOCATIONS the retargeting_alloc_tracking object library replaces the global operator new
+ * and delete: each block carries a small header with its size and the subsystem of the innermost MemoryScope of the
+ * allocating thread, so a block freed on another thread or outside the scope is still charged back to its owner.
+ * The replacement is process wide and every block must come from it, so only the headless executables (tests,
+ * landmark service) link it, never the Maya plugin. Scopes are per thread: work handed to parallelFor workers
+ * inherits the scope of the caller, other threads start in MemorySubsystem::other. Without the allocator the scopes
+ * only set a thread local and every count stays 0.
+ */
+class MemoryTracker {
+public:
+    /**
+     * @brief Returns true if the executable links the tracking allocator.
+     */
+    static bool enabled();
+
+    /**
+     * @brief Returns the name of a subsystem ("actionUnit", ...).
+     */
+    static const char* name(MemorySubsystem subsystem);
+
+    /**
+     * @brief Returns the subsystem charged by the calling thread.
+     */
+    static MemorySubsystem current() noexcept;
+
+    /**
+     * @brief Returns the bytes currently allocated by a subsystem.
+     */
+    static int64_t liveBytes(MemorySubsystem subsystem);
+
+    /**
+     * @brief Returns the highest liveBytes() of a subsystem since the last resetPeaks().
+     */
+    static int64_t peakBytes(MemorySubsystem subsystem);
+
+    /**
+     * @brief Returns the number of allocations made by a subsystem.
+     */
+    static uint64_t allocationCount(MemorySubsystem subsystem);
+
+    /**
+     * @brief Returns the number of allocations made by all subsystems.
+     */
+    static uint64_t allocationCount();
+
+    /**
+     * @brief Lowers every peak to the current live bytes.
+     */
+    static void resetPeaks();
+
+    /**
+     * @brief JSON snapshot: {"enabled": b, "subsystems": {"<name>": {"liveBytes", "peakBytes", "allocations"}}}.
+     */
+    static std::string toJSON();
+
+    /**
+     * @brief Copies the live bytes of every subsystem to the "pixelmux_heap_<name>_bytes" gauges of the metrics registry.
+     */
+    static void publishMetrics();
+
+    /**
+     * @brief Marks the tracking allocator as linked (called once by it at startup).
+     */
+    static void install() noexcept;
+
+    /**
+     * @brief Charges an allocation to a subsystem (called by the tracking allocator).
+     */
+    static void charge(MemorySubsystem subsystem, size_t bytes) noexcept;
+
+    /**
+     * @brief Returns the bytes of a freed block to its subsystem (called by the tracking allocator).
+     */
+    static void release(MemorySubsystem subsystem, size_t bytes) noexcept;
+
+private:
+    friend class MemoryScope;
+
+    /**
+     * @brief Makes a subsystem current on the calling thread and returns the previous one.
+     */
+    static MemorySubsystem enter(MemorySubsystem subsystem);
+};
+
+/**
+ * @class MemoryScope
+ * @brief Charges the allocations of the calling thread to a subsystem until it goes out of scope.
+ */
+class MemoryScope {
+public:
+    explicit MemoryScope(MemorySubsystem subsystem) : m_previous(MemoryTracker::enter(subsystem)) {}
+    ~MemoryScope() { MemoryTracker::enter(m_previous); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemorySubsystem m_previous;     ///< Restored on destruction
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef MESHLODBUILDER_H_
+#define MESHLODBUILDER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "CompiledFaceRig.h"
+#include "TopologyCorrespondence.h"
+
+/**
+ * @struct MeshLODOptions
+ * @brief Settings of MeshLODBuilder::build().
+ */
+struct MeshLODOptions {
+    std::vector<float> ratios = {0.25f, 0.0625f};   ///< Target vertex count of each level, as a fraction of the template
+    unsigned int workerCount = 0;                   ///< Threads of the correspondence and the rig resampling (0 uses all)
+};
+
+/**
+ * @struct MeshLOD
+ * @brief Decimated proxy of the template with its own rig, for interactive preview.
+ */
+struct MeshLOD {
+    float ratio = 1.0f;                                 ///< Requested fraction of the template vertices
+    std::vector<glm::vec3> vertices;                    ///< Proxy rest positions (a subset of the template vertices)
+    std::vector<uint32_t> triangles;                    ///< Three proxy vertex ids per triangle
+    std::vector<uint32_t> sourceVertex;                 ///< Template vertex of every proxy vertex
+    std::vector<uint32_t> clusterOf;                    ///< Proxy vertex every template vertex collapsed into
+    TopologyCorrespondence correspondence;              ///< Proxy to template map the rig was resampled through
+    std::shared_ptr<const CompiledFaceRig> rig;         ///< AU deltas and landmark indices on the proxy
+};
+
+/**
+ * @struct MeshLODPlacement
+ * @brief Where a proxy sits on the user mesh it previews, computed once when the preview starts.
+ */
+struct MeshLODPlacement {
+    std::vector<glm::vec3> rest;    ///< Proxy rest positions, read from the user mesh vertices closest to its template vertices
+    float unitScale = 1.0f;         ///< User mesh units per template unit, applied to the proxy motion
+};
+
+/**
+ * @class MeshLODBuilder
+ * @brief Builds decimated preview meshes of the template and resamples the compiled rig onto them.
+ *
+ * Decimation is vertex clustering: the template is bucketed in a uniform grid whose cell size is searched so the
+ * number of occupied cells meets the target, and every cell collapses into one existing template vertex (the one
+ * closest to the cell mean). Pinned vertices (the landmark vertices and the bounding box extremes) always survive
+ * with their exact position, so the 51 landmarks read the same positions on every level and the bounding box
+ * alignment of TopologyCorrespondence is exact. Triangles are remapped, and the ones that collapse or repeat are
+ * dropped.
+ *
+ * The rig of a level is CompiledFaceRig::resampled() through a proxy to template correspondence, cached as a
+ * sidecar like the one of user meshes. Preview deforms the proxy with that rig and shows the proxy itself, placed on
+ * the user mesh by place() and moved by moveProxy(), so a preview frame costs O(proxy); final export keeps the full
+ * rig.
+ */
+class MeshLODBuilder {
+public:
+    /**
+     * @brief Decimates a mesh by vertex clustering.
+     * @param vertices Mesh positions.
+     * @param triangles Three vertex ids per triangle.
+     * @param targetVertexCount Maximum number of output vertices (pinned vertices are kept even past it).
+     * @param pinned Vertices kept as they are (out of range ids are ignored).
+     * @param lod Receives vertices, triangles, sourceVertex and clusterOf.
+     * @return False if the mesh is empty or a triangle indexes a missing vertex.
+     */
+    static bool decimate(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& triangles, size_t targetVertexCount,
+                         const std::vector<int>& pinned, MeshLOD& lod);
+
+    /**
+     * @brief Builds every level of detail of a template and its rig.
+     * @param rig Compiled rig of the template (the landmark vertices are pinned).
+     * @param templateVertices Template positions.
+     * @param templateTriangles Template triangles.
+     * @param cacheDir Directory of the correspondence sidecars (empty disables the cache).
+     * @param options Levels and thread count.
+     * @return One level per ratio, from the finest to the coarsest; empty on failure.
+     */
+    static std::vector<MeshLOD> build(const CompiledFaceRig& rig, const std::vector<glm::vec3>& templateVertices,
+                                      const std::vector<uint32_t>& templateTriangles, const std::string& cacheDir,
+                                      const MeshLODOptions& options = MeshLODOptions());
+
+    /**
+     * @brief Places a proxy on the user mesh it previews.
+     * @param lod Level to place.
+     * @param meshRest Rest positions of the user mesh.
+     * @param correspondence User mesh to template map, or null if the user mesh is the template itself.
+     * @param placement Receives the proxy rest positions and the unit scale of its motion.
+     * @return False if meshRest does not match the correspondence (or the template when there is none).
+     */
+    static bool place(const MeshLOD& lod, const std::vector<glm::vec3>& meshRest, const TopologyCorrespondence* correspondence,
+                      MeshLODPlacement& placement);
+
+    /**
+     * @brief Moves a placed proxy by the motion of its deformed rig.
+     * @param lod Level the proxy was deformed from.
+     * @param placement Result of place() for that level.
+     * @param deformedProxy Deformed proxy positions, one per lod.vertices, in template units.
+     * @param points Receives one position per proxy vertex on the user mesh.
+     * @return False if deformedProxy or the placement does not match the level.
+     */
+    static bool moveProxy(const MeshLOD& lod, const MeshLODPlacement& placement, const std::vector<glm::vec3>& deformedProxy,
+                          std::vector<glm::vec3>& points);
+};
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef METRICSREGISTRY_H_
+#define METRICSREGISTRY_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum MetricKind
+ * @brief Type of a registered metric.
+ */
+enum class MetricKind {
+    counter,    ///< Monotonic count (frames, bytes, cache hits)
+    gauge,      ///< Current level with its peak (queue depths)
+    histogram   ///< Latency distribution in seconds
+};
+
+/**
+ * @class MetricCounter
+ * @brief Monotonic counter; add() is a single relaxed atomic add.
+ */
+class MetricCounter {
+public:
+    void add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};   ///< Current count
+};
+
+/**
+ * @class MetricGauge
+ * @brief Level that goes up and down, with the highest level seen since the last reset.
+ */
+class MetricGauge {
+public:
+    void set(int64_t value);
+    void add(int64_t amount);
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+    int64_t peak() const { return m_peak.load(std::memory_order_relaxed); }
+    void reset();
+
+private:
+    void raisePeak(int64_t value);
+
+    std::atomic<int64_t> m_value{0};    ///< Current level
+    std::atomic<int64_t> m_peak{0};     ///< Highest level
+};
+
+/**
+ * @class MetricHistogram
+ * @brief Latency histogram with fixed power-of-two buckets from 1 us to about 8 s (plus an overflow bucket).
+ *
+ * observe() is three relaxed atomic adds; quantiles are read back as the upper bound of the bucket that holds them.
+ */
+class MetricHistogram {
+public:
+    static constexpr size_t kBucketCount = 24;  ///< Finite buckets; bucket i holds samples up to 2^i us
+
+    /**
+     * @brief Upper bound of a bucket in seconds (infinity for the overflow bucket kBucketCount).
+     */
+    static double bucketBound(size_t bucket);
+
+    void observe(double seconds);
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double sum() const { return static_cast<double>(m_sumNanoseconds.load(std::memory_order_relaxed)) * 1e-9; }
+
+    /**
+     * @brief Number of samples of one bucket (not cumulative); bucket kBucketCount counts the overflow.
+     */
+    uint64_t bucket(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Upper bound of the bucket holding quantile q, 0 without samples.
+     */
+    double quantile(double q) const;
+
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount + 1> m_buckets{};   ///< Samples per bucket
+    std::atomic<uint64_t> m_count{0};                                   ///< Number of samples
+    std::atomic<uint64_t> m_sumNanoseconds{0};                          ///< Sum of the samples
+};
+
+/**
+ * @class MetricTimer
+ * @brief Records the time between its construction and its destruction into a histogram.
+ */
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& histogram) : m_histogram(histogram), m_begin(std::chrono::steady_clock::now()) {}
+    ~MetricTimer() { m_histogram.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count()); }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& m_histogram;                       ///< Receives the elapsed time
+    std::chrono::steady_clock::time_point m_begin;      ///< Construction time
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Always-on aggregate metrics, exported as JSON or Prometheus text.
+ *
+ * Metrics live in a fixed table of kCapacity slots addressed by the hash of their name. Registration claims a
+ * slot with a compare-and-swap, so neither registration nor updates take a lock; a metric never moves, and call
+ * sites keep the returned reference in a function-static and only pay for the atomic update afterwards. A name
+ * registered again returns the same metric. Invalid names, kind clashes and a full table are reported and get a
+ * scratch metric that is never exported.
+ */
+class MetricsRegistry {
+public:
+    static constexpr size_t kCapacity = 256;        ///< Maximum number of metrics
+    static constexpr size_t kMaxNameLength = 63;    ///< Longest metric name
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * @brief Process wide registry used by the library instrumentation.
+     */
+    static MetricsRegistry& global();
+
+    /**
+     * @brief Returns the counter of that name, registering it on first use.
+     * @param name Prometheus metric name ([a-zA-Z_:][a-zA-Z0-9_:]*).
+     * @param help One line description (kept from the first registration).
+     */
+    MetricCounter& counter(const char* name, const char* help = "");
+
+    /**
+     * @brief Returns the gauge of that name, registering it on first use.
+     */
+    MetricGauge& gauge(const char* name, const char* help = "");
+
+    /**
+     * @brief Returns the latency histogram of that name, registering it on first use.
+     */
+    MetricHistogram& histogram(const char* name, const char* help = "");
+
+    /**
+     * @brief Returns the number of registered metrics.
+     */
+    size_t size() const;
+
+    /**
+     * @brief JSON snapshot: counters, gauges, histograms (count, sum, p50/p95/p99, buckets) and the hit rate of
+     *        every "<cache>_hits_total" / "<cache>_misses_total" counter pair.
+     */
+    std::string toJSON() const;
+
+    /**
+     * @brief Snapshot in the Prometheus text exposition format.
+     */
+    std::string toPrometheus() const;
+
+    /**
+     * @brief Writes a snapshot to a file: JSON for a ".json" path, Prometheus text otherwise.
+     * @return False if the file could not be written.
+     */
+    bool writeFile(const std::string& path) const;
+
+    /**
+     * @brief Zeroes every metric; the registrations are kept.
+     */
+    void reset();
+
+private:
+    struct Entry {
+        std::atomic<int> state{0};          ///< 0 free, 1 being registered, 2 ready
+        MetricKind kind = MetricKind::counter;
+        char name[kMaxNameLength + 1] = {};
+        std::string help;
+        MetricCounter counter;
+        MetricGauge gauge;
+        MetricHistogram histogram;
+    };
+
+    Entry& find(const char* name, const char* help, MetricKind kind);
+    template <typename Fn> void forEachSorted(Fn&& fn) const;
+
+    std::array<Entry, kCapacity> m_entries;     ///< Open addressing table
+    Entry m_scratch;                            ///< Returned for rejected registrations
+};
+
+/**
+ * @struct PipelineMetrics
+ * @brief The metrics of the retargeting pipeline, named in one place so dashboards and call sites agree.
+ */
+struct PipelineMetrics {
+    static MetricCounter& framesProcessed();        ///< Frames evaluated by the plugin
+    static MetricCounter& bytesLoaded();            ///< Bytes of table, mesh and clip files read
+    static MetricHistogram& parseSeconds();         ///< Parse time of a table, mesh or clip file
+    static MetricHistogram& evaluateSeconds();      ///< AU evaluation and solve time of a frame
+    static MetricHistogram& deformSeconds();        ///< Delta accumulation time of a character
+    static MetricHistogram& writeSeconds();         ///< Point cache write time of a frame
+    static MetricCounter& neutralProfileHits();     ///< Neutral profiles read from the cache
+    static MetricCounter& neutralProfileMisses();   ///< Neutral profiles computed from the neutral capture
+    static MetricCounter& correspondenceHits();     ///< Topology correspondences read from a sidecar
+    static MetricCounter& correspondenceMisses();   ///< Topology correspondences built from scratch
+    static MetricGauge& landmarkQueueDepth();       ///< Streamed frames waiting for the plugin
+
+    /**
+     * @brief Size of a file in bytes, 0 if it cannot be read.
+     */
+    static uint64_t fileBytes(const char* path);
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef MUSCLEPATCHSTORE_H_
+#define MUSCLEPATCHSTORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "MemoryFootprint.h"
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+class IndexedMesh;
+class TopologyCorrespondence;
+
+/**
+ * @struct MusclePatch
+ * @brief View of one muscle's vertex indices inside a MusclePatchStore.
+ */
+struct MusclePatch {
+    int muscleId;               ///< Muscle identifier from musclePatches.json
+    const uint32_t* vertices;   ///< Vertex indices, ascending
+    size_t size;                ///< Number of vertices
+};
+
+/**
+ * @struct MuscleStats
+ * @brief Cached per-muscle aggregates of a mesh.
+ */
+struct MuscleStats {
+    glm::vec3 centroid = glm::vec3(0.0f);   ///< Mean vertex position
+    glm::vec3 boundsMin = glm::vec3(0.0f);  ///< Bounding box minimum
+    glm::vec3 boundsMax = glm::vec3(0.0f);  ///< Bounding box maximum
+    float meanRadius = 0.0f;                ///< Mean distance of the vertices to the centroid
+    uint32_t edgeCount = 0;                 ///< Mesh edges with both ends in the patch (0 without adjacency)
+    float minEdgeLength = 0.0f;             ///< Shortest of those edges at rest
+    float meanEdgeLength = 0.0f;            ///< Mean rest length of those edges
+    float maxEdgeLength = 0.0f;             ///< Longest of those edges at rest
+};
+
+/**
+ * @class MusclePatchStore
+ * @brief Muscle patches in CSR form: muscles get dense indices (ascending muscle id) into one flat vertex index array.
+ *
+ * Per-muscle queries are gathers from the caller's mesh buffer, so no copy of the vertex positions is kept per
+ * muscle. computeStats() fills the per-muscle aggregates in parallel and caches them until the next call.
+ */
+class MusclePatchStore {
+public:
+    /**
+     * @brief Builds the store from a muscle id to vertex indices map.
+     * @return False if an index is negative; the store is then empty.
+     */
+    bool build(const std::unordered_map<int, std::vector<int>>& muscleIndexMap);
+
+    /**
+     * @brief Parses musclePatches.json (muscle id keys, vertex index arrays) straight into CSR form.
+     * @return False if the file cannot be read or a key or index is invalid.
+     */
+    bool loadFromJSON(const char* jsonPath);
+
+    /**
+     * @brief Returns a copy whose patches address the user mesh of a topology correspondence.
+     */
+    MusclePatchStore remapped(const TopologyCorrespondence& correspondence) const;
+
+    /**
+     * @brief Returns the number of muscles.
+     */
+    size_t muscleCount() const { return m_muscleIds.size(); }
+
+    /**
+     * @brief Returns the dense index of a muscle id, or -1 if the store has no such muscle.
+     */
+    int denseIndex(int muscleId) const;
+
+    /**
+     * @brief Returns the patch of a muscle by dense index.
+     */
+    MusclePatch patch(size_t dense) const
+    {
+        return {m_muscleIds[dense], m_vertices.data() + m_offsets[dense], static_cast<size_t>(m_offsets[dense + 1] - m_offsets[dense])};
+    }
+
+    /**
+     * @brief Copies the positions of a muscle's vertices out of a mesh buffer.
+     * @param dense Dense muscle index.
+     * @param meshVertices Mesh positions.
+     * @param out Receives one position per patch vertex (out of range vertices are skipped).
+     */
+    void gather(size_t dense, const std::vector<glm::vec3>& meshVertices, std::vector<glm::vec3>& out) const;
+
+    /**
+     * @brief Returns the highest vertex index referenced plus one.
+     */
+    uint32_t requiredVertexCount() const { return m_requiredVertexCount; }
+
+    /**
+     * @brief Computes the centroid, bounds and radius of every muscle in parallel.
+     * @return False if the mesh is smaller than requiredVertexCount().
+     */
+    bool computeStats(const std::vector<glm::vec3>& meshVertices, unsigned int workerCount = 0);
+
+    /**
+     * @brief Same as above, plus the rest edge length statistics from the mesh adjacency.
+     */
+    bool computeStats(const IndexedMesh& mesh, unsigned int workerCount = 0);
+
+    /**
+     * @brief Returns the aggregates of the last computeStats(), indexed by dense muscle index.
+     */
+    const std::vector<MuscleStats>& stats() const { return m_stats; }
+
+    /**
+     * @brief Returns the muscle ids, ascending.
+     */
+    const std::vector<int>& muscleIds() const { return m_muscleIds; }
+
+    /**
+     * @brief Returns the CSR offsets (muscleCount() + 1 entries).
+     */
+    const std::vector<uint32_t>& offsets() const { return m_offsets; }
+
+    /**
+     * @brief Returns the flat vertex index array.
+     */
+    const std::vector<uint32_t>& vertices() const { return m_vertices; }
+
+    /**
+     * @brief Returns the heap bytes of the CSR arrays and of the cached aggregates.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    bool computeStats(const std::vector<glm::vec3>& meshVertices, const IndexedMesh* mesh, unsigned int workerCount);
+    void append(int muscleId, std::vector<uint32_t> vertices);
+
+    std::vector<int> m_muscleIds;           ///< Muscle id per dense index, ascending
+    std::vector<uint32_t> m_offsets{0};     ///< CSR offsets into m_vertices
+    std::vector<uint32_t> m_vertices;       ///< Patch vertex indices
+    uint32_t m_requiredVertexCount = 0;     ///< Highest referenced vertex plus one
+    std::vector<MuscleStats> m_stats;       ///< Cached aggregates
+};
+
+#endif
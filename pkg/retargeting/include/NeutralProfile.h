@@ -0,0 +1,135 @@
+#ifndef NEUTRALPROFILE_H_
+#define NEUTRALPROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "FacialLandmark.h"
+#include "MemoryFootprint.h"
+#include "Side.h"
+
+/**
+ * @struct NeutralProfileHeader
+ * @brief Fixed size header of a neutral profile file.
+ */
+struct NeutralProfileHeader {
+    char magic[4];              ///< "PMXN"
+    uint32_t version;           ///< File format version
+    uint32_t entryCount;        ///< Number of AU/side entries
+    uint32_t landmarkCount;     ///< Number of stored landmarks (51)
+    float scale;                ///< Normalization scale of the neutral face
+    uint32_t reserved;          ///< Padding, always zero
+};
+
+/**
+ * @struct NeutralDistance
+ * @brief Neutral landmark-pair distance of one AU/side pair.
+ */
+struct NeutralDistance {
+    int32_t auId;           ///< Action Unit identifier
+    int32_t side;           ///< Side of the face (Side value)
+    float distance;         ///< Mean distance of the AU's landmark pairs on the neutral face
+    uint32_t pairCount;     ///< Number of pairs averaged
+};
+
+/**
+ * @class NeutralProfile
+ * @brief Per-actor neutral face baseline, computed once and reused by every clip of that actor.
+ *
+ * Holds the 51 selected neutral landmarks, the mean pair distance of every AU/side pair of the landmark/AU map and
+ * a normalization scale (bounding box diagonal of the 51 landmarks). The profile is stored as a small binary file
+ * (header, entries sorted by AU and side, landmarks) so reloading it is a handful of reads instead of parsing the
+ * 478-landmark neutral JSON.
+ */
+class NeutralProfile {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    NeutralProfile() = default;
+
+    /**
+     * @brief Computes the profile from the neutral landmarks.
+     * @param landmarksAUMap Landmark pairs of every AU/side pair (indices into the 51 landmarks).
+     * @param neutralLandmarks The 51 landmarks of the neutral frame.
+     * @return False if no AU pair could be measured.
+     */
+    bool compute(const std::unordered_map<int, std::vector<landmarksActionUnit>>& landmarksAUMap,
+                 const std::vector<glm::vec3>& neutralLandmarks);
+
+    /**
+     * @brief Writes the profile to a binary file.
+     * @return True if the file was written.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Reads a profile file.
+     * @return False if the file is missing, invalid or its length does not match the counts of its header.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Returns the neutral distance of an AU/side pair.
+     * @return The mean pair distance, or a negative value if the profile has no such pair.
+     */
+    float distance(int auId, Side side) const;
+
+    /**
+     * @brief Returns all entries, sorted by AU id and side.
+     */
+    const std::vector<NeutralDistance>& entries() const { return m_entries; }
+
+    /**
+     * @brief Returns the 51 neutral landmarks.
+     */
+    const std::vector<glm::vec3>& landmarks() const { return m_landmarks; }
+
+    /**
+     * @brief Returns the normalization scale (bounding box diagonal of the neutral landmarks).
+     */
+    float scale() const { return m_scale; }
+
+    /**
+     * @brief Returns true once compute() or load() succeeded.
+     */
+    bool isValid() const { return !m_entries.empty(); }
+
+    /**
+     * @brief Cache file path of an actor's profile inside cacheDir.
+     * @param cacheDir Directory of the profile files.
+     * @param actorKey Any string identifying the actor's neutral capture.
+     */
+    static std::string profilePath(const std::string& cacheDir, const std::string& actorKey);
+
+    /**
+     * @brief Cache key of a neutral capture measured with a landmark/AU map.
+     *
+     * Combines the capture path, size and modification time with a hash of the map's content, so editing either
+     * the capture or the rig tables selects another profile file.
+     */
+    static std::string profileKey(const std::string& neutralJson,
+                                  const std::unordered_map<int, std::vector<landmarksActionUnit>>& landmarksAUMap);
+
+    /**
+     * @brief Mean distance of consecutive landmark pairs (a, b), (c, d), ...
+     * @return The mean distance, or a negative value if there is no complete pair in range.
+     */
+    static float meanPairDistance(const std::vector<int>& landmarkIndices, const std::vector<glm::vec3>& landmarks);
+
+    /**
+     * @brief Returns the heap bytes of the distance entries and the neutral landmarks.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    std::vector<NeutralDistance> m_entries;     ///< Neutral distance per AU/side pair
+    std::vector<glm::vec3> m_landmarks;         ///< Neutral 51 landmarks
+    float m_scale = 0.0f;                       ///< Normalization scale
+};
+
+#endif
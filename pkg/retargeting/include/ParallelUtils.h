@@ -0,0 +1,180 @@
+#ifndef PARALLELUTILS_H_
+#define PARALLELUTILS_H_
+
+#include "MemoryFootprint.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Returns the number of workers used when a caller does not request a specific count.
+ * @return Hardware concurrency, or 1 when the platform cannot report it.
+ */
+inline unsigned int defaultWorkerCount()
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+/**
+ * @brief Splits the range [begin, end) into contiguous chunks and runs them on worker threads.
+ *
+ * The callable receives (chunkBegin, chunkEnd). Chunks never overlap, so kernels that only write
+ * to the elements of their own chunk need no synchronisation. Small ranges run on the calling thread.
+ *
+ * @param begin First index of the range.
+ * @param end One past the last index of the range.
+ * @param fn Callable invoked as fn(size_t chunkBegin, size_t chunkEnd).
+ * @param workerCount Number of workers (0 uses defaultWorkerCount()).
+ * @param minChunkSize Minimum number of elements given to a single worker.
+ */
+template <typename Fn>
+void parallelFor(size_t begin, size_t end, Fn&& fn, unsigned int workerCount = 0, size_t minChunkSize = 256)
+{
+    if (end <= begin) return;
+
+    const size_t total = end - begin;
+    if (workerCount == 0) workerCount = defaultWorkerCount();
+
+    size_t maxWorkers = std::max<size_t>(1, total / std::max<size_t>(1, minChunkSize));
+    size_t workers = std::min<size_t>(workerCount, maxWorkers);
+    if (workers <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    const size_t chunk = (total + workers - 1) / workers;
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+
+    // workers charge their allocations to the caller's subsystem (tracking builds)
+    const MemorySubsystem subsystem = MemoryTracker::current();
+    for (size_t w = 1; w < workers; ++w)
+    {
+        size_t chunkBegin = begin + w * chunk;
+        size_t chunkEnd = std::min(end, chunkBegin + chunk);
+        if (chunkBegin >= chunkEnd) break;
+        threads.emplace_back([&fn, chunkBegin, chunkEnd, subsystem]() {
+            MemoryScope scope(subsystem);
+            fn(chunkBegin, chunkEnd);
+        });
+    }
+
+    // the calling thread processes the first chunk instead of idling
+    fn(begin, std::min(end, begin + chunk));
+
+    for (auto& thread : threads) thread.join();
+}
+
+/**
+ * @enum ReductionMode
+ * @brief How parallel reductions combine their partial results.
+ */
+enum class ReductionMode {
+    fast,           ///< One partial result per worker: the rounding depends on the worker count
+    deterministic   ///< Fixed size blocks combined by a fixed tree: bitwise identical for any worker count
+};
+
+/**
+ * @brief Process wide reduction mode (fast by default), e.g. deterministic on farm nodes whose caches are diffed.
+ */
+inline std::atomic<ReductionMode>& reductionModeSetting()
+{
+    static std::atomic<ReductionMode> mode{ReductionMode::fast};
+    return mode;
+}
+
+/**
+ * @brief Returns the current reduction mode.
+ */
+inline ReductionMode reductionMode() { return reductionModeSetting().load(std::memory_order_relaxed); }
+
+/**
+ * @brief Sets the reduction mode of every parallel reduction of the library.
+ */
+inline void setReductionMode(ReductionMode mode) { reductionModeSetting().store(mode, std::memory_order_relaxed); }
+
+/**
+ * @struct NeumaierSum
+ * @brief Compensated sum (Kahan-Babuska-Neumaier): the rounding error of every addition is carried separately.
+ */
+struct NeumaierSum {
+    double sum = 0.0;           ///< Running sum
+    double compensation = 0.0;  ///< Accumulated rounding error
+
+    void add(double value)
+    {
+        const double t = sum + value;
+        if (std::fabs(sum) >= std::fabs(value)) compensation += (sum - t) + value;
+        else compensation += (value - t) + sum;
+        sum = t;
+    }
+
+    void add(const NeumaierSum& other)
+    {
+        add(other.sum);
+        add(other.compensation);
+    }
+
+    double value() const { return sum + compensation; }
+};
+
+/**
+ * @brief Reduces the range [begin, end) in parallel.
+ *
+ * map(chunkBegin, chunkEnd) returns the partial result of a chunk and combine(a, b) merges two partial results
+ * (a covers the elements before b). In fast mode every worker maps one chunk and the partials are combined in order.
+ * In deterministic mode the range is cut into blocks of blockSize elements whatever the worker count, and the block
+ * partials are combined pairwise in a fixed tree, so the result only depends on the data and blockSize.
+ *
+ * @param identity Result of an empty range.
+ * @param workerCount Number of workers (0 uses defaultWorkerCount()).
+ * @param blockSize Elements per block (deterministic mode) and minimum elements per worker (fast mode).
+ * @param mode Reduction mode (defaults to reductionMode()).
+ */
+template <typename T, typename MapFn, typename CombineFn>
+T parallelReduce(size_t begin, size_t end, T identity, MapFn&& map, CombineFn&& combine, unsigned int workerCount = 0,
+                 size_t blockSize = 256, ReductionMode mode = reductionMode())
+{
+    if (end <= begin) return identity;
+    blockSize = std::max<size_t>(1, blockSize);
+
+    std::vector<T> partials;
+    if (mode == ReductionMode::fast)
+    {
+        const size_t workers = std::max<size_t>(1, std::min<size_t>(workerCount == 0 ? defaultWorkerCount() : workerCount,
+                                                                    (end - begin) / blockSize));
+        const size_t chunk = (end - begin + workers - 1) / workers;
+        partials.assign(workers, identity);
+        parallelFor(0, workers, [&](size_t first, size_t last) {
+            for (size_t w = first; w < last; ++w)
+            {
+                const size_t chunkBegin = std::min(end, begin + w * chunk);
+                const size_t chunkEnd = std::min(end, chunkBegin + chunk);
+                if (chunkBegin < chunkEnd) partials[w] = map(chunkBegin, chunkEnd);
+            }
+        }, static_cast<unsigned int>(workers), 1);
+
+        T result = identity;
+        for (const T& partial : partials) result = combine(result, partial);
+        return result;
+    }
+
+    const size_t blocks = (end - begin + blockSize - 1) / blockSize;
+    partials.assign(blocks, identity);
+    parallelFor(0, blocks, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b)
+            partials[b] = map(begin + b * blockSize, std::min(end, begin + (b + 1) * blockSize));
+    }, workerCount, 1);
+
+    // pairwise tree: level by level, neighbours merge left to right
+    for (size_t stride = 1; stride < blocks; stride *= 2)
+        for (size_t b = 0; b + stride < blocks; b += 2 * stride)
+            partials[b] = combine(partials[b], partials[b + stride]);
+    return partials[0];
+}
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef PLAYBACKSCHEDULER_H_
+#define PLAYBACKSCHEDULER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "CompiledFaceRig.h"
+#include "LandmarkProtocol.h"
+#include "QuantileSketch.h"
+
+class LandmarkStreamClient;
+
+/**
+ * @enum PlaybackPolicy
+ * @brief What an output frame shows when its time falls between source frames.
+ */
+enum class PlaybackPolicy {
+    drop,           ///< The latest source frame at or before the output time; the frames skipped over are never evaluated
+    interpolate     ///< The AU weights blended between the two source frames around the output time
+};
+
+/**
+ * @struct PlaybackOptions
+ * @brief Playback settings.
+ */
+struct PlaybackOptions {
+    double frameRate = 30.0;                        ///< Target presentation rate
+    PlaybackPolicy policy = PlaybackPolicy::drop;   ///< Frame selection policy
+    unsigned int workerCount = 1;                   ///< Threads of the deformation (0 uses all hardware threads)
+    double maxMissRatio = 0.01;                     ///< Missed deadline ratio still reported as holding the rate
+};
+
+/**
+ * @struct PlaybackSource
+ * @brief Frame source of a playback: a live landmark stream or a preloaded clip.
+ */
+struct PlaybackSource {
+    std::function<bool(LandmarkFrame& frame, int timeoutMs)> next;  ///< Pops the next frame, false on timeout or at the end
+    std::function<bool()> finished;                                 ///< True once no more frame will arrive
+
+    /**
+     * @brief Plays the frames of a streaming client as they arrive.
+     */
+    static PlaybackSource fromStream(LandmarkStreamClient& client);
+
+    /**
+     * @brief Plays a clip that is already in memory.
+     */
+    static PlaybackSource fromClip(std::shared_ptr<const std::vector<LandmarkFrame>> frames);
+};
+
+/**
+ * @struct PlaybackClock
+ * @brief Time base of a playback (replaceable so tests can simulate load).
+ */
+struct PlaybackClock {
+    std::function<double()> now;                ///< Current time in seconds
+    std::function<void(double)> sleepUntil;     ///< Blocks until the given time
+
+    /**
+     * @brief std::chrono::steady_clock based clock.
+     */
+    static PlaybackClock steady();
+};
+
+/**
+ * @struct PlaybackFrame
+ * @brief A deformed vertex buffer ready to be shown.
+ */
+struct PlaybackFrame {
+    uint64_t tick = 0;                                      ///< Output frame number
+    double clipTime = 0.0;                                  ///< Clip time shown, in seconds from the first source frame
+    uint32_t sourceIndex = 0;                               ///< Source frame at or before clipTime
+    bool interpolated = false;                              ///< The weights were blended between two source frames
+    std::shared_ptr<const std::vector<glm::vec3>> vertices; ///< Deformed vertices; the scheduler reuses the buffer once released
+};
+
+/**
+ * @struct PlaybackStats
+ * @brief Deadline accounting of a playback.
+ */
+struct PlaybackStats {
+    uint64_t framesPresented = 0;       ///< Output frames handed to the presenter
+    uint64_t deadlinesMissed = 0;       ///< Output frames ready after their deadline
+    uint64_t ticksSkipped = 0;          ///< Output frames skipped because their deadline had already passed
+    uint64_t framesHeld = 0;            ///< Output frames that showed the previous state again (no newer source frame)
+    uint64_t framesInterpolated = 0;    ///< Output frames blended between two source frames
+    uint64_t sourceEvaluated = 0;       ///< Source frames whose AU weights were evaluated
+    uint64_t sourceDropped = 0;         ///< Source frames skipped without evaluation
+    double latencyP50Ms = 0.0;          ///< Median time from tick start to buffer ready
+    double latencyP95Ms = 0.0;          ///< 95th percentile latency
+    double latencyP99Ms = 0.0;          ///< 99th percentile latency
+    double latencyMaxMs = 0.0;          ///< Worst latency
+    double elapsedSeconds = 0.0;        ///< Wall time since the first tick
+    double achievedFrameRate = 0.0;     ///< Presented frames per second
+    bool holdsFrameRate = false;        ///< Missed and skipped frames stay within PlaybackOptions::maxMissRatio
+};
+
+/**
+ * @class PlaybackScheduler
+ * @brief Drives AU evaluation and deformation at a target frame rate from a frame source.
+ *
+ * Output tick k starts at t0 + k / frameRate and must be ready one period later (its deadline). For every tick the
+ * scheduler pulls the source frames that are due, evaluates the AU weights of the frames the policy needs (each
+ * source frame at most once), deforms the rest mesh with the shared rig and hands the buffer to the presenter.
+ * A tick whose deadline has already passed when it would start is skipped, so an overloaded machine shows fewer
+ * frames at the right time instead of drifting behind the audio. Latencies go to a quantile sketch, and stats()
+ * reports the percentiles, the missed deadlines and whether the target rate held.
+ */
+class PlaybackScheduler {
+public:
+    using EvaluateFn = std::function<bool(const LandmarkFrame& frame, std::vector<float>& slotWeights)>;
+    using PresentFn = std::function<void(const PlaybackFrame& frame)>;
+
+    /**
+     * @brief Creates a scheduler for one character.
+     * @param rig Compiled rig of the character.
+     * @param restVertices Character mesh at rest.
+     * @param options Playback settings.
+     */
+    PlaybackScheduler(std::shared_ptr<const CompiledFaceRig> rig, std::vector<glm::vec3> restVertices, PlaybackOptions options = PlaybackOptions());
+
+    /**
+     * @brief Stops a running playback and joins its thread.
+     */
+    ~PlaybackScheduler();
+
+    PlaybackScheduler(const PlaybackScheduler&) = delete;
+    PlaybackScheduler& operator=(const PlaybackScheduler&) = delete;
+
+    /**
+     * @brief Replaces the time base (steady clock by default). Call before run().
+     */
+    void setClock(PlaybackClock clock) { m_clock = std::move(clock); }
+
+    /**
+     * @brief Plays the source on the calling thread until it ends or stop() is called.
+     * @param source Frame source.
+     * @param evaluate Computes the AU weights of a source frame (one per rig slot); on failure the previous weights stay.
+     * @param present Receives every ready buffer (called on the playback thread).
+     * @return False if the rig or the rest mesh is unusable, or no source frame arrived.
+     */
+    bool run(PlaybackSource source, EvaluateFn evaluate, PresentFn present);
+
+    /**
+     * @brief Same as run() on a thread of its own.
+     * @return False if a playback is already running.
+     */
+    bool start(PlaybackSource source, EvaluateFn evaluate, PresentFn present);
+
+    /**
+     * @brief Asks the playback to stop after the current tick and joins its thread.
+     */
+    void stop();
+
+    /**
+     * @brief Returns true while a playback runs.
+     */
+    bool isRunning() const { return m_running.load(); }
+
+    /**
+     * @brief Returns a snapshot of the deadline accounting (safe while playing).
+     */
+    PlaybackStats stats() const;
+
+private:
+    bool play(const PlaybackSource& source, const EvaluateFn& evaluate, const PresentFn& present);
+    std::shared_ptr<std::vector<glm::vec3>> acquireBuffer();
+
+    std::shared_ptr<const CompiledFaceRig> m_rig;                   ///< Shared rig
+    std::vector<glm::vec3> m_restVertices;                          ///< Character rest mesh
+    PlaybackOptions m_options;                                      ///< Playback settings
+    PlaybackClock m_clock;                                          ///< Time base
+    std::vector<std::shared_ptr<std::vector<glm::vec3>>> m_buffers; ///< Output buffers recycled once the presenter drops them
+    std::thread m_thread;                                           ///< Playback thread of start()
+    std::atomic<bool> m_running{false};                             ///< A playback is in progress
+    std::atomic<bool> m_stopRequested{false};                       ///< stop() was called
+    mutable std::mutex m_statsMutex;                                ///< Guards the two fields below
+    PlaybackStats m_stats;                                          ///< Counters of the current playback
+    QuantileSketch m_latency;                                       ///< Tick latencies in milliseconds
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef POINTCACHE_H_
+#define POINTCACHE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @enum PointCacheEncoding
+ * @brief Storage format of the vertex components in a point cache.
+ */
+enum class PointCacheEncoding : uint32_t {
+    float32 = 0,    ///< Full precision floats
+    float16 = 1     ///< IEEE half floats, half the size on disk
+};
+
+/**
+ * @struct PointCacheOptions
+ * @brief Layout options chosen when a point cache is created.
+ */
+struct PointCacheOptions {
+    PointCacheEncoding encoding = PointCacheEncoding::float32;  ///< Component encoding
+    bool deltaEncoding = false;     ///< Store frames as the difference from the previous frame
+    uint32_t framesPerChunk = 16;   ///< Frames per chunk; each chunk starts with an absolute key frame
+    float framesPerSecond = 30.0f;  ///< Playback rate stored for the consumer
+};
+
+/**
+ * @struct PointCacheHeader
+ * @brief Fixed size header at the start of a point cache file.
+ */
+struct PointCacheHeader {
+    char magic[4];              ///< "PMXC"
+    uint32_t version;           ///< File format version
+    uint32_t vertexCount;       ///< Vertices per frame
+    uint32_t encoding;          ///< PointCacheEncoding value
+    uint32_t deltaEncoding;     ///< 1 if frames inside a chunk are deltas
+    uint32_t framesPerChunk;    ///< Chunk length in frames
+    float framesPerSecond;      ///< Playback rate
+    uint32_t reserved;          ///< Padding, always zero
+    uint64_t frameCount;        ///< Number of frames (patched when the writer closes)
+    uint64_t indexOffset;       ///< Byte offset of the frame index (patched when the writer closes)
+};
+
+/**
+ * @class PointCacheWriter
+ * @brief Streams deformed mesh frames to disk as they are produced.
+ *
+ * Frames are appended one at a time and never kept in memory, only their byte offsets are.
+ * The file is split in chunks of framesPerChunk frames: the first frame of a chunk is stored absolute and,
+ * with delta encoding, the rest as differences from the previously decoded frame, so decoding any frame
+ * touches at most one chunk. close() appends the frame index and patches the header.
+ */
+class PointCacheWriter {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    PointCacheWriter() = default;
+
+    /**
+     * @brief Closes the file if it is still open.
+     */
+    ~PointCacheWriter();
+
+    /**
+     * @brief Creates the cache file and writes its header.
+     * @param path Output file path.
+     * @param vertexCount Vertices per frame.
+     * @param options Layout options.
+     * @return True if the file could be created.
+     */
+    bool open(const char* path, uint32_t vertexCount, const PointCacheOptions& options = PointCacheOptions());
+
+    /**
+     * @brief Appends one frame to the cache.
+     * @param vertices Frame positions, must contain vertexCount entries.
+     * @return True if the frame was written.
+     */
+    bool appendFrame(const std::vector<glm::vec3>& vertices);
+
+    /**
+     * @brief Writes the frame index, patches the header and closes the file.
+     * @return True if the cache was finalised successfully.
+     */
+    bool close();
+
+    /**
+     * @brief Returns the number of frames written so far.
+     */
+    uint64_t frameCount() const { return m_frameOffsets.size(); }
+
+private:
+    void encode(const std::vector<glm::vec3>& values);
+
+    std::ofstream m_file;                       ///< Output stream
+    PointCacheHeader m_header{};                ///< Header written at open and patched at close
+    std::vector<uint64_t> m_frameOffsets;       ///< Byte offset of every frame written
+    std::vector<glm::vec3> m_previousFrame;     ///< Decoded previous frame (reference for delta encoding)
+    std::vector<glm::vec3> m_delta;             ///< Scratch buffer for the delta of the current frame
+    std::vector<char> m_encoded;                ///< Scratch buffer with the encoded frame bytes
+};
+
+/**
+ * @class PointCacheReader
+ * @brief Memory-mapped reader for point cache files.
+ *
+ * The file is mapped read-only and frames are located through the index, so any frame is reached in constant
+ * time: absolute frames are decoded directly and delta frames replay at most one chunk from its key frame.
+ */
+class PointCacheReader {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    PointCacheReader() = default;
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~PointCacheReader();
+
+    PointCacheReader(const PointCacheReader&) = delete;
+    PointCacheReader& operator=(const PointCacheReader&) = delete;
+
+    /**
+     * @brief Maps a point cache file and validates its header and index.
+     * @param path Cache file path.
+     * @return True if the file is a valid, finalised point cache.
+     */
+    bool open(const char* path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Decodes a frame.
+     * @param frame Frame number.
+     * @param vertices Output positions (resized to the vertex count).
+     * @return False if the frame is out of range or nothing is mapped.
+     */
+    bool readFrame(uint64_t frame, std::vector<glm::vec3>& vertices) const;
+
+    /**
+     * @brief Returns the number of frames in the cache.
+     */
+    uint64_t frameCount() const { return m_header.frameCount; }
+
+    /**
+     * @brief Returns the number of vertices per frame.
+     */
+    uint32_t vertexCount() const { return m_header.vertexCount; }
+
+    /**
+     * @brief Returns the playback rate stored in the cache.
+     */
+    float framesPerSecond() const { return m_header.framesPerSecond; }
+
+private:
+    void decode(uint64_t frame, glm::vec3* out, bool accumulate) const;
+
+    const char* m_data = nullptr;           ///< Mapped file contents
+    size_t m_size = 0;                      ///< Mapped size in bytes
+    PointCacheHeader m_header{};            ///< Copy of the file header
+    const uint64_t* m_frameOffsets = nullptr; ///< Frame index inside the mapping
+};
+
+/**
+ * @brief Converts a float to IEEE 754 half precision (round to nearest even).
+ */
+uint16_t floatToHalf(float value);
+
+/**
+ * @brief Converts an IEEE 754 half precision value to float.
+ */
+float halfToFloat(uint16_t value);
+
+#endif
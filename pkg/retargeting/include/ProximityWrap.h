@@ -0,0 +1,87 @@
+#ifndef PROXIMITYWRAP_H_
+#define PROXIMITYWRAP_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "SurfaceQuery.h"
+
+/**
+ * @class ProximityWrap
+ * @brief Drives the skin mesh from the deformed muscle mesh through a precomputed binding.
+ *
+ * bind() runs once per asset: every skin vertex is attached to the closest muscle triangle through
+ * barycentric weights plus an offset expressed in the triangle's local frame (edge tangent, bitangent, normal).
+ * bind() also lists the triangles that hold skin vertices, so apply() rebuilds one frame per bound triangle
+ * instead of one per skin vertex, then rebuilds the skin as a sparse gather from the deformed muscle buffer.
+ * The binding is stored as structure-of-arrays so the per-vertex kernel stays branch free and vectorisable.
+ */
+class ProximityWrap {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    ProximityWrap() = default;
+
+    /**
+     * @brief Binds every skin vertex to its closest muscle triangle.
+     * @param skinVertices Skin vertex positions at rest.
+     * @param muscleVertices Muscle vertex positions at rest.
+     * @param muscleTriangles Flat triangle index list of the muscle mesh.
+     * @param workerCount Number of worker threads (0 uses all hardware threads).
+     * @return True if every skin vertex was bound.
+     */
+    bool bind(const std::vector<glm::vec3>& skinVertices,
+              const std::vector<glm::vec3>& muscleVertices,
+              const std::vector<unsigned int>& muscleTriangles,
+              unsigned int workerCount = 0);
+
+    /**
+     * @brief Deforms the skin from the deformed muscle vertices.
+     * @param deformedMuscleVertices Muscle vertex positions for the current frame.
+     * @param skinVertices Output skin positions (resized to the bound vertex count).
+     * @param workerCount Number of worker threads (0 uses all hardware threads).
+     * @return False if nothing is bound or the muscle buffer does not match the bound topology.
+     */
+    bool apply(const std::vector<glm::vec3>& deformedMuscleVertices,
+               std::vector<glm::vec3>& skinVertices,
+               unsigned int workerCount = 0) const;
+
+    /**
+     * @brief Returns true if bind() has succeeded.
+     */
+    bool isBound() const { return !m_index0.empty(); }
+
+    /**
+     * @brief Returns the number of bound skin vertices.
+     */
+    size_t boundVertexCount() const { return m_index0.size(); }
+
+    /**
+     * @brief Returns the number of muscle triangles that hold skin vertices (frames rebuilt per apply()).
+     */
+    size_t boundTriangleCount() const { return m_frameTriangles.size() / 3; }
+
+    /**
+     * @brief Clears the binding.
+     */
+    void clear();
+
+private:
+    // Binding in structure-of-arrays layout, one entry per skin vertex
+    std::vector<unsigned int> m_index0;     ///< First muscle vertex of the bound triangle
+    std::vector<unsigned int> m_index1;     ///< Second muscle vertex of the bound triangle
+    std::vector<unsigned int> m_index2;     ///< Third muscle vertex of the bound triangle
+    std::vector<float> m_weight0;           ///< Barycentric weight of the first vertex
+    std::vector<float> m_weight1;           ///< Barycentric weight of the second vertex
+    std::vector<float> m_weight2;           ///< Barycentric weight of the third vertex
+    std::vector<float> m_offsetTangent;     ///< Offset along the triangle edge tangent
+    std::vector<float> m_offsetBitangent;   ///< Offset along the triangle bitangent
+    std::vector<float> m_offsetNormal;      ///< Offset along the triangle normal
+    std::vector<unsigned int> m_frameOf;    ///< Bound triangle (frame) of every skin vertex
+    std::vector<unsigned int> m_frameTriangles; ///< Three muscle vertices per bound triangle
+    size_t m_muscleVertexCount = 0;         ///< Muscle vertex count the binding was built for
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef QUANTILESKETCH_H_
+#define QUANTILESKETCH_H_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class QuantileSketch
+ * @brief Mergeable streaming quantile sketch with relative accuracy and bounded memory (DDSketch style).
+ *
+ * Values are counted in logarithmic buckets: bucket k holds magnitudes in (gamma^(k-1), gamma^k] with
+ * gamma = (1 + a) / (1 - a), so any quantile is returned within relative error a. Positive and negative values
+ * use separate bucket stores and values close to zero share one counter. Each store keeps at most maxBuckets
+ * contiguous buckets; when a stream needs more, the smallest magnitudes are folded together, which keeps the memory
+ * constant for arbitrarily long inputs. Two sketches with the same parameters merge exactly.
+ */
+class QuantileSketch {
+public:
+    /**
+     * @brief Creates an empty sketch.
+     * @param relativeAccuracy Relative error bound a of the returned quantiles (0 < a < 1).
+     * @param maxBuckets Maximum number of buckets per sign.
+     */
+    explicit QuantileSketch(double relativeAccuracy = 0.01, uint32_t maxBuckets = 1024);
+
+    /**
+     * @brief Adds one value.
+     */
+    void add(double value);
+
+    /**
+     * @brief Adds the contents of another sketch.
+     * @return False if the sketches were created with different parameters.
+     */
+    bool merge(const QuantileSketch& other);
+
+    /**
+     * @brief Returns the value at quantile q (0 = minimum, 1 = maximum), or 0 for an empty sketch.
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Returns the number of values added.
+     */
+    uint64_t count() const { return m_count; }
+
+    /**
+     * @brief Returns the smallest value added (exact).
+     */
+    double min() const { return m_min; }
+
+    /**
+     * @brief Returns the largest value added (exact).
+     */
+    double max() const { return m_max; }
+
+    /**
+     * @brief Returns the relative accuracy the sketch was created with.
+     */
+    double relativeAccuracy() const { return m_relativeAccuracy; }
+
+    /**
+     * @brief Removes all values.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Contiguous bucket counts starting at key offset.
+     */
+    struct Store {
+        int32_t offset = 0;             ///< Key of counts[0]
+        std::vector<uint64_t> counts;   ///< Count per key
+    };
+
+    int32_t keyOf(double magnitude) const;
+    double valueOf(int32_t key) const;
+    void addToStore(Store& store, int32_t key, uint64_t count);
+
+    double m_relativeAccuracy;          ///< Relative error bound
+    double m_gamma;                     ///< Bucket growth factor
+    double m_logGamma;                  ///< log(m_gamma)
+    double m_minIndexable;              ///< Magnitudes below this count as zero
+    uint32_t m_maxBuckets;              ///< Bucket limit per store
+    Store m_positive;                   ///< Buckets of positive values
+    Store m_negative;                   ///< Buckets of the magnitudes of negative values
+    uint64_t m_zeroCount = 0;           ///< Values too close to zero for a bucket
+    uint64_t m_count = 0;               ///< Total number of values
+    double m_min = 0.0;                 ///< Exact minimum
+    double m_max = 0.0;                 ///< Exact maximum
+};
+
+#endif
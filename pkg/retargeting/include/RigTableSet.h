@@ -0,0 +1,68 @@
+#ifndef RIGTABLESET_H_
+#define RIGTABLESET_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ActionUnit.h"
+#include "FacialLandmark.h"
+#include "MemoryFootprint.h"
+#include "MusclePatchStore.h"
+
+/**
+ * @struct RigTableSet
+ * @brief The parsed static data tables (the JSON files of data/), one immutable shared table per file.
+ *
+ * Copying a set only copies the pointers, so replacing one table builds a new set that shares the others.
+ */
+struct RigTableSet {
+    std::shared_ptr<const MusclePatchStore> musclePatches;                                           ///< musclePatches.json
+    std::shared_ptr<const std::unordered_map<int, std::vector<ActionUnitDelta>>> auDeltaTable;      ///< deltaTransfer.json
+    std::shared_ptr<const std::vector<int>> landmarksMeshIndex;                                      ///< landmarksMeshIndex.json
+    std::shared_ptr<const std::vector<int>> landmarksPixelIndex;                                     ///< landmarksPixelIndex.json
+    std::shared_ptr<const std::unordered_map<int, std::vector<landmarksActionUnit>>> landmarksAUMap; ///< landmarksActionUnits.json
+    std::shared_ptr<const SymmetryMap> symmetry;                                                     ///< Mirror table of deltaTransfer.json (mirrored AUs)
+
+    /**
+     * @brief Snapshots the tables already loaded in an ActionUnit and a FacialLandmark instance.
+     */
+    static RigTableSet fromObjects(ActionUnit& actionUnit, FacialLandmark& facialLandmark);
+
+    /**
+     * @brief Returns true if fileName is one of the five table files.
+     */
+    static bool isTableFile(const std::string& fileName);
+
+    /**
+     * @brief Returns the names of the five table files.
+     */
+    static const std::vector<std::string>& tableFiles();
+
+    /**
+     * @brief Copies the tables another set holds (non-null pointers) into this one.
+     */
+    void merge(const RigTableSet& other);
+
+    /**
+     * @brief Checks the tables against each other (landmark table sizes, landmark ids of the mapping, mirrored AUs).
+     * @return False if two tables disagree; missing tables are not an error.
+     */
+    bool validate() const;
+
+    /**
+     * @brief Parses one table file and validates it against the other tables of the set.
+     * @param fileName Table file name (e.g. "deltaTransfer.json"), selects the table to replace.
+     * @param path Path of the file to parse.
+     * @return False if the file is not a table, cannot be parsed or is inconsistent; the set is then unchanged.
+     */
+    bool reloadTable(const std::string& fileName, const std::string& path);
+
+    /**
+     * @brief Returns the heap bytes of the tables the set holds, one nested footprint per table file.
+     */
+    MemoryFootprint memoryFootprint() const;
+};
+
+#endif
@@ -60,4 +60,43 @@ inline std::string sideToString(Side side) {
         default: return "unknown";
     }
 }
+
+/**
+ * @brief Returns the side on the other half of the face (center maps to itself).
+ */
+inline Side mirrorSide(Side side) {
+    switch (side) {
+        case Side::left: return Side::right;
+        case Side::right: return Side::left;
+        case Side::dnleft: return Side::dnright;
+        case Side::dnright: return Side::dnleft;
+        case Side::upleft: return Side::upright;
+        case Side::upright: return Side::upleft;
+        case Side::lipfunneldnleft: return Side::lipfunneldnright;
+        case Side::lipfunneldnright: return Side::lipfunneldnleft;
+        case Side::lipfunnelupleft: return Side::lipfunnelupright;
+        case Side::lipfunnelupright: return Side::lipfunnelupleft;
+        case Side::liptightendnleft: return Side::liptightendnright;
+        case Side::liptightendnright: return Side::liptightendnleft;
+        case Side::liptightenupleft: return Side::liptightenupright;
+        case Side::liptightenupright: return Side::liptightenupleft;
+        default: return side;
+    }
+}
+
+/**
+ * @brief Returns true for the right-hand variant of a mirrored pair of sides.
+ */
+inline bool isRightSide(Side side) {
+    switch (side) {
+        case Side::right:
+        case Side::dnright:
+        case Side::upright:
+        case Side::lipfunneldnright:
+        case Side::lipfunnelupright:
+        case Side::liptightendnright:
+        case Side::liptightenupright: return true;
+        default: return false;
+    }
+}
 #endif 
\ No newline at end of file
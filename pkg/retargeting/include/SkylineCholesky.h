@@ -0,0 +1,77 @@
+#ifndef SKYLINECHOLESKY_H_
+#define SKYLINECHOLESKY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SkylineCholesky
+ * @brief Sparse Cholesky factorization of a symmetric positive definite matrix in envelope (skyline) storage.
+ *
+ * The work is split in three phases so each can be reused:
+ * - analyze(): symbolic phase, depends only on the sparsity pattern. Computes a reverse Cuthill-McKee ordering,
+ *   which keeps the envelope of mesh matrices narrow, and lays out the factor.
+ * - factorize(): numeric phase, depends on the values. Run it again when only the values change.
+ * - solve(): forward and back substitution, for any number of right-hand sides at once.
+ *
+ * Fill-in of a Cholesky factor stays inside the envelope of the (permuted) matrix, so the layout computed by
+ * analyze() holds the factor exactly.
+ */
+class SkylineCholesky {
+public:
+    /**
+     * @brief Symbolic phase.
+     * @param size Matrix dimension.
+     * @param rowOffsets CSR row offsets (size + 1 entries).
+     * @param columns CSR column indices. The pattern must be symmetric and contain the diagonal.
+     * @return False if the CSR arrays are inconsistent.
+     */
+    bool analyze(size_t size, const std::vector<uint32_t>& rowOffsets, const std::vector<uint32_t>& columns);
+
+    /**
+     * @brief Numeric phase.
+     * @param values One value per entry of the columns array given to analyze(). Only the lower triangle is read.
+     * @return False if analyze() was not run, the value count differs or the matrix is not positive definite.
+     */
+    bool factorize(const std::vector<double>& values);
+
+    /**
+     * @brief Solves A X = B in place.
+     * @param rhs B on input, X on output: size() rows of rhsCount values (row-major, original ordering).
+     * @param rhsCount Number of right-hand sides.
+     * @param workerCount Number of threads, the right-hand sides are split between them (0 uses all hardware threads).
+     * @return False if the matrix is not factorized or rhs has the wrong size.
+     */
+    bool solve(std::vector<double>& rhs, size_t rhsCount, unsigned int workerCount = 0) const;
+
+    /**
+     * @brief Returns the matrix dimension.
+     */
+    size_t size() const { return m_permutation.size(); }
+
+    /**
+     * @brief Returns true once factorize() succeeded.
+     */
+    bool isFactorized() const { return m_factorized; }
+
+    /**
+     * @brief Returns the number of stored factor entries (envelope plus diagonal).
+     */
+    size_t envelopeSize() const { return m_factor.size(); }
+
+    /**
+     * @brief Returns the fill-reducing ordering: permutation()[newIndex] is the original row.
+     */
+    const std::vector<uint32_t>& permutation() const { return m_permutation; }
+
+private:
+    std::vector<uint32_t> m_permutation;     ///< New index to original index
+    std::vector<uint32_t> m_firstColumn;     ///< First envelope column of each permuted row
+    std::vector<size_t> m_rowStart;          ///< Offset of each permuted row in m_factor
+    std::vector<int64_t> m_scatter;          ///< Factor slot of each CSR entry (-1 for the upper triangle)
+    std::vector<double> m_factor;            ///< Lower factor rows, first column to diagonal
+    bool m_factorized = false;               ///< factorize() succeeded for the current pattern
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef STARTUPLOADER_H_
+#define STARTUPLOADER_H_
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CompiledFaceRig.h"
+#include "RigTableSet.h"
+
+/**
+ * @struct StartupTableResult
+ * @brief Outcome of the load of one table file.
+ */
+struct StartupTableResult {
+    std::shared_ptr<const RigTableSet> parsed;  ///< Set holding only this table, nullptr if the file was missing or rejected
+    double seconds = 0.0;                       ///< Parse time
+};
+
+/**
+ * @struct StartupTable
+ * @brief Load of one table file.
+ */
+struct StartupTable {
+    std::string fileName;                           ///< Table file name (e.g. "deltaTransfer.json")
+    bool required = true;                           ///< The rig is not published without this table
+    std::shared_future<StartupTableResult> result;  ///< Resolves once the file was parsed or rejected
+};
+
+/**
+ * @class StartupLoader
+ * @brief Loads the static data tables in the background so the UI can show before they are parsed.
+ *
+ * start() returns immediately: every table file is parsed on a thread of its own (std::async), then one more
+ * stage merges the tables, checks them against each other and compiles the rig. Each stage is exposed as a
+ * shared future, so the UI can enable what a table unlocks as soon as it is ready and poll without blocking.
+ * A missing optional table leaves its slot empty; a missing or invalid required table resolves tables() and rig()
+ * to nullptr.
+ */
+class StartupLoader {
+public:
+    StartupLoader() = default;
+
+    /**
+     * @brief Waits for the background stages, whose results nobody may read any more.
+     */
+    ~StartupLoader();
+
+    StartupLoader(const StartupLoader&) = delete;
+    StartupLoader& operator=(const StartupLoader&) = delete;
+
+    /**
+     * @brief Starts loading the five table files of a directory.
+     * @param dataDir Directory holding the table files.
+     * @param optionalFiles Table files that may be missing (every other table is required).
+     * @return False if a load is already in progress.
+     */
+    bool start(const std::string& dataDir, const std::vector<std::string>& optionalFiles = {});
+
+    /**
+     * @brief Returns the per-table loads in RigTableSet::tableFiles() order.
+     */
+    const std::vector<StartupTable>& tables() const { return m_tables; }
+
+    /**
+     * @brief Resolves to the merged and validated tables, nullptr on failure.
+     */
+    std::shared_future<std::shared_ptr<const RigTableSet>> tableSet() const { return m_tableSet; }
+
+    /**
+     * @brief Resolves to the rig compiled from tableSet(), nullptr on failure.
+     */
+    std::shared_future<std::shared_ptr<const CompiledFaceRig>> rig() const { return m_rig; }
+
+    /**
+     * @brief Returns true once the rig stage finished (successfully or not), without blocking.
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Blocks until every stage finished.
+     */
+    void wait() const;
+
+private:
+    std::vector<StartupTable> m_tables;                                     ///< One load per table file
+    std::shared_future<std::shared_ptr<const RigTableSet>> m_tableSet;      ///< Merge and validation stage
+    std::shared_future<std::shared_ptr<const CompiledFaceRig>> m_rig;       ///< Compile stage
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SURFACEQUERY_H_
+#define SURFACEQUERY_H_
+
+#include <vector>
+#include <limits>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @struct SurfaceHit
+ * @brief Result of a closest-point query against a triangle mesh.
+ */
+struct SurfaceHit {
+    int triangle = -1;                                          ///< Index of the closest triangle (-1 when the query failed)
+    unsigned int vertexIndices[3] = {0, 0, 0};                  ///< Mesh vertex indices of that triangle
+    glm::vec3 barycentric{0.0f};                                ///< Barycentric weights of the closest point on that triangle
+    glm::vec3 point{0.0f};                                      ///< Closest point on the surface
+    float distance = std::numeric_limits<float>::max();         ///< Distance from the query point to the surface
+};
+
+/**
+ * @class SurfaceQuery
+ * @brief Uniform-grid acceleration structure for closest-point queries on a triangle mesh.
+ *
+ * Triangles are bucketed into the grid cells overlapped by their bounding boxes (stored as CSR arrays).
+ * Queries walk cell shells outwards from the query point and stop once no unvisited cell can hold a closer
+ * triangle. The structure is immutable after build(), so queries can run concurrently from several threads.
+ */
+class SurfaceQuery {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    SurfaceQuery() = default;
+
+    /**
+     * @brief Builds the grid for the given mesh.
+     * @param vertices Mesh vertex positions.
+     * @param triangles Flat triangle index list (three indices per triangle).
+     * @return True if the mesh contained at least one valid triangle.
+     */
+    bool build(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& triangles);
+
+    /**
+     * @brief Finds the closest point on the mesh surface.
+     * @param point Query position.
+     * @return Closest triangle, barycentric weights, surface point and distance.
+     */
+    SurfaceHit closestPoint(const glm::vec3& point) const;
+
+    /**
+     * @brief Returns true if build() has not produced any triangles.
+     */
+    bool empty() const { return m_triangleCount == 0; }
+
+    /**
+     * @brief Computes the closest point on triangle (a, b, c) to p.
+     * @param p Query position.
+     * @param a First triangle corner.
+     * @param b Second triangle corner.
+     * @param c Third triangle corner.
+     * @param barycentric Output barycentric weights of the closest point.
+     * @return Closest point on the triangle.
+     */
+    static glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b,
+                                            const glm::vec3& c, glm::vec3& barycentric);
+
+private:
+    int cellCoordinate(float value, int axis) const;
+
+    std::vector<glm::vec3> m_vertices;                      ///< Copy of the mesh vertices
+    std::vector<unsigned int> m_triangles;                  ///< Copy of the mesh triangle indices
+    size_t m_triangleCount = 0;                             ///< Number of triangles in the mesh
+
+    glm::vec3 m_origin{0.0f};                               ///< Minimum corner of the grid
+    float m_cellSize = 1.0f;                                ///< Edge length of a grid cell
+    int m_dims[3] = {1, 1, 1};                              ///< Number of cells per axis
+    std::vector<unsigned int> m_cellStart;                  ///< CSR offsets into m_cellTriangles per cell
+    std::vector<unsigned int> m_cellTriangles;              ///< Triangle indices bucketed per cell
+};
+
+#endif
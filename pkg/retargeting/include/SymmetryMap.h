@@ -0,0 +1,140 @@
+#ifndef SYMMETRYMAP_H_
+#define SYMMETRYMAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+#include "MemoryFootprint.h"
+
+/**
+ * @struct SymmetryMapHeader
+ * @brief Fixed size header of a symmetry map cache file.
+ */
+struct SymmetryMapHeader {
+    char magic[4];              ///< "PMXS"
+    uint32_t version;           ///< File format version
+    uint32_t vertexCount;       ///< Vertices of the mesh the map was built on
+    uint32_t axis;              ///< Mirror axis (0 = x, 1 = y, 2 = z)
+    float planeOffset;          ///< Coordinate of the mirror plane on the axis
+    float tolerance;            ///< Matching distance used by build()
+    uint64_t meshHash;          ///< Hash of the mesh positions, to detect a changed template
+};
+
+/**
+ * @class SymmetryMap
+ * @brief Pairs every vertex of a symmetric template with its mirror across a coordinate plane.
+ *
+ * Built once with a spatial search: vertices are bucketed in a uniform grid (sorted by cell, CSR style) and every
+ * reflected position looks for the closest vertex in the 27 surrounding cells. Only mutual matches are kept, so
+ * mirror(mirror(v)) == v for every paired vertex; vertices on the plane are their own mirror and vertices without a
+ * match within the tolerance are left unpaired. The map is cached in a small binary file keyed by a hash of the
+ * mesh positions.
+ */
+class SymmetryMap {
+public:
+    /**
+     * @brief Builds the map of a mesh.
+     * @param vertices Mesh positions.
+     * @param tolerance Matching distance, as a fraction of the bounding box diagonal.
+     * @param axis Mirror axis (0 = x, 1 = y, 2 = z); the plane goes through the middle of the bounding box.
+     * @param workerCount Threads used for the queries (0 uses all hardware threads).
+     * @return False if the mesh is empty or the axis is invalid.
+     */
+    bool build(const std::vector<glm::vec3>& vertices, float tolerance = 1e-3f, int axis = 0, unsigned int workerCount = 0);
+
+    /**
+     * @brief Loads the map from a cache file, or builds it and writes the cache if the file is missing or stale.
+     * @param vertices Mesh positions; the cache is only used if it was built on the same positions and settings.
+     * @param cachePath Cache file path.
+     * @return False if the map could not be built.
+     */
+    bool loadOrBuild(const std::vector<glm::vec3>& vertices, const std::string& cachePath, float tolerance = 1e-3f, int axis = 0);
+
+    /**
+     * @brief Sets the map from a stored mirror table (e.g. the one embedded in deltaTransfer.json).
+     * @param mirror Mirror vertex per vertex, -1 for unpaired vertices.
+     * @param axis Mirror axis.
+     * @return False if an entry is out of range or a pair is not mutual; the map is then empty.
+     */
+    bool assign(std::vector<int32_t> mirror, int axis = 0);
+
+    /**
+     * @brief Writes the map to a binary cache file.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Reads a cache file.
+     * @return False if the file is missing or invalid.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Returns the mirror of a vertex, or -1 if it is unpaired or out of range.
+     */
+    int32_t mirror(uint32_t vertex) const { return vertex < m_mirror.size() ? m_mirror[vertex] : -1; }
+
+    /**
+     * @brief Reflects a displacement across the mirror plane.
+     */
+    glm::vec3 reflect(glm::vec3 delta) const
+    {
+        delta[m_axis] = -delta[m_axis];
+        return delta;
+    }
+
+    /**
+     * @brief Returns the mirror vertex of every vertex (-1 for unpaired).
+     */
+    const std::vector<int32_t>& mirrorTable() const { return m_mirror; }
+
+    /**
+     * @brief Returns the number of vertices of the mesh.
+     */
+    size_t vertexCount() const { return m_mirror.size(); }
+
+    /**
+     * @brief Returns the number of vertices that have a mirror (including those on the plane).
+     */
+    size_t pairedCount() const { return m_pairedCount; }
+
+    /**
+     * @brief Returns the mirror axis.
+     */
+    int axis() const { return m_axis; }
+
+    /**
+     * @brief Returns the hash of the positions the map was built on (0 for an assigned table).
+     */
+    uint64_t meshHash() const { return m_meshHash; }
+
+    /**
+     * @brief Returns true once the map holds a mirror table.
+     */
+    bool isValid() const { return !m_mirror.empty(); }
+
+    /**
+     * @brief Hashes mesh positions and build settings (FNV-1a), the key of a cache file.
+     */
+    static uint64_t hashMesh(const std::vector<glm::vec3>& vertices, float tolerance, int axis);
+
+    /**
+     * @brief Returns the heap bytes of the mirror table.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    void clear();
+
+    std::vector<int32_t> m_mirror;      ///< Mirror vertex per vertex
+    size_t m_pairedCount = 0;           ///< Vertices with a mirror
+    int m_axis = 0;                     ///< Mirror axis
+    float m_planeOffset = 0.0f;         ///< Plane coordinate on the axis
+    float m_tolerance = 0.0f;           ///< Matching distance fraction used by build()
+    uint64_t m_meshHash = 0;            ///< Hash of the source positions
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef THRESHOLDCALIBRATOR_H_
+#define THRESHOLDCALIBRATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+
+#include "CompiledFaceRig.h"
+#include "QuantileSketch.h"
+#include "Side.h"
+
+/**
+ * @struct AUThreshold
+ * @brief Calibrated activation range of one AU/side pair.
+ */
+struct AUThreshold {
+    int auId;                   ///< Action Unit identifier
+    Side side;                  ///< Side of the face
+    float minThreshold;         ///< Distance delta where the AU starts to activate
+    float maxThreshold;         ///< Distance delta of full activation
+    uint64_t sampleCount;       ///< Number of frames the range was derived from
+};
+
+/**
+ * @class ThresholdCalibrator
+ * @brief Derives per-AU activation thresholds from the landmark distance statistics of clips.
+ *
+ * Every frame contributes, for each AU slot of the rig that has landmark pairs, the change of the mean pair
+ * distance from the neutral frame. The values go into one QuantileSketch per slot, so the calibrator runs in
+ * constant memory over any number of frames, and calibrators fed by parallel shards merge into one.
+ * The thresholds are two quantiles of each distribution (by default the 75th percentile as the start of the
+ * activation and the 98th as full intensity).
+ */
+class ThresholdCalibrator {
+public:
+    static constexpr uint64_t kMinSamples = 100;   ///< Samples a slot needs before its quantiles mean anything
+
+    /**
+     * @brief Creates an empty calibrator.
+     * @param rig Compiled rig providing the AU slots and their landmark pairs.
+     * @param relativeAccuracy Relative accuracy of the quantile sketches.
+     */
+    explicit ThresholdCalibrator(std::shared_ptr<const CompiledFaceRig> rig, double relativeAccuracy = 0.01);
+
+    /**
+     * @brief Adds one frame.
+     * @param neutralLandmarks The 51 landmarks of the neutral frame.
+     * @param currentLandmarks The 51 landmarks of the frame.
+     * @return False if the landmark sets are too small for the rig's pairs.
+     */
+    bool addFrame(const std::vector<glm::vec3>& neutralLandmarks, const std::vector<glm::vec3>& currentLandmarks);
+
+    /**
+     * @brief Adds a precomputed distance delta to one slot.
+     */
+    void addSample(size_t slot, float distanceDelta);
+
+    /**
+     * @brief Adds the statistics of another calibrator built on the same rig.
+     * @return False if the rigs or sketch parameters differ.
+     */
+    bool merge(const ThresholdCalibrator& other);
+
+    /**
+     * @brief Computes the thresholds of every slot that received enough samples.
+     *
+     * With a handful of samples both quantiles fall on the same rank and the range collapses, so slots below
+     * minSamples are left out and keep the default thresholds of the plugin.
+     * @param lowQuantile Quantile used as the activation start.
+     * @param highQuantile Quantile used as full activation.
+     * @param minSamples Samples a slot needs to be calibrated (at least 1).
+     */
+    std::vector<AUThreshold> computeThresholds(float lowQuantile = 0.75f, float highQuantile = 0.98f,
+                                               uint64_t minSamples = kMinSamples) const;
+
+    /**
+     * @brief Calibrates a set of clips in parallel, one calibrator per shard merged by parallelReduce().
+     *
+     * In ReductionMode::deterministic the shards have a fixed size and merge in a fixed order, so the thresholds do
+     * not depend on the worker count.
+     * @param rig Compiled rig.
+     * @param neutralLandmarks The 51 landmarks of the neutral frame.
+     * @param frames The 51 landmarks of every frame of every clip.
+     * @param workerCount Number of worker threads (0 uses all hardware threads).
+     */
+    static ThresholdCalibrator calibrateFrames(std::shared_ptr<const CompiledFaceRig> rig,
+                                               const std::vector<glm::vec3>& neutralLandmarks,
+                                               const std::vector<std::vector<glm::vec3>>& frames,
+                                               unsigned int workerCount = 0);
+
+    /**
+     * @brief Mean distance of the landmark pairs of a slot.
+     * @return The mean distance, or a negative value if the slot has no pairs or an index is out of range.
+     */
+    static float slotDistance(const CompiledFaceRig& rig, size_t slot, const std::vector<glm::vec3>& landmarks);
+
+    /**
+     * @brief Writes thresholds as a calibration JSON file.
+     * @return True if the file was written.
+     */
+    static bool saveCalibration(const char* path, const std::vector<AUThreshold>& thresholds);
+
+    /**
+     * @brief Reads a calibration JSON file.
+     * @return True if the file was read.
+     */
+    static bool loadCalibration(const char* path, std::vector<AUThreshold>& thresholds);
+
+    /**
+     * @brief Returns the sketch of a slot.
+     */
+    const QuantileSketch& sketch(size_t slot) const { return m_sketches[slot]; }
+
+private:
+    std::shared_ptr<const CompiledFaceRig> m_rig;   ///< Rig the slots refer to
+    std::vector<QuantileSketch> m_sketches;         ///< One distance delta sketch per slot
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef TOPOLOGYCORRESPONDENCE_H_
+#define TOPOLOGYCORRESPONDENCE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/vec3.hpp>
+#include "MemoryFootprint.h"
+
+/**
+ * @struct TopologyCorrespondenceHeader
+ * @brief Fixed size header of a correspondence sidecar file.
+ */
+struct TopologyCorrespondenceHeader {
+    char magic[4];                  ///< "PMXT"
+    uint32_t version;               ///< File format version
+    uint32_t meshVertexCount;       ///< Vertices of the user mesh
+    uint32_t templateVertexCount;   ///< Vertices of the template mesh
+    uint64_t meshHash;              ///< hashVertices() of the user mesh
+    uint64_t templateHash;          ///< hashMesh() of the template mesh
+    float scale;                    ///< Template units per user mesh unit
+    uint32_t reserved;              ///< Padding, always zero
+};
+
+/**
+ * @class TopologyCorrespondence
+ * @brief Maps an arbitrary user mesh onto the template mesh (TargetTemplate.obj).
+ *
+ * The user mesh is aligned to the template by bounding box, then every user vertex is attached to the closest
+ * point on the template surface (triangle vertices plus barycentric weights). Per-vertex template data such as the
+ * AU deltas can then be resampled onto the user mesh once, and template vertex ids (muscle patches, landmarks) are
+ * remapped to the closest user vertex. The map is persisted as a binary sidecar named after the user mesh hash.
+ */
+class TopologyCorrespondence {
+public:
+    /**
+     * @brief Default constructor.
+     */
+    TopologyCorrespondence() = default;
+
+    /**
+     * @brief Computes the correspondence in parallel.
+     * @param meshVertices User mesh vertex positions.
+     * @param templateVertices Template mesh vertex positions.
+     * @param templateTriangles Flat triangle index list of the template mesh.
+     * @param workerCount Number of worker threads (0 uses all hardware threads).
+     * @return True if every user vertex was mapped.
+     */
+    bool build(const std::vector<glm::vec3>& meshVertices,
+               const std::vector<glm::vec3>& templateVertices,
+               const std::vector<unsigned int>& templateTriangles,
+               unsigned int workerCount = 0);
+
+    /**
+     * @brief Loads the sidecar of the user mesh from cacheDir, or builds the map and writes the sidecar.
+     * @param cacheDir Directory holding the sidecar files (created if missing).
+     * @return True if a valid correspondence is available afterwards.
+     */
+    bool loadOrBuild(const std::string& cacheDir,
+                     const std::vector<glm::vec3>& meshVertices,
+                     const std::vector<glm::vec3>& templateVertices,
+                     const std::vector<unsigned int>& templateTriangles,
+                     unsigned int workerCount = 0);
+
+    /**
+     * @brief Writes the correspondence to a binary file.
+     * @return True if the file was written.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Reads a correspondence file and checks it belongs to the given meshes.
+     * @param path Sidecar file path.
+     * @param meshHash Expected hashVertices() of the user mesh.
+     * @param templateHash Expected hashMesh() of the template mesh.
+     * @return False if the file is missing, corrupt or was built for other meshes.
+     */
+    bool load(const std::string& path, uint64_t meshHash, uint64_t templateHash);
+
+    /**
+     * @brief Interpolates per template vertex values onto the user mesh.
+     * @param templateValues One value per template vertex.
+     * @return One value per user vertex (empty if the sizes do not match).
+     */
+    std::vector<glm::vec3> resample(const std::vector<glm::vec3>& templateValues) const;
+
+    /**
+     * @brief Converts template vertex ids into user mesh vertex ids.
+     * @param templateIndices Template vertex ids, out of range ids map to -1.
+     * @return The closest user vertex of every template vertex.
+     */
+    std::vector<int> remapIndices(const std::vector<int>& templateIndices) const;
+
+    /**
+     * @brief Converts a template vertex set (e.g. a muscle patch) into a user mesh vertex set.
+     *
+     * Keeps every user vertex whose strongest template vertex is in the set, plus the closest user vertex of each
+     * template vertex, so the region has no holes on a denser mesh and is never empty on a coarser one.
+     * @return Sorted user vertex ids.
+     */
+    std::vector<int> remapRegion(const std::vector<int>& templateIndices) const;
+
+    /**
+     * @brief 64-bit FNV-1a hash of the vertex positions, used as the sidecar key.
+     */
+    static uint64_t hashVertices(const std::vector<glm::vec3>& vertices);
+
+    /**
+     * @brief 64-bit FNV-1a hash of a flat triangle index list, tells meshes with the same vertex count apart.
+     */
+    static uint64_t hashTriangles(const std::vector<unsigned int>& triangles);
+
+    /**
+     * @brief 64-bit FNV-1a hash of the vertex positions followed by the triangle indices.
+     */
+    static uint64_t hashMesh(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& triangles);
+
+    /**
+     * @brief Returns the sidecar file path of a mesh hash inside cacheDir.
+     */
+    static std::string sidecarPath(const std::string& cacheDir, uint64_t meshHash);
+
+    /**
+     * @brief Returns true once build() or load() succeeded.
+     */
+    bool isValid() const { return !m_templateToMesh.empty(); }
+
+    /**
+     * @brief Returns the number of user mesh vertices.
+     */
+    size_t meshVertexCount() const { return m_index.size() / 3; }
+
+    /**
+     * @brief Returns the number of template vertices.
+     */
+    size_t templateVertexCount() const { return m_templateToMesh.size(); }
+
+    /**
+     * @brief Returns the template vertex ids of the triangle each user vertex maps to (three per vertex).
+     */
+    const std::vector<uint32_t>& indices() const { return m_index; }
+
+    /**
+     * @brief Returns the barycentric weights matching indices().
+     */
+    const std::vector<float>& weights() const { return m_weight; }
+
+    /**
+     * @brief Returns the template units per user mesh unit used by the alignment.
+     */
+    float scale() const { return m_scale; }
+
+    /**
+     * @brief Clears the correspondence.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the heap bytes of the per-vertex triangle, weight and reverse tables.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    std::vector<uint32_t> m_index;          ///< Template triangle vertex ids, three per user vertex
+    std::vector<float> m_weight;            ///< Barycentric weights, three per user vertex
+    std::vector<uint32_t> m_templateToMesh; ///< Closest user vertex of every template vertex
+    uint64_t m_meshHash = 0;                ///< Hash of the user mesh
+    uint64_t m_templateHash = 0;            ///< Hash of the template mesh
+    float m_scale = 1.0f;                   ///< Template units per user mesh unit
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkerPool
+ * @brief Fixed set of long lived worker threads that run submitted tasks in FIFO order.
+ *
+ * Used for work that must not block the calling (UI) thread, unlike parallelFor which splits one loop and waits.
+ * The destructor finishes the queued tasks before joining the threads.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Starts the worker threads.
+     * @param threadCount Number of threads (0 uses all hardware threads).
+     */
+    explicit WorkerPool(unsigned int threadCount = 0);
+
+    /**
+     * @brief Runs the remaining tasks and joins the threads.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Queues a task; it runs on the first idle worker.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until the queue is empty and no task is running.
+     */
+    void waitIdle();
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    size_t threadCount() const { return m_threads.size(); }
+
+private:
+    void run();
+
+    std::vector<std::thread> m_threads;         ///< Worker threads
+    std::deque<std::function<void()>> m_tasks;  ///< Pending tasks
+    std::mutex m_mutex;                         ///< Guards m_tasks, m_active and m_stopping
+    std::condition_variable m_taskReady;        ///< Signalled when a task is queued or the pool stops
+    std::condition_variable m_idle;             ///< Signalled when the pool runs out of work
+    size_t m_active = 0;                        ///< Tasks currently running
+    bool m_stopping = false;                    ///< Set by the destructor
+};
+
+#endif
@@ -0,0 +1,255 @@
+#include "AUSolver.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+bool AUSolver::build(const CompiledFaceRig& rig, const AUSolverOptions& options)
+{
+    m_options = options;
+    m_slotCount = 0;
+    m_landmarkCount = rig.landmarksMeshIndex().size();
+    const size_t slotCount = rig.slotCount();
+
+    if (slotCount == 0 || m_landmarkCount == 0) {
+        std::cerr << "[AUSolver] The rig has no AU slots or no landmarks\n";
+        return false;
+    }
+
+    // basis column k = displacement of every landmark vertex when slot k is fully active
+    const size_t rows = m_landmarkCount * 3;
+    m_basis.assign(rows * slotCount, 0.0f);
+    const auto& landmarks = rig.landmarksMeshIndex();
+    const auto& deltaVertices = rig.deltaVertices();
+    const auto& deltaValues = rig.deltaValues();
+    for (size_t k = 0; k < slotCount; ++k)
+    {
+        const AUSlot& slot = rig.slots()[k];
+        auto first = deltaVertices.begin() + slot.deltaBegin;
+        auto last = deltaVertices.begin() + slot.deltaEnd;
+        for (size_t l = 0; l < m_landmarkCount; ++l)
+        {
+            if (landmarks[l] < 0) continue;
+            // deltas are sorted by vertex inside a slot
+            auto it = std::lower_bound(first, last, static_cast<uint32_t>(landmarks[l]));
+            if (it == last || *it != static_cast<uint32_t>(landmarks[l])) continue;
+            const glm::vec3& delta = deltaValues[it - deltaVertices.begin()];
+            for (int c = 0; c < 3; ++c) m_basis[(l * 3 + c) * slotCount + k] = delta[c];
+        }
+    }
+
+    m_gram.assign(slotCount * slotCount, 0.0);
+    for (size_t r = 0; r < rows; ++r)
+    {
+        const float* row = &m_basis[r * slotCount];
+        for (size_t i = 0; i < slotCount; ++i)
+        {
+            if (row[i] == 0.0f) continue;
+            for (size_t j = 0; j <= i; ++j) m_gram[i * slotCount + j] += static_cast<double>(row[i]) * row[j];
+        }
+    }
+
+    double meanDiagonal = 0.0;
+    for (size_t i = 0; i < slotCount; ++i) meanDiagonal += m_gram[i * slotCount + i];
+    meanDiagonal /= static_cast<double>(slotCount);
+    if (meanDiagonal <= 0.0) {
+        std::cerr << "[AUSolver] No AU moves any landmark vertex\n";
+        return false;
+    }
+
+    // the ridge term keeps AUs that do not move any landmark (and collinear AUs) solvable
+    const double ridge = std::max(static_cast<double>(options.regularization), 1e-9) * meanDiagonal;
+    for (size_t i = 0; i < slotCount; ++i)
+    {
+        m_gram[i * slotCount + i] += ridge;
+        for (size_t j = 0; j < i; ++j) m_gram[j * slotCount + i] = m_gram[i * slotCount + j];
+    }
+
+    m_cholesky.assign(slotCount * slotCount, 0.0);
+    for (size_t i = 0; i < slotCount; ++i)
+    {
+        for (size_t j = 0; j <= i; ++j)
+        {
+            double sum = m_gram[i * slotCount + j];
+            for (size_t k = 0; k < j; ++k) sum -= m_cholesky[i * slotCount + k] * m_cholesky[j * slotCount + k];
+            if (i == j) {
+                if (sum <= 0.0) {
+                    std::cerr << "[AUSolver] Gram matrix is not positive definite\n";
+                    return false;
+                }
+                m_cholesky[i * slotCount + i] = std::sqrt(sum);
+            } else {
+                m_cholesky[i * slotCount + j] = sum / m_cholesky[j * slotCount + j];
+            }
+        }
+    }
+
+    m_slotCount = slotCount;
+    std::cout << "[AUSolver] Built a " << rows << " x " << slotCount << " landmark basis\n";
+    return true;
+}
+
+void AUSolver::project(const glm::vec3* displacement, double* rhs) const
+{
+    std::fill(rhs, rhs + m_slotCount, 0.0);
+    for (size_t l = 0; l < m_landmarkCount; ++l)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            const double d = displacement[l][c];
+            if (d == 0.0) continue;
+            const float* row = &m_basis[(l * 3 + c) * m_slotCount];
+            for (size_t k = 0; k < m_slotCount; ++k) rhs[k] += row[k] * d;
+        }
+    }
+}
+
+void AUSolver::solveNormal(const double* rhs, float* weights, double* scratch) const
+{
+    const size_t n = m_slotCount;
+    const double lower = m_options.lowerBound;
+    const double upper = m_options.upperBound;
+
+    // unconstrained solution through the prefactored Gram matrix: L y = rhs, L^T x = y
+    double* x = scratch;
+    std::copy(rhs, rhs + n, x);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 0; k < i; ++k) x[i] -= m_cholesky[i * n + k] * x[k];
+        x[i] /= m_cholesky[i * n + i];
+    }
+    for (size_t i = n; i-- > 0;) {
+        for (size_t k = i + 1; k < n; ++k) x[i] -= m_cholesky[k * n + i] * x[k];
+        x[i] /= m_cholesky[i * n + i];
+    }
+
+    bool feasible = true;
+    for (size_t i = 0; i < n && feasible; ++i) feasible = x[i] >= lower && x[i] <= upper;
+    if (feasible) {
+        for (size_t i = 0; i < n; ++i) weights[i] = static_cast<float>(x[i]);
+        return;
+    }
+
+    // a bound is active: projected Gauss-Seidel on the Gram matrix, warm-started from the previous frame
+    double* w = scratch;
+    for (size_t i = 0; i < n; ++i) w[i] = std::clamp(static_cast<double>(weights[i]), lower, upper);
+    for (int iteration = 0; iteration < m_options.maxIterations; ++iteration)
+    {
+        double maxChange = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double* row = &m_gram[i * n];
+            double residual = rhs[i];
+            for (size_t j = 0; j < n; ++j) residual -= row[j] * w[j];
+            double updated = std::clamp(w[i] + residual / row[i], lower, upper);
+            maxChange = std::max(maxChange, std::abs(updated - w[i]));
+            w[i] = updated;
+        }
+        if (maxChange < m_options.tolerance) break;
+    }
+    for (size_t i = 0; i < n; ++i) weights[i] = static_cast<float>(w[i]);
+}
+
+bool AUSolver::solve(const std::vector<glm::vec3>& displacement, std::vector<float>& weights) const
+{
+    if (!isBuilt()) {
+        std::cerr << "[AUSolver] solve called before build\n";
+        return false;
+    }
+    if (displacement.size() != m_landmarkCount) {
+        std::cerr << "[AUSolver] Expected " << m_landmarkCount << " landmark displacements, got " << displacement.size() << "\n";
+        return false;
+    }
+    if (weights.size() != m_slotCount) weights.assign(m_slotCount, 0.0f);
+
+    // right-hand side and solve scratch, reused by every frame solved on this thread
+    static thread_local std::vector<double> scratch;
+    if (scratch.size() < 2 * m_slotCount) scratch.resize(2 * m_slotCount);
+    project(displacement.data(), scratch.data());
+    solveNormal(scratch.data(), weights.data(), scratch.data() + m_slotCount);
+    return true;
+}
+
+bool AUSolver::solveClip(const std::vector<std::vector<glm::vec3>>& displacements,
+                         std::vector<std::vector<float>>& weights,
+                         unsigned int workerCount) const
+{
+    if (!isBuilt()) {
+        std::cerr << "[AUSolver] solveClip called before build\n";
+        return false;
+    }
+    for (size_t f = 0; f < displacements.size(); ++f) {
+        if (displacements[f].size() != m_landmarkCount) {
+            std::cerr << "[AUSolver] Frame " << f << " has " << displacements[f].size() << " landmarks, expected " << m_landmarkCount << "\n";
+            return false;
+        }
+    }
+
+    const size_t frameCount = displacements.size();
+    weights.assign(frameCount, std::vector<float>(m_slotCount, 0.0f));
+
+    // each run of frames warm-starts from the frame before it, runs are solved in parallel
+    // scratch holds the right-hand side and the solve scratch of one frame
+    auto solveRun = [&](size_t begin, size_t end, std::vector<double>& scratch) {
+        for (size_t f = begin; f < end; ++f)
+        {
+            if (f > begin) weights[f] = weights[f - 1];
+            project(displacements[f].data(), scratch.data());
+            solveNormal(scratch.data(), weights[f].data(), scratch.data() + m_slotCount);
+        }
+    };
+    const size_t runLength = 64;
+    if (reductionMode() == ReductionMode::deterministic) {
+        // the warm start decides where Gauss-Seidel stops: runs of fixed length give the same weights for any worker count
+        const size_t runCount = (frameCount + runLength - 1) / runLength;
+        parallelFor(0, runCount, [&](size_t begin, size_t end) {
+            std::vector<double> scratch(2 * m_slotCount);
+            for (size_t r = begin; r < end; ++r) solveRun(r * runLength, std::min(frameCount, (r + 1) * runLength), scratch);
+        }, workerCount, 1);
+        return true;
+    }
+    parallelFor(0, frameCount, [&](size_t begin, size_t end) {
+        std::vector<double> scratch(2 * m_slotCount);
+        solveRun(begin, end, scratch);
+    }, workerCount, runLength);
+    return true;
+}
+
+static float landmarkDiagonal(const std::vector<glm::vec3>& points)
+{
+    glm::vec3 minCorner(std::numeric_limits<float>::max());
+    glm::vec3 maxCorner(std::numeric_limits<float>::lowest());
+    for (const auto& p : points) {
+        minCorner = glm::min(minCorner, p);
+        maxCorner = glm::max(maxCorner, p);
+    }
+    return points.empty() ? 0.0f : glm::length(maxCorner - minCorner);
+}
+
+std::vector<glm::vec3> AUSolver::imageToMeshDisplacement(const std::vector<glm::vec3>& neutralLandmarks,
+                                                         const std::vector<glm::vec3>& currentLandmarks,
+                                                         const std::vector<glm::vec3>& meshLandmarks)
+{
+    if (neutralLandmarks.size() != currentLandmarks.size()) return {};
+
+    // the diagonal does not depend on the axis flips, so the scale can be taken in image space
+    float imageDiagonal = landmarkDiagonal(neutralLandmarks);
+    float meshDiagonal = landmarkDiagonal(meshLandmarks);
+    float scale = (imageDiagonal > 0.0f && meshDiagonal > 0.0f) ? meshDiagonal / imageDiagonal : 1.0f;
+
+    // image y points down and z away from the camera, the rig is y up and faces +z
+    const glm::vec3 imageToMesh(scale, -scale, -scale);
+    std::vector<glm::vec3> displacement(currentLandmarks.size());
+    for (size_t i = 0; i < displacement.size(); ++i)
+        displacement[i] = (currentLandmarks[i] - neutralLandmarks[i]) * imageToMesh;
+    return displacement;
+}
+
+MemoryFootprint AUSolver::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("basis", heapBytes(m_basis));
+    footprint.add("gram", heapBytes(m_gram));
+    footprint.add("cholesky", heapBytes(m_cholesky));
+    return footprint;
+}
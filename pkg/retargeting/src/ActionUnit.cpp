@@ -1,4 +1,6 @@
 #include "ActionUnit.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
 #include <iostream>
 #include <bits/stdc++.h> 
 #include <nlohmann/json.hpp>
@@ -8,6 +10,10 @@
 
 bool ActionUnit::loadMuscleIndexMapFromJSON(const char* musclesJson)
 {
+    MemoryScope memory(MemorySubsystem::actionUnit);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(musclesJson));
+
     std::string filePathStr = std::string(musclesJson);
     std::ifstream file(filePathStr);
     if (!file.is_open()) {
@@ -123,6 +129,7 @@ std::vector<MuscleDelta> ActionUnit::getMusclesVertices(const std::vector<glm::v
 
 bool ActionUnit::loadModelPathsFromJSON(const char* pathsJson, const char* basePath)
 {
+    MemoryScope memory(MemorySubsystem::actionUnit);
     std::cout << "[Loader][ACTIONUNIT]: loading the file modelsPath.json to create deltatransfer.json (pre-processing)" << "\n";
     // reading the json file
     nlohmann::json root; 
@@ -134,7 +141,24 @@ bool ActionUnit::loadModelPathsFromJSON(const char* pathsJson, const char* baseP
         (std::string(basePath) + "/" + root["NEUTRALFACE"]["path"].get<std::string>())
             .c_str());
 
+    // with a symmetry map only one blendshape of each left/right pair is loaded, the other side is mirrored
+    std::set<std::pair<int, int>> present;
+    if (!m_symmetryCachePath.empty())
+    {
+        auto symmetry = std::make_shared<SymmetryMap>();
+        if (symmetry->loadOrBuild(m_neutralFaceVertices, m_symmetryCachePath)) {
+            m_symmetryMap = std::move(symmetry);
+            for (auto& [key, node] : root.items())
+                if (key != "NEUTRALFACE" && key != "SKULL")
+                    present.insert({parseAUId(key), static_cast<int>(sideFromString(node.at("side").get<std::string>()))});
+        }
+    }
+    auto hasMirror = [&present](int auId, Side side) {
+        return mirrorSide(side) != side && present.count({auId, static_cast<int>(mirrorSide(side))}) > 0;
+    };
+
     // parsing the json file
+    size_t mirroredCount = 0;
     for (auto& [key, node] : root.items())
     {
         if (key == "NEUTRALFACE" || key == "SKULL") 
@@ -142,6 +166,10 @@ bool ActionUnit::loadModelPathsFromJSON(const char* pathsJson, const char* baseP
 
         int auId = parseAUId(key);  // extract the AU value 
         std::string sideStr = node.at("side").get<std::string>();
+        if (isRightSide(sideFromString(sideStr)) && hasMirror(auId, sideFromString(sideStr))) {
+            ++mirroredCount;
+            continue;
+        }
 
         // Uploading the blendshapes
         std::string blendPath = basePath + std::string("/") + node["path"].get<std::string>();
@@ -167,8 +195,11 @@ bool ActionUnit::loadModelPathsFromJSON(const char* pathsJson, const char* baseP
         auDelta.side           = side;
         auDelta.activeMuscles  = std::move(active);
         auDelta.passiveMuscles = std::move(passive);
+        auDelta.mirrored       = hasMirror(auId, side);
         m_auDeltaTable[auId].push_back(auDelta); 
     }
+    if (mirroredCount > 0)
+        std::cout << "[Loader][ACTIONUNIT]: " << mirroredCount << " blendshapes are synthesized from their mirror side" << "\n";
     return true;
 }
 
@@ -183,10 +214,11 @@ bool ActionUnit::saveDeltaTransfersToJSON(const char* outJsonPath)
         {
             nlohmann::ordered_json auJ = {
                 {"auId", auId},
-                {"side", auDelta.side},
+                {"side", sideToString(auDelta.side)},
                 {"activeMuscles", nlohmann::ordered_json::array()},
                 {"passiveMuscles", nlohmann::ordered_json::array()}
             };
+            if (auDelta.mirrored) auJ["mirrored"] = true;
 
             auto serialize = [&](nlohmann::ordered_json& targetArray,
                                 const std::vector<MuscleDelta>& muscles)
@@ -219,6 +251,10 @@ bool ActionUnit::saveDeltaTransfersToJSON(const char* outJsonPath)
         }
     }
 
+    // mirrored entries need the template's mirror table to be synthesized at load time
+    if (m_symmetryMap && m_symmetryMap->isValid())
+        root["symmetry"] = {{"axis", m_symmetryMap->axis()}, {"mirror", m_symmetryMap->mirrorTable()}};
+
     std::ofstream ofs(outJsonPath);
     if (!ofs.is_open()) return false;
     ofs << std::setw(2) << root << std::endl;
@@ -244,6 +280,10 @@ int ActionUnit::parseAUId(const std::string& auKey)
 
 void ActionUnit::loadDeltaTransfersFromJSON(const char* deltaJson)
 {
+    MemoryScope memory(MemorySubsystem::actionUnit);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(deltaJson));
+
      // reading the json file
     nlohmann::json root; 
     std::ifstream ifs(deltaJson);
@@ -297,8 +337,16 @@ void ActionUnit::loadDeltaTransfersFromJSON(const char* deltaJson)
 
         parseMuscles(auJ["activeMuscles"], auDelta.activeMuscles);
         parseMuscles(auJ["passiveMuscles"], auDelta.passiveMuscles);
+        auDelta.mirrored = auJ.value("mirrored", false);
         m_auDeltaTable[auId].push_back(std::move(auDelta)); 
     }
+
+    if (root.contains("symmetry"))
+    {
+        auto symmetry = std::make_shared<SymmetryMap>();
+        if (symmetry->assign(root["symmetry"]["mirror"].get<std::vector<int32_t>>(), root["symmetry"].value("axis", 0)))
+            m_symmetryMap = std::move(symmetry);
+    }
 }
 
 void ActionUnit::printauDeltaTable()
@@ -349,3 +397,34 @@ std::unordered_map<int, std::vector<int>> ActionUnit::getMuscleIndexMap()
     }
     return m_muscleIndexMap;
 }
+
+MemoryFootprint ActionUnit::memoryFootprint() const
+{
+    MemoryFootprint footprint = auDeltaTableFootprint(m_auDeltaTable);
+    footprint.add("muscleIndexMap", heapBytesOfVectorMap(m_muscleIndexMap));
+    footprint.add("neutralFaceVertices", heapBytes(m_neutralFaceVertices));
+    footprint.add("helpers", (m_facialMesh ? sizeof(FacialMesh) : 0) + (m_mathUtils ? sizeof(MathUtils) : 0) + heapBytes(m_symmetryCachePath));
+    if (m_symmetryMap) footprint.add("symmetryMap", m_symmetryMap->memoryFootprint());
+    return footprint;
+}
+
+MemoryFootprint auDeltaTableFootprint(const std::unordered_map<int, std::vector<ActionUnitDelta>>& table)
+{
+    size_t deltaTable = heapBytes(table);
+    size_t deltaEntries = 0;
+    for (const auto& entry : table)
+    {
+        deltaTable += heapBytes(entry.second);
+        for (const ActionUnitDelta& auDelta : entry.second)
+        {
+            deltaTable += heapBytes(auDelta.activeMuscles) + heapBytes(auDelta.passiveMuscles);
+            for (const MuscleDelta& muscle : auDelta.activeMuscles) deltaEntries += heapBytes(muscle.deltas);
+            for (const MuscleDelta& muscle : auDelta.passiveMuscles) deltaEntries += heapBytes(muscle.deltas);
+        }
+    }
+
+    MemoryFootprint footprint;
+    footprint.add("auDeltaTable", deltaTable);
+    footprint.add("auDeltaEntries", deltaEntries);
+    return footprint;
+}
@@ -0,0 +1,7 @@
+#include "AppliedOffsets.h"
+
+void AppliedOffsets::toRest(std::vector<glm::vec3>& points) const
+{
+    if (!tracks(points.size())) return;
+    for (size_t i = 0; i < points.size(); ++i) points[i] -= m_offsets[i];
+}
@@ -0,0 +1,111 @@
+#include "BackgroundJob.h"
+#include <algorithm>
+#include <iostream>
+
+void JobContext::setStepProgress(float fraction)
+{
+    const float clamped = std::clamp(fraction, 0.0f, 1.0f);
+    m_progress.store(m_stepBegin + m_stepWeight * clamped, std::memory_order_relaxed);
+}
+
+std::shared_ptr<BackgroundJob> BackgroundJob::create(std::string name)
+{
+    return std::shared_ptr<BackgroundJob>(new BackgroundJob(std::move(name)));
+}
+
+void BackgroundJob::addStep(std::string name, float weight, Step step)
+{
+    if (m_state.load() != JobState::Pending) {
+        std::cerr << "[BackgroundJob] " << m_name << ": cannot add a step to a started job\n";
+        return;
+    }
+    m_steps.push_back(NamedStep{std::move(name), std::max(weight, 0.0f), std::move(step)});
+}
+
+void BackgroundJob::setCompletionCallback(CompletionCallback callback)
+{
+    m_onComplete = std::move(callback);
+}
+
+bool BackgroundJob::start(WorkerPool& pool)
+{
+    JobState expected = JobState::Pending;
+    if (!m_state.compare_exchange_strong(expected, JobState::Running)) {
+        std::cerr << "[BackgroundJob] " << m_name << ": already started\n";
+        return false;
+    }
+    auto self = shared_from_this();
+    pool.submit([self] { self->run(); });
+    return true;
+}
+
+void BackgroundJob::run()
+{
+    float totalWeight = 0.0f;
+    for (const auto& step : m_steps) totalWeight += step.weight;
+
+    JobContext context(m_cancelled, m_progress);
+    float done = 0.0f;
+    for (const auto& step : m_steps)
+    {
+        if (m_cancelled.load(std::memory_order_relaxed)) {
+            finish(JobState::Cancelled);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_currentStep = step.name;
+        }
+
+        context.m_stepBegin = totalWeight > 0.0f ? done / totalWeight : 0.0f;
+        context.m_stepWeight = totalWeight > 0.0f ? step.weight / totalWeight : 0.0f;
+        context.setStepProgress(0.0f);
+
+        bool ok = false;
+        try {
+            ok = step.run(context);
+        } catch (const std::exception& e) {
+            std::cerr << "[BackgroundJob] " << m_name << ": step '" << step.name << "' threw: " << e.what() << "\n";
+        }
+        if (!ok) {
+            // a step that bailed out because of cancel is not a failure
+            finish(m_cancelled.load(std::memory_order_relaxed) ? JobState::Cancelled : JobState::Failed);
+            return;
+        }
+
+        done += step.weight;
+        context.setStepProgress(1.0f);
+    }
+    finish(m_cancelled.load(std::memory_order_relaxed) ? JobState::Cancelled : JobState::Finished);
+}
+
+void BackgroundJob::finish(JobState state)
+{
+    if (state == JobState::Failed)
+        std::cerr << "[BackgroundJob] " << m_name << ": failed during '" << currentStep() << "'\n";
+
+    // the callback runs before waiters are released, so wait() implies the callback has returned
+    if (m_onComplete) m_onComplete(state);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_state.store(state);
+    }
+    m_done.notify_all();
+}
+
+JobState BackgroundJob::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] {
+        JobState s = m_state.load();
+        return s != JobState::Pending && s != JobState::Running;
+    });
+    return m_state.load();
+}
+
+std::string BackgroundJob::currentStep() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_currentStep;
+}
@@ -0,0 +1,309 @@
+#include "CompiledFaceRig.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+
+std::shared_ptr<const CompiledFaceRig> CompiledFaceRig::compile(ActionUnit& actionUnit, FacialLandmark& facialLandmark)
+{
+    return compile(RigTableSet::fromObjects(actionUnit, facialLandmark));
+}
+
+std::shared_ptr<const CompiledFaceRig> CompiledFaceRig::compile(const RigTableSet& tables)
+{
+    MemoryScope memory(MemorySubsystem::rig);
+    // the constructor is private, so the rig is built in place and only published as const
+    std::shared_ptr<CompiledFaceRig> rig(new CompiledFaceRig());
+
+    struct SlotSource {
+        std::vector<std::pair<uint32_t, glm::vec3>> deltas;
+        std::vector<uint32_t> pairs;
+    };
+    std::map<std::pair<int, int>, SlotSource> sources; // ordered by (auId, side)
+
+    static const std::unordered_map<int, std::vector<ActionUnitDelta>> noDeltas;
+    const auto& auDeltaTable = tables.auDeltaTable ? *tables.auDeltaTable : noDeltas;
+    std::vector<std::pair<int, const ActionUnitDelta*>> mirrored;
+    for (const auto& [auId, deltaList] : auDeltaTable)
+    {
+        for (const auto& auDelta : deltaList)
+        {
+            SlotSource& source = sources[{auId, static_cast<int>(auDelta.side)}];
+            for (const auto* muscles : {&auDelta.activeMuscles, &auDelta.passiveMuscles})
+                for (const auto& md : *muscles)
+                    for (const auto& vd : md.deltas)
+                        if (vd.vertexIndex >= 0)
+                            source.deltas.emplace_back(static_cast<uint32_t>(vd.vertexIndex), vd.delta);
+            if (auDelta.mirrored) mirrored.emplace_back(auId, &auDelta);
+        }
+    }
+
+    // the other side of a mirrored AU is only stored once: reflect its deltas onto the mirror vertices
+    size_t unpaired = 0;
+    for (const auto& [auId, auDelta] : mirrored)
+    {
+        const std::pair<int, int> key{auId, static_cast<int>(mirrorSide(auDelta->side))};
+        if (sources.count(key)) continue; // stored explicitly
+        if (!tables.symmetry) {
+            std::cerr << "[CompiledFaceRig] AU " << auId << ", side: " << sideToString(auDelta->side)
+                      << " is mirrored but the rig has no symmetry map\n";
+            continue;
+        }
+        SlotSource& source = sources[key];
+        for (const auto* muscles : {&auDelta->activeMuscles, &auDelta->passiveMuscles})
+            for (const auto& md : *muscles)
+                for (const auto& vd : md.deltas)
+                {
+                    const int32_t vertex = vd.vertexIndex >= 0 ? tables.symmetry->mirror(static_cast<uint32_t>(vd.vertexIndex)) : -1;
+                    if (vertex < 0) {
+                        ++unpaired;
+                        continue;
+                    }
+                    source.deltas.emplace_back(static_cast<uint32_t>(vertex), tables.symmetry->reflect(vd.delta));
+                }
+    }
+    if (unpaired > 0)
+        std::cout << "[CompiledFaceRig] " << unpaired << " mirrored deltas fall on vertices without a mirror and were dropped\n";
+
+    if (tables.landmarksAUMap) rig->m_landmarksAUMap = *tables.landmarksAUMap;
+    const auto& landmarksAUMap = rig->m_landmarksAUMap;
+    for (const auto& [auId, landmarkUnits] : landmarksAUMap)
+    {
+        for (const auto& unit : landmarkUnits)
+        {
+            SlotSource& source = sources[{auId, static_cast<int>(unit.side)}];
+            const auto& indices = unit.landmarkIndices;
+            if (indices.size() % 2 != 0) {
+                std::cout << "[CompiledFaceRig] Landmark group has odd number of points: AU " << auId
+                          << ", side: " << sideToString(unit.side) << "\n";
+                continue;
+            }
+            for (int index : indices) source.pairs.push_back(static_cast<uint32_t>(index));
+        }
+    }
+
+    for (auto& [key, source] : sources)
+    {
+        AUSlot slot;
+        slot.auId = key.first;
+        slot.side = static_cast<Side>(key.second);
+
+        // overlapping muscles touch the same vertex several times; the deformation sums them, so merge them here
+        std::sort(source.deltas.begin(), source.deltas.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        slot.deltaBegin = static_cast<uint32_t>(rig->m_deltaVertices.size());
+        for (const auto& [vertex, delta] : source.deltas)
+        {
+            if (rig->m_deltaVertices.size() > slot.deltaBegin && rig->m_deltaVertices.back() == vertex) {
+                rig->m_deltaValues.back() += delta;
+                continue;
+            }
+            rig->m_deltaVertices.push_back(vertex);
+            rig->m_deltaValues.push_back(delta);
+            rig->m_requiredVertexCount = std::max(rig->m_requiredVertexCount, vertex + 1);
+        }
+        slot.deltaEnd = static_cast<uint32_t>(rig->m_deltaVertices.size());
+
+        slot.pairBegin = static_cast<uint32_t>(rig->m_landmarkPairs.size() / 2);
+        rig->m_landmarkPairs.insert(rig->m_landmarkPairs.end(), source.pairs.begin(), source.pairs.end());
+        slot.pairEnd = static_cast<uint32_t>(rig->m_landmarkPairs.size() / 2);
+
+        rig->m_slots.push_back(slot);
+    }
+
+    if (tables.musclePatches) rig->m_musclePatches = *tables.musclePatches;
+    if (tables.landmarksMeshIndex) rig->m_landmarksMeshIndex = *tables.landmarksMeshIndex;
+    if (tables.landmarksPixelIndex) rig->m_landmarksPixelIndex = *tables.landmarksPixelIndex;
+
+    rig->m_deltaTiles = DeltaTilePartition::build(*rig);
+
+    std::cout << "[CompiledFaceRig] Compiled " << rig->m_slots.size() << " AU slots with "
+              << rig->m_deltaVertices.size() << " vertex deltas and " << rig->m_landmarkPairs.size() / 2 << " landmark pairs\n";
+    return rig;
+}
+
+std::shared_ptr<const CompiledFaceRig> CompiledFaceRig::resampled(const TopologyCorrespondence& correspondence) const
+{
+    MemoryScope memory(MemorySubsystem::rig);
+    if (!correspondence.isValid() || correspondence.templateVertexCount() < m_requiredVertexCount) {
+        std::cerr << "[CompiledFaceRig] Correspondence does not match the rig template\n";
+        return nullptr;
+    }
+
+    const size_t meshCount = correspondence.meshVertexCount();
+    const size_t templateCount = correspondence.templateVertexCount();
+    const auto& index = correspondence.indices();
+    const auto& weight = correspondence.weights();
+
+    // invert the correspondence: template vertex -> (user vertex, weight), CSR layout
+    std::vector<uint32_t> inverseStart(templateCount + 1, 0);
+    for (size_t i = 0; i < index.size(); ++i)
+        if (weight[i] > 0.0f) ++inverseStart[index[i] + 1];
+    for (size_t t = 0; t < templateCount; ++t) inverseStart[t + 1] += inverseStart[t];
+    std::vector<std::pair<uint32_t, float>> inverse(inverseStart.back());
+    std::vector<uint32_t> cursor(inverseStart.begin(), inverseStart.end() - 1);
+    for (size_t i = 0; i < index.size(); ++i)
+        if (weight[i] > 0.0f) inverse[cursor[index[i]]++] = {static_cast<uint32_t>(i / 3), weight[i]};
+
+    // template deltas are in template units
+    const float unitScale = correspondence.scale() > 0.0f ? 1.0f / correspondence.scale() : 1.0f;
+
+    std::vector<std::vector<uint32_t>> slotVertices(m_slots.size());
+    std::vector<std::vector<glm::vec3>> slotValues(m_slots.size());
+    parallelFor(0, m_slots.size(), [&](size_t begin, size_t end) {
+        std::vector<glm::vec3> accum(meshCount, glm::vec3(0.0f));
+        std::vector<char> touched(meshCount, 0);
+        std::vector<uint32_t> touchedList;
+        for (size_t s = begin; s < end; ++s)
+        {
+            touchedList.clear();
+            for (uint32_t i = m_slots[s].deltaBegin; i < m_slots[s].deltaEnd; ++i)
+            {
+                const uint32_t t = m_deltaVertices[i];
+                for (uint32_t k = inverseStart[t]; k < inverseStart[t + 1]; ++k)
+                {
+                    const auto& [vertex, w] = inverse[k];
+                    if (!touched[vertex]) {
+                        touched[vertex] = 1;
+                        touchedList.push_back(vertex);
+                    }
+                    accum[vertex] += m_deltaValues[i] * w;
+                }
+            }
+            std::sort(touchedList.begin(), touchedList.end());
+            for (uint32_t vertex : touchedList) {
+                slotVertices[s].push_back(vertex);
+                slotValues[s].push_back(accum[vertex] * unitScale);
+                accum[vertex] = glm::vec3(0.0f);
+                touched[vertex] = 0;
+            }
+        }
+    }, 0, 1);
+
+    std::shared_ptr<CompiledFaceRig> rig(new CompiledFaceRig());
+    rig->m_slots = m_slots;
+    for (size_t s = 0; s < m_slots.size(); ++s)
+    {
+        rig->m_slots[s].deltaBegin = static_cast<uint32_t>(rig->m_deltaVertices.size());
+        rig->m_deltaVertices.insert(rig->m_deltaVertices.end(), slotVertices[s].begin(), slotVertices[s].end());
+        rig->m_deltaValues.insert(rig->m_deltaValues.end(), slotValues[s].begin(), slotValues[s].end());
+        rig->m_slots[s].deltaEnd = static_cast<uint32_t>(rig->m_deltaVertices.size());
+        if (!slotVertices[s].empty())
+            rig->m_requiredVertexCount = std::max(rig->m_requiredVertexCount, slotVertices[s].back() + 1);
+    }
+
+    rig->m_landmarkPairs = m_landmarkPairs;
+    rig->m_landmarksPixelIndex = m_landmarksPixelIndex;
+    rig->m_landmarksAUMap = m_landmarksAUMap;
+    rig->m_landmarksMeshIndex = correspondence.remapIndices(m_landmarksMeshIndex);
+    rig->m_musclePatches = m_musclePatches.remapped(correspondence);
+
+    rig->m_deltaTiles = DeltaTilePartition::build(*rig);
+
+    std::cout << "[CompiledFaceRig] Resampled " << m_deltaVertices.size() << " template deltas to "
+              << rig->m_deltaVertices.size() << " deltas on a " << meshCount << " vertex mesh\n";
+    return rig;
+}
+
+int CompiledFaceRig::findSlot(int auId, Side side) const
+{
+    auto it = std::lower_bound(m_slots.begin(), m_slots.end(), std::make_pair(auId, static_cast<int>(side)),
+        [](const AUSlot& slot, const std::pair<int, int>& key) {
+            return std::make_pair(slot.auId, static_cast<int>(slot.side)) < key;
+        });
+    if (it == m_slots.end() || it->auId != auId || it->side != side) return -1;
+    return static_cast<int>(it - m_slots.begin());
+}
+
+void CompiledFaceRig::touchedVertices(const std::vector<float>& slotWeights, std::vector<uint32_t>& vertices) const
+{
+    const size_t count = std::min(slotWeights.size(), m_slots.size());
+    for (size_t s = 0; s < count; ++s)
+    {
+        if (slotWeights[s] == 0.0f) continue;
+        vertices.insert(vertices.end(), m_deltaVertices.begin() + m_slots[s].deltaBegin, m_deltaVertices.begin() + m_slots[s].deltaEnd);
+    }
+}
+
+CharacterDeformState::CharacterDeformState(std::shared_ptr<const CompiledFaceRig> rig, std::vector<glm::vec3> restVertices)
+    : m_rig(std::move(rig)), m_restVertices(std::move(restVertices))
+{
+    m_weights.assign(m_rig ? m_rig->slotCount() : 0, 0.0f);
+    m_deformedVertices = m_restVertices;
+}
+
+bool CharacterDeformState::setWeight(int auId, Side side, float weight)
+{
+    int slot = m_rig ? m_rig->findSlot(auId, side) : -1;
+    if (slot < 0) return false;
+    m_weights[slot] = weight;
+    return true;
+}
+
+bool CharacterDeformState::setSlotWeight(size_t slot, float weight)
+{
+    if (slot >= m_weights.size()) return false;
+    m_weights[slot] = weight;
+    return true;
+}
+
+void CharacterDeformState::clearWeights()
+{
+    std::fill(m_weights.begin(), m_weights.end(), 0.0f);
+}
+
+bool CharacterDeformState::evaluate()
+{
+    if (!m_rig) return false;
+    if (m_restVertices.size() < m_rig->requiredVertexCount()) {
+        std::cerr << "[CharacterDeformState] Mesh has " << m_restVertices.size() << " vertices, the rig needs "
+                  << m_rig->requiredVertexCount() << "\n";
+        return false;
+    }
+
+    MetricTimer timer(PipelineMetrics::deformSeconds());
+    m_deformedVertices.resize(m_restVertices.size());
+    std::copy(m_restVertices.begin(), m_restVertices.end(), m_deformedVertices.begin());
+
+    // each tile owns its vertex range, so tiles accumulate in parallel without atomics
+    m_rig->deltaTiles().accumulate(m_weights, m_deformedVertices.data(), m_deformedVertices.size(), m_workerCount);
+    return true;
+}
+
+bool evaluateCharacters(std::vector<CharacterDeformState>& states, unsigned int workerCount)
+{
+    std::atomic<bool> ok{true};
+    parallelFor(0, states.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            if (!states[i].evaluate()) ok = false;
+    }, workerCount, 1);
+    return ok;
+}
+
+MemoryFootprint CompiledFaceRig::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("slots", heapBytes(m_slots));
+    footprint.add("deltaVertices", heapBytes(m_deltaVertices));
+    footprint.add("deltaValues", heapBytes(m_deltaValues));
+    footprint.add("landmarkPairs", heapBytes(m_landmarkPairs));
+    footprint.add("landmarksMeshIndex", heapBytes(m_landmarksMeshIndex));
+    footprint.add("landmarksPixelIndex", heapBytes(m_landmarksPixelIndex));
+    footprint.add("landmarksActionUnitMap", landmarksActionUnitMapBytes(m_landmarksAUMap));
+    footprint.add("musclePatches", m_musclePatches.memoryFootprint());
+    footprint.add("deltaTiles", m_deltaTiles.memoryFootprint());
+    return footprint;
+}
+
+MemoryFootprint CharacterDeformState::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("restVertices", heapBytes(m_restVertices));
+    footprint.add("deformedVertices", heapBytes(m_deformedVertices));
+    footprint.add("weights", heapBytes(m_weights));
+    return footprint;
+}
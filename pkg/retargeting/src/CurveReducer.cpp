@@ -0,0 +1,156 @@
+#include "CurveReducer.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+// Cubic Hermite between two keys.
+static double hermite(const AUKeyframe& k0, const AUKeyframe& k1, double time)
+{
+    const double dt = k1.time - k0.time;
+    if (dt <= 0.0) return k1.value;
+    const double s = (time - k0.time) / dt;
+    const double s2 = s * s;
+    const double s3 = s2 * s;
+    return (2.0 * s3 - 3.0 * s2 + 1.0) * k0.value + (s3 - 2.0 * s2 + s) * dt * k0.outTangent
+         + (-2.0 * s3 + 3.0 * s2) * k1.value + (s3 - s2) * dt * k1.inTangent;
+}
+
+float AUCurve::evaluate(double time) const
+{
+    if (keys.empty()) return 0.0f;
+    if (time <= keys.front().time) return keys.front().value;
+    if (time >= keys.back().time) return keys.back().value;
+
+    auto next = std::upper_bound(keys.begin(), keys.end(), time, [](double t, const AUKeyframe& key) { return t < key.time; });
+    return static_cast<float>(hermite(*(next - 1), *next, time));
+}
+
+// Slope at the first of three samples, second order on uneven spacing.
+static double endSlope(double t0, double t1, double t2, double v0, double v1, double v2)
+{
+    const double h1 = t1 - t0;
+    const double h2 = t2 - t1;
+    if (h1 <= 0.0 || h2 <= 0.0) return 0.0;
+    return -(2.0 * h1 + h2) / (h1 * (h1 + h2)) * v0 + (h1 + h2) / (h1 * h2) * v1 - h1 / (h2 * (h1 + h2)) * v2;
+}
+
+AUCurve CurveReducer::reduceChannel(const std::vector<double>& times, const std::vector<float>& values, size_t slot, float tolerance)
+{
+    AUCurve curve;
+    curve.slot = slot;
+    const size_t n = times.size();
+    if (n == 0 || values.size() != n) return curve;
+
+    // a channel that stays within the tolerance of its first value keeps one flat key
+    bool constant = true;
+    for (size_t i = 1; i < n && constant; ++i) constant = std::fabs(values[i] - values[0]) <= tolerance;
+    if (constant) {
+        AUKeyframe key;
+        key.time = times[0];
+        key.value = values[0];
+        curve.keys.push_back(key);
+        return curve;
+    }
+
+    // end keys of a segment, with the slopes of the stream measured inside the segment so a corner
+    // (e.g. a weight leaving zero) gets a broken tangent instead of an averaged one
+    auto segmentKeys = [&](size_t first, size_t last, AUKeyframe& k0, AUKeyframe& k1) {
+        k0.time = times[first];
+        k0.value = values[first];
+        k1.time = times[last];
+        k1.value = values[last];
+        if (last - first >= 2) {
+            k0.outTangent = static_cast<float>(endSlope(times[first], times[first + 1], times[first + 2], values[first], values[first + 1], values[first + 2]));
+            k1.inTangent = static_cast<float>(-endSlope(-times[last], -times[last - 1], -times[last - 2], values[last], values[last - 1], values[last - 2]));
+        } else {
+            const double dt = times[last] - times[first];
+            const float slope = dt > 0.0 ? static_cast<float>((values[last] - values[first]) / dt) : 0.0f;
+            k0.outTangent = slope;
+            k1.inTangent = slope;
+        }
+    };
+
+    std::vector<char> isKey(n, 0);
+    isKey[0] = 1;
+    isKey[n - 1] = 1;
+
+    // split segments at their worst frame until every frame is within the tolerance (explicit stack, no recursion)
+    std::vector<std::pair<size_t, size_t>> segments{{0, n - 1}};
+    while (!segments.empty())
+    {
+        const auto [first, last] = segments.back();
+        segments.pop_back();
+        if (last - first < 2) continue;
+
+        AUKeyframe k0, k1;
+        segmentKeys(first, last, k0, k1);
+        size_t worst = first;
+        double worstError = tolerance;
+        for (size_t i = first + 1; i < last; ++i)
+        {
+            const double error = std::fabs(hermite(k0, k1, times[i]) - values[i]);
+            if (error > worstError) {
+                worstError = error;
+                worst = i;
+            }
+        }
+        if (worst == first) continue;
+
+        isKey[worst] = 1;
+        segments.emplace_back(first, worst);
+        segments.emplace_back(worst, last);
+    }
+
+    // the tangents of a key come from the segments on either side of it
+    size_t previous = 0;
+    curve.keys.emplace_back();
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (!isKey[i]) continue;
+        AUKeyframe& k0 = curve.keys.back();
+        AUKeyframe k1;
+        segmentKeys(previous, i, k0, k1);
+        k1.outTangent = k1.inTangent;
+        curve.keys.push_back(k1);
+        previous = i;
+    }
+    curve.keys.front().inTangent = curve.keys.front().outTangent;
+    return curve;
+}
+
+std::vector<AUCurve> CurveReducer::reduce(const std::vector<double>& times, const std::vector<std::vector<float>>& frameWeights, const CurveReductionOptions& options)
+{
+    if (times.empty() || frameWeights.size() != times.size()) {
+        std::cerr << "[CurveReducer] Expected one weight vector per frame time\n";
+        return {};
+    }
+    const size_t slotCount = frameWeights.front().size();
+    for (const auto& weights : frameWeights)
+    {
+        if (weights.size() != slotCount) {
+            std::cerr << "[CurveReducer] Frames have different slot counts\n";
+            return {};
+        }
+    }
+
+    // channels are independent: each worker gathers and reduces its own slots
+    std::vector<AUCurve> curves(slotCount);
+    parallelFor(0, slotCount, [&](size_t chunkBegin, size_t chunkEnd) {
+        std::vector<float> values(times.size());
+        for (size_t slot = chunkBegin; slot < chunkEnd; ++slot)
+        {
+            for (size_t f = 0; f < times.size(); ++f) values[f] = frameWeights[f][slot];
+            curves[slot] = reduceChannel(times, values, slot, options.tolerance);
+        }
+    }, options.workerCount, 1);
+    return curves;
+}
+
+size_t CurveReducer::keyCount(const std::vector<AUCurve>& curves)
+{
+    size_t count = 0;
+    for (const AUCurve& curve : curves) count += curve.keys.size();
+    return count;
+}
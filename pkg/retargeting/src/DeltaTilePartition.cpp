@@ -0,0 +1,95 @@
+#include "DeltaTilePartition.h"
+#include "CompiledFaceRig.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <atomic>
+
+DeltaTilePartition DeltaTilePartition::build(const CompiledFaceRig& rig, uint32_t tileSize)
+{
+    DeltaTilePartition partition;
+    partition.m_tileSize = std::max<uint32_t>(tileSize, 1);
+    const uint32_t size = partition.m_tileSize;
+
+    const auto& slots = rig.slots();
+    const auto& deltaVertices = rig.deltaVertices();
+    const auto& deltaValues = rig.deltaValues();
+    const size_t tileCount = rig.requiredVertexCount() / size + 1;
+
+    // counting sort by tile; scattering in slot order keeps each tile's entries grouped by slot
+    std::vector<uint32_t> tileStart(tileCount + 1, 0);
+    for (uint32_t vertex : deltaVertices) ++tileStart[vertex / size + 1];
+    for (size_t t = 0; t < tileCount; ++t) tileStart[t + 1] += tileStart[t];
+
+    partition.m_vertices.resize(deltaVertices.size());
+    partition.m_deltas.resize(deltaValues.size());
+    std::vector<uint32_t> entrySlot(deltaVertices.size());
+    std::vector<uint32_t> cursor(tileStart.begin(), tileStart.end() - 1);
+    for (size_t s = 0; s < slots.size(); ++s)
+        for (uint32_t i = slots[s].deltaBegin; i < slots[s].deltaEnd; ++i)
+        {
+            const uint32_t position = cursor[deltaVertices[i] / size]++;
+            partition.m_vertices[position] = deltaVertices[i];
+            partition.m_deltas[position] = deltaValues[i];
+            entrySlot[position] = static_cast<uint32_t>(s);
+        }
+
+    for (size_t t = 0; t < tileCount; ++t)
+    {
+        if (tileStart[t] == tileStart[t + 1]) continue;
+        DeltaTile tile;
+        tile.vertexBegin = static_cast<uint32_t>(t * size);
+        tile.vertexEnd = static_cast<uint32_t>((t + 1) * size);
+        tile.runBegin = static_cast<uint32_t>(partition.m_runs.size());
+        for (uint32_t i = tileStart[t]; i < tileStart[t + 1]; ++i)
+        {
+            if (i == tileStart[t] || entrySlot[i] != partition.m_runs.back().slot)
+                partition.m_runs.push_back({entrySlot[i], i, i});
+            partition.m_runs.back().end = i + 1;
+        }
+        tile.runEnd = static_cast<uint32_t>(partition.m_runs.size());
+        partition.m_tiles.push_back(tile);
+    }
+    return partition;
+}
+
+size_t DeltaTilePartition::accumulate(const std::vector<float>& weights, glm::vec3* out, size_t vertexCount, unsigned int workerCount) const
+{
+    std::atomic<size_t> activeTiles{0};
+    parallelFor(0, m_tiles.size(), [&](size_t begin, size_t end) {
+        size_t active = 0;
+        for (size_t t = begin; t < end; ++t)
+        {
+            const DeltaTile& tile = m_tiles[t];
+            if (tile.vertexBegin >= vertexCount) continue;
+            const bool inRange = tile.vertexEnd <= vertexCount;
+
+            bool touched = false;
+            for (uint32_t r = tile.runBegin; r < tile.runEnd; ++r)
+            {
+                const DeltaTileRun& run = m_runs[r];
+                const float weight = run.slot < weights.size() ? weights[run.slot] : 0.0f;
+                if (weight == 0.0f) continue;
+                touched = true;
+                if (inRange) {
+                    for (uint32_t i = run.begin; i < run.end; ++i) out[m_vertices[i]] += m_deltas[i] * weight;
+                } else {
+                    for (uint32_t i = run.begin; i < run.end; ++i)
+                        if (m_vertices[i] < vertexCount) out[m_vertices[i]] += m_deltas[i] * weight;
+                }
+            }
+            if (touched) ++active;
+        }
+        activeTiles.fetch_add(active, std::memory_order_relaxed);
+    }, workerCount, 4);
+    return activeTiles.load();
+}
+
+MemoryFootprint DeltaTilePartition::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("tiles", heapBytes(m_tiles));
+    footprint.add("runs", heapBytes(m_runs));
+    footprint.add("vertices", heapBytes(m_vertices));
+    footprint.add("deltas", heapBytes(m_deltas));
+    return footprint;
+}
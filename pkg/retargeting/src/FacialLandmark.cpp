@@ -1,7 +1,13 @@
 #include "FacialLandmark.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
 
 bool FacialLandmark::loadLandmarksMeshIndexFromJSON(const char* landmarksMeshJson)
 {
+    MemoryScope memory(MemorySubsystem::facialLandmark);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(landmarksMeshJson));
+
     m_landmarksMeshIndex.clear();
 
     // read the json files
@@ -31,6 +37,10 @@ bool FacialLandmark::loadLandmarksMeshIndexFromJSON(const char* landmarksMeshJso
 
 bool FacialLandmark::loadLandmarksPixelIndexFromJSON(const char* landmarksPixelJson)
 {
+    MemoryScope memory(MemorySubsystem::facialLandmark);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(landmarksPixelJson));
+
     m_landmarksPixelIndex.clear();
 
     // read the json files
@@ -69,6 +79,10 @@ std::vector<int> FacialLandmark::getLandmarksPixelIndex()
 }
 
 bool FacialLandmark::loadLandmarksActionUnitsMappingFromJson(const char* path) {
+    MemoryScope memory(MemorySubsystem::facialLandmark);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(path));
+
     m_landmarksActionUnitMap.clear();
 
     std::cout << "[Loader][FACIALLANDMARK] Loading file: landmarksActionUnits.json from path: " << path << "\n";
@@ -132,4 +146,21 @@ bool FacialLandmark::loadLandmarksActionUnitsMappingFromJson(const char* path) {
 const std::unordered_map <int, std::vector<landmarksActionUnit>> FacialLandmark::getLandmarksActionUnitMap()
 {
     return m_landmarksActionUnitMap;
-}
\ No newline at end of file
+}
+
+MemoryFootprint FacialLandmark::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("landmarksMeshIndex", heapBytes(m_landmarksMeshIndex));
+    footprint.add("landmarksPixelIndex", heapBytes(m_landmarksPixelIndex));
+    footprint.add("landmarksActionUnitMap", landmarksActionUnitMapBytes(m_landmarksActionUnitMap));
+    return footprint;
+}
+
+size_t landmarksActionUnitMapBytes(const std::unordered_map<int, std::vector<landmarksActionUnit>>& map)
+{
+    size_t bytes = heapBytesOfVectorMap(map);
+    for (const auto& entry : map)
+        for (const landmarksActionUnit& mapping : entry.second) bytes += heapBytes(mapping.landmarkIndices);
+    return bytes;
+}
@@ -1,4 +1,6 @@
 #include "FacialMesh.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
 
 glm::vec3 FacialMesh::computeBoundingBox(glm::vec3 &maxBBValue, glm::vec3 &minBBValue)
 {   
@@ -20,6 +22,10 @@ void FacialMesh::setVertex(std::vector<glm::vec3> &vertices, glm::vec3 vertex)
 
 std::vector<glm::vec3> FacialMesh::loadModel(const char* modelPath)
 {
+    MemoryScope memory(MemorySubsystem::facialMesh);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(modelPath));
+
     std::vector<glm::vec3> meshVertices;
     
     tinyobj::attrib_t attrib;
@@ -47,3 +53,35 @@ std::vector<glm::vec3> FacialMesh::loadModel(const char* modelPath)
 
     return meshVertices;
 }
+
+std::vector<unsigned int> FacialMesh::loadModelTriangles(const char* modelPath)
+{
+    MemoryScope memory(MemorySubsystem::facialMesh);
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(modelPath));
+
+    std::vector<unsigned int> triangles;
+
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn;
+    std::string err;
+
+    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath);
+
+    if (!warn.empty()) std::cout << "Warning: " << warn << std::endl;
+    if (!err.empty()) std::cerr << "Error: " << err << std::endl;
+    if (!ret) {
+        std::cerr << "Failed to load OBJ file: " << modelPath << std::endl;
+        return triangles;
+    }
+
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            triangles.push_back(static_cast<unsigned int>(index.vertex_index));
+        }
+    }
+
+    return triangles;
+}
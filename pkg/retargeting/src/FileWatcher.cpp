@@ -0,0 +1,116 @@
+#include "FileWatcher.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher()
+{
+    stop();
+}
+
+#ifdef __linux__
+
+bool FileWatcher::start(const std::string& directory, Callback onChanged, int debounceMs)
+{
+    if (isRunning()) return false;
+
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        std::cerr << "[FileWatcher] inotify_init1 failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (::inotify_add_watch(m_inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "[FileWatcher] Cannot watch " << directory << ": " << std::strerror(errno) << "\n";
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+        return false;
+    }
+    if (::pipe(m_wakePipe) != 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+        return false;
+    }
+
+    m_onChanged = std::move(onChanged);
+    m_debounceMs = debounceMs;
+    m_thread = std::thread(&FileWatcher::run, this);
+    return true;
+}
+
+void FileWatcher::stop()
+{
+    if (!isRunning()) return;
+
+    const char wake = 1;
+    if (::write(m_wakePipe[1], &wake, 1) < 0)
+        std::cerr << "[FileWatcher] Cannot wake the watcher thread: " << std::strerror(errno) << "\n";
+    m_thread.join();
+
+    ::close(m_wakePipe[0]);
+    ::close(m_wakePipe[1]);
+    ::close(m_inotifyFd);
+    m_wakePipe[0] = m_wakePipe[1] = m_inotifyFd = -1;
+}
+
+void FileWatcher::run()
+{
+    // inotify_event is variable length; align the buffer for it
+    alignas(inotify_event) char buffer[8192];
+    std::set<std::string> pending;
+
+    for (;;)
+    {
+        pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_wakePipe[0], POLLIN, 0}};
+        const int ready = ::poll(fds, 2, pending.empty() ? -1 : m_debounceMs);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[FileWatcher] poll failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+        if (fds[1].revents & POLLIN) return;
+
+        if (ready == 0) {
+            // the directory has been quiet for the debounce delay
+            for (const auto& name : pending) m_onChanged(name);
+            pending.clear();
+            continue;
+        }
+
+        for (;;)
+        {
+            const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) break;
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0) pending.insert(event->name);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+    }
+}
+
+#else
+
+bool FileWatcher::start(const std::string& directory, Callback, int)
+{
+    std::cerr << "[FileWatcher] File watching is only supported on Linux, not watching " << directory << "\n";
+    return false;
+}
+
+void FileWatcher::stop()
+{
+}
+
+void FileWatcher::run()
+{
+}
+
+#endif
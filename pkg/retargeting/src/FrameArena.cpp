@@ -0,0 +1,47 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t initialBytes)
+    : m_block(new unsigned char[std::max<size_t>(initialBytes, 1)]), m_capacity(std::max<size_t>(initialBytes, 1))
+{
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    // align the address rather than the offset, the block itself is only max_align_t aligned
+    const uintptr_t base = reinterpret_cast<uintptr_t>(m_block.get());
+    const uintptr_t aligned = (base + m_offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    const size_t end = static_cast<size_t>(aligned - base) + bytes;
+    if (end <= m_capacity) {
+        m_offset = end;
+        m_highWater = std::max(m_highWater, used());
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    m_overflow.emplace_back(new unsigned char[bytes + alignment]);
+    m_overflowBytes += bytes + alignment;
+    m_highWater = std::max(m_highWater, used());
+    const uintptr_t block = reinterpret_cast<uintptr_t>(m_overflow.back().get());
+    return reinterpret_cast<void*>((block + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+}
+
+void FrameArena::reset()
+{
+    if (!m_overflow.empty())
+    {
+        m_overflow.clear();
+        m_capacity = std::max(m_capacity * 2, m_highWater);
+        m_block.reset(new unsigned char[m_capacity]);
+    }
+    m_offset = 0;
+    m_overflowBytes = 0;
+}
+
+MemoryFootprint FrameArena::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("block", m_capacity);
+    footprint.add("overflow", m_overflowBytes + heapBytes(m_overflow));
+    return footprint;
+}
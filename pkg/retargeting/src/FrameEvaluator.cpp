@@ -0,0 +1,115 @@
+#include "FrameEvaluator.h"
+#include "MathUtils.h"
+#include <iostream>
+
+FrameEvaluator::FrameEvaluator(std::shared_ptr<const CompiledFaceRig> rig)
+    : m_rig(std::move(rig))
+{
+    const size_t slots = m_rig ? m_rig->slotCount() : 0;
+    m_baseDistances.assign(slots, 0.0f);
+    m_thresholdMin.assign(slots, 0.0f);
+    m_thresholdMax.assign(slots, 0.0f);
+    m_calibrated.assign(slots, 0);
+}
+
+float FrameEvaluator::meanPairDistance(size_t slot, const glm::vec3* landmarks, size_t landmarkCount) const
+{
+    const AUSlot& au = m_rig->slots()[slot];
+    const auto& pairs = m_rig->landmarkPairs();
+    float sum = 0.0f;
+    int count = 0;
+    for (uint32_t p = au.pairBegin; p < au.pairEnd; ++p)
+    {
+        const uint32_t a = pairs[p * 2];
+        const uint32_t b = pairs[p * 2 + 1];
+        if (a >= landmarkCount || b >= landmarkCount) continue;
+        sum += glm::length(landmarks[a] - landmarks[b]);
+        ++count;
+    }
+    return count > 0 ? sum / static_cast<float>(count) : -1.0f;
+}
+
+bool FrameEvaluator::setNeutralLandmarks(const std::vector<glm::vec3>& neutralLandmarks)
+{
+    bool complete = true;
+    for (size_t slot = 0; slot < m_baseDistances.size(); ++slot)
+    {
+        const AUSlot& au = m_rig->slots()[slot];
+        if (au.pairBegin == au.pairEnd) continue;
+        float distance = meanPairDistance(slot, neutralLandmarks.data(), neutralLandmarks.size());
+        if (distance < 0.0f) {
+            std::cout << "[FrameEvaluator] [WARNING] No neutral distance for AU " << au.auId << ", side: " << sideToString(au.side) << "\n";
+            complete = false;
+            continue;
+        }
+        m_baseDistances[slot] = distance;
+    }
+    return complete;
+}
+
+void FrameEvaluator::setBaseDistance(size_t slot, float distance)
+{
+    if (slot < m_baseDistances.size()) m_baseDistances[slot] = distance;
+}
+
+void FrameEvaluator::setThresholds(size_t slot, float thresholdMin, float thresholdMax)
+{
+    if (slot >= m_calibrated.size()) return;
+    m_thresholdMin[slot] = thresholdMin;
+    m_thresholdMax[slot] = thresholdMax;
+    m_calibrated[slot] = 1;
+}
+
+FrameEvaluation FrameEvaluator::evaluate(const glm::vec3* landmarks, size_t landmarkCount, float defaultMin, float defaultMax, FrameArena& arena) const
+{
+    FrameEvaluation evaluation;
+    evaluation.count = m_baseDistances.size();
+    landmarksDistanceData* records = arena.allocateArray<landmarksDistanceData>(evaluation.count);
+    evaluation.records = records;
+
+    float maxActivation = 0.0f;
+    for (size_t slot = 0; slot < evaluation.count; ++slot)
+    {
+        const AUSlot& au = m_rig->slots()[slot];
+        landmarksDistanceData& record = records[slot];
+        record = landmarksDistanceData();
+        record.auId = au.auId;
+        record.side = au.side;
+        record.slot = static_cast<uint32_t>(slot);
+        record.baseDistance = m_baseDistances[slot];
+
+        const float distance = meanPairDistance(slot, landmarks, landmarkCount);
+        if (distance < 0.0f) continue;
+        record.currentDistance = distance;
+
+        // AUs are compared relative to their own range
+        const float thresholdMin = m_calibrated[slot] ? m_thresholdMin[slot] : defaultMin;
+        const float thresholdMax = m_calibrated[slot] ? m_thresholdMax[slot] : defaultMax;
+        const float delta = record.currentDistance - record.baseDistance;
+        if (delta > thresholdMin) record.activation = (delta - thresholdMin) / (thresholdMax - thresholdMin);
+
+        if (record.activation > maxActivation) {
+            maxActivation = record.activation;
+            evaluation.strongest = static_cast<int>(slot);
+        }
+    }
+
+    if (evaluation.strongest >= 0)
+    {
+        landmarksDistanceData& strongest = records[evaluation.strongest];
+        float thresholdMin = m_calibrated[strongest.slot] ? m_thresholdMin[strongest.slot] : defaultMin;
+        float thresholdMax = m_calibrated[strongest.slot] ? m_thresholdMax[strongest.slot] : defaultMax;
+        MathUtils mathUtils;
+        strongest.intensity = mathUtils.calculateIntensity(thresholdMin, thresholdMax, strongest.currentDistance, strongest.baseDistance);
+        strongest.isActive = true;
+    }
+    return evaluation;
+}
+
+MemoryFootprint FrameEvaluator::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("baseDistances", heapBytes(m_baseDistances));
+    footprint.add("thresholds", heapBytes(m_thresholdMin) + heapBytes(m_thresholdMax) + heapBytes(m_calibrated));
+    return footprint;
+}
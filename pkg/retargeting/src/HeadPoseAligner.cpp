@@ -0,0 +1,278 @@
+#include "HeadPoseAligner.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Forehead, nose bridge and tip, eye corners and face sides (MediaPipe face mesh indices).
+static const int kStableMediaPipeLandmarks[] = {10, 168, 6, 4, 33, 133, 173, 263, 362, 398, 234, 454};
+
+// Eigen decomposition of a symmetric 3x3 matrix by cyclic Jacobi rotations: a becomes diagonal, v holds the eigenvectors.
+static void jacobiEigen(double a[3][3], double v[3][3])
+{
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c) v[r][c] = r == c ? 1.0 : 0.0;
+
+    static const int pairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    for (int sweep = 0; sweep < 16; ++sweep)
+    {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        const double diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (off <= 1e-30 * diagonal || off == 0.0) break;
+
+        for (const auto& pair : pairs)
+        {
+            const int p = pair[0];
+            const int q = pair[1];
+            if (a[p][q] == 0.0) continue;
+            const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+            const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+            const double c = 1.0 / std::sqrt(t * t + 1.0);
+            const double s = t * c;
+            for (int k = 0; k < 3; ++k)
+            {
+                const double akp = a[k][p];
+                const double akq = a[k][q];
+                a[k][p] = c * akp - s * akq;
+                a[k][q] = s * akp + c * akq;
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                const double apk = a[p][k];
+                const double aqk = a[q][k];
+                a[p][k] = c * apk - s * aqk;
+                a[q][k] = s * apk + c * aqk;
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                const double vkp = v[k][p];
+                const double vkq = v[k][q];
+                v[k][p] = c * vkp - s * vkq;
+                v[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+}
+
+static double dot3(const double a[3], const double b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+static bool normalize3(double a[3])
+{
+    const double length = std::sqrt(dot3(a, a));
+    if (length <= 1e-300) return false;
+    for (int k = 0; k < 3; ++k) a[k] /= length;
+    return true;
+}
+
+// Umeyama: covariance[r][c] = mean of target_r * source_c over the centered pairs, variances are mean squared norms.
+static bool poseFromCovariance(const double covariance[3][3], double sourceVariance, double targetVariance,
+                               const double sourceCentroid[3], const double targetCentroid[3], HeadPose& pose)
+{
+    if (!(sourceVariance > 1e-20)) return false;
+
+    // covariance = U D V^T from the eigenvectors of covariance^T covariance
+    double normal[3][3];
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+            normal[r][c] = covariance[0][r] * covariance[0][c] + covariance[1][r] * covariance[1][c] + covariance[2][r] * covariance[2][c];
+    double v[3][3];
+    jacobiEigen(normal, v);
+
+    // singular vectors by decreasing singular value, V a proper rotation
+    int order[3] = {0, 1, 2};
+    std::sort(order, order + 3, [&](int a, int b) { return normal[a][a] > normal[b][b]; });
+    double vColumns[3][3];
+    for (int k = 0; k < 3; ++k)
+        for (int r = 0; r < 3; ++r) vColumns[k][r] = v[r][order[k]];
+    const double cross[3] = {vColumns[0][1] * vColumns[1][2] - vColumns[0][2] * vColumns[1][1],
+                             vColumns[0][2] * vColumns[1][0] - vColumns[0][0] * vColumns[1][2],
+                             vColumns[0][0] * vColumns[1][1] - vColumns[0][1] * vColumns[1][0]};
+    if (dot3(cross, vColumns[2]) < 0.0)
+        for (int r = 0; r < 3; ++r) vColumns[2][r] = -vColumns[2][r];
+
+    // U by Gram-Schmidt on covariance * v, completed to a proper rotation
+    double b[3][3];
+    for (int k = 0; k < 3; ++k)
+        for (int r = 0; r < 3; ++r) b[k][r] = dot3(covariance[r], vColumns[k]);
+    double u[3][3];
+    for (int r = 0; r < 3; ++r) u[0][r] = b[0][r];
+    if (!normalize3(u[0])) return false;
+    const double projection = dot3(u[0], b[1]);
+    for (int r = 0; r < 3; ++r) u[1][r] = b[1][r] - projection * u[0][r];
+    if (!normalize3(u[1])) {
+        // collinear points: any axis perpendicular to the first one
+        const int axis = std::fabs(u[0][0]) < 0.9 ? 0 : 1;
+        double e[3] = {0.0, 0.0, 0.0};
+        e[axis] = 1.0;
+        const double along = dot3(u[0], e);
+        for (int r = 0; r < 3; ++r) u[1][r] = e[r] - along * u[0][r];
+        normalize3(u[1]);
+    }
+    u[2][0] = u[0][1] * u[1][2] - u[0][2] * u[1][1];
+    u[2][1] = u[0][2] * u[1][0] - u[0][0] * u[1][2];
+    u[2][2] = u[0][0] * u[1][1] - u[0][1] * u[1][0];
+    const double singular[3] = {dot3(u[0], b[0]), dot3(u[1], b[1]), dot3(u[2], b[2])};
+
+    // with U and V proper rotations the smallest singular value is signed: R = U V^T is the best rotation (Umeyama's
+    // diag(1, 1, -1) correction is already folded into that sign) and trace(D S) is the signed sum
+    double rotation[3][3];
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+            rotation[r][c] = u[0][r] * vColumns[0][c] + u[1][r] * vColumns[1][c] + u[2][r] * vColumns[2][c];
+    const double trace = singular[0] + singular[1] + singular[2];
+    const double scale = trace / sourceVariance;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 3; ++c) pose.rotation[c][r] = static_cast<float>(rotation[r][c]);
+        pose.translation[r] = static_cast<float>(targetCentroid[r] - scale * dot3(rotation[r], sourceCentroid));
+    }
+    pose.scale = static_cast<float>(scale);
+    pose.rmsError = static_cast<float>(std::sqrt(std::max(0.0, targetVariance - trace * trace / sourceVariance)));
+    return true;
+}
+
+bool HeadPoseAligner::estimate(const glm::vec3* source, const glm::vec3* target, size_t count, HeadPose& pose)
+{
+    if (count < 3) return false;
+    double sourceCentroid[3] = {0.0, 0.0, 0.0};
+    double targetCentroid[3] = {0.0, 0.0, 0.0};
+    for (size_t i = 0; i < count; ++i)
+        for (int k = 0; k < 3; ++k) {
+            sourceCentroid[k] += source[i][k];
+            targetCentroid[k] += target[i][k];
+        }
+    for (int k = 0; k < 3; ++k) {
+        sourceCentroid[k] /= static_cast<double>(count);
+        targetCentroid[k] /= static_cast<double>(count);
+    }
+
+    double covariance[3][3] = {};
+    double sourceVariance = 0.0;
+    double targetVariance = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double x[3], y[3];
+        for (int k = 0; k < 3; ++k) {
+            x[k] = source[i][k] - sourceCentroid[k];
+            y[k] = target[i][k] - targetCentroid[k];
+        }
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c) covariance[r][c] += y[r] * x[c];
+        sourceVariance += dot3(x, x);
+        targetVariance += dot3(y, y);
+    }
+    const double inverseCount = 1.0 / static_cast<double>(count);
+    for (auto& row : covariance)
+        for (double& value : row) value *= inverseCount;
+    return poseFromCovariance(covariance, sourceVariance * inverseCount, targetVariance * inverseCount, sourceCentroid, targetCentroid, pose);
+}
+
+bool HeadPoseAligner::setReference(const std::vector<glm::vec3>& neutralLandmarks, const std::vector<int>& stableIndices)
+{
+    m_stableIndices.clear();
+    m_centeredReference.clear();
+    m_landmarkCount = neutralLandmarks.size();
+
+    std::vector<int> indices;
+    if (stableIndices.empty()) {
+        for (size_t i = 0; i < neutralLandmarks.size(); ++i) indices.push_back(static_cast<int>(i));
+    } else {
+        for (int i : stableIndices)
+            if (i >= 0 && static_cast<size_t>(i) < neutralLandmarks.size()) indices.push_back(i);
+    }
+    if (indices.size() < 3) {
+        std::cerr << "[HeadPoseAligner] Need at least three stable landmarks, got " << indices.size() << "\n";
+        return false;
+    }
+
+    glm::vec3 centroid(0.0f);
+    for (int i : indices) centroid += neutralLandmarks[i];
+    centroid /= static_cast<float>(indices.size());
+    double variance = 0.0;
+    for (int i : indices)
+    {
+        m_centeredReference.push_back(neutralLandmarks[i] - centroid);
+        variance += glm::dot(m_centeredReference.back(), m_centeredReference.back());
+    }
+    if (!(variance > 1e-20)) {
+        std::cerr << "[HeadPoseAligner] The stable neutral landmarks are all at the same place\n";
+        m_centeredReference.clear();
+        return false;
+    }
+    m_referenceCentroid = centroid;
+    m_referenceVariance = variance / static_cast<double>(indices.size());
+    m_stableIndices = std::move(indices);
+    return true;
+}
+
+bool HeadPoseAligner::estimateFrame(const glm::vec3* landmarks, HeadPose& pose) const
+{
+    // the reference is centered, so the covariance needs no centered copy of the frame: one pass over its stable landmarks
+    const size_t count = m_stableIndices.size();
+    double covariance[3][3] = {};
+    double sum[3] = {0.0, 0.0, 0.0};
+    double squaredNorms = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const glm::vec3& p = landmarks[m_stableIndices[i]];
+        const glm::vec3& y = m_centeredReference[i];
+        for (int r = 0; r < 3; ++r)
+        {
+            covariance[r][0] += static_cast<double>(y[r]) * p.x;
+            covariance[r][1] += static_cast<double>(y[r]) * p.y;
+            covariance[r][2] += static_cast<double>(y[r]) * p.z;
+            sum[r] += p[r];
+        }
+        squaredNorms += static_cast<double>(p.x) * p.x + static_cast<double>(p.y) * p.y + static_cast<double>(p.z) * p.z;
+    }
+
+    const double inverseCount = 1.0 / static_cast<double>(count);
+    const double centroid[3] = {sum[0] * inverseCount, sum[1] * inverseCount, sum[2] * inverseCount};
+    for (auto& row : covariance)
+        for (double& value : row) value *= inverseCount;
+    const double sourceVariance = squaredNorms * inverseCount - dot3(centroid, centroid);
+    const double referenceCentroid[3] = {m_referenceCentroid.x, m_referenceCentroid.y, m_referenceCentroid.z};
+    return poseFromCovariance(covariance, sourceVariance, m_referenceVariance, centroid, referenceCentroid, pose);
+}
+
+bool HeadPoseAligner::align(glm::vec3* landmarks, size_t landmarkCount, HeadPose* pose) const
+{
+    if (!isValid() || landmarkCount < m_landmarkCount) return false;
+    HeadPose estimated;
+    if (!estimateFrame(landmarks, estimated)) return false;
+
+    const glm::mat3 scaledRotation = estimated.rotation * estimated.scale;
+    for (size_t i = 0; i < landmarkCount; ++i) landmarks[i] = scaledRotation * landmarks[i] + estimated.translation;
+    if (pose) *pose = estimated;
+    return true;
+}
+
+size_t HeadPoseAligner::alignFrames(std::vector<std::vector<glm::vec3>>& frames, std::vector<HeadPose>* poses,
+                                    unsigned int workerCount) const
+{
+    if (poses) poses->assign(frames.size(), HeadPose());
+    std::vector<char> aligned(frames.size(), 0);
+    parallelFor(0, frames.size(), [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f)
+            aligned[f] = align(frames[f].data(), frames[f].size(), poses ? &(*poses)[f] : nullptr);
+    }, workerCount, 64);
+    return static_cast<size_t>(std::count(aligned.begin(), aligned.end(), 1));
+}
+
+std::vector<int> HeadPoseAligner::stableLandmarks(const std::vector<int>& landmarksPixelIndex)
+{
+    std::vector<int> stable;
+    for (size_t i = 0; i < landmarksPixelIndex.size(); ++i)
+        if (std::find(std::begin(kStableMediaPipeLandmarks), std::end(kStableMediaPipeLandmarks), landmarksPixelIndex[i]) != std::end(kStableMediaPipeLandmarks))
+            stable.push_back(static_cast<int>(i));
+    return stable;
+}
+
+MemoryFootprint HeadPoseAligner::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("stableIndices", heapBytes(m_stableIndices));
+    footprint.add("reference", heapBytes(m_centeredReference));
+    return footprint;
+}
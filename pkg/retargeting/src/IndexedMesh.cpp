@@ -0,0 +1,206 @@
+#include "IndexedMesh.h"
+#include "FacialMesh.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+
+bool IndexedMesh::build(std::vector<glm::vec3> vertices, std::vector<uint32_t> triangles, unsigned int workerCount)
+{
+    if (triangles.size() % 3 != 0) {
+        std::cerr << "[IndexedMesh] Triangle list size " << triangles.size() << " is not a multiple of 3\n";
+        return false;
+    }
+    for (uint32_t index : triangles) {
+        if (index >= vertices.size()) {
+            std::cerr << "[IndexedMesh] Triangle index " << index << " out of range (" << vertices.size() << " vertices)\n";
+            return false;
+        }
+    }
+
+    m_vertices = std::move(vertices);
+    m_triangles = std::move(triangles);
+    m_dirtyFlag.assign(m_vertices.size(), 0);
+    m_dirtyList.clear();
+
+    buildAdjacency(workerCount);
+    computeNormals(workerCount);
+    return true;
+}
+
+bool IndexedMesh::loadOBJ(const char* modelPath, unsigned int workerCount)
+{
+    FacialMesh loader;
+    std::vector<glm::vec3> vertices = loader.loadModel(modelPath);
+    std::vector<unsigned int> triangles = loader.loadModelTriangles(modelPath);
+    if (vertices.empty()) return false;
+    return build(std::move(vertices), std::vector<uint32_t>(triangles.begin(), triangles.end()), workerCount);
+}
+
+void IndexedMesh::buildAdjacency(unsigned int workerCount)
+{
+    const size_t vertexCount = m_vertices.size();
+    const size_t faces = faceCount();
+
+    // vertex -> face: count, prefix sum, scatter, then sort each list so the layout does not depend on scheduling
+    std::unique_ptr<std::atomic<uint32_t>[]> counts(new std::atomic<uint32_t>[vertexCount + 1]);
+    for (size_t v = 0; v <= vertexCount; ++v) counts[v].store(0, std::memory_order_relaxed);
+
+    parallelFor(0, faces, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f)
+            for (int k = 0; k < 3; ++k) counts[m_triangles[f * 3 + k]].fetch_add(1, std::memory_order_relaxed);
+    }, workerCount, 4096);
+
+    m_vertexFaceOffsets.assign(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        m_vertexFaceOffsets[v + 1] = m_vertexFaceOffsets[v] + counts[v].load(std::memory_order_relaxed);
+
+    for (size_t v = 0; v < vertexCount; ++v) counts[v].store(m_vertexFaceOffsets[v], std::memory_order_relaxed);
+    m_vertexFaces.assign(m_vertexFaceOffsets.back(), 0);
+    parallelFor(0, faces, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f)
+            for (int k = 0; k < 3; ++k)
+                m_vertexFaces[counts[m_triangles[f * 3 + k]].fetch_add(1, std::memory_order_relaxed)] = static_cast<uint32_t>(f);
+    }, workerCount, 4096);
+
+    parallelFor(0, vertexCount, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+            std::sort(m_vertexFaces.begin() + m_vertexFaceOffsets[v], m_vertexFaces.begin() + m_vertexFaceOffsets[v + 1]);
+    }, workerCount, 4096);
+
+    // vertex -> vertex: the one ring is the other two corners of every incident face, deduplicated
+    auto gatherRing = [this](size_t v, std::vector<uint32_t>& ring) {
+        ring.clear();
+        for (uint32_t i = m_vertexFaceOffsets[v]; i < m_vertexFaceOffsets[v + 1]; ++i)
+        {
+            const uint32_t* tri = &m_triangles[m_vertexFaces[i] * 3];
+            for (int k = 0; k < 3; ++k)
+                if (tri[k] != v) ring.push_back(tri[k]);
+        }
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    };
+
+    std::vector<uint32_t> ringSizes(vertexCount, 0);
+    parallelFor(0, vertexCount, [&](size_t begin, size_t end) {
+        std::vector<uint32_t> ring;
+        for (size_t v = begin; v < end; ++v) {
+            gatherRing(v, ring);
+            ringSizes[v] = static_cast<uint32_t>(ring.size());
+        }
+    }, workerCount, 4096);
+
+    m_vertexNeighborOffsets.assign(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) m_vertexNeighborOffsets[v + 1] = m_vertexNeighborOffsets[v] + ringSizes[v];
+
+    m_vertexNeighbors.assign(m_vertexNeighborOffsets.back(), 0);
+    parallelFor(0, vertexCount, [&](size_t begin, size_t end) {
+        std::vector<uint32_t> ring;
+        for (size_t v = begin; v < end; ++v) {
+            gatherRing(v, ring);
+            std::copy(ring.begin(), ring.end(), m_vertexNeighbors.begin() + m_vertexNeighborOffsets[v]);
+        }
+    }, workerCount, 4096);
+}
+
+glm::vec3 IndexedMesh::faceNormal(size_t face) const
+{
+    const glm::vec3& a = m_vertices[m_triangles[face * 3]];
+    const glm::vec3& b = m_vertices[m_triangles[face * 3 + 1]];
+    const glm::vec3& c = m_vertices[m_triangles[face * 3 + 2]];
+    // length is twice the triangle area, so larger faces weigh more in the vertex normal
+    return glm::cross(b - a, c - a);
+}
+
+glm::vec3 IndexedMesh::vertexNormal(size_t vertex) const
+{
+    glm::vec3 sum(0.0f);
+    for (uint32_t i = m_vertexFaceOffsets[vertex]; i < m_vertexFaceOffsets[vertex + 1]; ++i)
+        sum += m_faceNormals[m_vertexFaces[i]];
+    const float length = glm::length(sum);
+    return length > 1e-12f ? sum / length : glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+void IndexedMesh::computeNormals(unsigned int workerCount)
+{
+    m_faceNormals.resize(faceCount());
+    m_normals.resize(m_vertices.size());
+
+    parallelFor(0, faceCount(), [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) m_faceNormals[f] = faceNormal(f);
+    }, workerCount, 4096);
+    parallelFor(0, m_vertices.size(), [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) m_normals[v] = vertexNormal(v);
+    }, workerCount, 4096);
+
+    for (uint32_t v : m_dirtyList) m_dirtyFlag[v] = 0;
+    m_dirtyList.clear();
+}
+
+void IndexedMesh::markDirty(const std::vector<uint32_t>& vertices)
+{
+    for (uint32_t v : vertices)
+    {
+        if (v >= m_vertices.size() || m_dirtyFlag[v]) continue;
+        m_dirtyFlag[v] = 1;
+        m_dirtyList.push_back(v);
+    }
+}
+
+void IndexedMesh::setPositions(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions)
+{
+    const size_t count = std::min(indices.size(), positions.size());
+    for (size_t i = 0; i < count; ++i)
+        if (indices[i] < m_vertices.size()) m_vertices[indices[i]] = positions[i];
+    markDirty(indices);
+}
+
+bool IndexedMesh::setAllPositions(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& movedVertices)
+{
+    if (vertices.size() != m_vertices.size()) {
+        std::cerr << "[IndexedMesh] Expected " << m_vertices.size() << " positions, got " << vertices.size() << "\n";
+        return false;
+    }
+    std::copy(vertices.begin(), vertices.end(), m_vertices.begin());
+    markDirty(movedVertices);
+    return true;
+}
+
+size_t IndexedMesh::updateDirtyNormals(unsigned int workerCount)
+{
+    if (m_dirtyList.empty()) return 0;
+
+    // faces around a moved vertex changed; every corner of those faces needs a new normal
+    std::vector<uint32_t> faces;
+    std::vector<char> faceSeen(faceCount(), 0);
+    for (uint32_t v : m_dirtyList)
+        for (uint32_t i = m_vertexFaceOffsets[v]; i < m_vertexFaceOffsets[v + 1]; ++i)
+            if (!faceSeen[m_vertexFaces[i]]) {
+                faceSeen[m_vertexFaces[i]] = 1;
+                faces.push_back(m_vertexFaces[i]);
+            }
+
+    std::vector<uint32_t> affected;
+    for (uint32_t f : faces)
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = m_triangles[f * 3 + k];
+            // m_dirtyFlag doubles as the visited mark; it is cleared for every affected vertex below
+            if (m_dirtyFlag[v] == 2) continue;
+            m_dirtyFlag[v] = 2;
+            affected.push_back(v);
+        }
+
+    parallelFor(0, faces.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) m_faceNormals[faces[i]] = faceNormal(faces[i]);
+    }, workerCount, 2048);
+    parallelFor(0, affected.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) m_normals[affected[i]] = vertexNormal(affected[i]);
+    }, workerCount, 2048);
+
+    for (uint32_t v : affected) m_dirtyFlag[v] = 0;
+    for (uint32_t v : m_dirtyList) m_dirtyFlag[v] = 0; // isolated dirty vertices have no face
+    m_dirtyList.clear();
+    return affected.size();
+}
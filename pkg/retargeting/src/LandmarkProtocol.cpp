@@ -0,0 +1,148 @@
+#include "LandmarkProtocol.h"
+#include "MetricsRegistry.h"
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+std::string LandmarkProtocol::encodeRequest(const LandmarkRequest& request)
+{
+    nlohmann::ordered_json message;
+    message["type"] = "generate";
+    message["id"] = request.id;
+    message["portrait"] = request.portraitPath;
+    message["audio"] = request.audioPath;
+    return message.dump() + "\n";
+}
+
+std::string LandmarkProtocol::encodeFrame(const LandmarkFrame& frame)
+{
+    std::vector<float> flat;
+    flat.reserve(frame.landmarks.size() * 3);
+    for (const auto& p : frame.landmarks) {
+        flat.push_back(p.x);
+        flat.push_back(p.y);
+        flat.push_back(p.z);
+    }
+
+    nlohmann::ordered_json message;
+    message["type"] = "frame";
+    message["id"] = frame.requestId;
+    message["index"] = frame.index;
+    message["time"] = frame.time;
+    message["landmarks"] = flat;
+    return message.dump() + "\n";
+}
+
+std::string LandmarkProtocol::encodeEnd(uint64_t requestId, uint32_t frameCount)
+{
+    nlohmann::ordered_json message;
+    message["type"] = "end";
+    message["id"] = requestId;
+    message["frames"] = frameCount;
+    return message.dump() + "\n";
+}
+
+std::string LandmarkProtocol::encodeError(uint64_t requestId, const std::string& errorMessage)
+{
+    nlohmann::ordered_json message;
+    message["type"] = "error";
+    message["id"] = requestId;
+    message["message"] = errorMessage;
+    return message.dump() + "\n";
+}
+
+LandmarkMessage LandmarkProtocol::decode(const std::string& line)
+{
+    LandmarkMessage result;
+    try {
+        const nlohmann::json message = nlohmann::json::parse(line);
+        const std::string type = message.at("type").get<std::string>();
+        const uint64_t id = message.at("id").get<uint64_t>();
+
+        if (type == "generate") {
+            result.request.id = id;
+            result.request.portraitPath = message.value("portrait", std::string());
+            result.request.audioPath = message.value("audio", std::string());
+            result.type = LandmarkMessageType::Request;
+        }
+        else if (type == "frame") {
+            const auto& flat = message.at("landmarks");
+            if (!flat.is_array() || flat.size() % 3 != 0) {
+                result.error = "landmarks must be a flat array of x, y, z triples";
+                return result;
+            }
+            result.frame.requestId = id;
+            result.frame.index = message.at("index").get<uint32_t>();
+            result.frame.time = message.value("time", 0.0);
+            result.frame.landmarks.resize(flat.size() / 3);
+            for (size_t i = 0; i < result.frame.landmarks.size(); ++i)
+                result.frame.landmarks[i] = glm::vec3(flat[i * 3].get<float>(), flat[i * 3 + 1].get<float>(), flat[i * 3 + 2].get<float>());
+            result.type = LandmarkMessageType::Frame;
+        }
+        else if (type == "end") {
+            result.requestId = id;
+            result.frameCount = message.value("frames", 0u);
+            result.type = LandmarkMessageType::End;
+        }
+        else if (type == "error") {
+            result.requestId = id;
+            result.error = message.value("message", std::string());
+            result.type = LandmarkMessageType::Error;
+        }
+        else {
+            result.error = "unknown message type: " + type;
+        }
+    } catch (const std::exception& e) {
+        result.type = LandmarkMessageType::Invalid;
+        result.error = e.what();
+    }
+    return result;
+}
+
+bool LandmarkProtocol::loadFramesFromJSON(const std::string& path, std::vector<std::vector<glm::vec3>>& frames)
+{
+    MetricTimer timer(PipelineMetrics::parseSeconds());
+    PipelineMetrics::bytesLoaded().add(PipelineMetrics::fileBytes(path.c_str()));
+    frames.clear();
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "[LandmarkProtocol] Failed to open file: " << path << "\n";
+        return false;
+    }
+
+    try {
+        nlohmann::json data;
+        file >> data;
+        for (const auto& group : data.at("data"))
+        {
+            std::vector<glm::vec3> frame;
+            frame.reserve(group.size());
+            for (const auto& vertex : group)
+                frame.emplace_back(vertex.at("x").get<float>(), vertex.at("y").get<float>(), vertex.at("z").get<float>());
+            frames.push_back(std::move(frame));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[LandmarkProtocol] JSON landmarks data parse error: " << e.what() << "\n";
+        frames.clear();
+        return false;
+    }
+    return true;
+}
+
+bool LineBuffer::nextLine(std::string& line)
+{
+    const size_t newline = m_buffer.find('\n', m_consumed);
+    if (newline == std::string::npos) {
+        // drop the consumed prefix once in a while so the buffer does not grow with the stream
+        if (m_consumed > 0 && m_consumed * 2 >= m_buffer.size()) {
+            m_buffer.erase(0, m_consumed);
+            m_consumed = 0;
+        }
+        return false;
+    }
+    line.assign(m_buffer, m_consumed, newline - m_consumed);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    m_consumed = newline + 1;
+    return true;
+}
@@ -0,0 +1,169 @@
+#include "LandmarkReplayServer.h"
+#include "LandmarkProtocol.h"
+#include "MetricsRegistry.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static bool sendAll(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+LandmarkReplayServer::LandmarkReplayServer(std::vector<std::string> clipFiles, double frameRate)
+    : m_clipFiles(std::move(clipFiles)), m_frameRate(frameRate)
+{
+}
+
+LandmarkReplayServer::~LandmarkReplayServer()
+{
+    stop();
+}
+
+bool LandmarkReplayServer::start(const std::string& socketPath)
+{
+    if (m_running.load()) return false;
+
+    m_frames.clear();
+    for (const auto& clip : m_clipFiles)
+    {
+        std::vector<std::vector<glm::vec3>> frames;
+        if (!LandmarkProtocol::loadFramesFromJSON(clip, frames)) continue;
+        m_frames.insert(m_frames.end(), frames.begin(), frames.end());
+    }
+    if (m_frames.empty()) {
+        std::cerr << "[LandmarkReplayServer] No frame to replay\n";
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "[LandmarkReplayServer] Socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+        std::cerr << "[LandmarkReplayServer] socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    ::unlink(socketPath.c_str());
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(m_listenFd, 8) != 0) {
+        std::cerr << "[LandmarkReplayServer] Cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    m_socketPath = socketPath;
+    m_running.store(true);
+    m_acceptThread = std::thread(&LandmarkReplayServer::acceptLoop, this);
+    std::cout << "[LandmarkReplayServer] Replaying " << m_frames.size() << " frames on " << socketPath << "\n";
+    return true;
+}
+
+void LandmarkReplayServer::stop()
+{
+    if (!m_running.exchange(false)) return;
+
+    // shutdown wakes the blocking accept() and recv() calls
+    ::shutdown(m_listenFd, SHUT_RDWR);
+    if (m_acceptThread.joinable()) m_acceptThread.join();
+    ::close(m_listenFd);
+    m_listenFd = -1;
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        for (int fd : m_clientFds) ::shutdown(fd, SHUT_RDWR);
+        threads.swap(m_clientThreads);
+    }
+    for (auto& thread : threads) thread.join();
+
+    ::unlink(m_socketPath.c_str());
+}
+
+void LandmarkReplayServer::acceptLoop()
+{
+    while (m_running.load())
+    {
+        int clientFd = ::accept(m_listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            if (errno == EINTR) continue;
+            return; // listening socket shut down
+        }
+
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        if (!m_running.load()) {
+            ::close(clientFd);
+            return;
+        }
+        m_clientFds.push_back(clientFd);
+        m_clientThreads.emplace_back(&LandmarkReplayServer::serveClient, this, clientFd);
+    }
+}
+
+void LandmarkReplayServer::serveClient(int clientFd)
+{
+    LineBuffer lines;
+    char chunk[4096];
+    bool open = true;
+    while (open && m_running.load())
+    {
+        ssize_t n = ::recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        lines.append(chunk, static_cast<size_t>(n));
+
+        std::string line;
+        while (open && lines.nextLine(line))
+        {
+            if (line.empty()) continue;
+            LandmarkMessage message = LandmarkProtocol::decode(line);
+            if (message.type != LandmarkMessageType::Request) {
+                const std::string reason = message.type == LandmarkMessageType::Invalid ? message.error : "expected a generate request";
+                open = sendAll(clientFd, LandmarkProtocol::encodeError(message.requestId, reason));
+                continue;
+            }
+            open = replay(clientFd, message.request.id);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    m_clientFds.erase(std::remove(m_clientFds.begin(), m_clientFds.end(), clientFd), m_clientFds.end());
+    ::close(clientFd);
+}
+
+bool LandmarkReplayServer::replay(int clientFd, uint64_t requestId)
+{
+    static MetricCounter& framesSent = MetricsRegistry::global().counter("pixelmux_frames_sent_total", "Frames sent by the replay service");
+    const auto start = std::chrono::steady_clock::now();
+    LandmarkFrame frame;
+    frame.requestId = requestId;
+    for (size_t i = 0; i < m_frames.size(); ++i)
+    {
+        if (!m_running.load()) return false;
+
+        frame.index = static_cast<uint32_t>(i);
+        frame.time = m_frameRate > 0.0 ? static_cast<double>(i) / m_frameRate : 0.0;
+        if (m_frameRate > 0.0) std::this_thread::sleep_until(start + std::chrono::duration<double>(frame.time));
+
+        frame.landmarks = m_frames[i];
+        if (!sendAll(clientFd, LandmarkProtocol::encodeFrame(frame))) return false;
+        framesSent.add();
+    }
+    return sendAll(clientFd, LandmarkProtocol::encodeEnd(requestId, static_cast<uint32_t>(m_frames.size())));
+}
@@ -0,0 +1,180 @@
+#include "LandmarkStreamClient.h"
+#include "MetricsRegistry.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+LandmarkStreamClient::~LandmarkStreamClient()
+{
+    close();
+}
+
+bool LandmarkStreamClient::connect(const std::string& socketPath)
+{
+    if (m_fd >= 0) close();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "[LandmarkStreamClient] Socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "[LandmarkStreamClient] Cannot connect to " << socketPath << ": " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fd = fd;
+        m_streaming = false;
+        m_finished = false;
+        m_error.clear();
+        m_frames.clear();
+    }
+    m_reader = std::thread(&LandmarkStreamClient::readLoop, this);
+    return true;
+}
+
+bool LandmarkStreamClient::request(const LandmarkRequest& request, FrameCallback onFrame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_fd < 0 || m_streaming) return false;
+        m_frames.clear();
+        PipelineMetrics::landmarkQueueDepth().set(0);
+        m_onFrame = std::move(onFrame);
+        m_requestId = request.id;
+        m_received = 0;
+        m_streaming = true;
+        m_finished = false;
+        m_error.clear();
+    }
+
+    const std::string line = LandmarkProtocol::encodeRequest(request);
+    size_t sent = 0;
+    while (sent < line.size())
+    {
+        ssize_t n = ::send(m_fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            finish("failed to send the request");
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool LandmarkStreamClient::nextFrame(LandmarkFrame& frame, int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_frameReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !m_frames.empty() || m_finished; });
+    if (m_frames.empty()) return false;
+    frame = std::move(m_frames.front());
+    m_frames.pop_front();
+    PipelineMetrics::landmarkQueueDepth().set(static_cast<int64_t>(m_frames.size()));
+    return true;
+}
+
+bool LandmarkStreamClient::isFinished() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_finished;
+}
+
+std::string LandmarkStreamClient::error() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+uint32_t LandmarkStreamClient::framesReceived() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_received;
+}
+
+void LandmarkStreamClient::close()
+{
+    if (m_fd < 0) return;
+    // shutdown wakes the reader's recv(), which then reports the lost connection
+    ::shutdown(m_fd, SHUT_RDWR);
+    if (m_reader.joinable()) m_reader.join();
+    ::close(m_fd);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fd = -1;
+}
+
+void LandmarkStreamClient::finish(const std::string& error)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished) return;
+        m_finished = true;
+        m_streaming = false;
+        m_error = error;
+    }
+    m_frameReady.notify_all();
+}
+
+void LandmarkStreamClient::readLoop()
+{
+    LineBuffer lines;
+    char chunk[1 << 16];
+    for (;;)
+    {
+        ssize_t n = ::recv(m_fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            finish("connection closed by the service");
+            return;
+        }
+        lines.append(chunk, static_cast<size_t>(n));
+
+        std::string line;
+        while (lines.nextLine(line))
+        {
+            if (line.empty()) continue;
+            LandmarkMessage message = LandmarkProtocol::decode(line);
+
+            FrameCallback callback;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const uint64_t id = message.type == LandmarkMessageType::Frame ? message.frame.requestId : message.requestId;
+                if (!m_streaming || id != m_requestId) continue; // stale reply of a previous request
+                callback = m_onFrame;
+            }
+
+            switch (message.type)
+            {
+            case LandmarkMessageType::Frame:
+                if (callback) callback(message.frame);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_frames.push_back(std::move(message.frame));
+                    PipelineMetrics::landmarkQueueDepth().set(static_cast<int64_t>(m_frames.size()));
+                    ++m_received;
+                }
+                m_frameReady.notify_all();
+                break;
+            case LandmarkMessageType::End:
+                finish("");
+                break;
+            case LandmarkMessageType::Error:
+                finish(message.error.empty() ? "service error" : message.error);
+                break;
+            default:
+                std::cerr << "[LandmarkStreamClient] Ignoring invalid line: " << message.error << "\n";
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "LaplacianDeformer.h"
+#include <algorithm>
+#include <iostream>
+
+// Keeps the matrix definite on mesh parts without a handle; those parts then simply do not move.
+static constexpr double kRegularization = 1e-6;
+
+bool LaplacianDeformer::setup(const IndexedMesh& mesh, const std::vector<uint32_t>& handles, float handleWeight, int order)
+{
+    if (order != 1 && order != 2) {
+        std::cerr << "[LaplacianDeformer] Unsupported order " << order << "\n";
+        return false;
+    }
+    const size_t n = mesh.vertexCount();
+    for (uint32_t handle : handles) {
+        if (handle >= n) {
+            std::cerr << "[LaplacianDeformer] Handle vertex " << handle << " out of range\n";
+            return false;
+        }
+    }
+
+    m_restVertices = mesh.vertices();
+    m_handles = handles;
+
+    const auto& ringOffsets = mesh.vertexNeighborOffsets();
+    const auto& ring = mesh.vertexNeighbors();
+
+    // row i of the uniform Laplacian: degree on the diagonal, -1 per neighbour
+    auto forEachLaplacian = [&](uint32_t i, auto&& fn) {
+        fn(i, static_cast<double>(ringOffsets[i + 1] - ringOffsets[i]));
+        for (uint32_t k = ringOffsets[i]; k < ringOffsets[i + 1]; ++k) fn(ring[k], -1.0);
+    };
+
+    m_rowOffsets.assign(1, 0);
+    m_columns.clear();
+    m_energyValues.clear();
+    m_diagonal.assign(n, 0);
+
+    std::vector<double> accum(n, 0.0);
+    std::vector<char> used(n, 0);
+    std::vector<uint32_t> rowColumns;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        rowColumns.clear();
+        auto add = [&](uint32_t j, double value) {
+            if (!used[j]) {
+                used[j] = 1;
+                rowColumns.push_back(j);
+            }
+            accum[j] += value;
+        };
+        if (order == 1) {
+            forEachLaplacian(i, add);
+        } else {
+            // L is symmetric, so L^T L = L L and row i is a combination of the rows of its one ring
+            forEachLaplacian(i, [&](uint32_t k, double lik) {
+                forEachLaplacian(k, [&](uint32_t j, double lkj) { add(j, lik * lkj); });
+            });
+        }
+        std::sort(rowColumns.begin(), rowColumns.end());
+        for (uint32_t j : rowColumns)
+        {
+            if (j == i) {
+                m_diagonal[i] = static_cast<uint32_t>(m_columns.size());
+                accum[j] += kRegularization;
+            }
+            m_columns.push_back(j);
+            m_energyValues.push_back(accum[j]);
+            accum[j] = 0.0;
+            used[j] = 0;
+        }
+        m_rowOffsets.push_back(static_cast<uint32_t>(m_columns.size()));
+    }
+
+    if (!m_solver.analyze(n, m_rowOffsets, m_columns)) return false;
+    return setHandleWeight(handleWeight);
+}
+
+bool LaplacianDeformer::setHandleWeight(float handleWeight)
+{
+    if (m_rowOffsets.size() != m_restVertices.size() + 1) return false;
+
+    m_handleWeight = handleWeight;
+    std::vector<double> values = m_energyValues;
+    for (uint32_t handle : m_handles) values[m_diagonal[handle]] += handleWeight;
+    if (!m_solver.factorize(values)) {
+        std::cerr << "[LaplacianDeformer] Factorization failed\n";
+        return false;
+    }
+    std::cout << "[LaplacianDeformer] Factorized " << m_restVertices.size() << " vertices with " << m_handles.size()
+              << " handles (" << m_solver.envelopeSize() << " factor entries)\n";
+    return true;
+}
+
+bool LaplacianDeformer::buildRightHandSides(const std::vector<std::vector<glm::vec3>>& handleTargets, std::vector<double>& rhs) const
+{
+    if (!isReady()) return false;
+    const size_t frameCount = handleTargets.size();
+    const size_t width = frameCount * 3;
+    rhs.assign(m_restVertices.size() * width, 0.0);
+
+    for (size_t f = 0; f < frameCount; ++f)
+    {
+        if (handleTargets[f].size() != m_handles.size()) {
+            std::cerr << "[LaplacianDeformer] Frame " << f << " has " << handleTargets[f].size() << " handle targets, expected "
+                      << m_handles.size() << "\n";
+            return false;
+        }
+        for (size_t h = 0; h < m_handles.size(); ++h)
+        {
+            const glm::vec3 offset = handleTargets[f][h] - m_restVertices[m_handles[h]];
+            double* row = &rhs[m_handles[h] * width + f * 3];
+            row[0] += m_handleWeight * offset.x;
+            row[1] += m_handleWeight * offset.y;
+            row[2] += m_handleWeight * offset.z;
+        }
+    }
+    return true;
+}
+
+bool LaplacianDeformer::deform(const std::vector<glm::vec3>& handleTargets, std::vector<glm::vec3>& vertices) const
+{
+    std::vector<std::vector<glm::vec3>> frames;
+    if (!deformBatch({handleTargets}, frames, 1)) return false;
+    vertices = std::move(frames[0]);
+    return true;
+}
+
+bool LaplacianDeformer::deformBatch(const std::vector<std::vector<glm::vec3>>& handleTargets, std::vector<std::vector<glm::vec3>>& frames,
+                                    unsigned int workerCount) const
+{
+    std::vector<double> rhs;
+    if (!buildRightHandSides(handleTargets, rhs)) return false;
+
+    // x, y and z of every frame are independent right-hand sides of the same factorization
+    const size_t width = handleTargets.size() * 3;
+    if (!m_solver.solve(rhs, width, workerCount)) return false;
+
+    frames.assign(handleTargets.size(), m_restVertices);
+    for (size_t f = 0; f < frames.size(); ++f)
+        for (size_t v = 0; v < m_restVertices.size(); ++v)
+        {
+            const double* d = &rhs[v * width + f * 3];
+            frames[f][v] += glm::vec3(static_cast<float>(d[0]), static_cast<float>(d[1]), static_cast<float>(d[2]));
+        }
+    return true;
+}
@@ -0,0 +1,182 @@
+#include "LinearBlendSkinning.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+bool LinearBlendSkinning::setBindPoses(const std::vector<glm::mat4>& bindPoses)
+{
+    if (bindPoses.empty()) {
+        std::cerr << "[LinearBlendSkinning] The bind pose list is empty\n";
+        return false;
+    }
+
+    m_inverseBindPoses.resize(bindPoses.size());
+    for (size_t j = 0; j < bindPoses.size(); ++j) {
+        m_inverseBindPoses[j] = glm::inverse(bindPoses[j]);
+    }
+    return true;
+}
+
+bool LinearBlendSkinning::setWeights(size_t vertexCount, const std::vector<JointInfluence>& influences)
+{
+    if (m_inverseBindPoses.empty()) {
+        std::cerr << "[LinearBlendSkinning] setBindPoses must be called before setWeights\n";
+        return false;
+    }
+    const int jointCount = static_cast<int>(m_inverseBindPoses.size());
+
+    // collect the strongest influences per vertex in a fixed size slot list
+    std::vector<std::array<JointInfluence, kMaxInfluences>> slots(vertexCount);
+    std::vector<int> slotCount(vertexCount, 0);
+
+    for (const auto& influence : influences)
+    {
+        if (influence.vertexIndex < 0 || influence.vertexIndex >= static_cast<int>(vertexCount) ||
+            influence.jointIndex < 0 || influence.jointIndex >= jointCount) {
+            std::cerr << "[LinearBlendSkinning] Influence out of range: vertex " << influence.vertexIndex
+                      << " joint " << influence.jointIndex << "\n";
+            return false;
+        }
+        if (influence.weight <= 0.0f) continue;
+
+        auto& list = slots[influence.vertexIndex];
+        int& count = slotCount[influence.vertexIndex];
+        if (count < kMaxInfluences) {
+            list[count++] = influence;
+            continue;
+        }
+
+        // replace the weakest kept influence if the new one is stronger
+        auto weakest = std::min_element(list.begin(), list.end(),
+            [](const JointInfluence& a, const JointInfluence& b) { return a.weight < b.weight; });
+        if (weakest->weight < influence.weight) *weakest = influence;
+    }
+
+    m_vertexCount = vertexCount;
+    m_weightJointCount = m_inverseBindPoses.size();
+    m_jointIndices.assign(vertexCount * kMaxInfluences, 0);
+    m_weights.assign(vertexCount * kMaxInfluences, 0.0f);
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < slotCount[v]; ++k) sum += slots[v][k].weight;
+        if (sum <= 0.0f) continue;
+
+        for (int k = 0; k < slotCount[v]; ++k) {
+            m_jointIndices[v * kMaxInfluences + k] = slots[v][k].jointIndex;
+            m_weights[v * kMaxInfluences + k] = slots[v][k].weight / sum;
+        }
+    }
+    return true;
+}
+
+bool LinearBlendSkinning::deform(const std::vector<glm::vec3>& restVertices,
+                                 const std::vector<glm::mat4>& jointTransforms,
+                                 std::vector<glm::vec3>& deformedVertices,
+                                 unsigned int workerCount) const
+{
+    if (m_inverseBindPoses.empty()) {
+        std::cerr << "[LinearBlendSkinning] No bind poses set\n";
+        return false;
+    }
+    if (jointTransforms.size() != m_inverseBindPoses.size()) {
+        std::cerr << "[LinearBlendSkinning] Expected " << m_inverseBindPoses.size()
+                  << " joint transforms, got " << jointTransforms.size() << "\n";
+        return false;
+    }
+    if (m_weightJointCount != m_inverseBindPoses.size()) {
+        // the packed joint indices were checked against the bind poses of setWeights
+        std::cerr << "[LinearBlendSkinning] The weights were set for " << m_weightJointCount
+                  << " joints, the bind pose has " << m_inverseBindPoses.size() << "\n";
+        return false;
+    }
+    if (restVertices.size() != m_vertexCount) {
+        std::cerr << "[LinearBlendSkinning] Expected " << m_vertexCount
+                  << " vertices, got " << restVertices.size() << "\n";
+        return false;
+    }
+
+    // skinning matrices as the top three rows of (joint * inverseBind), row major
+    std::vector<float> skinRows(m_inverseBindPoses.size() * 12);
+    for (size_t j = 0; j < m_inverseBindPoses.size(); ++j)
+    {
+        glm::mat4 skin = jointTransforms[j] * m_inverseBindPoses[j];
+        float* rows = &skinRows[j * 12];
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c)
+                rows[r * 4 + c] = skin[c][r];
+    }
+
+    deformedVertices.resize(m_vertexCount);
+    const float* matrices = skinRows.data();
+    const int* jointIndices = m_jointIndices.data();
+    const float* weights = m_weights.data();
+    const glm::vec3* rest = restVertices.data();
+    glm::vec3* out = deformedVertices.data();
+
+    parallelFor(0, m_vertexCount, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+        {
+            // blend the fixed number of influences; padding entries have zero weight
+            float blended[12] = {0.0f};
+            float weightSum = 0.0f;
+            for (int k = 0; k < kMaxInfluences; ++k)
+            {
+                const float w = weights[v * kMaxInfluences + k];
+                const float* m = matrices + jointIndices[v * kMaxInfluences + k] * 12;
+                for (int e = 0; e < 12; ++e) blended[e] += w * m[e];
+                weightSum += w;
+            }
+
+            // vertices without influences keep their rest position
+            const float restWeight = 1.0f - weightSum;
+            const glm::vec3& p = rest[v];
+            out[v] = glm::vec3(
+                blended[0] * p.x + blended[1] * p.y + blended[2]  * p.z + blended[3],
+                blended[4] * p.x + blended[5] * p.y + blended[6]  * p.z + blended[7],
+                blended[8] * p.x + blended[9] * p.y + blended[10] * p.z + blended[11]) + p * restWeight;
+        }
+    }, workerCount, 1024);
+    return true;
+}
+
+std::vector<JointInfluence> LinearBlendSkinning::computeDistanceWeights(const std::vector<glm::vec3>& vertices,
+                                                                        const std::vector<glm::vec3>& jointPositions,
+                                                                        int maxInfluences)
+{
+    std::vector<JointInfluence> influences;
+    if (jointPositions.empty() || maxInfluences <= 0) return influences;
+
+    const size_t keep = std::min<size_t>(static_cast<size_t>(maxInfluences), jointPositions.size());
+    influences.resize(vertices.size() * keep);
+
+    parallelFor(0, vertices.size(), [&](size_t begin, size_t end) {
+        std::vector<std::pair<float, int>> distances(jointPositions.size());
+        for (size_t v = begin; v < end; ++v)
+        {
+            for (size_t j = 0; j < jointPositions.size(); ++j) {
+                glm::vec3 d = vertices[v] - jointPositions[j];
+                distances[j] = {glm::dot(d, d), static_cast<int>(j)};
+            }
+            std::partial_sort(distances.begin(), distances.begin() + keep, distances.end());
+
+            for (size_t k = 0; k < keep; ++k) {
+                // inverse squared distance, the epsilon keeps a vertex sitting on a joint finite
+                float weight = 1.0f / (distances[k].first + 1e-8f);
+                influences[v * keep + k] = JointInfluence{static_cast<int>(v), distances[k].second, weight};
+            }
+        }
+    }, 0);
+    return influences;
+}
+
+std::vector<glm::mat4> LinearBlendSkinning::translationPoses(const std::vector<glm::vec3>& positions)
+{
+    std::vector<glm::mat4> poses(positions.size(), glm::mat4(1.0f));
+    for (size_t j = 0; j < positions.size(); ++j) {
+        poses[j][3] = glm::vec4(positions[j], 1.0f);
+    }
+    return poses;
+}
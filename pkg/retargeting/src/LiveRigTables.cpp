@@ -0,0 +1,53 @@
+#include "LiveRigTables.h"
+#include <filesystem>
+#include <iostream>
+
+LiveRigTables::LiveRigTables(const RigTableSet& initial)
+{
+    m_tables.store(std::make_shared<const RigTableSet>(initial));
+    m_rig.store(CompiledFaceRig::compile(initial));
+}
+
+LiveRigTables::LiveRigTables(std::shared_ptr<const RigTableSet> tables, std::shared_ptr<const CompiledFaceRig> rig)
+{
+    m_tables.store(std::move(tables));
+    m_rig.store(std::move(rig));
+}
+
+LiveRigTables::~LiveRigTables()
+{
+    m_watcher.stop();
+}
+
+bool LiveRigTables::watch(const std::string& dataDir, ReloadCallback onReload)
+{
+    return m_watcher.start(dataDir, [this, dataDir, onReload](const std::string& fileName) {
+        if (!RigTableSet::isTableFile(fileName)) return;
+        const std::string path = (std::filesystem::path(dataDir) / fileName).string();
+        const bool accepted = reloadFile(fileName, path);
+        if (onReload) onReload(fileName, accepted);
+    });
+}
+
+bool LiveRigTables::reloadFile(const std::string& fileName, const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+
+    // copy of five pointers; only the reloaded table is parsed again
+    RigTableSet next = *m_tables.load();
+    if (!next.reloadTable(fileName, path)) {
+        std::cerr << "[LiveRigTables] Rejected " << fileName << ", keeping the published tables\n";
+        return false;
+    }
+
+    auto rig = CompiledFaceRig::compile(next);
+    if (rig->slotCount() == 0) {
+        std::cerr << "[LiveRigTables] Rejected " << fileName << ": the rig has no AU slot\n";
+        return false;
+    }
+
+    m_tables.store(std::make_shared<const RigTableSet>(std::move(next)));
+    m_rig.store(std::move(rig));
+    std::cout << "[LiveRigTables] Reloaded " << fileName << " (rig version " << m_rig.version() << ")\n";
+    return true;
+}
@@ -0,0 +1,158 @@
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
+#include <array>
+#include <atomic>
+#include <nlohmann/json.hpp>
+
+void MemoryFootprint::add(const std::string& table, size_t bytes)
+{
+    for (MemoryTable& entry : m_tables)
+    {
+        if (entry.name == table)
+        {
+            entry.bytes += bytes;
+            return;
+        }
+    }
+    m_tables.push_back({table, bytes});
+}
+
+void MemoryFootprint::add(const std::string& owner, const MemoryFootprint& nested)
+{
+    for (const MemoryTable& entry : nested.m_tables) add(owner + "." + entry.name, entry.bytes);
+}
+
+size_t MemoryFootprint::bytes(const std::string& table) const
+{
+    for (const MemoryTable& entry : m_tables)
+        if (entry.name == table) return entry.bytes;
+    return 0;
+}
+
+size_t MemoryFootprint::totalBytes() const
+{
+    size_t total = 0;
+    for (const MemoryTable& entry : m_tables) total += entry.bytes;
+    return total;
+}
+
+std::string MemoryFootprint::toJSON() const
+{
+    nlohmann::ordered_json root;
+    root["totalBytes"] = totalBytes();
+    root["tables"] = nlohmann::ordered_json::object();
+    for (const MemoryTable& entry : m_tables) root["tables"][entry.name] = entry.bytes;
+    return root.dump(2);
+}
+
+static constexpr size_t kSubsystemCount = static_cast<size_t>(MemorySubsystem::count);
+
+// Counters are constant initialized, so allocations made before main are charged correctly
+static std::array<std::atomic<int64_t>, kSubsystemCount> s_liveBytes{};
+static std::array<std::atomic<int64_t>, kSubsystemCount> s_peakBytes{};
+static std::array<std::atomic<uint64_t>, kSubsystemCount> s_allocations{};
+static thread_local MemorySubsystem t_subsystem = MemorySubsystem::other;
+static std::atomic<bool> s_installed{false};
+
+bool MemoryTracker::enabled()
+{
+    return s_installed.load(std::memory_order_relaxed);
+}
+
+void MemoryTracker::install() noexcept
+{
+    s_installed.store(true, std::memory_order_relaxed);
+}
+
+void MemoryTracker::charge(MemorySubsystem subsystem, size_t bytes) noexcept
+{
+    const size_t index = static_cast<size_t>(subsystem);
+    const int64_t live = s_liveBytes[index].fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+    int64_t peak = s_peakBytes[index].load(std::memory_order_relaxed);
+    while (live > peak && !s_peakBytes[index].compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    s_allocations[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::release(MemorySubsystem subsystem, size_t bytes) noexcept
+{
+    s_liveBytes[static_cast<size_t>(subsystem)].fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+const char* MemoryTracker::name(MemorySubsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case MemorySubsystem::actionUnit: return "actionUnit";
+        case MemorySubsystem::facialLandmark: return "facialLandmark";
+        case MemorySubsystem::facialMesh: return "facialMesh";
+        case MemorySubsystem::rig: return "rig";
+        case MemorySubsystem::caches: return "caches";
+        case MemorySubsystem::dccInterface: return "dccInterface";
+        default: return "other";
+    }
+}
+
+MemorySubsystem MemoryTracker::current() noexcept
+{
+    return t_subsystem;
+}
+
+MemorySubsystem MemoryTracker::enter(MemorySubsystem subsystem)
+{
+    const MemorySubsystem previous = t_subsystem;
+    t_subsystem = subsystem;
+    return previous;
+}
+
+int64_t MemoryTracker::liveBytes(MemorySubsystem subsystem)
+{
+    return s_liveBytes[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+}
+
+int64_t MemoryTracker::peakBytes(MemorySubsystem subsystem)
+{
+    return s_peakBytes[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryTracker::allocationCount(MemorySubsystem subsystem)
+{
+    return s_allocations[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryTracker::allocationCount()
+{
+    uint64_t total = 0;
+    for (const auto& count : s_allocations) total += count.load(std::memory_order_relaxed);
+    return total;
+}
+
+void MemoryTracker::resetPeaks()
+{
+    for (size_t i = 0; i < kSubsystemCount; ++i)
+        s_peakBytes[i].store(s_liveBytes[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+std::string MemoryTracker::toJSON()
+{
+    nlohmann::ordered_json root;
+    root["enabled"] = enabled();
+    root["subsystems"] = nlohmann::ordered_json::object();
+    for (size_t i = 0; i < kSubsystemCount; ++i)
+    {
+        const MemorySubsystem subsystem = static_cast<MemorySubsystem>(i);
+        root["subsystems"][name(subsystem)] = {{"liveBytes", liveBytes(subsystem)},
+                                               {"peakBytes", peakBytes(subsystem)},
+                                               {"allocations", allocationCount(subsystem)}};
+    }
+    return root.dump(2);
+}
+
+void MemoryTracker::publishMetrics()
+{
+    for (size_t i = 0; i < kSubsystemCount; ++i)
+    {
+        const MemorySubsystem subsystem = static_cast<MemorySubsystem>(i);
+        const std::string metric = std::string("pixelmux_heap_") + name(subsystem) + "_bytes";
+        MetricsRegistry::global().gauge(metric.c_str(), "Live heap bytes of the subsystem (tracking builds)").set(liveBytes(subsystem));
+    }
+}
@@ -0,0 +1,55 @@
+#include "MemoryFootprint.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete of the executable that links it (see MemoryTracker). It is built in
+// the retargeting_alloc_tracking object library, never in retargeting_lib: inside a host such as Maya, freeing a
+// block the host allocated before the plugin loaded would read a header that does not exist.
+#ifdef PIXELMUX_TRACK_ALLOCATIONS
+
+// Every block starts with this header; its size keeps the payload aligned like malloc's
+struct alignas(alignof(std::max_align_t)) AllocationHeader {
+    size_t bytes;                   ///< Payload size
+    MemorySubsystem subsystem;      ///< Charged subsystem
+};
+
+static void* trackedAllocate(size_t bytes) noexcept
+{
+    void* block = std::malloc(sizeof(AllocationHeader) + bytes);
+    if (!block) return nullptr;
+
+    auto* header = static_cast<AllocationHeader*>(block);
+    header->bytes = bytes;
+    header->subsystem = MemoryTracker::current();
+    MemoryTracker::charge(header->subsystem, bytes);
+    return header + 1;
+}
+
+static void trackedFree(void* payload) noexcept
+{
+    if (!payload) return;
+    auto* header = static_cast<AllocationHeader*>(payload) - 1;
+    MemoryTracker::release(header->subsystem, header->bytes);
+    std::free(header);
+}
+
+// blocks allocated before this runs are charged too, enabled() only waits for static initialisation
+[[maybe_unused]] static const bool s_installed = (MemoryTracker::install(), true);
+
+void* operator new(std::size_t size)
+{
+    if (void* p = trackedAllocate(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size ? size : 1); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size ? size : 1); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+
+#endif
@@ -0,0 +1,237 @@
+#include "MeshLODBuilder.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+// Grid cell of a position, 21 bits per axis.
+static uint64_t cellKey(const glm::vec3& p, const glm::vec3& minCorner, float cellSize, uint32_t resolution)
+{
+    uint64_t key = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float cell = std::floor((p[axis] - minCorner[axis]) / cellSize);
+        const uint64_t c = static_cast<uint64_t>(std::clamp(cell, 0.0f, static_cast<float>(resolution)));
+        key |= c << (21 * axis);
+    }
+    return key;
+}
+
+bool MeshLODBuilder::decimate(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& triangles, size_t targetVertexCount,
+                              const std::vector<int>& pinned, MeshLOD& lod)
+{
+    const size_t n = vertices.size();
+    if (n == 0 || triangles.size() % 3 != 0) {
+        std::cerr << "[MeshLODBuilder] Empty mesh or broken triangle list\n";
+        return false;
+    }
+    for (uint32_t v : triangles)
+    {
+        if (v >= n) {
+            std::cerr << "[MeshLODBuilder] Triangle references missing vertex " << v << "\n";
+            return false;
+        }
+    }
+
+    // the bounding box extremes stay so the proxy has the same box as the template
+    std::vector<char> isPinned(n, 0);
+    for (int v : pinned)
+        if (v >= 0 && static_cast<size_t>(v) < n) isPinned[v] = 1;
+    glm::vec3 minCorner = vertices[0];
+    glm::vec3 maxCorner = vertices[0];
+    std::array<size_t, 6> extremes{};
+    for (size_t v = 1; v < n; ++v)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (vertices[v][axis] < minCorner[axis]) { minCorner[axis] = vertices[v][axis]; extremes[axis] = v; }
+            if (vertices[v][axis] > maxCorner[axis]) { maxCorner[axis] = vertices[v][axis]; extremes[3 + axis] = v; }
+        }
+    }
+    for (size_t v : extremes) isPinned[v] = 1;
+    const glm::vec3 extent = maxCorner - minCorner;
+    const float maxExtent = std::max({extent.x, extent.y, extent.z, std::numeric_limits<float>::min()});
+
+    // vertices sorted by cell, pinned vertices first inside a cell
+    std::vector<uint64_t> keys(n);
+    std::vector<uint32_t> order(n);
+    auto sortByCell = [&](uint32_t resolution) {
+        const float cellSize = maxExtent / static_cast<float>(resolution);
+        for (size_t v = 0; v < n; ++v) keys[v] = cellKey(vertices[v], minCorner, cellSize, resolution);
+        for (size_t v = 0; v < n; ++v) order[v] = static_cast<uint32_t>(v);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            if (keys[a] != keys[b]) return keys[a] < keys[b];
+            if (isPinned[a] != isPinned[b]) return isPinned[a] > isPinned[b];
+            return a < b;
+        });
+    };
+    // one proxy vertex per cell, plus one per pinned vertex that shares its cell with another pinned one
+    auto countClusters = [&]() {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const bool newCell = i == 0 || keys[order[i]] != keys[order[i - 1]];
+            if (newCell || isPinned[order[i]]) ++count;
+        }
+        return count;
+    };
+
+    // the finest grid that meets the target (the cluster count grows with the resolution)
+    uint32_t resolution = 1;
+    if (targetVertexCount >= n) {
+        resolution = (1u << 21) - 1;
+    } else {
+        uint32_t low = 1;
+        uint32_t high = (1u << 21) - 1;
+        while (low < high)
+        {
+            const uint32_t mid = low + (high - low + 1) / 2;
+            sortByCell(mid);
+            if (countClusters() <= targetVertexCount) low = mid;
+            else high = mid - 1;
+        }
+        resolution = low;
+    }
+    sortByCell(resolution);
+
+    // collapse every cell into the vertex closest to its mean (or its first pinned vertex)
+    std::vector<uint32_t> clusterSource;
+    std::vector<uint32_t> clusterOf(n);
+    for (size_t begin = 0; begin < n;)
+    {
+        size_t end = begin + 1;
+        while (end < n && keys[order[end]] == keys[order[begin]]) ++end;
+
+        glm::vec3 mean(0.0f);
+        for (size_t i = begin; i < end; ++i) mean += vertices[order[i]];
+        mean /= static_cast<float>(end - begin);
+
+        uint32_t representative = order[begin];
+        if (!isPinned[representative]) {
+            float best = std::numeric_limits<float>::max();
+            for (size_t i = begin; i < end; ++i)
+            {
+                const glm::vec3 d = vertices[order[i]] - mean;
+                const float distance = glm::dot(d, d);
+                if (distance < best) {
+                    best = distance;
+                    representative = order[i];
+                }
+            }
+        }
+        const uint32_t cluster = static_cast<uint32_t>(clusterSource.size());
+        clusterSource.push_back(representative);
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t v = order[i];
+            if (v != representative && isPinned[v]) {
+                clusterOf[v] = static_cast<uint32_t>(clusterSource.size());
+                clusterSource.push_back(v);
+            } else {
+                clusterOf[v] = cluster;
+            }
+        }
+        begin = end;
+    }
+
+    // proxy vertices in template order, which keeps the memory layout of the template
+    std::vector<uint32_t> byTemplate(clusterSource.size());
+    for (uint32_t c = 0; c < byTemplate.size(); ++c) byTemplate[c] = c;
+    std::sort(byTemplate.begin(), byTemplate.end(), [&](uint32_t a, uint32_t b) { return clusterSource[a] < clusterSource[b]; });
+    std::vector<uint32_t> proxyOfCluster(clusterSource.size());
+    lod.sourceVertex.resize(clusterSource.size());
+    lod.vertices.resize(clusterSource.size());
+    for (uint32_t p = 0; p < byTemplate.size(); ++p)
+    {
+        proxyOfCluster[byTemplate[p]] = p;
+        lod.sourceVertex[p] = clusterSource[byTemplate[p]];
+        lod.vertices[p] = vertices[lod.sourceVertex[p]];
+    }
+    lod.clusterOf.resize(n);
+    for (size_t v = 0; v < n; ++v) lod.clusterOf[v] = proxyOfCluster[clusterOf[v]];
+
+    // remapped triangles without the collapsed and repeated ones; the winding is kept
+    std::vector<std::array<uint32_t, 3>> remapped;
+    remapped.reserve(triangles.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t += 3)
+    {
+        std::array<uint32_t, 3> tri = {lod.clusterOf[triangles[t]], lod.clusterOf[triangles[t + 1]], lod.clusterOf[triangles[t + 2]]};
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) continue;
+        std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+        remapped.push_back(tri);
+    }
+    std::sort(remapped.begin(), remapped.end());
+    remapped.erase(std::unique(remapped.begin(), remapped.end()), remapped.end());
+    lod.triangles.clear();
+    lod.triangles.reserve(remapped.size() * 3);
+    for (const auto& tri : remapped) lod.triangles.insert(lod.triangles.end(), tri.begin(), tri.end());
+    return true;
+}
+
+std::vector<MeshLOD> MeshLODBuilder::build(const CompiledFaceRig& rig, const std::vector<glm::vec3>& templateVertices,
+                                           const std::vector<uint32_t>& templateTriangles, const std::string& cacheDir,
+                                           const MeshLODOptions& options)
+{
+    std::vector<float> ratios = options.ratios;
+    std::sort(ratios.begin(), ratios.end(), std::greater<float>());
+    const std::vector<unsigned int> triangles(templateTriangles.begin(), templateTriangles.end());
+
+    std::vector<MeshLOD> levels(ratios.size());
+    for (size_t level = 0; level < ratios.size(); ++level)
+    {
+        MeshLOD& lod = levels[level];
+        lod.ratio = ratios[level];
+        const size_t target = static_cast<size_t>(std::ceil(static_cast<double>(lod.ratio) * static_cast<double>(templateVertices.size())));
+        if (!decimate(templateVertices, templateTriangles, target, rig.landmarksMeshIndex(), lod)) return {};
+
+        // the proxy is a mesh like any user mesh: its correspondence is cached under its own hash
+        const bool mapped = cacheDir.empty()
+            ? lod.correspondence.build(lod.vertices, templateVertices, triangles, options.workerCount)
+            : lod.correspondence.loadOrBuild(cacheDir, lod.vertices, templateVertices, triangles, options.workerCount);
+        if (mapped) lod.rig = rig.resampled(lod.correspondence);
+        if (!lod.rig) {
+            std::cerr << "[MeshLODBuilder] Could not resample the rig onto level " << level << "\n";
+            return {};
+        }
+    }
+    return levels;
+}
+
+bool MeshLODBuilder::place(const MeshLOD& lod, const std::vector<glm::vec3>& meshRest, const TopologyCorrespondence* correspondence,
+                           MeshLODPlacement& placement)
+{
+    const size_t templateCount = correspondence ? correspondence->templateVertexCount() : meshRest.size();
+    const size_t meshCount = correspondence ? correspondence->meshVertexCount() : lod.clusterOf.size();
+    if (meshRest.size() != meshCount || templateCount != lod.clusterOf.size()) {
+        std::cerr << "[MeshLODBuilder] The mesh does not match the template of the level\n";
+        return false;
+    }
+
+    // every proxy vertex is a template vertex: it sits on the closest user mesh vertex
+    std::vector<int> meshVertex(lod.sourceVertex.begin(), lod.sourceVertex.end());
+    if (correspondence) meshVertex = correspondence->remapIndices(meshVertex);
+    placement.rest.resize(lod.vertices.size());
+    for (size_t p = 0; p < lod.vertices.size(); ++p)
+    {
+        if (meshVertex[p] < 0) return false;
+        placement.rest[p] = meshRest[meshVertex[p]];
+    }
+    // the proxy rig deltas are in template units, like CompiledFaceRig::resampled() scales them for user meshes
+    placement.unitScale = correspondence && correspondence->scale() > 0.0f ? 1.0f / correspondence->scale() : 1.0f;
+    return true;
+}
+
+bool MeshLODBuilder::moveProxy(const MeshLOD& lod, const MeshLODPlacement& placement, const std::vector<glm::vec3>& deformedProxy,
+                               std::vector<glm::vec3>& points)
+{
+    if (deformedProxy.size() != lod.vertices.size() || placement.rest.size() != lod.vertices.size()) {
+        std::cerr << "[MeshLODBuilder] Expected " << lod.vertices.size() << " proxy vertices, got " << deformedProxy.size() << "\n";
+        return false;
+    }
+    points.resize(lod.vertices.size());
+    for (size_t p = 0; p < lod.vertices.size(); ++p)
+        points[p] = placement.rest[p] + (deformedProxy[p] - lod.vertices[p]) * placement.unitScale;
+    return true;
+}
@@ -0,0 +1,358 @@
+#include "MetricsRegistry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+void MetricGauge::raisePeak(int64_t value)
+{
+    int64_t peak = m_peak.load(std::memory_order_relaxed);
+    while (value > peak && !m_peak.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {}
+}
+
+void MetricGauge::set(int64_t value)
+{
+    m_value.store(value, std::memory_order_relaxed);
+    raisePeak(value);
+}
+
+void MetricGauge::add(int64_t amount)
+{
+    raisePeak(m_value.fetch_add(amount, std::memory_order_relaxed) + amount);
+}
+
+void MetricGauge::reset()
+{
+    m_value.store(0, std::memory_order_relaxed);
+    m_peak.store(0, std::memory_order_relaxed);
+}
+
+double MetricHistogram::bucketBound(size_t bucket)
+{
+    return bucket < kBucketCount ? std::ldexp(1e-6, static_cast<int>(bucket)) : std::numeric_limits<double>::infinity();
+}
+
+void MetricHistogram::observe(double seconds)
+{
+    if (!(seconds > 0.0)) seconds = 0.0;
+    // bucket i holds (2^(i-1), 2^i] microseconds
+    size_t bucket = 0;
+    const double microseconds = seconds * 1e6;
+    if (microseconds > 1.0) {
+        int exponent = 0;
+        const double mantissa = std::frexp(microseconds, &exponent);
+        bucket = static_cast<size_t>(mantissa == 0.5 ? exponent - 1 : exponent);
+        bucket = std::min(bucket, kBucketCount);
+    }
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumNanoseconds.fetch_add(static_cast<uint64_t>(std::min(seconds * 1e9, 1e18)), std::memory_order_relaxed);
+}
+
+double MetricHistogram::quantile(double q) const
+{
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets) total += bucket.load(std::memory_order_relaxed);
+    if (total == 0) return 0.0;
+
+    const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(total);
+    uint64_t cumulative = 0;
+    for (size_t b = 0; b <= kBucketCount; ++b)
+    {
+        cumulative += m_buckets[b].load(std::memory_order_relaxed);
+        if (static_cast<double>(cumulative) >= rank && cumulative > 0) return bucketBound(std::min(b, kBucketCount - 1));
+    }
+    return bucketBound(kBucketCount - 1);
+}
+
+void MetricHistogram::reset()
+{
+    for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+MetricsRegistry& MetricsRegistry::global()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+static bool validMetricName(const char* name)
+{
+    const size_t length = name ? std::strlen(name) : 0;
+    if (length == 0 || length > MetricsRegistry::kMaxNameLength) return false;
+    for (size_t i = 0; i < length; ++i)
+    {
+        const char c = name[i];
+        const bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+        if (!letter && !(i > 0 && c >= '0' && c <= '9')) return false;
+    }
+    return true;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::find(const char* name, const char* help, MetricKind kind)
+{
+    if (!validMetricName(name)) {
+        std::cerr << "[MetricsRegistry] Invalid metric name: " << (name ? name : "") << "\n";
+        return m_scratch;
+    }
+
+    // FNV-1a, then linear probing; a slot is claimed once and never released
+    uint64_t hash = 1469598103934665603ull;
+    for (const char* c = name; *c; ++c) hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    for (size_t probe = 0; probe < kCapacity; ++probe)
+    {
+        Entry& entry = m_entries[(hash + probe) % kCapacity];
+        int state = entry.state.load(std::memory_order_acquire);
+        if (state == 0) {
+            if (entry.state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+                entry.kind = kind;
+                std::strncpy(entry.name, name, kMaxNameLength);
+                entry.help = help ? help : "";
+                entry.state.store(2, std::memory_order_release);
+                return entry;
+            }
+        }
+        // another thread is registering this slot: it only takes a few stores
+        while ((state = entry.state.load(std::memory_order_acquire)) == 1) std::this_thread::yield();
+        if (std::strcmp(entry.name, name) != 0) continue;
+        if (entry.kind != kind) {
+            std::cerr << "[MetricsRegistry] Metric " << name << " is registered with another type\n";
+            return m_scratch;
+        }
+        return entry;
+    }
+    std::cerr << "[MetricsRegistry] No room left for metric " << name << "\n";
+    return m_scratch;
+}
+
+MetricCounter& MetricsRegistry::counter(const char* name, const char* help)
+{
+    return find(name, help, MetricKind::counter).counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const char* name, const char* help)
+{
+    return find(name, help, MetricKind::gauge).gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const char* name, const char* help)
+{
+    return find(name, help, MetricKind::histogram).histogram;
+}
+
+size_t MetricsRegistry::size() const
+{
+    return static_cast<size_t>(std::count_if(m_entries.begin(), m_entries.end(), [](const Entry& entry) {
+        return entry.state.load(std::memory_order_acquire) == 2;
+    }));
+}
+
+template <typename Fn>
+void MetricsRegistry::forEachSorted(Fn&& fn) const
+{
+    // slots follow the hashes, exports follow the names
+    std::vector<const Entry*> ready;
+    for (const Entry& entry : m_entries)
+        if (entry.state.load(std::memory_order_acquire) == 2) ready.push_back(&entry);
+    std::sort(ready.begin(), ready.end(), [](const Entry* a, const Entry* b) { return std::strcmp(a->name, b->name) < 0; });
+    for (const Entry* entry : ready) fn(*entry);
+}
+
+std::string MetricsRegistry::toJSON() const
+{
+    nlohmann::ordered_json root;
+    root["counters"] = nlohmann::ordered_json::object();
+    root["gauges"] = nlohmann::ordered_json::object();
+    root["histograms"] = nlohmann::ordered_json::object();
+    root["hitRates"] = nlohmann::ordered_json::object();
+
+    static const std::string hitsSuffix = "_hits_total";
+    forEachSorted([&](const Entry& entry) {
+        switch (entry.kind)
+        {
+        case MetricKind::counter:
+            root["counters"][entry.name] = entry.counter.value();
+            break;
+        case MetricKind::gauge:
+            root["gauges"][entry.name] = {{"value", entry.gauge.value()}, {"peak", entry.gauge.peak()}};
+            break;
+        case MetricKind::histogram: {
+            nlohmann::ordered_json buckets = nlohmann::ordered_json::array();
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < MetricHistogram::kBucketCount; ++b)
+            {
+                cumulative += entry.histogram.bucket(b);
+                buckets.push_back({{"le", MetricHistogram::bucketBound(b)}, {"count", cumulative}});
+            }
+            root["histograms"][entry.name] = {
+                {"count", entry.histogram.count()},
+                {"sum", entry.histogram.sum()},
+                {"p50", entry.histogram.quantile(0.5)},
+                {"p95", entry.histogram.quantile(0.95)},
+                {"p99", entry.histogram.quantile(0.99)},
+                {"overflow", entry.histogram.bucket(MetricHistogram::kBucketCount)},
+                {"buckets", buckets}
+            };
+            break;
+        }
+        }
+    });
+
+    // a cache shows up as a pair of counters
+    for (const auto& [name, value] : root["counters"].items())
+    {
+        if (name.size() <= hitsSuffix.size() || name.compare(name.size() - hitsSuffix.size(), hitsSuffix.size(), hitsSuffix) != 0) continue;
+        const std::string cache = name.substr(0, name.size() - hitsSuffix.size());
+        const auto misses = root["counters"].find(cache + "_misses_total");
+        if (misses == root["counters"].end()) continue;
+        const double hits = value.get<double>();
+        const double total = hits + misses->get<double>();
+        root["hitRates"][cache] = total > 0.0 ? hits / total : 0.0;
+    }
+    return root.dump(2);
+}
+
+std::string MetricsRegistry::toPrometheus() const
+{
+    std::ostringstream out;
+    out.precision(9);
+    auto header = [&](const std::string& name, const std::string& help, const char* type) {
+        if (!help.empty()) out << "# HELP " << name << " " << help << "\n";
+        out << "# TYPE " << name << " " << type << "\n";
+    };
+    forEachSorted([&](const Entry& entry) {
+        switch (entry.kind)
+        {
+        case MetricKind::counter:
+            header(entry.name, entry.help, "counter");
+            out << entry.name << " " << entry.counter.value() << "\n";
+            break;
+        case MetricKind::gauge:
+            header(entry.name, entry.help, "gauge");
+            out << entry.name << " " << entry.gauge.value() << "\n";
+            header(std::string(entry.name) + "_peak", entry.help.empty() ? "" : "Peak of " + entry.help, "gauge");
+            out << entry.name << "_peak " << entry.gauge.peak() << "\n";
+            break;
+        case MetricKind::histogram: {
+            header(entry.name, entry.help, "histogram");
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < MetricHistogram::kBucketCount; ++b)
+            {
+                cumulative += entry.histogram.bucket(b);
+                out << entry.name << "_bucket{le=\"" << MetricHistogram::bucketBound(b) << "\"} " << cumulative << "\n";
+            }
+            cumulative += entry.histogram.bucket(MetricHistogram::kBucketCount);
+            out << entry.name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+            out << entry.name << "_sum " << entry.histogram.sum() << "\n";
+            out << entry.name << "_count " << cumulative << "\n";
+            break;
+        }
+        }
+    });
+    return out.str();
+}
+
+bool MetricsRegistry::writeFile(const std::string& path) const
+{
+    const bool json = std::filesystem::path(path).extension() == ".json";
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[MetricsRegistry] Cannot write metrics: " << path << "\n";
+        return false;
+    }
+    file << (json ? toJSON() + "\n" : toPrometheus());
+    return static_cast<bool>(file);
+}
+
+void MetricsRegistry::reset()
+{
+    for (Entry& entry : m_entries)
+    {
+        if (entry.state.load(std::memory_order_acquire) != 2) continue;
+        entry.counter.reset();
+        entry.gauge.reset();
+        entry.histogram.reset();
+    }
+}
+
+MetricCounter& PipelineMetrics::framesProcessed()
+{
+    static MetricCounter& metric = MetricsRegistry::global().counter("pixelmux_frames_processed_total", "Frames evaluated by the plugin");
+    return metric;
+}
+
+MetricCounter& PipelineMetrics::bytesLoaded()
+{
+    static MetricCounter& metric = MetricsRegistry::global().counter("pixelmux_bytes_loaded_total", "Bytes of table, mesh and clip files read");
+    return metric;
+}
+
+MetricHistogram& PipelineMetrics::parseSeconds()
+{
+    static MetricHistogram& metric = MetricsRegistry::global().histogram("pixelmux_parse_seconds", "Parse time of a table, mesh or clip file");
+    return metric;
+}
+
+MetricHistogram& PipelineMetrics::evaluateSeconds()
+{
+    static MetricHistogram& metric = MetricsRegistry::global().histogram("pixelmux_evaluate_seconds", "AU evaluation and solve time of a frame");
+    return metric;
+}
+
+MetricHistogram& PipelineMetrics::deformSeconds()
+{
+    static MetricHistogram& metric = MetricsRegistry::global().histogram("pixelmux_deform_seconds", "Delta accumulation time of a character");
+    return metric;
+}
+
+MetricHistogram& PipelineMetrics::writeSeconds()
+{
+    static MetricHistogram& metric = MetricsRegistry::global().histogram("pixelmux_write_seconds", "Point cache write time of a frame");
+    return metric;
+}
+
+MetricCounter& PipelineMetrics::neutralProfileHits()
+{
+    static MetricCounter& metric = MetricsRegistry::global().counter("pixelmux_neutral_profile_cache_hits_total", "Neutral profiles read from the cache");
+    return metric;
+}
+
+MetricCounter& PipelineMetrics::neutralProfileMisses()
+{
+    static MetricCounter& metric = MetricsRegistry::global().counter("pixelmux_neutral_profile_cache_misses_total", "Neutral profiles computed from the neutral capture");
+    return metric;
+}
+
+MetricCounter& PipelineMetrics::correspondenceHits()
+{
+    static MetricCounter& metric = MetricsRegistry::global().counter("pixelmux_correspondence_cache_hits_total", "Topology correspondences read from a sidecar");
+    return metric;
+}
+
+MetricCounter& PipelineMetrics::correspondenceMisses()
+{
+    static MetricCounter& metric = MetricsRegistry::global().counter("pixelmux_correspondence_cache_misses_total", "Topology correspondences built from scratch");
+    return metric;
+}
+
+MetricGauge& PipelineMetrics::landmarkQueueDepth()
+{
+    static MetricGauge& metric = MetricsRegistry::global().gauge("pixelmux_landmark_queue_depth", "Streamed frames waiting for the plugin");
+    return metric;
+}
+
+uint64_t PipelineMetrics::fileBytes(const char* path)
+{
+    std::error_code error;
+    const uintmax_t size = path ? std::filesystem::file_size(path, error) : 0;
+    return error ? 0 : static_cast<uint64_t>(size);
+}
@@ -0,0 +1,221 @@
+#include "MusclePatchStore.h"
+#include "IndexedMesh.h"
+#include "ParallelUtils.h"
+#include "TopologyCorrespondence.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <nlohmann/json.hpp>
+
+void MusclePatchStore::append(int muscleId, std::vector<uint32_t> vertices)
+{
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    if (!vertices.empty()) m_requiredVertexCount = std::max(m_requiredVertexCount, vertices.back() + 1);
+
+    m_muscleIds.push_back(muscleId);
+    m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+    m_offsets.push_back(static_cast<uint32_t>(m_vertices.size()));
+}
+
+bool MusclePatchStore::build(const std::unordered_map<int, std::vector<int>>& muscleIndexMap)
+{
+    *this = MusclePatchStore();
+
+    std::vector<int> ids;
+    ids.reserve(muscleIndexMap.size());
+    for (const auto& entry : muscleIndexMap) ids.push_back(entry.first);
+    std::sort(ids.begin(), ids.end());
+
+    for (int id : ids)
+    {
+        const std::vector<int>& indices = muscleIndexMap.at(id);
+        if (std::any_of(indices.begin(), indices.end(), [](int index) { return index < 0; })) {
+            std::cerr << "[MusclePatchStore] Muscle " << id << " has a negative vertex index\n";
+            *this = MusclePatchStore();
+            return false;
+        }
+        append(id, std::vector<uint32_t>(indices.begin(), indices.end()));
+    }
+    return true;
+}
+
+bool MusclePatchStore::loadFromJSON(const char* jsonPath)
+{
+    *this = MusclePatchStore();
+
+    std::ifstream file(jsonPath);
+    if (!file.is_open()) {
+        std::cerr << "[MusclePatchStore] Failed to open " << jsonPath << "\n";
+        return false;
+    }
+
+    nlohmann::json data;
+    try {
+        file >> data;
+    } catch (const std::exception& e) {
+        std::cerr << "[MusclePatchStore] JSON parse error: " << e.what() << "\n";
+        return false;
+    }
+    if (!data.is_object()) {
+        std::cerr << "[MusclePatchStore] " << jsonPath << " is not a muscle id to vertex list object\n";
+        return false;
+    }
+
+    std::vector<std::pair<int, std::vector<uint32_t>>> patches;
+    patches.reserve(data.size());
+    for (const auto& [key, value] : data.items())
+    {
+        errno = 0;
+        char* end = nullptr;
+        const long id = std::strtol(key.c_str(), &end, 10);
+        if (key.empty() || *end != '\0' || errno != 0 || id < std::numeric_limits<int>::min() || id > std::numeric_limits<int>::max()) {
+            std::cerr << "[MusclePatchStore] Invalid muscle id \"" << key << "\"\n";
+            return false;
+        }
+        if (!value.is_array()) {
+            std::cerr << "[MusclePatchStore] Muscle " << key << " is not a vertex list\n";
+            return false;
+        }
+
+        std::vector<uint32_t> vertices;
+        vertices.reserve(value.size());
+        for (const auto& index : value)
+        {
+            if (!index.is_number_integer() || index.get<long long>() < 0 || index.get<long long>() > std::numeric_limits<uint32_t>::max()) {
+                std::cerr << "[MusclePatchStore] Muscle " << key << " has an invalid vertex index\n";
+                return false;
+            }
+            vertices.push_back(index.get<uint32_t>());
+        }
+        patches.emplace_back(static_cast<int>(id), std::move(vertices));
+    }
+
+    std::sort(patches.begin(), patches.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < patches.size(); ++i)
+    {
+        // "7" and "07" parse to the same muscle
+        if (i > 0 && patches[i].first == patches[i - 1].first) {
+            std::cerr << "[MusclePatchStore] Muscle " << patches[i].first << " is listed twice\n";
+            *this = MusclePatchStore();
+            return false;
+        }
+        append(patches[i].first, std::move(patches[i].second));
+    }
+    return true;
+}
+
+MusclePatchStore MusclePatchStore::remapped(const TopologyCorrespondence& correspondence) const
+{
+    MusclePatchStore store;
+    for (size_t dense = 0; dense < muscleCount(); ++dense)
+    {
+        const MusclePatch source = patch(dense);
+        std::vector<int> region = correspondence.remapRegion(std::vector<int>(source.vertices, source.vertices + source.size));
+        std::vector<uint32_t> vertices;
+        vertices.reserve(region.size());
+        for (int index : region)
+            if (index >= 0) vertices.push_back(static_cast<uint32_t>(index));
+        store.append(source.muscleId, std::move(vertices));
+    }
+    return store;
+}
+
+int MusclePatchStore::denseIndex(int muscleId) const
+{
+    auto it = std::lower_bound(m_muscleIds.begin(), m_muscleIds.end(), muscleId);
+    if (it == m_muscleIds.end() || *it != muscleId) return -1;
+    return static_cast<int>(it - m_muscleIds.begin());
+}
+
+void MusclePatchStore::gather(size_t dense, const std::vector<glm::vec3>& meshVertices, std::vector<glm::vec3>& out) const
+{
+    out.clear();
+    const MusclePatch source = patch(dense);
+    out.reserve(source.size);
+    for (size_t i = 0; i < source.size; ++i)
+        if (source.vertices[i] < meshVertices.size()) out.push_back(meshVertices[source.vertices[i]]);
+}
+
+bool MusclePatchStore::computeStats(const std::vector<glm::vec3>& meshVertices, unsigned int workerCount)
+{
+    return computeStats(meshVertices, nullptr, workerCount);
+}
+
+bool MusclePatchStore::computeStats(const IndexedMesh& mesh, unsigned int workerCount)
+{
+    return computeStats(mesh.vertices(), &mesh, workerCount);
+}
+
+bool MusclePatchStore::computeStats(const std::vector<glm::vec3>& meshVertices, const IndexedMesh* mesh, unsigned int workerCount)
+{
+    if (meshVertices.size() < m_requiredVertexCount) {
+        std::cerr << "[MusclePatchStore] Mesh has " << meshVertices.size() << " vertices, the patches need " << m_requiredVertexCount << "\n";
+        m_stats.clear();
+        return false;
+    }
+
+    m_stats.assign(muscleCount(), MuscleStats());
+    parallelFor(0, muscleCount(), [&](size_t begin, size_t end) {
+        // patch membership for the edge test; the tag is unique per muscle, so it never needs clearing
+        std::vector<uint32_t> tag(mesh ? meshVertices.size() : 0, 0);
+        for (size_t dense = begin; dense < end; ++dense)
+        {
+            const MusclePatch source = patch(dense);
+            if (source.size == 0) continue;
+            MuscleStats& stats = m_stats[dense];
+
+            glm::vec3 sum(0.0f);
+            stats.boundsMin = stats.boundsMax = meshVertices[source.vertices[0]];
+            for (size_t i = 0; i < source.size; ++i)
+            {
+                const glm::vec3& p = meshVertices[source.vertices[i]];
+                sum += p;
+                stats.boundsMin = glm::min(stats.boundsMin, p);
+                stats.boundsMax = glm::max(stats.boundsMax, p);
+            }
+            stats.centroid = sum / static_cast<float>(source.size);
+
+            float radius = 0.0f;
+            for (size_t i = 0; i < source.size; ++i) radius += glm::length(meshVertices[source.vertices[i]] - stats.centroid);
+            stats.meanRadius = radius / static_cast<float>(source.size);
+
+            if (!mesh) continue;
+            const uint32_t muscleTag = static_cast<uint32_t>(dense + 1);
+            for (size_t i = 0; i < source.size; ++i) tag[source.vertices[i]] = muscleTag;
+
+            const auto& ringOffsets = mesh->vertexNeighborOffsets();
+            const auto& ring = mesh->vertexNeighbors();
+            float lengthSum = 0.0f;
+            for (size_t i = 0; i < source.size; ++i)
+            {
+                const uint32_t u = source.vertices[i];
+                for (uint32_t k = ringOffsets[u]; k < ringOffsets[u + 1]; ++k)
+                {
+                    const uint32_t v = ring[k];
+                    if (v <= u || tag[v] != muscleTag) continue;
+                    const float length = glm::length(meshVertices[v] - meshVertices[u]);
+                    stats.minEdgeLength = stats.edgeCount == 0 ? length : std::min(stats.minEdgeLength, length);
+                    stats.maxEdgeLength = std::max(stats.maxEdgeLength, length);
+                    lengthSum += length;
+                    ++stats.edgeCount;
+                }
+            }
+            if (stats.edgeCount > 0) stats.meanEdgeLength = lengthSum / static_cast<float>(stats.edgeCount);
+        }
+    }, workerCount, 4);
+    return true;
+}
+
+MemoryFootprint MusclePatchStore::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("muscleIds", heapBytes(m_muscleIds));
+    footprint.add("offsets", heapBytes(m_offsets));
+    footprint.add("vertices", heapBytes(m_vertices));
+    footprint.add("stats", heapBytes(m_stats));
+    return footprint;
+}
@@ -0,0 +1,206 @@
+#include "NeutralProfile.h"
+#include "MemoryFootprint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+
+static_assert(sizeof(NeutralProfileHeader) == 24, "NeutralProfileHeader layout changed");
+static_assert(sizeof(NeutralDistance) == 16, "NeutralDistance layout changed");
+
+static const char kNeutralProfileMagic[4] = {'P', 'M', 'X', 'N'};
+static const uint32_t kNeutralProfileVersion = 1;
+
+float NeutralProfile::meanPairDistance(const std::vector<int>& landmarkIndices, const std::vector<glm::vec3>& landmarks)
+{
+    float sum = 0.0f;
+    int pairs = 0;
+    for (size_t i = 0; i + 1 < landmarkIndices.size(); i += 2)
+    {
+        int a = landmarkIndices[i];
+        int b = landmarkIndices[i + 1];
+        if (a < 0 || b < 0 || a >= static_cast<int>(landmarks.size()) || b >= static_cast<int>(landmarks.size())) continue;
+        sum += glm::length(landmarks[a] - landmarks[b]);
+        ++pairs;
+    }
+    return pairs > 0 ? sum / static_cast<float>(pairs) : -1.0f;
+}
+
+bool NeutralProfile::compute(const std::unordered_map<int, std::vector<landmarksActionUnit>>& landmarksAUMap,
+                             const std::vector<glm::vec3>& neutralLandmarks)
+{
+    MemoryScope memory(MemorySubsystem::caches);
+    m_entries.clear();
+    m_landmarks = neutralLandmarks;
+
+    // groups of the same AU and side are pooled, as in CompiledFaceRig
+    std::map<std::pair<int, int>, std::pair<float, uint32_t>> sums;
+    for (const auto& [auId, units] : landmarksAUMap)
+    {
+        for (const auto& unit : units)
+        {
+            if (unit.landmarkIndices.size() % 2 != 0) continue;
+            for (size_t i = 0; i + 1 < unit.landmarkIndices.size(); i += 2)
+            {
+                float d = meanPairDistance({unit.landmarkIndices[i], unit.landmarkIndices[i + 1]}, neutralLandmarks);
+                if (d < 0.0f) continue;
+                auto& sum = sums[{auId, static_cast<int>(unit.side)}];
+                sum.first += d;
+                sum.second += 1;
+            }
+        }
+    }
+    for (const auto& [key, sum] : sums)
+        m_entries.push_back(NeutralDistance{key.first, key.second, sum.first / static_cast<float>(sum.second), sum.second});
+
+    glm::vec3 minCorner(std::numeric_limits<float>::max());
+    glm::vec3 maxCorner(std::numeric_limits<float>::lowest());
+    for (const auto& p : neutralLandmarks) {
+        minCorner = glm::min(minCorner, p);
+        maxCorner = glm::max(maxCorner, p);
+    }
+    m_scale = neutralLandmarks.empty() ? 0.0f : glm::length(maxCorner - minCorner);
+
+    if (m_entries.empty()) {
+        std::cerr << "[NeutralProfile] No AU landmark pair could be measured on the neutral face\n";
+        return false;
+    }
+    std::cout << "[NeutralProfile] Computed neutral distances of " << m_entries.size() << " AU/side pairs\n";
+    return true;
+}
+
+bool NeutralProfile::save(const std::string& path) const
+{
+    if (!isValid()) return false;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[NeutralProfile] Cannot write profile: " << path << "\n";
+        return false;
+    }
+
+    NeutralProfileHeader header{};
+    std::memcpy(header.magic, kNeutralProfileMagic, sizeof(kNeutralProfileMagic));
+    header.version = kNeutralProfileVersion;
+    header.entryCount = static_cast<uint32_t>(m_entries.size());
+    header.landmarkCount = static_cast<uint32_t>(m_landmarks.size());
+    header.scale = m_scale;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_entries.data()), static_cast<std::streamsize>(m_entries.size() * sizeof(NeutralDistance)));
+    file.write(reinterpret_cast<const char*>(m_landmarks.data()), static_cast<std::streamsize>(m_landmarks.size() * sizeof(glm::vec3)));
+    return file.good();
+}
+
+bool NeutralProfile::load(const std::string& path)
+{
+    MemoryScope memory(MemorySubsystem::caches);
+    m_entries.clear();
+    m_landmarks.clear();
+    m_scale = 0.0f;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    NeutralProfileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, kNeutralProfileMagic, sizeof(kNeutralProfileMagic)) != 0 ||
+        header.version != kNeutralProfileVersion) {
+        std::cerr << "[NeutralProfile] Not a neutral profile: " << path << "\n";
+        return false;
+    }
+
+    // the counts come from the file, check them against its length before allocating
+    const uint64_t expectedSize = sizeof(NeutralProfileHeader) + uint64_t(header.entryCount) * sizeof(NeutralDistance) +
+                                  uint64_t(header.landmarkCount) * sizeof(glm::vec3);
+    if (fileSize != expectedSize) {
+        std::cerr << "[NeutralProfile] Neutral profile of " << fileSize << " bytes, expected " << expectedSize << ": " << path << "\n";
+        return false;
+    }
+
+    m_entries.resize(header.entryCount);
+    m_landmarks.resize(header.landmarkCount);
+    file.read(reinterpret_cast<char*>(m_entries.data()), static_cast<std::streamsize>(m_entries.size() * sizeof(NeutralDistance)));
+    file.read(reinterpret_cast<char*>(m_landmarks.data()), static_cast<std::streamsize>(m_landmarks.size() * sizeof(glm::vec3)));
+    if (!file) {
+        std::cerr << "[NeutralProfile] Truncated neutral profile: " << path << "\n";
+        m_entries.clear();
+        m_landmarks.clear();
+        return false;
+    }
+    m_scale = header.scale;
+    return true;
+}
+
+float NeutralProfile::distance(int auId, Side side) const
+{
+    const std::pair<int, int> key{auId, static_cast<int>(side)};
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), key,
+        [](const NeutralDistance& entry, const std::pair<int, int>& k) {
+            return std::make_pair(entry.auId, entry.side) < k;
+        });
+    if (it == m_entries.end() || it->auId != auId || it->side != key.second) return -1.0f;
+    return it->distance;
+}
+
+std::string NeutralProfile::profilePath(const std::string& cacheDir, const std::string& actorKey)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : actorKey) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.pmxn", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(cacheDir) / name).string();
+}
+
+std::string NeutralProfile::profileKey(const std::string& neutralJson,
+                                       const std::unordered_map<int, std::vector<landmarksActionUnit>>& landmarksAUMap)
+{
+    // the capture file path plus its size and modification time identify the actor's neutral frame
+    std::error_code error;
+    auto size = std::filesystem::file_size(neutralJson, error);
+    auto time = std::filesystem::last_write_time(neutralJson, error).time_since_epoch().count();
+
+    // the map is hashed in AU order, hash map iteration order is not stable across builds
+    std::vector<int> auIds;
+    for (const auto& entry : landmarksAUMap) auIds.push_back(entry.first);
+    std::sort(auIds.begin(), auIds.end());
+
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](int64_t value) {
+        for (int byte = 0; byte < 8; ++byte) {
+            hash ^= static_cast<uint64_t>(value >> (byte * 8)) & 0xffu;
+            hash *= 1099511628211ull;
+        }
+    };
+    for (int auId : auIds)
+    {
+        for (const auto& unit : landmarksAUMap.at(auId))
+        {
+            mix(auId);
+            mix(static_cast<int>(unit.side));
+            mix(static_cast<int64_t>(unit.landmarkIndices.size()));
+            for (int index : unit.landmarkIndices) mix(index);
+        }
+    }
+
+    char tables[17];
+    std::snprintf(tables, sizeof(tables), "%016llx", static_cast<unsigned long long>(hash));
+    return neutralJson + "|" + std::to_string(size) + "|" + std::to_string(time) + "|" + tables;
+}
+
+MemoryFootprint NeutralProfile::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("entries", heapBytes(m_entries));
+    footprint.add("landmarks", heapBytes(m_landmarks));
+    return footprint;
+}
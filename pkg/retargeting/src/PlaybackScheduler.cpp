@@ -0,0 +1,248 @@
+#include "PlaybackScheduler.h"
+#include "LandmarkStreamClient.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+
+PlaybackSource PlaybackSource::fromStream(LandmarkStreamClient& client)
+{
+    PlaybackSource source;
+    source.next = [&client](LandmarkFrame& frame, int timeoutMs) { return client.nextFrame(frame, timeoutMs); };
+    source.finished = [&client]() { return client.isFinished(); };
+    return source;
+}
+
+PlaybackSource PlaybackSource::fromClip(std::shared_ptr<const std::vector<LandmarkFrame>> frames)
+{
+    auto cursor = std::make_shared<size_t>(0);
+    PlaybackSource source;
+    source.next = [frames, cursor](LandmarkFrame& frame, int) {
+        if (!frames || *cursor >= frames->size()) return false;
+        frame = (*frames)[(*cursor)++];
+        return true;
+    };
+    source.finished = [frames, cursor]() { return !frames || *cursor >= frames->size(); };
+    return source;
+}
+
+PlaybackClock PlaybackClock::steady()
+{
+    using Clock = std::chrono::steady_clock;
+    PlaybackClock clock;
+    clock.now = []() { return std::chrono::duration<double>(Clock::now().time_since_epoch()).count(); };
+    clock.sleepUntil = [](double time) {
+        std::this_thread::sleep_until(Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(time))));
+    };
+    return clock;
+}
+
+PlaybackScheduler::PlaybackScheduler(std::shared_ptr<const CompiledFaceRig> rig, std::vector<glm::vec3> restVertices, PlaybackOptions options)
+    : m_rig(std::move(rig)), m_restVertices(std::move(restVertices)), m_options(options), m_clock(PlaybackClock::steady())
+{
+}
+
+PlaybackScheduler::~PlaybackScheduler()
+{
+    stop();
+}
+
+bool PlaybackScheduler::run(PlaybackSource source, EvaluateFn evaluate, PresentFn present)
+{
+    if (m_running.exchange(true)) return false;
+    m_stopRequested = false;
+    const bool ok = play(source, evaluate, present);
+    m_running = false;
+    return ok;
+}
+
+bool PlaybackScheduler::start(PlaybackSource source, EvaluateFn evaluate, PresentFn present)
+{
+    if (m_running.exchange(true)) return false;
+    if (m_thread.joinable()) m_thread.join();
+
+    m_stopRequested = false;
+    m_thread = std::thread([this, source = std::move(source), evaluate = std::move(evaluate), present = std::move(present)]() {
+        play(source, evaluate, present);
+        m_running = false;
+    });
+    return true;
+}
+
+void PlaybackScheduler::stop()
+{
+    m_stopRequested = true;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+PlaybackStats PlaybackScheduler::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    PlaybackStats stats = m_stats;
+    stats.latencyP50Ms = m_latency.quantile(0.50);
+    stats.latencyP95Ms = m_latency.quantile(0.95);
+    stats.latencyP99Ms = m_latency.quantile(0.99);
+    stats.latencyMaxMs = m_latency.max();
+    const uint64_t ticks = stats.framesPresented + stats.ticksSkipped;
+    stats.holdsFrameRate = ticks > 0 && static_cast<double>(stats.deadlinesMissed + stats.ticksSkipped) <= m_options.maxMissRatio * static_cast<double>(ticks);
+    return stats;
+}
+
+std::shared_ptr<std::vector<glm::vec3>> PlaybackScheduler::acquireBuffer()
+{
+    // a buffer only the pool references has been released by the presenter
+    for (auto& buffer : m_buffers)
+        if (buffer.use_count() == 1) return buffer;
+    auto buffer = std::make_shared<std::vector<glm::vec3>>(m_restVertices.size());
+    if (m_buffers.size() < 3) m_buffers.push_back(buffer);
+    return buffer;
+}
+
+bool PlaybackScheduler::play(const PlaybackSource& source, const EvaluateFn& evaluate, const PresentFn& present)
+{
+    if (!m_rig || m_restVertices.size() < m_rig->requiredVertexCount() || m_options.frameRate <= 0.0 || !source.next || !evaluate) {
+        std::cerr << "[PlaybackScheduler] Nothing to play: missing rig, rest mesh, frame source or evaluator\n";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats = PlaybackStats();
+        m_latency.clear();
+    }
+
+    auto sourceEnded = [&source]() { return !source.finished || source.finished(); };
+
+    // the clock starts with the first frame, so a slow service start is not counted as missed deadlines
+    LandmarkFrame frame;
+    bool received = false;
+    while (!received && !m_stopRequested.load())
+    {
+        received = source.next(frame, 100);
+        if (!received && sourceEnded()) break;
+    }
+    if (!received) {
+        std::cerr << "[PlaybackScheduler] The source ended before its first frame\n";
+        return false;
+    }
+
+    const size_t slotCount = m_rig->slotCount();
+    const double period = 1.0 / m_options.frameRate;
+    const double clipStart = frame.time;
+    std::deque<LandmarkFrame> pending{std::move(frame)};
+    bool ended = false;
+
+    struct Evaluated {
+        bool valid = false;
+        uint32_t index = 0;
+        double time = 0.0;
+        std::vector<float> weights;
+    };
+    Evaluated before;   // latest frame at or before the tick time
+    Evaluated after;    // interpolate: first frame after the tick time
+    auto evaluateFrame = [&](const LandmarkFrame& sourceFrame, std::vector<float> fallback, Evaluated& out) {
+        out.valid = true;
+        out.index = sourceFrame.index;
+        out.time = sourceFrame.time - clipStart;
+        out.weights.assign(slotCount, 0.0f);
+        if (!evaluate(sourceFrame, out.weights) || out.weights.size() != slotCount) out.weights = fallback;
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.sourceEvaluated;
+    };
+
+    CharacterDeformState state(m_rig, m_restVertices);
+    state.setWorkerCount(m_options.workerCount);
+    std::vector<float> weights(slotCount, 0.0f);
+    PlaybackFrame shown;
+    bool shownInterpolated = false;
+
+    const double t0 = m_clock.now();
+    for (uint64_t tick = 0; !m_stopRequested.load(); ++tick)
+    {
+        const double tickStart = t0 + static_cast<double>(tick) * period;
+        const double deadline = tickStart + period;
+        const double clipTime = static_cast<double>(tick) * period;
+        const double dueTime = clipTime + period * 1e-4; // frames stamped on the tick are due despite rounding
+
+        // pull what has arrived without blocking: the frames due by this tick, plus the next one to interpolate towards
+        while (!ended && (pending.empty() || pending.back().time - clipStart <= dueTime))
+        {
+            if (source.next(frame, 0)) pending.push_back(std::move(frame));
+            else if (sourceEnded()) ended = true;
+            else break;
+        }
+        if (ended && pending.empty() && shown.vertices && !shownInterpolated && shown.sourceIndex == before.index) break;
+
+        if (m_clock.now() >= deadline) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            ++m_stats.ticksSkipped;
+            continue;
+        }
+        m_clock.sleepUntil(tickStart);
+
+        // frames overtaken by a later due frame are never evaluated
+        bool changed = false;
+        while (!pending.empty() && pending.front().time - clipStart <= dueTime)
+        {
+            if (pending.size() > 1 && pending[1].time - clipStart <= dueTime) {
+                if (!(after.valid && after.index == pending.front().index)) {
+                    std::lock_guard<std::mutex> lock(m_statsMutex);
+                    ++m_stats.sourceDropped;
+                }
+                pending.pop_front();
+                continue;
+            }
+            if (after.valid && after.index == pending.front().index) before = std::move(after);
+            else evaluateFrame(pending.front(), before.valid ? before.weights : weights, before);
+            after.valid = false;
+            pending.pop_front();
+            changed = true;
+        }
+
+        float alpha = 0.0f;
+        if (m_options.policy == PlaybackPolicy::interpolate && !pending.empty() && before.valid)
+        {
+            if (!(after.valid && after.index == pending.front().index)) evaluateFrame(pending.front(), before.weights, after);
+            const double span = after.time - before.time;
+            const double offset = clipTime - before.time;
+            if (span > 0.0 && offset > period * 1e-4) alpha = static_cast<float>(std::clamp(offset / span, 0.0, 1.0));
+        }
+
+        PlaybackFrame output;
+        output.tick = tick;
+        output.clipTime = clipTime;
+        output.sourceIndex = before.index;
+        output.interpolated = alpha > 0.0f;
+        if (!changed && !output.interpolated && !shownInterpolated && shown.vertices)
+        {
+            // nothing new to show: present the previous buffer again without deforming
+            output.vertices = shown.vertices;
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            ++m_stats.framesHeld;
+        }
+        else
+        {
+            for (size_t s = 0; s < slotCount; ++s)
+                weights[s] = output.interpolated ? before.weights[s] + (after.weights[s] - before.weights[s]) * alpha : before.weights[s];
+            for (size_t s = 0; s < slotCount; ++s) state.setSlotWeight(s, weights[s]);
+            state.evaluate();
+
+            auto buffer = acquireBuffer();
+            buffer->assign(state.deformedVertices().begin(), state.deformedVertices().end());
+            output.vertices = std::move(buffer);
+        }
+        if (present) present(output);
+        shown = output;
+        shownInterpolated = output.interpolated;
+
+        const double finish = m_clock.now();
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.framesPresented;
+        if (output.interpolated) ++m_stats.framesInterpolated;
+        if (finish > deadline) ++m_stats.deadlinesMissed;
+        m_latency.add((finish - tickStart) * 1000.0);
+        m_stats.elapsedSeconds = finish - t0;
+        m_stats.achievedFrameRate = m_stats.elapsedSeconds > 0.0 ? static_cast<double>(m_stats.framesPresented) / m_stats.elapsedSeconds : 0.0;
+    }
+    return true;
+}
@@ -0,0 +1,306 @@
+#include "PointCache.h"
+#include "MetricsRegistry.h"
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+static_assert(sizeof(PointCacheHeader) == 48, "PointCacheHeader layout changed");
+
+static const char kPointCacheMagic[4] = {'P', 'M', 'X', 'C'};
+static const uint32_t kPointCacheVersion = 1;
+
+static size_t encodedFrameSize(uint32_t vertexCount, uint32_t encoding)
+{
+    size_t componentSize = encoding == static_cast<uint32_t>(PointCacheEncoding::float16) ? sizeof(uint16_t) : sizeof(float);
+    return static_cast<size_t>(vertexCount) * 3 * componentSize;
+}
+
+// Decodes one encoded frame; with accumulate the values are added to out (delta frames)
+static void decodeFrameBytes(const char* bytes, uint32_t vertexCount, uint32_t encoding, glm::vec3* out, bool accumulate)
+{
+    float* components = reinterpret_cast<float*>(out);
+    const size_t count = static_cast<size_t>(vertexCount) * 3;
+
+    if (encoding == static_cast<uint32_t>(PointCacheEncoding::float16))
+    {
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t half;
+            std::memcpy(&half, bytes + i * sizeof(uint16_t), sizeof(uint16_t));
+            float value = halfToFloat(half);
+            components[i] = accumulate ? components[i] + value : value;
+        }
+        return;
+    }
+
+    if (!accumulate) {
+        std::memcpy(components, bytes, count * sizeof(float));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        float value;
+        std::memcpy(&value, bytes + i * sizeof(float), sizeof(float));
+        components[i] += value;
+    }
+}
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t rawExponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (rawExponent == 0xffu) // infinity or NaN
+        return static_cast<uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+
+    int32_t exponent = static_cast<int32_t>(rawExponent) - 127 + 15;
+    if (exponent >= 31) // overflow to infinity
+        return static_cast<uint16_t>(sign | 0x7c00u);
+
+    if (exponent <= 0)
+    {
+        // subnormal half (or zero)
+        if (exponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fffu;
+    // round to nearest even, a carry into the exponent is the correct result
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) ++half;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // normalise the subnormal half
+            int32_t e = 1;
+            while (!(mantissa & 0x400u)) { mantissa <<= 1; --e; }
+            mantissa &= 0x3ffu;
+            bits = sign | (static_cast<uint32_t>(e + 127 - 15) << 23) | (mantissa << 13);
+        }
+    }
+    else if (exponent == 31) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+PointCacheWriter::~PointCacheWriter()
+{
+    if (m_file.is_open()) close();
+}
+
+bool PointCacheWriter::open(const char* path, uint32_t vertexCount, const PointCacheOptions& options)
+{
+    if (m_file.is_open()) close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        std::cerr << "[PointCache] Failed to create file: " << path << "\n";
+        return false;
+    }
+
+    m_header = PointCacheHeader{};
+    std::memcpy(m_header.magic, kPointCacheMagic, sizeof(kPointCacheMagic));
+    m_header.version = kPointCacheVersion;
+    m_header.vertexCount = vertexCount;
+    m_header.encoding = static_cast<uint32_t>(options.encoding);
+    m_header.deltaEncoding = options.deltaEncoding ? 1u : 0u;
+    m_header.framesPerChunk = options.framesPerChunk == 0 ? 1u : options.framesPerChunk;
+    m_header.framesPerSecond = options.framesPerSecond;
+
+    m_frameOffsets.clear();
+    m_previousFrame.assign(vertexCount, glm::vec3(0.0f));
+    m_delta.resize(vertexCount);
+    m_encoded.resize(encodedFrameSize(vertexCount, m_header.encoding));
+
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    return m_file.good();
+}
+
+void PointCacheWriter::encode(const std::vector<glm::vec3>& values)
+{
+    const float* components = reinterpret_cast<const float*>(values.data());
+    const size_t count = values.size() * 3;
+
+    if (m_header.encoding == static_cast<uint32_t>(PointCacheEncoding::float16)) {
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t half = floatToHalf(components[i]);
+            std::memcpy(m_encoded.data() + i * sizeof(uint16_t), &half, sizeof(uint16_t));
+        }
+    } else {
+        std::memcpy(m_encoded.data(), components, count * sizeof(float));
+    }
+}
+
+bool PointCacheWriter::appendFrame(const std::vector<glm::vec3>& vertices)
+{
+    if (!m_file.is_open()) {
+        std::cerr << "[PointCache] appendFrame called on a closed writer\n";
+        return false;
+    }
+    if (vertices.size() != m_header.vertexCount) {
+        std::cerr << "[PointCache] Frame has " << vertices.size() << " vertices, expected " << m_header.vertexCount << "\n";
+        return false;
+    }
+
+    MetricTimer timer(PipelineMetrics::writeSeconds());
+    const uint64_t frame = m_frameOffsets.size();
+    const bool keyFrame = !m_header.deltaEncoding || frame % m_header.framesPerChunk == 0;
+
+    if (keyFrame) {
+        encode(vertices);
+        decodeFrameBytes(m_encoded.data(), m_header.vertexCount, m_header.encoding, m_previousFrame.data(), false);
+    } else {
+        // deltas are taken against the decoded previous frame so quantisation error does not drift
+        for (size_t i = 0; i < vertices.size(); ++i) m_delta[i] = vertices[i] - m_previousFrame[i];
+        encode(m_delta);
+        decodeFrameBytes(m_encoded.data(), m_header.vertexCount, m_header.encoding, m_previousFrame.data(), true);
+    }
+
+    m_frameOffsets.push_back(static_cast<uint64_t>(m_file.tellp()));
+    m_file.write(m_encoded.data(), static_cast<std::streamsize>(m_encoded.size()));
+    return m_file.good();
+}
+
+bool PointCacheWriter::close()
+{
+    if (!m_file.is_open()) return false;
+
+    // the index is 8-byte aligned so the reader can use it in place
+    uint64_t position = static_cast<uint64_t>(m_file.tellp());
+    uint64_t padding = (8 - position % 8) % 8;
+    const char zeros[8] = {0};
+    m_file.write(zeros, static_cast<std::streamsize>(padding));
+
+    m_header.indexOffset = position + padding;
+    m_header.frameCount = m_frameOffsets.size();
+    m_file.write(reinterpret_cast<const char*>(m_frameOffsets.data()),
+                 static_cast<std::streamsize>(m_frameOffsets.size() * sizeof(uint64_t)));
+
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    bool ok = m_file.good();
+    m_file.close();
+
+    std::cout << "[PointCache] Wrote " << m_header.frameCount << " frames of " << m_header.vertexCount << " vertices\n";
+    return ok;
+}
+
+PointCacheReader::~PointCacheReader()
+{
+    close();
+}
+
+void PointCacheReader::close()
+{
+    if (m_data) munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_frameOffsets = nullptr;
+    m_header = PointCacheHeader{};
+}
+
+bool PointCacheReader::open(const char* path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "[PointCache] Failed to open file: " << path << "\n";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(PointCacheHeader)) {
+        std::cerr << "[PointCache] File is too small to be a point cache: " << path << "\n";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "[PointCache] Failed to map file: " << path << "\n";
+        return false;
+    }
+    m_data = static_cast<const char*>(mapping);
+    m_size = static_cast<size_t>(info.st_size);
+
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    const size_t frameSize = encodedFrameSize(m_header.vertexCount, m_header.encoding);
+    const bool valid = std::memcmp(m_header.magic, kPointCacheMagic, sizeof(kPointCacheMagic)) == 0
+        && m_header.version == kPointCacheVersion
+        && m_header.encoding <= static_cast<uint32_t>(PointCacheEncoding::float16)
+        && m_header.framesPerChunk > 0
+        && m_header.indexOffset % 8 == 0
+        && m_header.indexOffset >= sizeof(PointCacheHeader)   // 0 until the writer closes
+        && m_header.indexOffset <= m_size
+        && m_header.frameCount <= (m_size - m_header.indexOffset) / sizeof(uint64_t);
+    if (!valid) {
+        std::cerr << "[PointCache] Invalid or unfinished point cache: " << path << "\n";
+        close();
+        return false;
+    }
+
+    m_frameOffsets = reinterpret_cast<const uint64_t*>(m_data + m_header.indexOffset);
+    for (uint64_t frame = 0; frame < m_header.frameCount; ++frame) {
+        if (m_frameOffsets[frame] + frameSize > m_header.indexOffset) {
+            std::cerr << "[PointCache] Frame " << frame << " points outside the frame data\n";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void PointCacheReader::decode(uint64_t frame, glm::vec3* out, bool accumulate) const
+{
+    decodeFrameBytes(m_data + m_frameOffsets[frame], m_header.vertexCount, m_header.encoding, out, accumulate);
+}
+
+bool PointCacheReader::readFrame(uint64_t frame, std::vector<glm::vec3>& vertices) const
+{
+    if (!m_data || frame >= m_header.frameCount) return false;
+
+    vertices.resize(m_header.vertexCount);
+    if (!m_header.deltaEncoding) {
+        decode(frame, vertices.data(), false);
+        return true;
+    }
+
+    // replay from the chunk key frame, bounded by framesPerChunk
+    uint64_t keyFrame = frame - frame % m_header.framesPerChunk;
+    decode(keyFrame, vertices.data(), false);
+    for (uint64_t f = keyFrame + 1; f <= frame; ++f) decode(f, vertices.data(), true);
+    return true;
+}
@@ -0,0 +1,143 @@
+#include "ProximityWrap.h"
+#include "ParallelUtils.h"
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+// Orthonormal frame of a triangle: tangent along the first edge, normal from the winding.
+// Degenerate triangles fall back to the world axes so the offset is still reproduced.
+static inline void triangleFrame(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+                                 glm::vec3& tangent, glm::vec3& bitangent, glm::vec3& normal)
+{
+    glm::vec3 edge = b - a;
+    glm::vec3 faceNormal = glm::cross(edge, c - a);
+    float edgeLength = glm::length(edge);
+    float normalLength = glm::length(faceNormal);
+    if (edgeLength <= 1e-12f || normalLength <= 1e-12f) {
+        tangent = {1.0f, 0.0f, 0.0f};
+        bitangent = {0.0f, 1.0f, 0.0f};
+        normal = {0.0f, 0.0f, 1.0f};
+        return;
+    }
+    tangent = edge / edgeLength;
+    normal = faceNormal / normalLength;
+    bitangent = glm::cross(normal, tangent);
+}
+
+void ProximityWrap::clear()
+{
+    m_index0.clear(); m_index1.clear(); m_index2.clear();
+    m_weight0.clear(); m_weight1.clear(); m_weight2.clear();
+    m_offsetTangent.clear(); m_offsetBitangent.clear(); m_offsetNormal.clear();
+    m_frameOf.clear(); m_frameTriangles.clear();
+    m_muscleVertexCount = 0;
+}
+
+bool ProximityWrap::bind(const std::vector<glm::vec3>& skinVertices,
+                         const std::vector<glm::vec3>& muscleVertices,
+                         const std::vector<unsigned int>& muscleTriangles,
+                         unsigned int workerCount)
+{
+    clear();
+
+    SurfaceQuery query;
+    if (!query.build(muscleVertices, muscleTriangles)) {
+        std::cerr << "[ProximityWrap] The muscle mesh has no valid triangles to bind to\n";
+        return false;
+    }
+
+    const size_t count = skinVertices.size();
+    m_index0.resize(count); m_index1.resize(count); m_index2.resize(count);
+    m_weight0.resize(count); m_weight1.resize(count); m_weight2.resize(count);
+    m_offsetTangent.resize(count); m_offsetBitangent.resize(count); m_offsetNormal.resize(count);
+    m_frameOf.resize(count);
+
+    std::atomic<size_t> unbound{0};
+    parallelFor(0, count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            SurfaceHit hit = query.closestPoint(skinVertices[i]);
+            if (hit.triangle < 0) { ++unbound; continue; }
+
+            unsigned int i0 = hit.vertexIndices[0];
+            unsigned int i1 = hit.vertexIndices[1];
+            unsigned int i2 = hit.vertexIndices[2];
+
+            glm::vec3 tangent, bitangent, normal;
+            triangleFrame(muscleVertices[i0], muscleVertices[i1], muscleVertices[i2], tangent, bitangent, normal);
+            glm::vec3 offset = skinVertices[i] - hit.point;
+
+            m_index0[i] = i0; m_index1[i] = i1; m_index2[i] = i2;
+            m_frameOf[i] = static_cast<unsigned int>(hit.triangle);
+            m_weight0[i] = hit.barycentric.x; m_weight1[i] = hit.barycentric.y; m_weight2[i] = hit.barycentric.z;
+            m_offsetTangent[i] = glm::dot(offset, tangent);
+            m_offsetBitangent[i] = glm::dot(offset, bitangent);
+            m_offsetNormal[i] = glm::dot(offset, normal);
+        }
+    }, workerCount);
+
+    if (unbound > 0) {
+        std::cerr << "[ProximityWrap] " << unbound << " skin vertices could not be bound\n";
+        clear();
+        return false;
+    }
+
+    // one frame per bound triangle, shared by every skin vertex on it: ids are compacted in triangle order
+    std::vector<int> frameOfTriangle(muscleTriangles.size() / 3, -1);
+    for (size_t i = 0; i < count; ++i) frameOfTriangle[m_frameOf[i]] = 0;
+    unsigned int frameCount = 0;
+    for (size_t t = 0; t < frameOfTriangle.size(); ++t)
+    {
+        if (frameOfTriangle[t] < 0) continue;
+        frameOfTriangle[t] = static_cast<int>(frameCount++);
+        m_frameTriangles.insert(m_frameTriangles.end(), {muscleTriangles[t * 3], muscleTriangles[t * 3 + 1], muscleTriangles[t * 3 + 2]});
+    }
+    for (size_t i = 0; i < count; ++i) m_frameOf[i] = static_cast<unsigned int>(frameOfTriangle[m_frameOf[i]]);
+
+    m_muscleVertexCount = muscleVertices.size();
+    std::cout << "[ProximityWrap] Bound " << count << " skin vertices to " << frameCount << " of " << muscleTriangles.size() / 3
+              << " muscle triangles\n";
+    return true;
+}
+
+bool ProximityWrap::apply(const std::vector<glm::vec3>& deformedMuscleVertices,
+                          std::vector<glm::vec3>& skinVertices,
+                          unsigned int workerCount) const
+{
+    if (!isBound()) return false;
+    if (deformedMuscleVertices.size() != m_muscleVertexCount) {
+        std::cerr << "[ProximityWrap] Muscle buffer has " << deformedMuscleVertices.size()
+                  << " vertices, the binding expects " << m_muscleVertexCount << "\n";
+        return false;
+    }
+
+    skinVertices.resize(m_index0.size());
+    const glm::vec3* muscle = deformedMuscleVertices.data();
+    glm::vec3* skin = skinVertices.data();
+
+    // frames of the bound triangles only, three vectors each, in a buffer reused by the frames of this thread
+    static thread_local std::vector<glm::vec3> frameBuffer;
+    const size_t frameCount = m_frameTriangles.size() / 3;
+    if (frameBuffer.size() < frameCount * 3) frameBuffer.resize(frameCount * 3);
+    glm::vec3* frames = frameBuffer.data();
+    parallelFor(0, frameCount, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f)
+        {
+            const unsigned int* tri = &m_frameTriangles[f * 3];
+            triangleFrame(muscle[tri[0]], muscle[tri[1]], muscle[tri[2]], frames[f * 3], frames[f * 3 + 1], frames[f * 3 + 2]);
+        }
+    }, workerCount, 1024);
+
+    // every skin vertex is then a gather: barycentric point plus the offset in its triangle's frame
+    parallelFor(0, m_index0.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const glm::vec3* frame = frames + m_frameOf[i] * 3;
+            skin[i] = muscle[m_index0[i]] * m_weight0[i] + muscle[m_index1[i]] * m_weight1[i] + muscle[m_index2[i]] * m_weight2[i]
+                    + frame[0] * m_offsetTangent[i]
+                    + frame[1] * m_offsetBitangent[i]
+                    + frame[2] * m_offsetNormal[i];
+        }
+    }, workerCount, 1024);
+    return true;
+}
@@ -0,0 +1,141 @@
+#include "QuantileSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+QuantileSketch::QuantileSketch(double relativeAccuracy, uint32_t maxBuckets)
+{
+    m_relativeAccuracy = std::clamp(relativeAccuracy, 1e-6, 0.5);
+    m_gamma = (1.0 + m_relativeAccuracy) / (1.0 - m_relativeAccuracy);
+    m_logGamma = std::log(m_gamma);
+    m_maxBuckets = std::max<uint32_t>(maxBuckets, 2);
+    // smallest normal double, its key is still far inside the int32 range
+    m_minIndexable = std::numeric_limits<double>::min() * m_gamma;
+}
+
+void QuantileSketch::clear()
+{
+    m_positive = Store();
+    m_negative = Store();
+    m_zeroCount = 0;
+    m_count = 0;
+    m_min = 0.0;
+    m_max = 0.0;
+}
+
+int32_t QuantileSketch::keyOf(double magnitude) const
+{
+    return static_cast<int32_t>(std::ceil(std::log(magnitude) / m_logGamma));
+}
+
+double QuantileSketch::valueOf(int32_t key) const
+{
+    // midpoint of the bucket in the relative error sense
+    return 2.0 * std::pow(m_gamma, key) / (m_gamma + 1.0);
+}
+
+void QuantileSketch::addToStore(Store& store, int32_t key, uint64_t count)
+{
+    if (store.counts.empty()) {
+        store.offset = key;
+        store.counts.assign(1, 0);
+    }
+
+    // keys below the widest allowed window fold into its lowest bucket (smallest magnitudes lose resolution first)
+    int32_t lowest = store.offset;
+    int32_t highest = store.offset + static_cast<int32_t>(store.counts.size()) - 1;
+    const int64_t windowStart = static_cast<int64_t>(highest) - m_maxBuckets + 1;
+    if (key < windowStart) key = static_cast<int32_t>(windowStart);
+
+    if (key < lowest) {
+        store.counts.insert(store.counts.begin(), static_cast<size_t>(lowest - key), 0);
+        store.offset = key;
+    }
+    else if (key > highest) {
+        store.counts.resize(static_cast<size_t>(key - store.offset + 1), 0);
+        if (store.counts.size() > m_maxBuckets) {
+            const size_t excess = store.counts.size() - m_maxBuckets;
+            uint64_t folded = 0;
+            for (size_t i = 0; i <= excess; ++i) folded += store.counts[i];
+            store.counts.erase(store.counts.begin(), store.counts.begin() + static_cast<std::ptrdiff_t>(excess));
+            store.counts[0] = folded;
+            store.offset += static_cast<int32_t>(excess);
+        }
+    }
+
+    store.counts[static_cast<size_t>(key - store.offset)] += count;
+}
+
+void QuantileSketch::add(double value)
+{
+    if (std::isnan(value)) return;
+
+    if (value > m_minIndexable) addToStore(m_positive, keyOf(value), 1);
+    else if (value < -m_minIndexable) addToStore(m_negative, keyOf(-value), 1);
+    else ++m_zeroCount;
+
+    if (m_count == 0) {
+        m_min = value;
+        m_max = value;
+    } else {
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+    ++m_count;
+}
+
+bool QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (other.m_relativeAccuracy != m_relativeAccuracy || other.m_maxBuckets != m_maxBuckets) return false;
+    if (other.m_count == 0) return true;
+
+    // highest keys first so a fold never happens twice for the same buckets
+    for (size_t i = other.m_positive.counts.size(); i-- > 0;)
+        if (other.m_positive.counts[i]) addToStore(m_positive, other.m_positive.offset + static_cast<int32_t>(i), other.m_positive.counts[i]);
+    for (size_t i = other.m_negative.counts.size(); i-- > 0;)
+        if (other.m_negative.counts[i]) addToStore(m_negative, other.m_negative.offset + static_cast<int32_t>(i), other.m_negative.counts[i]);
+    m_zeroCount += other.m_zeroCount;
+
+    if (m_count == 0) {
+        m_min = other.m_min;
+        m_max = other.m_max;
+    } else {
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+    m_count += other.m_count;
+    return true;
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    if (m_count == 0) return 0.0;
+    if (q <= 0.0) return m_min;
+    if (q >= 1.0) return m_max;
+
+    const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(m_count - 1));
+    uint64_t seen = 0;
+    double result = 0.0;
+
+    // negative values from the largest magnitude down, then zero, then positive values upwards
+    bool found = false;
+    for (size_t i = m_negative.counts.size(); i-- > 0 && !found;) {
+        seen += m_negative.counts[i];
+        if (seen > rank) {
+            result = -valueOf(m_negative.offset + static_cast<int32_t>(i));
+            found = true;
+        }
+    }
+    if (!found) {
+        seen += m_zeroCount;
+        if (seen > rank) found = true;
+    }
+    for (size_t i = 0; i < m_positive.counts.size() && !found; ++i) {
+        seen += m_positive.counts[i];
+        if (seen > rank) {
+            result = valueOf(m_positive.offset + static_cast<int32_t>(i));
+            found = true;
+        }
+    }
+    return std::clamp(result, m_min, m_max);
+}
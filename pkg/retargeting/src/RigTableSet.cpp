@@ -0,0 +1,191 @@
+#include "RigTableSet.h"
+#include <iostream>
+
+static const char* kMusclePatchesFile = "musclePatches.json";
+static const char* kDeltaTransferFile = "deltaTransfer.json";
+static const char* kLandmarksMeshIndexFile = "landmarksMeshIndex.json";
+static const char* kLandmarksPixelIndexFile = "landmarksPixelIndex.json";
+static const char* kLandmarksActionUnitsFile = "landmarksActionUnits.json";
+
+static bool validIndexTable(const std::vector<int>& indices, const std::shared_ptr<const std::vector<int>>& other, const std::string& fileName)
+{
+    if (indices.empty()) {
+        std::cerr << "[RigTableSet] " << fileName << " is empty\n";
+        return false;
+    }
+    for (int index : indices) {
+        if (index < 0) {
+            std::cerr << "[RigTableSet] " << fileName << " has a negative index\n";
+            return false;
+        }
+    }
+    // mesh and pixel tables describe the same landmarks, one entry each
+    if (other && !other->empty() && other->size() != indices.size()) {
+        std::cerr << "[RigTableSet] " << fileName << " has " << indices.size() << " landmarks, the other landmark table has " << other->size() << "\n";
+        return false;
+    }
+    return true;
+}
+
+RigTableSet RigTableSet::fromObjects(ActionUnit& actionUnit, FacialLandmark& facialLandmark)
+{
+    RigTableSet set;
+    auto musclePatches = std::make_shared<MusclePatchStore>();
+    musclePatches->build(actionUnit.getMuscleIndexMap());
+    set.musclePatches = std::move(musclePatches);
+    set.auDeltaTable = std::make_shared<const std::unordered_map<int, std::vector<ActionUnitDelta>>>(actionUnit.getAuDeltaTable());
+    set.landmarksMeshIndex = std::make_shared<const std::vector<int>>(facialLandmark.getLandmarksMeshIndex());
+    set.landmarksPixelIndex = std::make_shared<const std::vector<int>>(facialLandmark.getLandmarksPixelIndex());
+    set.landmarksAUMap = std::make_shared<const std::unordered_map<int, std::vector<landmarksActionUnit>>>(facialLandmark.getLandmarksActionUnitMap());
+    set.symmetry = actionUnit.getSymmetryMap();
+    return set;
+}
+
+bool RigTableSet::isTableFile(const std::string& fileName)
+{
+    return fileName == kMusclePatchesFile || fileName == kDeltaTransferFile || fileName == kLandmarksMeshIndexFile ||
+           fileName == kLandmarksPixelIndexFile || fileName == kLandmarksActionUnitsFile;
+}
+
+const std::vector<std::string>& RigTableSet::tableFiles()
+{
+    static const std::vector<std::string> files = {kMusclePatchesFile, kDeltaTransferFile, kLandmarksMeshIndexFile,
+                                                   kLandmarksPixelIndexFile, kLandmarksActionUnitsFile};
+    return files;
+}
+
+void RigTableSet::merge(const RigTableSet& other)
+{
+    if (other.musclePatches) musclePatches = other.musclePatches;
+    if (other.auDeltaTable) {
+        auDeltaTable = other.auDeltaTable;
+        symmetry = other.symmetry;
+    }
+    if (other.landmarksMeshIndex) landmarksMeshIndex = other.landmarksMeshIndex;
+    if (other.landmarksPixelIndex) landmarksPixelIndex = other.landmarksPixelIndex;
+    if (other.landmarksAUMap) landmarksAUMap = other.landmarksAUMap;
+}
+
+bool RigTableSet::validate() const
+{
+    if (landmarksMeshIndex && landmarksPixelIndex && !landmarksMeshIndex->empty() && !landmarksPixelIndex->empty() &&
+        landmarksMeshIndex->size() != landmarksPixelIndex->size()) {
+        std::cerr << "[RigTableSet] " << kLandmarksMeshIndexFile << " has " << landmarksMeshIndex->size() << " landmarks, "
+                  << kLandmarksPixelIndexFile << " has " << landmarksPixelIndex->size() << "\n";
+        return false;
+    }
+    if (landmarksAUMap && landmarksPixelIndex && !landmarksPixelIndex->empty()) {
+        for (const auto& [auId, units] : *landmarksAUMap)
+            for (const auto& unit : units)
+                for (int index : unit.landmarkIndices)
+                    if (index < 0 || static_cast<size_t>(index) >= landmarksPixelIndex->size()) {
+                        std::cerr << "[RigTableSet] " << kLandmarksActionUnitsFile << ": AU " << auId << " uses landmark " << index
+                                  << " outside the " << landmarksPixelIndex->size() << " landmarks\n";
+                        return false;
+                    }
+    }
+    if (auDeltaTable && !symmetry) {
+        for (const auto& [auId, deltaList] : *auDeltaTable)
+            for (const auto& auDelta : deltaList)
+                if (auDelta.mirrored) {
+                    std::cerr << "[RigTableSet] " << kDeltaTransferFile << " mirrors AU " << auId << " but has no symmetry table\n";
+                    return false;
+                }
+    }
+    return true;
+}
+
+bool RigTableSet::reloadTable(const std::string& fileName, const std::string& path)
+{
+    // parse into a scratch loader so a bad file never touches the published tables
+    try {
+        if (fileName == kMusclePatchesFile)
+        {
+            auto table = std::make_shared<MusclePatchStore>();
+            if (!table->loadFromJSON(path.c_str())) return false;
+            if (table->muscleCount() == 0) {
+                std::cerr << "[RigTableSet] " << fileName << " has no muscle\n";
+                return false;
+            }
+            musclePatches = std::move(table);
+            return true;
+        }
+        if (fileName == kDeltaTransferFile)
+        {
+            ActionUnit scratch;
+            scratch.loadDeltaTransfersFromJSON(path.c_str());
+            auto table = scratch.getAuDeltaTable();
+            if (table.empty()) {
+                std::cerr << "[RigTableSet] " << fileName << " has no action unit\n";
+                return false;
+            }
+            for (const auto& [auId, deltaList] : table)
+                for (const auto& auDelta : deltaList)
+                    if (auDelta.mirrored && !scratch.getSymmetryMap()) {
+                        std::cerr << "[RigTableSet] " << fileName << " mirrors AU " << auId << " but has no symmetry table\n";
+                        return false;
+                    }
+            auDeltaTable = std::make_shared<const std::unordered_map<int, std::vector<ActionUnitDelta>>>(std::move(table));
+            symmetry = scratch.getSymmetryMap();
+            return true;
+        }
+        if (fileName == kLandmarksMeshIndexFile)
+        {
+            FacialLandmark scratch;
+            if (!scratch.loadLandmarksMeshIndexFromJSON(path.c_str())) return false;
+            auto table = scratch.getLandmarksMeshIndex();
+            if (!validIndexTable(table, landmarksPixelIndex, fileName)) return false;
+            landmarksMeshIndex = std::make_shared<const std::vector<int>>(std::move(table));
+            return true;
+        }
+        if (fileName == kLandmarksPixelIndexFile)
+        {
+            FacialLandmark scratch;
+            if (!scratch.loadLandmarksPixelIndexFromJSON(path.c_str())) return false;
+            auto table = scratch.getLandmarksPixelIndex();
+            if (!validIndexTable(table, landmarksMeshIndex, fileName)) return false;
+            landmarksPixelIndex = std::make_shared<const std::vector<int>>(std::move(table));
+            return true;
+        }
+        if (fileName == kLandmarksActionUnitsFile)
+        {
+            FacialLandmark scratch;
+            if (!scratch.loadLandmarksActionUnitsMappingFromJson(path.c_str())) return false;
+            auto table = scratch.getLandmarksActionUnitMap();
+            if (table.empty()) {
+                std::cerr << "[RigTableSet] " << fileName << " has no mapping\n";
+                return false;
+            }
+            // landmark indices address the 51-landmark set
+            const size_t landmarkCount = landmarksPixelIndex ? landmarksPixelIndex->size() : 0;
+            for (const auto& [auId, units] : table)
+                for (const auto& unit : units)
+                    for (int index : unit.landmarkIndices)
+                        if (index < 0 || (landmarkCount > 0 && static_cast<size_t>(index) >= landmarkCount)) {
+                            std::cerr << "[RigTableSet] " << fileName << ": AU " << auId << " uses landmark " << index
+                                      << " outside the " << landmarkCount << " landmarks\n";
+                            return false;
+                        }
+            landmarksAUMap = std::make_shared<const std::unordered_map<int, std::vector<landmarksActionUnit>>>(std::move(table));
+            return true;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[RigTableSet] Cannot parse " << path << ": " << e.what() << "\n";
+        return false;
+    }
+
+    std::cerr << "[RigTableSet] Not a rig table: " << fileName << "\n";
+    return false;
+}
+
+MemoryFootprint RigTableSet::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    if (musclePatches) footprint.add("musclePatches", musclePatches->memoryFootprint());
+    if (auDeltaTable) footprint.add("deltaTransfer", auDeltaTableFootprint(*auDeltaTable));
+    if (landmarksMeshIndex) footprint.add("landmarksMeshIndex", heapBytes(*landmarksMeshIndex));
+    if (landmarksPixelIndex) footprint.add("landmarksPixelIndex", heapBytes(*landmarksPixelIndex));
+    if (landmarksAUMap) footprint.add("landmarksActionUnits", landmarksActionUnitMapBytes(*landmarksAUMap));
+    if (symmetry) footprint.add("symmetry", symmetry->memoryFootprint());
+    return footprint;
+}
@@ -0,0 +1,225 @@
+#include "SkylineCholesky.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Breadth-first search from root over unplaced vertices; returns the depth and the vertices of the last level.
+static size_t bfsDepth(uint32_t root, const std::vector<uint32_t>& rowOffsets, const std::vector<uint32_t>& columns,
+                       const std::vector<char>& placed, std::vector<uint32_t>& stamp, uint32_t pass,
+                       std::vector<uint32_t>& lastLevel)
+{
+    std::vector<uint32_t> level{root}, next;
+    stamp[root] = pass;
+    size_t depth = 0;
+    while (true)
+    {
+        next.clear();
+        for (uint32_t v : level)
+            for (uint32_t k = rowOffsets[v]; k < rowOffsets[v + 1]; ++k)
+            {
+                const uint32_t u = columns[k];
+                if (placed[u] || stamp[u] == pass) continue;
+                stamp[u] = pass;
+                next.push_back(u);
+            }
+        if (next.empty()) break;
+        level.swap(next);
+        ++depth;
+    }
+    lastLevel = level;
+    return depth;
+}
+
+// Reverse Cuthill-McKee, one component at a time, each started from a pseudo-peripheral vertex.
+static std::vector<uint32_t> reverseCuthillMcKee(size_t size, const std::vector<uint32_t>& rowOffsets, const std::vector<uint32_t>& columns)
+{
+    std::vector<uint32_t> degree(size);
+    for (size_t v = 0; v < size; ++v) degree[v] = rowOffsets[v + 1] - rowOffsets[v];
+
+    std::vector<uint32_t> order;
+    order.reserve(size);
+    std::vector<char> placed(size, 0);
+    std::vector<uint32_t> stamp(size, 0);
+    uint32_t pass = 0;
+    std::vector<uint32_t> lastLevel, neighbours;
+
+    std::vector<uint32_t> byDegree(size);
+    for (size_t v = 0; v < size; ++v) byDegree[v] = static_cast<uint32_t>(v);
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+
+    for (uint32_t seed : byDegree)
+    {
+        if (placed[seed]) continue;
+
+        // move the root to the far end of the component while that makes the level structure deeper
+        uint32_t root = seed;
+        size_t depth = bfsDepth(root, rowOffsets, columns, placed, stamp, ++pass, lastLevel);
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            uint32_t candidate = *std::min_element(lastLevel.begin(), lastLevel.end(),
+                [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+            std::vector<uint32_t> candidateLevel;
+            size_t candidateDepth = bfsDepth(candidate, rowOffsets, columns, placed, stamp, ++pass, candidateLevel);
+            if (candidateDepth <= depth) break;
+            root = candidate;
+            depth = candidateDepth;
+            lastLevel.swap(candidateLevel);
+        }
+
+        size_t head = order.size();
+        order.push_back(root);
+        placed[root] = 1;
+        while (head < order.size())
+        {
+            const uint32_t v = order[head++];
+            neighbours.clear();
+            for (uint32_t k = rowOffsets[v]; k < rowOffsets[v + 1]; ++k)
+                if (!placed[columns[k]]) {
+                    placed[columns[k]] = 1;
+                    neighbours.push_back(columns[k]);
+                }
+            std::sort(neighbours.begin(), neighbours.end(), [&](uint32_t a, uint32_t b) {
+                return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+            });
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+bool SkylineCholesky::analyze(size_t size, const std::vector<uint32_t>& rowOffsets, const std::vector<uint32_t>& columns)
+{
+    m_factorized = false;
+    if (rowOffsets.size() != size + 1 || rowOffsets.back() != columns.size()) {
+        std::cerr << "[SkylineCholesky] CSR offsets do not match a " << size << " row matrix\n";
+        return false;
+    }
+    for (uint32_t column : columns) {
+        if (column >= size) {
+            std::cerr << "[SkylineCholesky] Column index " << column << " out of range\n";
+            return false;
+        }
+    }
+
+    m_permutation = reverseCuthillMcKee(size, rowOffsets, columns);
+    std::vector<uint32_t> inverse(size);
+    for (size_t i = 0; i < size; ++i) inverse[m_permutation[i]] = static_cast<uint32_t>(i);
+
+    // envelope of each permuted row: from its leftmost nonzero to the diagonal
+    m_firstColumn.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        const uint32_t original = m_permutation[i];
+        uint32_t first = static_cast<uint32_t>(i);
+        for (uint32_t k = rowOffsets[original]; k < rowOffsets[original + 1]; ++k)
+            first = std::min(first, inverse[columns[k]]);
+        m_firstColumn[i] = first;
+    }
+
+    m_rowStart.resize(size + 1);
+    m_rowStart[0] = 0;
+    for (size_t i = 0; i < size; ++i) m_rowStart[i + 1] = m_rowStart[i] + (i - m_firstColumn[i] + 1);
+    m_factor.assign(m_rowStart[size], 0.0);
+
+    m_scatter.assign(columns.size(), -1);
+    for (size_t row = 0; row < size; ++row)
+        for (uint32_t k = rowOffsets[row]; k < rowOffsets[row + 1]; ++k)
+        {
+            const size_t i = inverse[row];
+            const size_t j = inverse[columns[k]];
+            if (j <= i) m_scatter[k] = static_cast<int64_t>(m_rowStart[i] + j - m_firstColumn[i]);
+        }
+    return true;
+}
+
+bool SkylineCholesky::factorize(const std::vector<double>& values)
+{
+    m_factorized = false;
+    if (values.size() != m_scatter.size()) {
+        std::cerr << "[SkylineCholesky] Expected " << m_scatter.size() << " values, got " << values.size() << "\n";
+        return false;
+    }
+
+    std::fill(m_factor.begin(), m_factor.end(), 0.0);
+    for (size_t k = 0; k < values.size(); ++k)
+        if (m_scatter[k] >= 0) m_factor[m_scatter[k]] += values[k];
+
+    // row-oriented (bordering) factorization: each row of L only reads rows above it
+    const size_t n = size();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t fi = m_firstColumn[i];
+        double* rowI = m_factor.data() + m_rowStart[i];
+        for (size_t j = fi; j < i; ++j)
+        {
+            const size_t fj = m_firstColumn[j];
+            const double* rowJ = m_factor.data() + m_rowStart[j];
+            double sum = rowI[j - fi];
+            for (size_t k = std::max(fi, fj); k < j; ++k) sum -= rowI[k - fi] * rowJ[k - fj];
+            rowI[j - fi] = sum / rowJ[j - fj];
+        }
+        double diagonal = rowI[i - fi];
+        for (size_t k = fi; k < i; ++k) diagonal -= rowI[k - fi] * rowI[k - fi];
+        if (!(diagonal > 0.0)) {
+            std::cerr << "[SkylineCholesky] Matrix is not positive definite (pivot " << diagonal << " at row " << m_permutation[i] << ")\n";
+            return false;
+        }
+        rowI[i - fi] = std::sqrt(diagonal);
+    }
+
+    m_factorized = true;
+    return true;
+}
+
+bool SkylineCholesky::solve(std::vector<double>& rhs, size_t rhsCount, unsigned int workerCount) const
+{
+    const size_t n = size();
+    if (!m_factorized || rhs.size() != n * rhsCount) return false;
+
+    // independent right-hand sides, so each thread takes a block of columns
+    parallelFor(0, rhsCount, [&](size_t columnBegin, size_t columnEnd) {
+        const size_t width = columnEnd - columnBegin;
+        std::vector<double> y(n * width);
+        for (size_t i = 0; i < n; ++i)
+            std::copy_n(&rhs[m_permutation[i] * rhsCount + columnBegin], width, &y[i * width]);
+
+        // L y = b
+        for (size_t i = 0; i < n; ++i)
+        {
+            const size_t fi = m_firstColumn[i];
+            const double* row = m_factor.data() + m_rowStart[i];
+            double* yi = &y[i * width];
+            for (size_t k = fi; k < i; ++k)
+            {
+                const double l = row[k - fi];
+                const double* yk = &y[k * width];
+                for (size_t c = 0; c < width; ++c) yi[c] -= l * yk[c];
+            }
+            const double inv = 1.0 / row[i - fi];
+            for (size_t c = 0; c < width; ++c) yi[c] *= inv;
+        }
+
+        // L^T x = y, column-oriented because the factor is stored by rows
+        for (size_t i = n; i-- > 0;)
+        {
+            const size_t fi = m_firstColumn[i];
+            const double* row = m_factor.data() + m_rowStart[i];
+            double* xi = &y[i * width];
+            const double inv = 1.0 / row[i - fi];
+            for (size_t c = 0; c < width; ++c) xi[c] *= inv;
+            for (size_t k = fi; k < i; ++k)
+            {
+                const double l = row[k - fi];
+                double* yk = &y[k * width];
+                for (size_t c = 0; c < width; ++c) yk[c] -= l * xi[c];
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            std::copy_n(&y[i * width], width, &rhs[m_permutation[i] * rhsCount + columnBegin]);
+    }, workerCount, 8);
+    return true;
+}
@@ -0,0 +1,75 @@
+#include "StartupLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+StartupLoader::~StartupLoader()
+{
+    wait();
+}
+
+bool StartupLoader::start(const std::string& dataDir, const std::vector<std::string>& optionalFiles)
+{
+    if (m_rig.valid() && !isFinished()) {
+        std::cerr << "[StartupLoader] A load is already in progress\n";
+        return false;
+    }
+
+    // one parse per file, each into a set of its own: the tables do not share any state while loading
+    m_tables.clear();
+    for (const std::string& fileName : RigTableSet::tableFiles())
+    {
+        StartupTable table;
+        table.fileName = fileName;
+        table.required = std::find(optionalFiles.begin(), optionalFiles.end(), fileName) == optionalFiles.end();
+        const std::string path = (std::filesystem::path(dataDir) / fileName).string();
+        table.result = std::async(std::launch::async, [fileName, path, required = table.required]() {
+            const auto begin = std::chrono::steady_clock::now();
+            StartupTableResult result;
+            if (std::filesystem::exists(path)) {
+                auto parsed = std::make_shared<RigTableSet>();
+                if (parsed->reloadTable(fileName, path)) result.parsed = std::move(parsed);
+            } else if (required) {
+                std::cerr << "[StartupLoader] Missing table " << path << "\n";
+            }
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            return result;
+        }).share();
+        m_tables.push_back(std::move(table));
+    }
+
+    // the merge waits for every parse; the tables are only checked against each other once all are in
+    m_tableSet = std::async(std::launch::async, [tables = m_tables]() -> std::shared_ptr<const RigTableSet> {
+        auto merged = std::make_shared<RigTableSet>();
+        bool complete = true;
+        for (const StartupTable& table : tables)
+        {
+            const StartupTableResult& result = table.result.get();
+            if (result.parsed) merged->merge(*result.parsed);
+            else if (table.required) complete = false;
+        }
+        if (!complete || !merged->validate()) {
+            std::cerr << "[StartupLoader] The data tables are incomplete or inconsistent\n";
+            return nullptr;
+        }
+        return merged;
+    }).share();
+
+    m_rig = std::async(std::launch::async, [tableSet = m_tableSet]() -> std::shared_ptr<const CompiledFaceRig> {
+        const auto tables = tableSet.get();
+        if (!tables) return nullptr;
+        return CompiledFaceRig::compile(*tables);
+    }).share();
+    return true;
+}
+
+bool StartupLoader::isFinished() const
+{
+    return m_rig.valid() && m_rig.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void StartupLoader::wait() const
+{
+    if (m_rig.valid()) m_rig.wait();
+}
@@ -0,0 +1,197 @@
+#include "SurfaceQuery.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool SurfaceQuery::build(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& triangles)
+{
+    m_vertices = vertices;
+    m_triangles.clear();
+    m_triangles.reserve(triangles.size());
+    m_cellStart.clear();
+    m_cellTriangles.clear();
+
+    // drop triangles that reference missing vertices
+    for (size_t t = 0; t + 2 < triangles.size(); t += 3)
+    {
+        if (triangles[t] >= vertices.size() || triangles[t + 1] >= vertices.size() || triangles[t + 2] >= vertices.size()) {
+            std::cerr << "[SurfaceQuery] Skipping triangle " << t / 3 << " with out of range vertex index\n";
+            continue;
+        }
+        m_triangles.insert(m_triangles.end(), {triangles[t], triangles[t + 1], triangles[t + 2]});
+    }
+    m_triangleCount = m_triangles.size() / 3;
+    if (m_triangleCount == 0) return false;
+
+    glm::vec3 minBB(std::numeric_limits<float>::max());
+    glm::vec3 maxBB(-std::numeric_limits<float>::max());
+    float edgeSum = 0.0f;
+    for (size_t t = 0; t < m_triangleCount; ++t)
+    {
+        const glm::vec3& a = m_vertices[m_triangles[3 * t + 0]];
+        const glm::vec3& b = m_vertices[m_triangles[3 * t + 1]];
+        const glm::vec3& c = m_vertices[m_triangles[3 * t + 2]];
+        minBB = glm::min(minBB, glm::min(a, glm::min(b, c)));
+        maxBB = glm::max(maxBB, glm::max(a, glm::max(b, c)));
+        edgeSum += glm::distance(a, b) + glm::distance(b, c) + glm::distance(c, a);
+    }
+
+    // cells roughly twice the average edge length keep a handful of triangles per cell
+    glm::vec3 extent = maxBB - minBB;
+    float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+    float averageEdge = edgeSum / static_cast<float>(3 * m_triangleCount);
+    m_cellSize = std::max(2.0f * averageEdge, maxExtent / 128.0f);
+    if (m_cellSize <= 0.0f) m_cellSize = 1.0f;
+
+    m_origin = minBB;
+    for (int axis = 0; axis < 3; ++axis)
+        m_dims[axis] = std::max(1, static_cast<int>(std::ceil(extent[axis] / m_cellSize)));
+
+    const size_t cellCount = static_cast<size_t>(m_dims[0]) * m_dims[1] * m_dims[2];
+    auto cellRange = [&](size_t t, int lo[3], int hi[3]) {
+        const glm::vec3& a = m_vertices[m_triangles[3 * t + 0]];
+        const glm::vec3& b = m_vertices[m_triangles[3 * t + 1]];
+        const glm::vec3& c = m_vertices[m_triangles[3 * t + 2]];
+        glm::vec3 tMin = glm::min(a, glm::min(b, c));
+        glm::vec3 tMax = glm::max(a, glm::max(b, c));
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = cellCoordinate(tMin[axis], axis);
+            hi[axis] = cellCoordinate(tMax[axis], axis);
+        }
+    };
+
+    // two passes (count, fill) to build the CSR buckets without per-cell vectors
+    m_cellStart.assign(cellCount + 1, 0);
+    for (size_t t = 0; t < m_triangleCount; ++t)
+    {
+        int lo[3], hi[3];
+        cellRange(t, lo, hi);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    ++m_cellStart[(static_cast<size_t>(z) * m_dims[1] + y) * m_dims[0] + x + 1];
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell) m_cellStart[cell + 1] += m_cellStart[cell];
+
+    m_cellTriangles.resize(m_cellStart[cellCount]);
+    std::vector<unsigned int> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t t = 0; t < m_triangleCount; ++t)
+    {
+        int lo[3], hi[3];
+        cellRange(t, lo, hi);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    m_cellTriangles[cursor[(static_cast<size_t>(z) * m_dims[1] + y) * m_dims[0] + x]++] = static_cast<unsigned int>(t);
+    }
+    return true;
+}
+
+int SurfaceQuery::cellCoordinate(float value, int axis) const
+{
+    int cell = static_cast<int>(std::floor((value - m_origin[axis]) / m_cellSize));
+    return std::clamp(cell, 0, m_dims[axis] - 1);
+}
+
+SurfaceHit SurfaceQuery::closestPoint(const glm::vec3& point) const
+{
+    SurfaceHit best;
+    if (m_triangleCount == 0) return best;
+
+    const int center[3] = {cellCoordinate(point.x, 0), cellCoordinate(point.y, 1), cellCoordinate(point.z, 2)};
+    const int maxRing = std::max(m_dims[0], std::max(m_dims[1], m_dims[2]));
+
+    for (int ring = 0; ring <= maxRing; ++ring)
+    {
+        // every cell outside the visited shells is at least ring * cellSize away (the clamp to the grid only moves the point closer)
+        if (best.triangle >= 0 && best.distance <= static_cast<float>(ring - 1) * m_cellSize) break;
+
+        for (int z = center[2] - ring; z <= center[2] + ring; ++z)
+        {
+            if (z < 0 || z >= m_dims[2]) continue;
+            for (int y = center[1] - ring; y <= center[1] + ring; ++y)
+            {
+                if (y < 0 || y >= m_dims[1]) continue;
+                bool onShellYZ = std::abs(z - center[2]) == ring || std::abs(y - center[1]) == ring;
+                // inner cells of the shell were visited by previous rings, only the faces of the cube are new
+                int step = onShellYZ ? 1 : std::max(1, 2 * ring);
+                for (int x = center[0] - ring; x <= center[0] + ring; x += step)
+                {
+                    if (x < 0 || x >= m_dims[0]) continue;
+                    size_t cell = (static_cast<size_t>(z) * m_dims[1] + y) * m_dims[0] + x;
+                    for (unsigned int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+                    {
+                        unsigned int t = m_cellTriangles[i];
+                        glm::vec3 barycentric;
+                        glm::vec3 surfacePoint = closestPointOnTriangle(point,
+                            m_vertices[m_triangles[3 * t + 0]],
+                            m_vertices[m_triangles[3 * t + 1]],
+                            m_vertices[m_triangles[3 * t + 2]],
+                            barycentric);
+                        float distance = glm::distance(point, surfacePoint);
+                        if (distance < best.distance) {
+                            best.triangle = static_cast<int>(t);
+                            best.vertexIndices[0] = m_triangles[3 * t + 0];
+                            best.vertexIndices[1] = m_triangles[3 * t + 1];
+                            best.vertexIndices[2] = m_triangles[3 * t + 2];
+                            best.barycentric = barycentric;
+                            best.point = surfacePoint;
+                            best.distance = distance;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+glm::vec3 SurfaceQuery::closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b,
+                                               const glm::vec3& c, glm::vec3& barycentric)
+{
+    // Voronoi region walk (Ericson, Real-Time Collision Detection 5.1.5)
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) { barycentric = {1.0f, 0.0f, 0.0f}; return a; }
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) { barycentric = {0.0f, 1.0f, 0.0f}; return b; }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        barycentric = {1.0f - v, v, 0.0f};
+        return a + ab * v;
+    }
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) { barycentric = {0.0f, 0.0f, 1.0f}; return c; }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        barycentric = {1.0f - w, 0.0f, w};
+        return a + ac * w;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        barycentric = {0.0f, 1.0f - w, w};
+        return b + (c - b) * w;
+    }
+
+    float denom = va + vb + vc;
+    if (denom == 0.0f) { barycentric = {1.0f, 0.0f, 0.0f}; return a; } // degenerate triangle
+    float v = vb / denom;
+    float w = vc / denom;
+    barycentric = {1.0f - v - w, v, w};
+    return a + ab * v + ac * w;
+}
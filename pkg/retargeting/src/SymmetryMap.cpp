@@ -0,0 +1,228 @@
+#include "SymmetryMap.h"
+#include "MemoryFootprint.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+static_assert(sizeof(SymmetryMapHeader) == 32, "SymmetryMapHeader layout changed");
+
+static const char kSymmetryMapMagic[4] = {'P', 'M', 'X', 'S'};
+static const uint32_t kSymmetryMapVersion = 1;
+
+// every entry in range and every pair mutual
+static bool validMirrorTable(const std::vector<int32_t>& mirror)
+{
+    const int32_t count = static_cast<int32_t>(mirror.size());
+    for (int32_t v = 0; v < count; ++v)
+    {
+        const int32_t m = mirror[v];
+        if (m < -1 || m >= count || (m >= 0 && mirror[m] != v)) return false;
+    }
+    return true;
+}
+
+void SymmetryMap::clear()
+{
+    *this = SymmetryMap();
+}
+
+bool SymmetryMap::build(const std::vector<glm::vec3>& vertices, float tolerance, int axis, unsigned int workerCount)
+{
+    MemoryScope memory(MemorySubsystem::caches);
+    clear();
+    if (vertices.empty() || axis < 0 || axis > 2) {
+        std::cerr << "[SymmetryMap] Cannot build a map of " << vertices.size() << " vertices on axis " << axis << "\n";
+        return false;
+    }
+
+    glm::vec3 boundsMin = vertices[0];
+    glm::vec3 boundsMax = vertices[0];
+    for (const glm::vec3& p : vertices)
+    {
+        boundsMin = glm::min(boundsMin, p);
+        boundsMax = glm::max(boundsMax, p);
+    }
+    const float diagonal = glm::length(boundsMax - boundsMin);
+    const float radius = std::max(tolerance * diagonal, 1e-12f);
+    const float planeOffset = 0.5f * (boundsMin[axis] + boundsMax[axis]);
+
+    // uniform grid with one cell of margin on every side, the reflected points may land just outside the bounds;
+    // cells are at least the radius (so the 27 neighbours cover it) and few enough for the key to fit 64 bits
+    const float cell = std::max(radius, diagonal * 1e-5f);
+    using Cell = std::array<int64_t, 3>;
+    Cell cells;
+    for (int k = 0; k < 3; ++k) cells[k] = static_cast<int64_t>((boundsMax[k] - boundsMin[k]) / cell) + 3;
+    auto cellOf = [&](const glm::vec3& p) {
+        Cell c;
+        for (int k = 0; k < 3; ++k)
+            c[k] = std::clamp<int64_t>(static_cast<int64_t>(std::floor((p[k] - boundsMin[k]) / cell)) + 1, 0, cells[k] - 1);
+        return c;
+    };
+    auto keyOf = [&](const Cell& c) { return static_cast<uint64_t>((c[0] * cells[1] + c[1]) * cells[2] + c[2]); };
+
+    // vertices sorted by cell key: the vertices of one cell are one equal_range
+    std::vector<uint64_t> vertexKey(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) vertexKey[v] = keyOf(cellOf(vertices[v]));
+    std::vector<uint32_t> order(vertices.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return vertexKey[a] != vertexKey[b] ? vertexKey[a] < vertexKey[b] : a < b;
+    });
+    std::vector<uint64_t> sortedKey(order.size());
+    for (size_t i = 0; i < order.size(); ++i) sortedKey[i] = vertexKey[order[i]];
+
+    std::vector<int32_t> closest(vertices.size(), -1);
+    parallelFor(0, vertices.size(), [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+        {
+            glm::vec3 reflected = vertices[v];
+            reflected[axis] = 2.0f * planeOffset - reflected[axis];
+            const Cell center = cellOf(reflected);
+
+            float bestDistance = radius * radius;
+            int32_t best = -1;
+            for (int64_t dx = -1; dx <= 1; ++dx)
+                for (int64_t dy = -1; dy <= 1; ++dy)
+                    for (int64_t dz = -1; dz <= 1; ++dz)
+                    {
+                        const Cell c = {center[0] + dx, center[1] + dy, center[2] + dz};
+                        if (c[0] < 0 || c[1] < 0 || c[2] < 0 || c[0] >= cells[0] || c[1] >= cells[1] || c[2] >= cells[2]) continue;
+                        auto range = std::equal_range(sortedKey.begin(), sortedKey.end(), keyOf(c));
+                        for (auto it = range.first; it != range.second; ++it)
+                        {
+                            const uint32_t candidate = order[it - sortedKey.begin()];
+                            const glm::vec3 d = vertices[candidate] - reflected;
+                            const float distance = glm::dot(d, d);
+                            // ties go to the lower index so the result does not depend on the chunking
+                            if (distance < bestDistance || (distance == bestDistance && best >= 0 && static_cast<int32_t>(candidate) < best)) {
+                                bestDistance = distance;
+                                best = static_cast<int32_t>(candidate);
+                            }
+                        }
+                    }
+            closest[v] = best;
+        }
+    }, workerCount);
+
+    // keep mutual matches only, so the map is an involution
+    m_mirror.assign(vertices.size(), -1);
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        const int32_t m = closest[v];
+        if (m >= 0 && closest[m] == static_cast<int32_t>(v)) {
+            m_mirror[v] = m;
+            ++m_pairedCount;
+        }
+    }
+    m_axis = axis;
+    m_planeOffset = planeOffset;
+    m_tolerance = tolerance;
+    m_meshHash = hashMesh(vertices, tolerance, axis);
+
+    std::cout << "[SymmetryMap] Paired " << m_pairedCount << " of " << vertices.size() << " vertices across axis " << axis << "\n";
+    return true;
+}
+
+bool SymmetryMap::loadOrBuild(const std::vector<glm::vec3>& vertices, const std::string& cachePath, float tolerance, int axis)
+{
+    const uint64_t hash = hashMesh(vertices, tolerance, axis);
+    if (load(cachePath) && m_meshHash == hash && vertexCount() == vertices.size()) {
+        std::cout << "[SymmetryMap] Reusing " << cachePath << "\n";
+        return true;
+    }
+
+    if (!build(vertices, tolerance, axis)) return false;
+    if (!save(cachePath)) std::cerr << "[SymmetryMap] Could not write the cache " << cachePath << "\n";
+    return true;
+}
+
+bool SymmetryMap::assign(std::vector<int32_t> mirror, int axis)
+{
+    clear();
+    if (axis < 0 || axis > 2 || !validMirrorTable(mirror)) {
+        std::cerr << "[SymmetryMap] Invalid mirror table\n";
+        return false;
+    }
+    m_pairedCount = static_cast<size_t>(std::count_if(mirror.begin(), mirror.end(), [](int32_t m) { return m >= 0; }));
+    m_mirror = std::move(mirror);
+    m_axis = axis;
+    return true;
+}
+
+bool SymmetryMap::save(const std::string& path) const
+{
+    if (!isValid()) return false;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    SymmetryMapHeader header{};
+    std::memcpy(header.magic, kSymmetryMapMagic, sizeof(kSymmetryMapMagic));
+    header.version = kSymmetryMapVersion;
+    header.vertexCount = static_cast<uint32_t>(m_mirror.size());
+    header.axis = static_cast<uint32_t>(m_axis);
+    header.planeOffset = m_planeOffset;
+    header.tolerance = m_tolerance;
+    header.meshHash = m_meshHash;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_mirror.data()), static_cast<std::streamsize>(m_mirror.size() * sizeof(int32_t)));
+    return file.good();
+}
+
+bool SymmetryMap::load(const std::string& path)
+{
+    MemoryScope memory(MemorySubsystem::caches);
+    clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    SymmetryMapHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, kSymmetryMapMagic, sizeof(kSymmetryMapMagic)) != 0 ||
+        header.version != kSymmetryMapVersion || header.axis > 2) {
+        std::cerr << "[SymmetryMap] Not a symmetry map: " << path << "\n";
+        return false;
+    }
+
+    std::vector<int32_t> mirror(header.vertexCount);
+    file.read(reinterpret_cast<char*>(mirror.data()), static_cast<std::streamsize>(mirror.size() * sizeof(int32_t)));
+    if (!file || !assign(std::move(mirror), static_cast<int>(header.axis))) {
+        std::cerr << "[SymmetryMap] Truncated or corrupt symmetry map: " << path << "\n";
+        clear();
+        return false;
+    }
+    m_planeOffset = header.planeOffset;
+    m_tolerance = header.tolerance;
+    m_meshHash = header.meshHash;
+    return true;
+}
+
+uint64_t SymmetryMap::hashMesh(const std::vector<glm::vec3>& vertices, float tolerance, int axis)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(vertices.data(), vertices.size() * sizeof(glm::vec3));
+    mix(&tolerance, sizeof(tolerance));
+    mix(&axis, sizeof(axis));
+    return hash;
+}
+
+MemoryFootprint SymmetryMap::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("mirrorTable", heapBytes(m_mirror));
+    return footprint;
+}
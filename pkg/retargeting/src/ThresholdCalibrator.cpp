@@ -0,0 +1,155 @@
+#include "ThresholdCalibrator.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+ThresholdCalibrator::ThresholdCalibrator(std::shared_ptr<const CompiledFaceRig> rig, double relativeAccuracy)
+    : m_rig(std::move(rig))
+{
+    m_sketches.assign(m_rig ? m_rig->slotCount() : 0, QuantileSketch(relativeAccuracy));
+}
+
+float ThresholdCalibrator::slotDistance(const CompiledFaceRig& rig, size_t slot, const std::vector<glm::vec3>& landmarks)
+{
+    const AUSlot& au = rig.slots()[slot];
+    if (au.pairEnd == au.pairBegin) return -1.0f;
+
+    const auto& pairs = rig.landmarkPairs();
+    float sum = 0.0f;
+    for (uint32_t p = au.pairBegin; p < au.pairEnd; ++p)
+    {
+        const uint32_t a = pairs[p * 2];
+        const uint32_t b = pairs[p * 2 + 1];
+        if (a >= landmarks.size() || b >= landmarks.size()) return -1.0f;
+        sum += glm::length(landmarks[a] - landmarks[b]);
+    }
+    return sum / static_cast<float>(au.pairEnd - au.pairBegin);
+}
+
+bool ThresholdCalibrator::addFrame(const std::vector<glm::vec3>& neutralLandmarks, const std::vector<glm::vec3>& currentLandmarks)
+{
+    bool ok = true;
+    for (size_t s = 0; s < m_sketches.size(); ++s)
+    {
+        if (m_rig->slots()[s].pairEnd == m_rig->slots()[s].pairBegin) continue;
+        float neutral = slotDistance(*m_rig, s, neutralLandmarks);
+        float current = slotDistance(*m_rig, s, currentLandmarks);
+        if (neutral < 0.0f || current < 0.0f) {
+            ok = false;
+            continue;
+        }
+        m_sketches[s].add(current - neutral);
+    }
+    return ok;
+}
+
+void ThresholdCalibrator::addSample(size_t slot, float distanceDelta)
+{
+    if (slot < m_sketches.size()) m_sketches[slot].add(distanceDelta);
+}
+
+bool ThresholdCalibrator::merge(const ThresholdCalibrator& other)
+{
+    if (other.m_rig != m_rig || other.m_sketches.size() != m_sketches.size()) {
+        std::cerr << "[ThresholdCalibrator] Cannot merge calibrators built on different rigs\n";
+        return false;
+    }
+    for (size_t s = 0; s < m_sketches.size(); ++s)
+        if (!m_sketches[s].merge(other.m_sketches[s])) return false;
+    return true;
+}
+
+std::vector<AUThreshold> ThresholdCalibrator::computeThresholds(float lowQuantile, float highQuantile, uint64_t minSamples) const
+{
+    std::vector<AUThreshold> thresholds;
+    for (size_t s = 0; s < m_sketches.size(); ++s)
+    {
+        const QuantileSketch& sketch = m_sketches[s];
+        if (sketch.count() == 0 || sketch.count() < minSamples) continue;
+
+        const AUSlot& slot = m_rig->slots()[s];
+        float low = static_cast<float>(sketch.quantile(lowQuantile));
+        float high = static_cast<float>(sketch.quantile(highQuantile));
+        // calculateIntensity divides by the range, keep it open
+        if (high <= low) high = low + std::max(1e-6f, std::abs(low) * 1e-3f);
+        thresholds.push_back(AUThreshold{slot.auId, slot.side, low, high, sketch.count()});
+    }
+    return thresholds;
+}
+
+ThresholdCalibrator ThresholdCalibrator::calibrateFrames(std::shared_ptr<const CompiledFaceRig> rig,
+                                                         const std::vector<glm::vec3>& neutralLandmarks,
+                                                         const std::vector<std::vector<glm::vec3>>& frames,
+                                                         unsigned int workerCount)
+{
+    // a shard of frames maps to its own calibrator and the shards merge as a reduction; the deterministic mode cuts
+    // fixed size shards merged in a fixed tree, because a sketch that folds buckets depends on the order of its inputs
+    return parallelReduce(0, frames.size(), ThresholdCalibrator(rig), [&](size_t first, size_t last) {
+        ThresholdCalibrator shard(rig);
+        for (size_t f = first; f < last; ++f) shard.addFrame(neutralLandmarks, frames[f]);
+        return shard;
+    }, [](ThresholdCalibrator a, const ThresholdCalibrator& b) {
+        a.merge(b);
+        return a;
+    }, workerCount, 256);
+}
+
+bool ThresholdCalibrator::saveCalibration(const char* path, const std::vector<AUThreshold>& thresholds)
+{
+    nlohmann::ordered_json root;
+    root["version"] = 1;
+    root["thresholds"] = nlohmann::ordered_json::array();
+    for (const auto& t : thresholds)
+    {
+        root["thresholds"].push_back({
+            {"auId", t.auId},
+            {"side", sideToString(t.side)},
+            {"min", t.minThreshold},
+            {"max", t.maxThreshold},
+            {"samples", t.sampleCount}
+        });
+    }
+
+    std::ofstream ofs(path);
+    if (!ofs.is_open()) {
+        std::cerr << "[ThresholdCalibrator] Cannot write calibration file: " << path << "\n";
+        return false;
+    }
+    ofs << root.dump(2);
+    std::cout << "[ThresholdCalibrator] Saved thresholds of " << thresholds.size() << " AUs to " << path << "\n";
+    return ofs.good();
+}
+
+bool ThresholdCalibrator::loadCalibration(const char* path, std::vector<AUThreshold>& thresholds)
+{
+    thresholds.clear();
+
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        std::cerr << "[ThresholdCalibrator] Cannot open calibration file: " << path << "\n";
+        return false;
+    }
+
+    nlohmann::json root;
+    try {
+        ifs >> root;
+        for (const auto& entry : root.at("thresholds"))
+        {
+            thresholds.push_back(AUThreshold{
+                entry.at("auId").get<int>(),
+                sideFromString(entry.at("side").get<std::string>()),
+                entry.at("min").get<float>(),
+                entry.at("max").get<float>(),
+                entry.value("samples", static_cast<uint64_t>(0))
+            });
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ThresholdCalibrator] Calibration file parse error: " << e.what() << "\n";
+        thresholds.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,332 @@
+#include "TopologyCorrespondence.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
+#include "ParallelUtils.h"
+#include "SurfaceQuery.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+static_assert(sizeof(TopologyCorrespondenceHeader) == 40, "TopologyCorrespondenceHeader layout changed");
+
+static const char kCorrespondenceMagic[4] = {'P', 'M', 'X', 'T'};
+static const uint32_t kCorrespondenceVersion = 1;
+
+static void boundingBox(const std::vector<glm::vec3>& vertices, glm::vec3& minCorner, glm::vec3& maxCorner)
+{
+    minCorner = glm::vec3(std::numeric_limits<float>::max());
+    maxCorner = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto& v : vertices) {
+        minCorner = glm::min(minCorner, v);
+        maxCorner = glm::max(maxCorner, v);
+    }
+}
+
+void TopologyCorrespondence::clear()
+{
+    m_index.clear();
+    m_weight.clear();
+    m_templateToMesh.clear();
+    m_meshHash = 0;
+    m_templateHash = 0;
+    m_scale = 1.0f;
+}
+
+bool TopologyCorrespondence::build(const std::vector<glm::vec3>& meshVertices,
+                                   const std::vector<glm::vec3>& templateVertices,
+                                   const std::vector<unsigned int>& templateTriangles,
+                                   unsigned int workerCount)
+{
+    MemoryScope memory(MemorySubsystem::caches);
+    clear();
+    if (meshVertices.empty() || templateVertices.empty()) {
+        std::cerr << "[TopologyCorrespondence] Mesh or template has no vertices\n";
+        return false;
+    }
+
+    SurfaceQuery query;
+    if (!query.build(templateVertices, templateTriangles)) {
+        std::cerr << "[TopologyCorrespondence] Failed to build the template surface query\n";
+        return false;
+    }
+
+    // align the user mesh to the template by bounding box centre and diagonal
+    glm::vec3 meshMin, meshMax, templateMin, templateMax;
+    boundingBox(meshVertices, meshMin, meshMax);
+    boundingBox(templateVertices, templateMin, templateMax);
+    const float meshDiagonal = glm::length(meshMax - meshMin);
+    const float templateDiagonal = glm::length(templateMax - templateMin);
+    const float scale = meshDiagonal > 0.0f ? templateDiagonal / meshDiagonal : 1.0f;
+    const glm::vec3 meshCenter = (meshMin + meshMax) * 0.5f;
+    const glm::vec3 templateCenter = (templateMin + templateMax) * 0.5f;
+
+    const size_t meshCount = meshVertices.size();
+    std::vector<glm::vec3> aligned(meshCount);
+    m_index.resize(meshCount * 3);
+    m_weight.resize(meshCount * 3);
+    std::atomic<size_t> failed{0};
+
+    parallelFor(0, meshCount, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+        {
+            aligned[v] = (meshVertices[v] - meshCenter) * scale + templateCenter;
+            SurfaceHit hit = query.closestPoint(aligned[v]);
+            if (hit.triangle < 0) {
+                ++failed;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                m_index[v * 3 + k] = hit.vertexIndices[k];
+                m_weight[v * 3 + k] = hit.barycentric[k];
+            }
+        }
+    }, workerCount);
+
+    if (failed > 0) {
+        std::cerr << "[TopologyCorrespondence] " << failed << " vertices could not be mapped to the template\n";
+        clear();
+        return false;
+    }
+
+    // closest user vertex of each template vertex, first among the vertices that reference it
+    const size_t templateCount = templateVertices.size();
+    const uint32_t unset = std::numeric_limits<uint32_t>::max();
+    m_templateToMesh.assign(templateCount, unset);
+    std::vector<float> bestDistance(templateCount, std::numeric_limits<float>::max());
+    for (size_t v = 0; v < meshCount; ++v)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t t = m_index[v * 3 + k];
+            glm::vec3 d = aligned[v] - templateVertices[t];
+            float distance = glm::dot(d, d);
+            if (distance < bestDistance[t]) {
+                bestDistance[t] = distance;
+                m_templateToMesh[t] = static_cast<uint32_t>(v);
+            }
+        }
+    }
+
+    // template vertices no user vertex maps to (coarser user mesh) fall back to a direct search
+    std::vector<uint32_t> orphans;
+    for (size_t t = 0; t < templateCount; ++t)
+        if (m_templateToMesh[t] == unset) orphans.push_back(static_cast<uint32_t>(t));
+
+    parallelFor(0, orphans.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const glm::vec3& p = templateVertices[orphans[i]];
+            float best = std::numeric_limits<float>::max();
+            uint32_t bestVertex = 0;
+            for (size_t v = 0; v < meshCount; ++v) {
+                glm::vec3 d = aligned[v] - p;
+                float distance = glm::dot(d, d);
+                if (distance < best) {
+                    best = distance;
+                    bestVertex = static_cast<uint32_t>(v);
+                }
+            }
+            m_templateToMesh[orphans[i]] = bestVertex;
+        }
+    }, workerCount, 16);
+
+    m_meshHash = hashVertices(meshVertices);
+    m_templateHash = hashMesh(templateVertices, templateTriangles);
+    m_scale = scale;
+
+    std::cout << "[TopologyCorrespondence] Mapped " << meshCount << " vertices onto a template of "
+              << templateCount << " vertices (scale " << scale << ")\n";
+    return true;
+}
+
+bool TopologyCorrespondence::loadOrBuild(const std::string& cacheDir,
+                                         const std::vector<glm::vec3>& meshVertices,
+                                         const std::vector<glm::vec3>& templateVertices,
+                                         const std::vector<unsigned int>& templateTriangles,
+                                         unsigned int workerCount)
+{
+    const uint64_t meshHash = hashVertices(meshVertices);
+    const uint64_t templateHash = hashMesh(templateVertices, templateTriangles);
+    const std::string path = sidecarPath(cacheDir, meshHash);
+
+    if (std::filesystem::exists(path) && load(path, meshHash, templateHash)) {
+        std::cout << "[TopologyCorrespondence] Loaded cached correspondence: " << path << "\n";
+        PipelineMetrics::correspondenceHits().add();
+        return true;
+    }
+    PipelineMetrics::correspondenceMisses().add();
+
+    if (!build(meshVertices, templateVertices, templateTriangles, workerCount)) return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDir, error);
+    if (!save(path)) {
+        // the map is still usable, it is just rebuilt next time
+        std::cerr << "[TopologyCorrespondence] Could not write the correspondence cache: " << path << "\n";
+    }
+    return true;
+}
+
+bool TopologyCorrespondence::save(const std::string& path) const
+{
+    if (!isValid()) return false;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    TopologyCorrespondenceHeader header{};
+    std::memcpy(header.magic, kCorrespondenceMagic, sizeof(kCorrespondenceMagic));
+    header.version = kCorrespondenceVersion;
+    header.meshVertexCount = static_cast<uint32_t>(meshVertexCount());
+    header.templateVertexCount = static_cast<uint32_t>(templateVertexCount());
+    header.meshHash = m_meshHash;
+    header.templateHash = m_templateHash;
+    header.scale = m_scale;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_index.data()), static_cast<std::streamsize>(m_index.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(m_weight.data()), static_cast<std::streamsize>(m_weight.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(m_templateToMesh.data()),
+               static_cast<std::streamsize>(m_templateToMesh.size() * sizeof(uint32_t)));
+    return file.good();
+}
+
+bool TopologyCorrespondence::load(const std::string& path, uint64_t meshHash, uint64_t templateHash)
+{
+    MemoryScope memory(MemorySubsystem::caches);
+    clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    TopologyCorrespondenceHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, kCorrespondenceMagic, sizeof(kCorrespondenceMagic)) != 0 ||
+        header.version != kCorrespondenceVersion) {
+        std::cerr << "[TopologyCorrespondence] Not a correspondence file: " << path << "\n";
+        return false;
+    }
+    if (header.meshHash != meshHash || header.templateHash != templateHash) {
+        std::cerr << "[TopologyCorrespondence] Cached correspondence was built for other meshes: " << path << "\n";
+        return false;
+    }
+
+    m_index.resize(static_cast<size_t>(header.meshVertexCount) * 3);
+    m_weight.resize(static_cast<size_t>(header.meshVertexCount) * 3);
+    m_templateToMesh.resize(header.templateVertexCount);
+    file.read(reinterpret_cast<char*>(m_index.data()), static_cast<std::streamsize>(m_index.size() * sizeof(uint32_t)));
+    file.read(reinterpret_cast<char*>(m_weight.data()), static_cast<std::streamsize>(m_weight.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(m_templateToMesh.data()),
+              static_cast<std::streamsize>(m_templateToMesh.size() * sizeof(uint32_t)));
+
+    bool valid = static_cast<bool>(file);
+    for (size_t i = 0; valid && i < m_index.size(); ++i) valid = m_index[i] < header.templateVertexCount;
+    for (size_t i = 0; valid && i < m_templateToMesh.size(); ++i) valid = m_templateToMesh[i] < header.meshVertexCount;
+    if (!valid) {
+        std::cerr << "[TopologyCorrespondence] Truncated or corrupt correspondence file: " << path << "\n";
+        clear();
+        return false;
+    }
+
+    m_meshHash = header.meshHash;
+    m_templateHash = header.templateHash;
+    m_scale = header.scale;
+    return true;
+}
+
+std::vector<glm::vec3> TopologyCorrespondence::resample(const std::vector<glm::vec3>& templateValues) const
+{
+    std::vector<glm::vec3> values;
+    if (templateValues.size() != templateVertexCount()) return values;
+
+    values.resize(meshVertexCount());
+    parallelFor(0, values.size(), [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+            values[v] = templateValues[m_index[v * 3 + 0]] * m_weight[v * 3 + 0]
+                      + templateValues[m_index[v * 3 + 1]] * m_weight[v * 3 + 1]
+                      + templateValues[m_index[v * 3 + 2]] * m_weight[v * 3 + 2];
+    }, 0, 1024);
+    return values;
+}
+
+std::vector<int> TopologyCorrespondence::remapIndices(const std::vector<int>& templateIndices) const
+{
+    std::vector<int> indices;
+    indices.reserve(templateIndices.size());
+    for (int t : templateIndices) {
+        if (t < 0 || t >= static_cast<int>(m_templateToMesh.size())) indices.push_back(-1);
+        else indices.push_back(static_cast<int>(m_templateToMesh[t]));
+    }
+    return indices;
+}
+
+std::vector<int> TopologyCorrespondence::remapRegion(const std::vector<int>& templateIndices) const
+{
+    std::vector<char> inRegion(templateVertexCount(), 0);
+    for (int t : templateIndices)
+        if (t >= 0 && t < static_cast<int>(inRegion.size())) inRegion[t] = 1;
+
+    std::vector<char> selected(meshVertexCount(), 0);
+    for (size_t v = 0; v < selected.size(); ++v)
+    {
+        const float* w = &m_weight[v * 3];
+        int strongest = static_cast<int>(std::max_element(w, w + 3) - w);
+        if (inRegion[m_index[v * 3 + strongest]]) selected[v] = 1;
+    }
+    for (size_t t = 0; t < inRegion.size(); ++t)
+        if (inRegion[t]) selected[m_templateToMesh[t]] = 1;
+
+    std::vector<int> region;
+    for (size_t v = 0; v < selected.size(); ++v)
+        if (selected[v]) region.push_back(static_cast<int>(v));
+    return region;
+}
+
+// 64-bit FNV-1a over a byte range, continuing from hash
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static const uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+
+uint64_t TopologyCorrespondence::hashVertices(const std::vector<glm::vec3>& vertices)
+{
+    return fnv1a(kFnvOffsetBasis, vertices.data(), vertices.size() * sizeof(glm::vec3));
+}
+
+uint64_t TopologyCorrespondence::hashTriangles(const std::vector<unsigned int>& triangles)
+{
+    return fnv1a(kFnvOffsetBasis, triangles.data(), triangles.size() * sizeof(unsigned int));
+}
+
+uint64_t TopologyCorrespondence::hashMesh(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& triangles)
+{
+    return fnv1a(hashVertices(vertices), triangles.data(), triangles.size() * sizeof(unsigned int));
+}
+
+std::string TopologyCorrespondence::sidecarPath(const std::string& cacheDir, uint64_t meshHash)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.pmxt", static_cast<unsigned long long>(meshHash));
+    return (std::filesystem::path(cacheDir) / name).string();
+}
+
+MemoryFootprint TopologyCorrespondence::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("indices", heapBytes(m_index));
+    footprint.add("weights", heapBytes(m_weight));
+    footprint.add("templateToMesh", heapBytes(m_templateToMesh));
+    return footprint;
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "AUSolver.h"
+#include "ParallelUtils.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Three AUs moving four landmark vertices (mesh vertices 10..13) in different directions.
+static std::shared_ptr<const CompiledFaceRig> buildSolverRig()
+{
+    const std::string deltaPath = (std::filesystem::temp_directory_path() / "auSolverDeltas.json").string();
+    const std::string meshIndexPath = (std::filesystem::temp_directory_path() / "auSolverMeshIndex.json").string();
+
+    std::ofstream(deltaPath) << R"({"actionUnits":[
+        {"auId":1,"side":"center","activeMuscles":[{"muscleId":1,"deltas":[
+            {"vertexIndex":10,"position":[0,0,0],"delta":[1,0,0]},
+            {"vertexIndex":11,"position":[0,0,0],"delta":[1,0,0]}]}],"passiveMuscles":[]},
+        {"auId":2,"side":"center","activeMuscles":[{"muscleId":2,"deltas":[
+            {"vertexIndex":11,"position":[0,0,0],"delta":[0,1,0]},
+            {"vertexIndex":12,"position":[0,0,0],"delta":[0,2,0]}]}],"passiveMuscles":[]},
+        {"auId":4,"side":"left","activeMuscles":[{"muscleId":3,"deltas":[
+            {"vertexIndex":12,"position":[0,0,0],"delta":[0,0,1]},
+            {"vertexIndex":13,"position":[0,0,0],"delta":[0.5,0,1]}]}],"passiveMuscles":[]}]})";
+    std::ofstream(meshIndexPath) << "[10, 11, 12, 13]";
+
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON(deltaPath.c_str());
+    facialLandmark.loadLandmarksMeshIndexFromJSON(meshIndexPath.c_str());
+    std::remove(deltaPath.c_str());
+    std::remove(meshIndexPath.c_str());
+    return CompiledFaceRig::compile(actionUnit, facialLandmark);
+}
+
+// Landmark displacement produced by the given slot weights.
+static std::vector<glm::vec3> displacementFor(const AUSolver& solver, const std::vector<float>& weights)
+{
+    std::vector<glm::vec3> displacement(solver.landmarkCount(), glm::vec3(0.0f));
+    const auto& basis = solver.basis();
+    for (size_t l = 0; l < solver.landmarkCount(); ++l)
+        for (int c = 0; c < 3; ++c)
+            for (size_t k = 0; k < solver.slotCount(); ++k)
+                displacement[l][c] += basis[(l * 3 + c) * solver.slotCount() + k] * weights[k];
+    return displacement;
+}
+
+TEST(AUSolver, RecoversWeightsInsideBounds)
+{
+    auto rig = buildSolverRig();
+    AUSolver solver;
+    AUSolverOptions options;
+    options.regularization = 1e-7f;
+    ASSERT_TRUE(solver.build(*rig, options));
+    ASSERT_EQ(solver.slotCount(), 3u);
+    ASSERT_EQ(solver.landmarkCount(), 4u);
+
+    std::vector<float> expected = {0.25f, 0.8f, 0.5f};
+    std::vector<float> weights;
+    ASSERT_TRUE(solver.solve(displacementFor(solver, expected), weights));
+    for (size_t k = 0; k < expected.size(); ++k) EXPECT_NEAR(weights[k], expected[k], 1e-4f) << "slot " << k;
+}
+
+TEST(AUSolver, ClampsToBounds)
+{
+    auto rig = buildSolverRig();
+    AUSolver solver;
+    ASSERT_TRUE(solver.build(*rig));
+
+    // the first AU is pushed beyond full intensity and the third backwards
+    std::vector<float> weights;
+    ASSERT_TRUE(solver.solve(displacementFor(solver, {1.6f, 0.4f, -0.7f}), weights));
+    EXPECT_NEAR(weights[0], 1.0f, 1e-5f);
+    EXPECT_NEAR(weights[2], 0.0f, 1e-5f);
+    EXPECT_GT(weights[1], 0.0f);
+    EXPECT_LT(weights[1], 1.0f);
+}
+
+TEST(AUSolver, ClipMatchesPerFrameSolve)
+{
+    auto rig = buildSolverRig();
+    AUSolver solver;
+    ASSERT_TRUE(solver.build(*rig));
+
+    std::vector<std::vector<glm::vec3>> clip;
+    for (int f = 0; f < 300; ++f) {
+        float t = f / 299.0f;
+        clip.push_back(displacementFor(solver, {t, 1.2f - t, 0.5f * t - 0.1f}));
+    }
+
+    std::vector<std::vector<float>> clipWeights;
+    ASSERT_TRUE(solver.solveClip(clip, clipWeights, 4));
+    ASSERT_EQ(clipWeights.size(), clip.size());
+
+    for (size_t f = 0; f < clip.size(); f += 37)
+    {
+        std::vector<float> weights;
+        ASSERT_TRUE(solver.solve(clip[f], weights));
+        for (size_t k = 0; k < weights.size(); ++k) EXPECT_NEAR(clipWeights[f][k], weights[k], 1e-4f);
+    }
+    EXPECT_FALSE(solver.solve(std::vector<glm::vec3>(3), clipWeights[0]));
+}
+
+TEST(AUSolver, DeterministicClipIsIndependentOfWorkerCount)
+{
+    auto rig = buildSolverRig();
+    AUSolver solver;
+    ASSERT_TRUE(solver.build(*rig));
+
+    std::vector<std::vector<glm::vec3>> clip;
+    for (int f = 0; f < 500; ++f) {
+        float t = f / 499.0f;
+        clip.push_back(displacementFor(solver, {std::sin(9.0f * t), t * t, 0.7f - t}));
+    }
+
+    setReductionMode(ReductionMode::deterministic);
+    std::vector<std::vector<float>> reference;
+    EXPECT_TRUE(solver.solveClip(clip, reference, 1));
+    for (unsigned int workers = 2; workers <= 8; ++workers)
+    {
+        std::vector<std::vector<float>> clipWeights;
+        EXPECT_TRUE(solver.solveClip(clip, clipWeights, workers));
+        EXPECT_EQ(clipWeights, reference) << workers << " workers";
+    }
+    setReductionMode(ReductionMode::fast);
+}
+
+TEST(AUSolver, ConvertsImageMotionToMeshSpace)
+{
+    auto rig = buildSolverRig();
+    AUSolver solver;
+    AUSolverOptions options;
+    options.regularization = 1e-7f;
+    ASSERT_TRUE(solver.build(*rig, options));
+
+    // the image landmarks are the mesh landmarks at a tenth of the size, seen with y down and z into the screen
+    std::vector<glm::vec3> meshLandmarks = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    std::vector<glm::vec3> neutral;
+    for (const glm::vec3& p : meshLandmarks) neutral.push_back(glm::vec3(p.x, -p.y, -p.z) * 0.1f);
+
+    // AU2 at 0.5 raises landmarks 1 and 2 (up is -y in the image), AU4 at 0.4 brings 2 and 3 towards the camera
+    std::vector<glm::vec3> current = neutral;
+    current[1].y -= 0.05f;
+    current[2].y -= 0.1f;
+    current[2].z -= 0.04f;
+    current[3] += glm::vec3(0.02f, 0.0f, -0.04f);
+
+    std::vector<glm::vec3> displacement = AUSolver::imageToMeshDisplacement(neutral, current, meshLandmarks);
+    ASSERT_EQ(displacement.size(), 4u);
+    EXPECT_NEAR(displacement[1].y, 0.5f, 1e-5f);
+    EXPECT_NEAR(displacement[2].z, 0.4f, 1e-5f);
+
+    std::vector<float> weights;
+    ASSERT_TRUE(solver.solve(displacement, weights));
+    EXPECT_NEAR(weights[0], 0.0f, 1e-4f);
+    EXPECT_NEAR(weights[1], 0.5f, 1e-4f);
+    EXPECT_NEAR(weights[2], 0.4f, 1e-4f);
+
+    EXPECT_TRUE(AUSolver::imageToMeshDisplacement(neutral, {}, meshLandmarks).empty());
+}
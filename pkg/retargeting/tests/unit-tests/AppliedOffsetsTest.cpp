@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "AppliedOffsets.h"
+
+// Mimics MayaMesh: the scene holds the current points, offsets are written on top of the recovered rest pose.
+static std::vector<glm::vec3> deform(AppliedOffsets& applied, const std::vector<glm::vec3>& scene, const std::vector<glm::vec3>& offsets)
+{
+    std::vector<glm::vec3> points = scene;
+    applied.toRest(points);
+    for (size_t i = 0; i < points.size(); ++i) points[i] += offsets[i];
+    applied.record(offsets);
+    return points;
+}
+
+TEST(AppliedOffsets, SecondGenerateOnTheSameAssetStartsFromRest)
+{
+    const std::vector<glm::vec3> rest = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    const std::vector<glm::vec3> first = {{0, 0, 1}, {0, 0, 2}, {0, 0, 3}};
+    const std::vector<glm::vec3> second = {{1, 0, 0}, {0, 0, 0}, {0, 0, -1}};
+
+    AppliedOffsets applied;
+    std::vector<glm::vec3> scene = deform(applied, rest, first);
+    EXPECT_TRUE(applied.tracks(rest.size()));
+    std::vector<glm::vec3> recovered = scene;
+    applied.toRest(recovered);
+    EXPECT_EQ(recovered, rest);
+
+    // the second generation re-imports the mesh at rest and deforms it again
+    applied.reset();
+    EXPECT_FALSE(applied.tracks(rest.size()));
+    recovered = rest;
+    applied.toRest(recovered);
+    EXPECT_EQ(recovered, rest);
+    scene = deform(applied, rest, second);
+    for (size_t i = 0; i < rest.size(); ++i) EXPECT_EQ(scene[i], rest[i] + second[i]);
+
+    // without the reset the first offsets would be subtracted from the fresh mesh
+    AppliedOffsets stale;
+    stale.record(first);
+    scene = deform(stale, rest, second);
+    EXPECT_NE(scene[0], rest[0] + second[0]);
+
+    // offsets of another mesh are ignored
+    std::vector<glm::vec3> other(5, glm::vec3(1.0f));
+    applied.toRest(other);
+    EXPECT_EQ(other, std::vector<glm::vec3>(5, glm::vec3(1.0f)));
+}
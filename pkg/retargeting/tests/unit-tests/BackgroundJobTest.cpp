@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "BackgroundJob.h"
+#include <chrono>
+#include <thread>
+
+TEST(BackgroundJob, RunsStepsInOrderWithProgress)
+{
+    WorkerPool pool(2);
+    auto job = BackgroundJob::create("ordered");
+
+    std::vector<int> order;
+    float progressInSecond = -1.0f;
+    job->addStep("first", 1.0f, [&](JobContext&) { order.push_back(1); return true; });
+    job->addStep("second", 3.0f, [&](JobContext& ctx) {
+        ctx.setStepProgress(0.5f);
+        progressInSecond = job->progress();
+        order.push_back(2);
+        return true;
+    });
+
+    JobState reported = JobState::Pending;
+    job->setCompletionCallback([&](JobState state) { reported = state; });
+
+    ASSERT_TRUE(job->start(pool));
+    EXPECT_FALSE(job->start(pool));
+    EXPECT_EQ(job->wait(), JobState::Finished);
+    EXPECT_EQ(reported, JobState::Finished);
+    EXPECT_EQ(order, (std::vector<int>{1, 2}));
+    EXPECT_FLOAT_EQ(progressInSecond, 0.25f + 0.75f * 0.5f);
+    EXPECT_FLOAT_EQ(job->progress(), 1.0f);
+    EXPECT_EQ(job->currentStep(), "second");
+}
+
+TEST(BackgroundJob, CancelSkipsRemainingSteps)
+{
+    WorkerPool pool(1);
+    auto job = BackgroundJob::create("cancelled");
+
+    std::atomic<bool> entered{false};
+    bool lastRan = false;
+    job->addStep("spin", 1.0f, [&](JobContext& ctx) {
+        entered = true;
+        while (!ctx.cancelled()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return false;
+    });
+    job->addStep("last", 1.0f, [&](JobContext&) { lastRan = true; return true; });
+
+    job->start(pool);
+    while (!entered) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    job->cancel();
+    EXPECT_EQ(job->wait(), JobState::Cancelled);
+    EXPECT_FALSE(lastRan);
+}
+
+TEST(BackgroundJob, FailingOrThrowingStepFailsJob)
+{
+    WorkerPool pool(1);
+    auto failing = BackgroundJob::create("failing");
+    failing->addStep("fail", 1.0f, [](JobContext&) { return false; });
+    auto throwing = BackgroundJob::create("throwing");
+    throwing->addStep("throw", 1.0f, [](JobContext&) -> bool { throw std::runtime_error("boom"); });
+
+    failing->start(pool);
+    throwing->start(pool);
+    EXPECT_EQ(failing->wait(), JobState::Failed);
+    EXPECT_EQ(throwing->wait(), JobState::Failed);
+}
+
+TEST(WorkerPool, RunsEveryTask)
+{
+    std::atomic<int> sum{0};
+    {
+        WorkerPool pool(4);
+        for (int i = 1; i <= 100; ++i) pool.submit([&sum, i] { sum += i; });
+        pool.waitIdle();
+        EXPECT_EQ(sum.load(), 5050);
+        pool.submit([&sum] { sum += 1; });
+    }
+    // the destructor drains the queue
+    EXPECT_EQ(sum.load(), 5051);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "CompiledFaceRig.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Writes a small delta table (two AUs, overlapping muscles on vertex 1) and landmark/AU mapping to temp files.
+static void loadSmallRig(ActionUnit& actionUnit, FacialLandmark& facialLandmark)
+{
+    const std::string deltaPath = (std::filesystem::temp_directory_path() / "compiledFaceRigDeltas.json").string();
+    const std::string mappingPath = (std::filesystem::temp_directory_path() / "compiledFaceRigMappings.json").string();
+
+    std::ofstream(deltaPath) << R"({"actionUnits":[
+        {"auId":1,"side":"left",
+         "activeMuscles":[{"muscleId":3,"deltas":[
+            {"vertexIndex":1,"position":[0,0,0],"delta":[1,0,0]},
+            {"vertexIndex":3,"position":[0,0,0],"delta":[0,2,0]}]}],
+         "passiveMuscles":[{"muscleId":4,"deltas":[
+            {"vertexIndex":1,"position":[0,0,0],"delta":[0.5,0,0]}]}]},
+        {"auId":2,"side":"center",
+         "activeMuscles":[{"muscleId":5,"deltas":[
+            {"vertexIndex":0,"position":[0,0,0],"delta":[0,0,1]}]}],
+         "passiveMuscles":[]}]})";
+    std::ofstream(mappingPath) << R"({"mappings":[
+        {"auId":1,"side":"left","landmarkIndices":[0,1,2,3]},
+        {"auId":2,"side":"center","landmarkIndices":[4,5,6]}]})";
+
+    actionUnit.loadDeltaTransfersFromJSON(deltaPath.c_str());
+    facialLandmark.loadLandmarksActionUnitsMappingFromJson(mappingPath.c_str());
+    std::remove(deltaPath.c_str());
+    std::remove(mappingPath.c_str());
+}
+
+TEST(CompiledFaceRig, CompileMergesDeltas)
+{
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    loadSmallRig(actionUnit, facialLandmark);
+
+    auto rig = CompiledFaceRig::compile(actionUnit, facialLandmark);
+    ASSERT_EQ(rig->slotCount(), 2u);
+    EXPECT_EQ(rig->requiredVertexCount(), 4u);
+
+    int slot = rig->findSlot(1, Side::left);
+    ASSERT_GE(slot, 0);
+    EXPECT_EQ(rig->findSlot(1, Side::right), -1);
+
+    // active and passive deltas on vertex 1 are merged into one entry
+    const AUSlot& au1 = rig->slots()[slot];
+    ASSERT_EQ(au1.deltaEnd - au1.deltaBegin, 2u);
+    EXPECT_EQ(rig->deltaVertices()[au1.deltaBegin], 1u);
+    EXPECT_FLOAT_EQ(rig->deltaValues()[au1.deltaBegin].x, 1.5f);
+    EXPECT_EQ(au1.pairEnd - au1.pairBegin, 2u);
+
+    // the odd landmark group of AU 2 is skipped
+    const AUSlot& au2 = rig->slots()[rig->findSlot(2, Side::center)];
+    EXPECT_EQ(au2.pairEnd - au2.pairBegin, 0u);
+}
+
+TEST(CompiledFaceRig, CharactersShareOneRig)
+{
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    loadSmallRig(actionUnit, facialLandmark);
+    auto rig = CompiledFaceRig::compile(actionUnit, facialLandmark);
+
+    std::vector<CharacterDeformState> states;
+    for (int c = 0; c < 8; ++c)
+    {
+        std::vector<glm::vec3> rest(5, glm::vec3(static_cast<float>(c)));
+        states.emplace_back(rig, rest);
+        ASSERT_TRUE(states.back().setWeight(1, Side::left, 0.1f * c));
+        ASSERT_TRUE(states.back().setWeight(2, Side::center, 1.0f));
+    }
+    EXPECT_FALSE(states.back().setWeight(9, Side::left, 1.0f));
+    EXPECT_FALSE(states.back().setSlotWeight(rig->slotCount(), 1.0f));
+
+    ASSERT_TRUE(evaluateCharacters(states, 4));
+    for (int c = 0; c < 8; ++c)
+    {
+        const auto& out = states[c].deformedVertices();
+        const float base = static_cast<float>(c);
+        EXPECT_NEAR(out[0].z, base + 1.0f, 1e-5f);
+        EXPECT_NEAR(out[1].x, base + 1.5f * 0.1f * c, 1e-5f);
+        EXPECT_NEAR(out[3].y, base + 2.0f * 0.1f * c, 1e-5f);
+        EXPECT_NEAR(out[4].x, base, 1e-5f);
+    }
+    EXPECT_EQ(rig.use_count(), 9);
+
+    // a mesh smaller than the delta table is rejected
+    CharacterDeformState small(rig, std::vector<glm::vec3>(2));
+    EXPECT_FALSE(small.evaluate());
+}
+
+TEST(CompiledFaceRig, ResampleOntoSameTopology)
+{
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    loadSmallRig(actionUnit, facialLandmark);
+    auto rig = CompiledFaceRig::compile(actionUnit, facialLandmark);
+
+    // two quads as the template, the user mesh is the same surface at twice the size
+    std::vector<glm::vec3> templateVertices = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 1, 0}, {1, 1, 0}, {2, 1, 0}};
+    std::vector<unsigned int> triangles = {0, 1, 4, 0, 4, 3, 1, 2, 5, 1, 5, 4};
+    std::vector<glm::vec3> meshVertices;
+    for (const auto& v : templateVertices) meshVertices.push_back(v * 2.0f);
+
+    TopologyCorrespondence correspondence;
+    ASSERT_TRUE(correspondence.build(meshVertices, templateVertices, triangles, 1));
+    auto resampled = rig->resampled(correspondence);
+    ASSERT_TRUE(resampled);
+    ASSERT_EQ(resampled->slotCount(), rig->slotCount());
+
+    // same vertices, deltas converted to the larger mesh units
+    CharacterDeformState state(resampled, meshVertices);
+    ASSERT_TRUE(state.setWeight(1, Side::left, 1.0f));
+    ASSERT_TRUE(state.evaluate());
+    EXPECT_NEAR(state.deformedVertices()[1].x, meshVertices[1].x + 3.0f, 1e-4f);
+    EXPECT_NEAR(state.deformedVertices()[3].y, meshVertices[3].y + 4.0f, 1e-4f);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "CurveReducer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Ten seconds at 30 fps: smooth speech-like motion, a held ramp, a channel at rest and a noisy channel.
+static void makeStream(std::vector<double>& times, std::vector<std::vector<float>>& frames)
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    const size_t frameCount = 300;
+    times.resize(frameCount);
+    frames.assign(frameCount, std::vector<float>(4, 0.0f));
+    for (size_t f = 0; f < frameCount; ++f)
+    {
+        const double t = static_cast<double>(f) / 30.0;
+        times[f] = t;
+        frames[f][0] = static_cast<float>(0.5 + 0.4 * std::sin(2.0 * t) * std::sin(0.7 * t));
+        frames[f][1] = static_cast<float>(std::clamp((t - 2.0) / 3.0, 0.0, 1.0));
+        frames[f][2] = 0.0f;
+        frames[f][3] = 0.5f + 0.2f * noise(random);
+    }
+}
+
+TEST(CurveReducer, StaysWithinTheTolerance)
+{
+    std::vector<double> times;
+    std::vector<std::vector<float>> frames;
+    makeStream(times, frames);
+
+    CurveReductionOptions options;
+    options.tolerance = 1e-3f;
+    const std::vector<AUCurve> curves = CurveReducer::reduce(times, frames, options);
+    ASSERT_EQ(curves.size(), 4u);
+
+    for (const AUCurve& curve : curves)
+    {
+        ASSERT_FALSE(curve.keys.empty());
+        EXPECT_EQ(curve.keys.front().time, times.front());
+        for (size_t f = 0; f < times.size(); ++f)
+            EXPECT_NEAR(curve.evaluate(times[f]), frames[f][curve.slot], 1e-3f + 1e-6f) << "slot " << curve.slot << " frame " << f;
+    }
+
+    // smooth channels collapse by an order of magnitude; noise keeps what it needs
+    EXPECT_LT(curves[0].keys.size(), 30u);
+    EXPECT_LE(curves[1].keys.size(), 6u);
+    EXPECT_TRUE(curves[2].isConstant());
+    const size_t smoothKeys = CurveReducer::keyCount(curves) - curves[3].keys.size();
+    EXPECT_LT(smoothKeys * 10, 3 * times.size());
+    EXPECT_LE(curves[3].keys.size(), times.size());
+}
+
+TEST(CurveReducer, KeepsTheEndsOfARamp)
+{
+    const std::vector<double> times = {0.0, 0.1, 0.2, 0.3, 0.4, 0.5};
+    const std::vector<float> values = {0.0f, 0.2f, 0.4f, 0.6f, 0.8f, 1.0f};
+    const AUCurve curve = CurveReducer::reduceChannel(times, values, 7, 1e-4f);
+    EXPECT_EQ(curve.slot, 7u);
+    ASSERT_EQ(curve.keys.size(), 2u);
+    EXPECT_NEAR(curve.keys[0].outTangent, 2.0f, 1e-4f);
+    EXPECT_NEAR(curve.evaluate(0.25), 0.5f, 1e-5f);
+    EXPECT_EQ(curve.evaluate(-1.0), 0.0f);
+    EXPECT_EQ(curve.evaluate(2.0), 1.0f);
+
+    // a zero tolerance keeps the frames that are not on the line
+    const std::vector<float> corner = {0.0f, 0.0f, 0.0f, 0.5f, 1.0f, 1.0f};
+    const AUCurve exact = CurveReducer::reduceChannel(times, corner, 0, 0.0f);
+    for (size_t i = 0; i < times.size(); ++i) EXPECT_FLOAT_EQ(exact.evaluate(times[i]), corner[i]);
+}
+
+TEST(CurveReducer, ParallelMatchesSerial)
+{
+    std::vector<double> times;
+    std::vector<std::vector<float>> frames;
+    makeStream(times, frames);
+    for (auto& frame : frames) frame.resize(64, frame[0]);
+
+    CurveReductionOptions serial;
+    serial.workerCount = 1;
+    CurveReductionOptions parallel;
+    parallel.workerCount = 4;
+    const auto expected = CurveReducer::reduce(times, frames, serial);
+    const auto curves = CurveReducer::reduce(times, frames, parallel);
+    ASSERT_EQ(curves.size(), expected.size());
+    for (size_t s = 0; s < curves.size(); ++s)
+    {
+        ASSERT_EQ(curves[s].keys.size(), expected[s].keys.size());
+        for (size_t k = 0; k < curves[s].keys.size(); ++k)
+        {
+            EXPECT_EQ(curves[s].keys[k].time, expected[s].keys[k].time);
+            EXPECT_EQ(curves[s].keys[k].value, expected[s].keys[k].value);
+        }
+    }
+
+    frames[5].pop_back();
+    EXPECT_TRUE(CurveReducer::reduce(times, frames).empty());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "CompiledFaceRig.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// Overlapping AUs over a 5000 vertex mesh; AU 9 only moves vertices below 300.
+static std::shared_ptr<const CompiledFaceRig> makeOverlappingRig()
+{
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> vertex(0, 4999);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+    std::ostringstream json;
+    json << R"({"actionUnits":[)";
+    for (int au = 1; au <= 9; ++au)
+    {
+        json << (au > 1 ? "," : "") << R"({"auId":)" << au << R"(,"side":"left","activeMuscles":[{"muscleId":)" << au << R"(,"deltas":[)";
+        for (int i = 0; i < 400; ++i)
+        {
+            const int v = au == 9 ? i % 300 : vertex(random);
+            json << (i > 0 ? "," : "") << R"({"vertexIndex":)" << v << R"(,"position":[0,0,0],"delta":[)"
+                 << value(random) << "," << value(random) << "," << value(random) << "]}";
+        }
+        json << R"(]}],"passiveMuscles":[]})";
+    }
+    json << "]}";
+
+    const std::string path = (std::filesystem::temp_directory_path() / "deltaTileDeltas.json").string();
+    std::ofstream(path) << json.str();
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON(path.c_str());
+    std::remove(path.c_str());
+    return CompiledFaceRig::compile(actionUnit, facialLandmark);
+}
+
+// Reference: slot by slot, the order evaluate() used before the tiles.
+static std::vector<glm::vec3> accumulateBySlot(const CompiledFaceRig& rig, const std::vector<float>& weights, size_t vertexCount)
+{
+    std::vector<glm::vec3> out(vertexCount, glm::vec3(0.0f));
+    for (size_t s = 0; s < rig.slotCount(); ++s)
+        for (uint32_t i = rig.slots()[s].deltaBegin; i < rig.slots()[s].deltaEnd; ++i)
+            out[rig.deltaVertices()[i]] += rig.deltaValues()[i] * weights[s];
+    return out;
+}
+
+TEST(DeltaTilePartition, TilesOwnTheirVertices)
+{
+    auto rig = makeOverlappingRig();
+    DeltaTilePartition partition = DeltaTilePartition::build(*rig, 256);
+    EXPECT_EQ(partition.vertices().size(), rig->deltaVertices().size());
+
+    for (const DeltaTile& tile : partition.tiles())
+        for (uint32_t r = tile.runBegin; r < tile.runEnd; ++r)
+        {
+            const DeltaTileRun& run = partition.runs()[r];
+            if (r > tile.runBegin) {
+                EXPECT_GT(run.slot, partition.runs()[r - 1].slot);
+            }
+            for (uint32_t i = run.begin; i < run.end; ++i)
+            {
+                EXPECT_GE(partition.vertices()[i], tile.vertexBegin);
+                EXPECT_LT(partition.vertices()[i], tile.vertexEnd);
+            }
+        }
+}
+
+TEST(DeltaTilePartition, ParallelAccumulationMatchesSerial)
+{
+    auto rig = makeOverlappingRig();
+    ASSERT_EQ(rig->slotCount(), 9u);
+    DeltaTilePartition partition = DeltaTilePartition::build(*rig, 256);
+
+    std::vector<float> weights = {0.5f, 0.0f, 1.0f, 0.25f, 0.0f, 0.8f, 0.1f, 0.0f, 0.3f};
+    std::vector<glm::vec3> expected = accumulateBySlot(*rig, weights, 5000);
+    std::vector<glm::vec3> out(5000, glm::vec3(0.0f));
+    partition.accumulate(weights, out.data(), out.size(), 4);
+
+    for (size_t v = 0; v < out.size(); ++v)
+    {
+        EXPECT_NEAR(out[v].x, expected[v].x, 1e-5f);
+        EXPECT_NEAR(out[v].y, expected[v].y, 1e-5f);
+        EXPECT_NEAR(out[v].z, expected[v].z, 1e-5f);
+    }
+}
+
+TEST(DeltaTilePartition, SkipsTilesWithoutWeight)
+{
+    auto rig = makeOverlappingRig();
+    DeltaTilePartition partition = DeltaTilePartition::build(*rig, 256);
+    std::vector<glm::vec3> out(5000, glm::vec3(0.0f));
+
+    std::vector<float> weights(rig->slotCount(), 0.0f);
+    EXPECT_EQ(partition.accumulate(weights, out.data(), out.size(), 4), 0u);
+
+    // only AU 9 is on and its vertices fit in the first two tiles
+    weights[rig->findSlot(9, Side::left)] = 1.0f;
+    EXPECT_EQ(partition.accumulate(weights, out.data(), out.size(), 4), 2u);
+    for (size_t v = 300; v < out.size(); ++v) EXPECT_EQ(out[v], glm::vec3(0.0f));
+
+    // a smaller buffer ignores the vertices past its end
+    std::vector<glm::vec3> small(100, glm::vec3(0.0f));
+    EXPECT_EQ(partition.accumulate(weights, small.data(), small.size(), 1), 1u);
+}
+
+TEST(DeltaTilePartition, CharacterStateUsesTheTiles)
+{
+    auto rig = makeOverlappingRig();
+    std::vector<glm::vec3> rest(5000, glm::vec3(1.0f));
+    CharacterDeformState state(rig, rest);
+    state.setWorkerCount(0);
+    std::vector<float> weights = {0.0f, 0.2f, 0.0f, 0.0f, 0.7f, 0.0f, 0.0f, 1.0f, 0.0f};
+    for (size_t s = 0; s < weights.size(); ++s) state.setSlotWeight(s, weights[s]);
+    ASSERT_TRUE(state.evaluate());
+
+    std::vector<glm::vec3> expected = accumulateBySlot(*rig, weights, 5000);
+    for (size_t v = 0; v < rest.size(); ++v) EXPECT_NEAR(state.deformedVertices()[v].y, 1.0f + expected[v].y, 1e-5f);
+}
+
+TEST(DeltaTilePartition, AccumulationIsBitwiseIdenticalForAnyWorkerCount)
+{
+    // every vertex is summed by the one tile that owns it, in slot order: nothing depends on the worker count
+    auto rig = makeOverlappingRig();
+    DeltaTilePartition partition = DeltaTilePartition::build(*rig, 256);
+    std::vector<float> weights = {0.31f, 0.9f, 0.05f, 0.7f, 0.44f, 0.12f, 1.0f, 0.6f, 0.27f};
+
+    std::vector<glm::vec3> reference(5000, glm::vec3(0.0f));
+    partition.accumulate(weights, reference.data(), reference.size(), 1);
+    for (unsigned int workers = 2; workers <= 8; ++workers)
+    {
+        std::vector<glm::vec3> out(5000, glm::vec3(0.0f));
+        partition.accumulate(weights, out.data(), out.size(), workers);
+        EXPECT_EQ(std::memcmp(out.data(), reference.data(), out.size() * sizeof(glm::vec3)), 0) << workers << " workers";
+    }
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "AUSolver.h"
+#include "FrameEvaluator.h"
+#include "MemoryFootprint.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+
+#ifdef PIXELMUX_TRACK_ALLOCATIONS
+// The tracking build already replaces operator new and counts every allocation.
+static size_t allocationCount() { return MemoryTracker::allocationCount(); }
+#else
+// Counts every heap allocation of the test binary so the steady-state frame path can be checked.
+static std::atomic<size_t> g_allocationCount{0};
+static size_t allocationCount() { return g_allocationCount.load(); }
+
+void* operator new(std::size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+// Two AU slots: AU 1 left measures pairs (0,1) and (2,3), AU 2 center measures pair (4,5).
+static std::shared_ptr<const CompiledFaceRig> makeRig()
+{
+    const std::string deltaPath = (std::filesystem::temp_directory_path() / "frameEvaluatorDeltas.json").string();
+    const std::string mappingPath = (std::filesystem::temp_directory_path() / "frameEvaluatorMappings.json").string();
+    std::ofstream(deltaPath) << R"({"actionUnits":[
+        {"auId":1,"side":"left","activeMuscles":[{"muscleId":3,"deltas":[{"vertexIndex":0,"position":[0,0,0],"delta":[1,0,0]}]}],"passiveMuscles":[]},
+        {"auId":2,"side":"center","activeMuscles":[{"muscleId":4,"deltas":[{"vertexIndex":1,"position":[0,0,0],"delta":[0,1,0]}]}],"passiveMuscles":[]}]})";
+    std::ofstream(mappingPath) << R"({"mappings":[
+        {"auId":1,"side":"left","landmarkIndices":[0,1,2,3]},
+        {"auId":2,"side":"center","landmarkIndices":[4,5]}]})";
+
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON(deltaPath.c_str());
+    facialLandmark.loadLandmarksActionUnitsMappingFromJson(mappingPath.c_str());
+    std::remove(deltaPath.c_str());
+    std::remove(mappingPath.c_str());
+    return CompiledFaceRig::compile(actionUnit, facialLandmark);
+}
+
+static std::vector<glm::vec3> neutralLandmarks()
+{
+    return {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}, {0, 2, 0}, {2, 2, 0}};
+}
+
+TEST(FrameArena, ResetReusesTheBlock)
+{
+    FrameArena arena(64);
+    double* a = arena.allocateArray<double>(4);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % alignof(double), 0u);
+    EXPECT_GE(arena.used(), 32u);
+
+    // does not fit: served from an overflow block, the next reset grows the block to the peak
+    arena.allocateArray<double>(16);
+    EXPECT_GT(arena.highWater(), 64u);
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_GE(arena.capacity(), arena.highWater());
+
+    const size_t before = allocationCount();
+    arena.allocateArray<double>(4);
+    arena.allocateArray<double>(16);
+    arena.reset();
+    EXPECT_EQ(allocationCount(), before);
+}
+
+TEST(FrameEvaluator, FindsTheStrongestSlot)
+{
+    auto rig = makeRig();
+    ASSERT_EQ(rig->slotCount(), 2u);
+    FrameEvaluator evaluator(rig);
+    EXPECT_TRUE(evaluator.setNeutralLandmarks(neutralLandmarks()));
+    EXPECT_FLOAT_EQ(evaluator.baseDistance(rig->findSlot(1, Side::left)), 1.0f);
+    EXPECT_FLOAT_EQ(evaluator.baseDistance(rig->findSlot(2, Side::center)), 2.0f);
+
+    // AU 2's pair opens by 0.6, AU 1's pairs by 0.5
+    std::vector<glm::vec3> current = neutralLandmarks();
+    current[1].x = 1.5f;
+    current[3].x = 1.5f;
+    current[5].x = 2.6f;
+
+    FrameArena arena;
+    FrameEvaluation evaluation = evaluator.evaluate(current.data(), current.size(), 0.4f, 0.8f, arena);
+    ASSERT_EQ(evaluation.count, 2u);
+    ASSERT_EQ(evaluation.strongest, rig->findSlot(2, Side::center));
+    const landmarksDistanceData& strongest = evaluation.records[evaluation.strongest];
+    EXPECT_EQ(strongest.auId, 2);
+    EXPECT_TRUE(strongest.isActive);
+    EXPECT_NEAR(strongest.intensity, 0.5f, 1e-5f);
+    EXPECT_FALSE(evaluation.records[rig->findSlot(1, Side::left)].isActive);
+
+    // a calibrated range makes AU 1 the strongest
+    evaluator.setThresholds(rig->findSlot(1, Side::left), 0.1f, 0.5f);
+    evaluation = evaluator.evaluate(current.data(), current.size(), 0.4f, 0.8f, arena);
+    EXPECT_EQ(evaluation.strongest, rig->findSlot(1, Side::left));
+    EXPECT_FLOAT_EQ(evaluation.records[evaluation.strongest].intensity, 1.0f);
+
+    // nothing moved: no active AU
+    std::vector<glm::vec3> neutral = neutralLandmarks();
+    evaluation = evaluator.evaluate(neutral.data(), neutral.size(), 0.4f, 0.8f, arena);
+    EXPECT_EQ(evaluation.strongest, -1);
+}
+
+TEST(FrameEvaluator, SteadyStateFramesDoNotAllocate)
+{
+    FrameEvaluator evaluator(makeRig());
+    evaluator.setNeutralLandmarks(neutralLandmarks());
+    std::vector<glm::vec3> current = neutralLandmarks();
+    FrameArena arena(256);
+
+    // the first frames may grow the arena
+    for (int frame = 0; frame < 2; ++frame) {
+        arena.reset();
+        evaluator.evaluate(current.data(), current.size(), 0.4f, 0.8f, arena);
+    }
+
+    const size_t before = allocationCount();
+    int activeFrames = 0;
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        arena.reset();
+        current[5].x = 2.0f + 0.01f * static_cast<float>(frame % 100);
+        FrameEvaluation evaluation = evaluator.evaluate(current.data(), current.size(), 0.4f, 0.8f, arena);
+        if (evaluation.strongest >= 0) ++activeFrames;
+    }
+    const size_t allocations = allocationCount() - before;
+
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_GT(activeFrames, 0);
+}
+
+// The per frame solve sits next to the evaluator on the live path, it is checked with the same counter.
+TEST(AUSolver, SteadyStateSolvesDoNotAllocate)
+{
+    const std::string deltaPath = (std::filesystem::temp_directory_path() / "frameSolverDeltas.json").string();
+    const std::string meshIndexPath = (std::filesystem::temp_directory_path() / "frameSolverMeshIndex.json").string();
+    std::ofstream(deltaPath) << R"({"actionUnits":[
+        {"auId":1,"side":"left","activeMuscles":[{"muscleId":3,"deltas":[{"vertexIndex":0,"position":[0,0,0],"delta":[1,0,0]}]}],"passiveMuscles":[]},
+        {"auId":2,"side":"center","activeMuscles":[{"muscleId":4,"deltas":[{"vertexIndex":1,"position":[0,0,0],"delta":[0,1,0]}]}],"passiveMuscles":[]}]})";
+    std::ofstream(meshIndexPath) << "[0, 1]";
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON(deltaPath.c_str());
+    facialLandmark.loadLandmarksMeshIndexFromJSON(meshIndexPath.c_str());
+    std::remove(deltaPath.c_str());
+    std::remove(meshIndexPath.c_str());
+
+    AUSolver solver;
+    ASSERT_TRUE(solver.build(*CompiledFaceRig::compile(actionUnit, facialLandmark)));
+    std::vector<glm::vec3> displacement = {{0.5f, 0, 0}, {0, 2.0f, 0}};
+    std::vector<float> weights;
+    ASSERT_TRUE(solver.solve(displacement, weights));
+
+    // both the unconstrained and the bounded path run without touching the heap
+    const size_t before = allocationCount();
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        displacement[0].x = 0.01f * static_cast<float>(frame % 100);
+        displacement[1].y = (frame % 2) ? 2.0f : 0.3f;
+        solver.solve(displacement, weights);
+    }
+    EXPECT_EQ(allocationCount() - before, 0u);
+    EXPECT_NEAR(weights[0], 0.99f, 1e-3f);
+    EXPECT_FLOAT_EQ(weights[1], 1.0f);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "HeadPoseAligner.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+// Rotation of angle radians around an axis (Rodrigues).
+static glm::mat3 axisRotation(glm::vec3 axis, float angle)
+{
+    axis = glm::normalize(axis);
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    const glm::vec3 scaled = axis * s;
+    glm::mat3 r;
+    for (int col = 0; col < 3; ++col)
+        for (int row = 0; row < 3; ++row) r[col][row] = (1.0f - c) * axis[row] * axis[col] + (row == col ? c : 0.0f);
+    r[1][0] -= scaled.z; r[0][1] += scaled.z;
+    r[2][0] += scaled.y; r[0][2] -= scaled.y;
+    r[2][1] -= scaled.x; r[1][2] += scaled.x;
+    return r;
+}
+
+static std::vector<glm::vec3> randomFace(std::mt19937& random, size_t count)
+{
+    std::uniform_real_distribution<float> coordinate(-0.5f, 0.5f);
+    std::vector<glm::vec3> points(count);
+    for (glm::vec3& p : points) p = glm::vec3(coordinate(random), coordinate(random), 0.3f * coordinate(random));
+    return points;
+}
+
+TEST(HeadPoseAligner, EstimatesSimilarityTransforms)
+{
+    std::mt19937 random(3);
+    const std::vector<glm::vec3> target = randomFace(random, 20);
+    const glm::mat3 rotation = axisRotation(glm::vec3(0.3f, -1.0f, 0.4f), 0.7f);
+    ASSERT_NEAR(glm::determinant(rotation), 1.0f, 1e-5f);
+    const float scale = 1.7f;
+    const glm::vec3 translation(0.2f, -3.0f, 1.5f);
+
+    // source is the inverse transform of the target
+    std::vector<glm::vec3> source;
+    for (const glm::vec3& p : target) source.push_back(glm::transpose(rotation) * ((p - translation) / scale));
+
+    HeadPose pose;
+    ASSERT_TRUE(HeadPoseAligner::estimate(source.data(), target.data(), source.size(), pose));
+    EXPECT_NEAR(pose.scale, scale, 1e-4f);
+    EXPECT_NEAR(pose.rmsError, 0.0f, 1e-3f);
+    for (int c = 0; c < 3; ++c)
+    {
+        EXPECT_NEAR(pose.translation[c], translation[c], 1e-4f);
+        for (int r = 0; r < 3; ++r) EXPECT_NEAR(pose.rotation[c][r], rotation[c][r], 1e-4f);
+    }
+
+    // a mirrored face is matched by a proper rotation, never by a reflection
+    std::vector<glm::vec3> mirrored;
+    for (const glm::vec3& p : target) mirrored.emplace_back(-p.x, p.y, p.z);
+    ASSERT_TRUE(HeadPoseAligner::estimate(mirrored.data(), target.data(), target.size(), pose));
+    EXPECT_NEAR(glm::determinant(pose.rotation), 1.0f, 1e-4f);
+    EXPECT_GT(pose.rmsError, 0.01f);
+
+    const std::vector<glm::vec3> collapsed(5, glm::vec3(1.0f));
+    EXPECT_FALSE(HeadPoseAligner::estimate(collapsed.data(), target.data(), collapsed.size(), pose));
+    EXPECT_FALSE(HeadPoseAligner::estimate(source.data(), target.data(), 2, pose));
+}
+
+TEST(HeadPoseAligner, RemovesHeadMotionButKeepsExpressions)
+{
+    std::mt19937 random(9);
+    const std::vector<glm::vec3> neutral = randomFace(random, 51);
+    const std::vector<int> stable = {0, 7, 8, 11, 12, 15, 35, 36, 37};
+    HeadPoseAligner aligner;
+    ASSERT_TRUE(aligner.setReference(neutral, stable));
+
+    // an expression moves only non-stable landmarks, then the head turns, moves and gets closer to the camera
+    std::vector<glm::vec3> expression = neutral;
+    expression[20] += glm::vec3(0.0f, -0.05f, 0.0f);
+    expression[40] += glm::vec3(0.03f, 0.02f, 0.01f);
+    const glm::mat3 rotation = axisRotation(glm::vec3(0.1f, 1.0f, 0.2f), 0.35f);
+    std::vector<glm::vec3> frame;
+    for (const glm::vec3& p : expression) frame.push_back(1.3f * (rotation * p) + glm::vec3(0.4f, 0.1f, -0.2f));
+    EXPECT_GT(std::fabs(glm::length(frame[20] - frame[40]) - glm::length(expression[20] - expression[40])), 1e-2f);
+
+    HeadPose pose;
+    ASSERT_TRUE(aligner.align(frame.data(), frame.size(), &pose));
+    EXPECT_NEAR(pose.scale, 1.0f / 1.3f, 1e-4f);
+    EXPECT_NEAR(pose.rmsError, 0.0f, 1e-3f);
+    for (size_t i = 0; i < frame.size(); ++i)
+        for (int c = 0; c < 3; ++c) EXPECT_NEAR(frame[i][c], expression[i][c], 1e-4f) << "landmark " << i;
+
+    std::vector<glm::vec3> tooShort(10);
+    EXPECT_FALSE(aligner.align(tooShort.data(), tooShort.size()));
+    EXPECT_FALSE(HeadPoseAligner().align(frame.data(), frame.size()));
+    EXPECT_FALSE(aligner.setReference(neutral, {1, 2, 60}));
+    EXPECT_FALSE(aligner.isValid());
+}
+
+TEST(HeadPoseAligner, AlignsWholeClipsInMicroseconds)
+{
+    std::mt19937 random(17);
+    const std::vector<glm::vec3> neutral = randomFace(random, 51);
+    HeadPoseAligner aligner;
+    ASSERT_TRUE(aligner.setReference(neutral, {0, 7, 8, 11, 12, 15, 35, 36, 37}));
+
+    std::uniform_real_distribution<float> angle(-0.4f, 0.4f);
+    std::vector<std::vector<glm::vec3>> frames;
+    for (int f = 0; f < 4000; ++f)
+    {
+        const glm::mat3 rotation = axisRotation(glm::vec3(angle(random), 1.0f, angle(random)), angle(random));
+        const glm::vec3 offset(angle(random), angle(random), 0.0f);
+        std::vector<glm::vec3> frame;
+        for (const glm::vec3& p : neutral) frame.push_back(rotation * p + offset);
+        frames.push_back(std::move(frame));
+    }
+    frames.emplace_back();
+
+    std::vector<HeadPose> poses;
+    const auto begin = std::chrono::steady_clock::now();
+    EXPECT_EQ(aligner.alignFrames(frames, &poses, 1), frames.size() - 1);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    EXPECT_LT(seconds / frames.size(), 20e-6) << seconds * 1e6 / frames.size() << " us per frame";
+
+    ASSERT_EQ(poses.size(), frames.size());
+    EXPECT_EQ(poses.back().scale, 1.0f);
+    for (size_t f = 0; f + 1 < frames.size(); f += 97)
+        for (size_t i = 0; i < neutral.size(); ++i) EXPECT_NEAR(glm::length(frames[f][i] - neutral[i]), 0.0f, 1e-4f);
+}
+
+TEST(HeadPoseAligner, FindsTheStableMediaPipeLandmarks)
+{
+    const std::vector<int> pixelIndex = {10, 336, 107, 263, 386, 33, 6, 152, 454, 234, 4, 0};
+    EXPECT_EQ(HeadPoseAligner::stableLandmarks(pixelIndex), (std::vector<int>{0, 3, 5, 6, 8, 9, 10}));
+    EXPECT_TRUE(HeadPoseAligner::stableLandmarks({152, 0, 17}).empty());
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "IndexedMesh.h"
+#include "CompiledFaceRig.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// Flat n x n vertex grid in the XY plane, two triangles per cell.
+static void makeGrid(int n, std::vector<glm::vec3>& vertices, std::vector<uint32_t>& triangles)
+{
+    vertices.clear();
+    triangles.clear();
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x)
+            vertices.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    for (int y = 0; y + 1 < n; ++y)
+        for (int x = 0; x + 1 < n; ++x)
+        {
+            const uint32_t v = static_cast<uint32_t>(y * n + x);
+            triangles.insert(triangles.end(), {v, v + 1, v + n + 1, v, v + n + 1, v + n});
+        }
+}
+
+static void expectSameNormals(const IndexedMesh& a, const IndexedMesh& b)
+{
+    ASSERT_EQ(a.normals().size(), b.normals().size());
+    for (size_t v = 0; v < a.normals().size(); ++v)
+    {
+        EXPECT_NEAR(a.normals()[v].x, b.normals()[v].x, 1e-6f) << "vertex " << v;
+        EXPECT_NEAR(a.normals()[v].y, b.normals()[v].y, 1e-6f) << "vertex " << v;
+        EXPECT_NEAR(a.normals()[v].z, b.normals()[v].z, 1e-6f) << "vertex " << v;
+    }
+}
+
+TEST(IndexedMesh, BuildsAdjacency)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    makeGrid(3, vertices, triangles);
+
+    IndexedMesh mesh;
+    ASSERT_TRUE(mesh.build(vertices, triangles, 4));
+    EXPECT_EQ(mesh.vertexCount(), 9u);
+    EXPECT_EQ(mesh.faceCount(), 8u);
+
+    // the centre vertex belongs to six faces and has six neighbours
+    const auto& faceOffsets = mesh.vertexFaceOffsets();
+    EXPECT_EQ(faceOffsets[5] - faceOffsets[4], 6u);
+    const auto& ringOffsets = mesh.vertexNeighborOffsets();
+    std::vector<uint32_t> ring(mesh.vertexNeighbors().begin() + ringOffsets[4], mesh.vertexNeighbors().begin() + ringOffsets[5]);
+    EXPECT_EQ(ring, (std::vector<uint32_t>{0, 1, 3, 5, 7, 8}));
+
+    // a corner of the shared diagonal only touches one face
+    EXPECT_EQ(faceOffsets[3] - faceOffsets[2], 1u);
+    EXPECT_EQ(faceOffsets.back(), static_cast<uint32_t>(triangles.size()));
+
+    for (const glm::vec3& n : mesh.normals()) EXPECT_NEAR(n.z, 1.0f, 1e-6f);
+}
+
+TEST(IndexedMesh, RejectsInvalidTriangles)
+{
+    std::vector<glm::vec3> vertices(3, glm::vec3(0.0f));
+    IndexedMesh mesh;
+    EXPECT_FALSE(mesh.build(vertices, {0, 1}));
+    EXPECT_FALSE(mesh.build(vertices, {0, 1, 3}));
+    EXPECT_TRUE(mesh.build(vertices, {0, 1, 2}));
+}
+
+TEST(IndexedMesh, IncrementalNormalsMatchFullRecompute)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    makeGrid(40, vertices, triangles);
+
+    IndexedMesh incremental;
+    ASSERT_TRUE(incremental.build(vertices, triangles));
+
+    // raise a small bump in the middle of the grid
+    std::vector<uint32_t> moved;
+    std::vector<glm::vec3> positions;
+    for (int y = 18; y < 22; ++y)
+        for (int x = 18; x < 22; ++x)
+        {
+            const uint32_t v = static_cast<uint32_t>(y * 40 + x);
+            moved.push_back(v);
+            positions.push_back(vertices[v] + glm::vec3(0.0f, 0.0f, 0.3f * std::sin(0.5f * x + y)));
+        }
+    incremental.setPositions(moved, positions);
+    EXPECT_EQ(incremental.dirtyCount(), moved.size());
+
+    const size_t recomputed = incremental.updateDirtyNormals(4);
+    EXPECT_GT(recomputed, moved.size());
+    EXPECT_LT(recomputed, incremental.vertexCount() / 10);
+    EXPECT_EQ(incremental.dirtyCount(), 0u);
+    EXPECT_EQ(incremental.updateDirtyNormals(), 0u);
+
+    IndexedMesh full;
+    ASSERT_TRUE(full.build(incremental.vertices(), triangles));
+    expectSameNormals(incremental, full);
+}
+
+TEST(IndexedMesh, RigTouchedVerticesDriveTheUpdate)
+{
+    const std::string deltaPath = (std::filesystem::temp_directory_path() / "indexedMeshDeltas.json").string();
+    std::ofstream(deltaPath) << R"({"actionUnits":[
+        {"auId":1,"side":"left",
+         "activeMuscles":[{"muscleId":3,"deltas":[
+            {"vertexIndex":12,"position":[0,0,0],"delta":[0,0,1]},
+            {"vertexIndex":13,"position":[0,0,0],"delta":[0,0.5,0.5]}]}],
+         "passiveMuscles":[]},
+        {"auId":2,"side":"right",
+         "activeMuscles":[{"muscleId":4,"deltas":[
+            {"vertexIndex":30,"position":[0,0,0],"delta":[0.2,0,-1]}]}],
+         "passiveMuscles":[]}]})";
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON(deltaPath.c_str());
+    std::remove(deltaPath.c_str());
+    auto rig = CompiledFaceRig::compile(actionUnit, facialLandmark);
+    ASSERT_EQ(rig->slotCount(), 2u);
+
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    makeGrid(8, vertices, triangles);
+    IndexedMesh mesh;
+    ASSERT_TRUE(mesh.build(vertices, triangles));
+    CharacterDeformState state(rig, vertices);
+
+    // frame 1: both AUs on; frame 2: AU 2 back to zero, its vertex must return to rest
+    const std::vector<std::vector<float>> frames = {{1.0f, 0.7f}, {0.4f, 0.0f}};
+    std::vector<float> previous(rig->slotCount(), 0.0f);
+    for (const auto& weights : frames)
+    {
+        for (size_t s = 0; s < weights.size(); ++s) state.setSlotWeight(s, weights[s]);
+        ASSERT_TRUE(state.evaluate());
+
+        std::vector<uint32_t> touched;
+        rig->touchedVertices(previous, touched);
+        rig->touchedVertices(weights, touched);
+        ASSERT_TRUE(mesh.setAllPositions(state.deformedVertices(), touched));
+        mesh.updateDirtyNormals();
+        previous = weights;
+
+        IndexedMesh full;
+        ASSERT_TRUE(full.build(state.deformedVertices(), triangles));
+        expectSameNormals(mesh, full);
+    }
+}
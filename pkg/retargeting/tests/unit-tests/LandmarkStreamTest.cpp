@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "LandmarkProtocol.h"
+#include "LandmarkReplayServer.h"
+#include "LandmarkStreamClient.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+static std::string writeClip(const std::string& name, int frames, int landmarks)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream file(path);
+    file << "{\"data\": [";
+    for (int f = 0; f < frames; ++f)
+    {
+        file << (f ? "," : "") << "[";
+        for (int i = 0; i < landmarks; ++i)
+            file << (i ? "," : "") << "{\"x\": " << f << ", \"y\": " << i << ", \"z\": 0.5}";
+        file << "]";
+    }
+    file << "]}";
+    return path;
+}
+
+TEST(LandmarkProtocol, RoundTripAndLineFraming)
+{
+    LandmarkFrame frame;
+    frame.requestId = 7;
+    frame.index = 3;
+    frame.time = 0.1;
+    frame.landmarks = {{0.25f, 0.5f, -0.125f}, {1.0f, 2.0f, 3.0f}};
+    const std::string encoded = LandmarkProtocol::encodeFrame(frame) + LandmarkProtocol::encodeEnd(7, 4);
+
+    // deliver the bytes in small pieces as a socket may
+    LineBuffer lines;
+    std::vector<std::string> received;
+    for (size_t i = 0; i < encoded.size(); i += 5)
+    {
+        lines.append(encoded.data() + i, std::min<size_t>(5, encoded.size() - i));
+        std::string line;
+        while (lines.nextLine(line)) received.push_back(line);
+    }
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(lines.pending(), 0u);
+
+    LandmarkMessage decoded = LandmarkProtocol::decode(received[0]);
+    ASSERT_EQ(decoded.type, LandmarkMessageType::Frame);
+    EXPECT_EQ(decoded.frame.requestId, 7u);
+    EXPECT_EQ(decoded.frame.index, 3u);
+    ASSERT_EQ(decoded.frame.landmarks.size(), 2u);
+    EXPECT_FLOAT_EQ(decoded.frame.landmarks[0].z, -0.125f);
+
+    LandmarkMessage end = LandmarkProtocol::decode(received[1]);
+    ASSERT_EQ(end.type, LandmarkMessageType::End);
+    EXPECT_EQ(end.frameCount, 4u);
+
+    EXPECT_EQ(LandmarkProtocol::decode("{not json").type, LandmarkMessageType::Invalid);
+    EXPECT_EQ(LandmarkProtocol::decode("{\"type\":\"frame\",\"id\":1,\"index\":0,\"landmarks\":[1,2]}").type, LandmarkMessageType::Invalid);
+}
+
+TEST(LandmarkStream, ReplaysClipsOverUnixSocket)
+{
+    const std::string clipA = writeClip("pmx_stream_a.json", 2, 4);
+    const std::string clipB = writeClip("pmx_stream_b.json", 1, 4);
+    const std::string socketPath = (std::filesystem::temp_directory_path() / ("pmx_stream_" + std::to_string(::getpid()) + ".sock")).string();
+
+    LandmarkReplayServer server({clipA, clipB}, 0.0);
+    ASSERT_TRUE(server.start(socketPath));
+    EXPECT_EQ(server.frameCount(), 3u);
+
+    LandmarkStreamClient client;
+    ASSERT_TRUE(client.connect(socketPath));
+
+    std::atomic<int> callbacks{0};
+    ASSERT_TRUE(client.request(LandmarkRequest{42, "portrait.jpg", "audio.wav"}, [&](const LandmarkFrame&) { ++callbacks; }));
+
+    std::vector<LandmarkFrame> frames;
+    LandmarkFrame frame;
+    while (client.nextFrame(frame, 2000)) frames.push_back(frame);
+
+    EXPECT_TRUE(client.isFinished());
+    EXPECT_TRUE(client.error().empty());
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(callbacks.load(), 3);
+    for (uint32_t i = 0; i < frames.size(); ++i)
+    {
+        EXPECT_EQ(frames[i].requestId, 42u);
+        EXPECT_EQ(frames[i].index, i);
+        ASSERT_EQ(frames[i].landmarks.size(), 4u);
+    }
+    EXPECT_FLOAT_EQ(frames[1].landmarks[2].x, 1.0f);    // second frame of clip A
+    EXPECT_FLOAT_EQ(frames[2].landmarks[3].y, 3.0f);    // clip B follows
+
+    // the connection is reusable for the next clip
+    ASSERT_TRUE(client.request(LandmarkRequest{43, "portrait.jpg", "audio.wav"}));
+    int second = 0;
+    while (client.nextFrame(frame, 2000)) ++second;
+    EXPECT_EQ(second, 3);
+
+    client.close();
+    server.stop();
+    EXPECT_FALSE(std::filesystem::exists(socketPath));
+    std::remove(clipA.c_str());
+    std::remove(clipB.c_str());
+}
+
+TEST(LandmarkStream, ConnectFailsWithoutServer)
+{
+    LandmarkStreamClient client;
+    EXPECT_FALSE(client.connect((std::filesystem::temp_directory_path() / "pmx_stream_missing.sock").string()));
+    EXPECT_FALSE(client.request(LandmarkRequest{1, "", ""}));
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "LaplacianDeformer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+// Flat n x n vertex grid in the XY plane, two triangles per cell.
+static IndexedMesh makeGrid(int n)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x)
+            vertices.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    for (int y = 0; y + 1 < n; ++y)
+        for (int x = 0; x + 1 < n; ++x)
+        {
+            const uint32_t v = static_cast<uint32_t>(y * n + x);
+            triangles.insert(triangles.end(), {v, v + 1, v + n + 1, v, v + n + 1, v + n});
+        }
+    IndexedMesh mesh;
+    mesh.build(vertices, triangles);
+    return mesh;
+}
+
+TEST(SkylineCholesky, SolvesSparseSystem)
+{
+    // 1D Laplacian plus a few long-range couplings, made diagonally dominant
+    const size_t n = 50;
+    std::vector<std::vector<std::pair<uint32_t, double>>> rows(n);
+    auto couple = [&](uint32_t i, uint32_t j, double value) {
+        rows[i].push_back({j, value});
+        rows[j].push_back({i, value});
+    };
+    for (uint32_t i = 0; i + 1 < n; ++i) couple(i, i + 1, -1.0);
+    couple(3, 40, -0.5);
+    couple(10, 27, -0.25);
+    for (uint32_t i = 0; i < n; ++i) rows[i].push_back({i, 3.0 + 0.01 * i});
+
+    std::vector<uint32_t> offsets{0}, columns;
+    std::vector<double> values;
+    for (auto& row : rows)
+    {
+        std::sort(row.begin(), row.end());
+        for (auto& entry : row) {
+            columns.push_back(entry.first);
+            values.push_back(entry.second);
+        }
+        offsets.push_back(static_cast<uint32_t>(columns.size()));
+    }
+
+    SkylineCholesky solver;
+    ASSERT_TRUE(solver.analyze(n, offsets, columns));
+    ASSERT_TRUE(solver.factorize(values));
+
+    // two right-hand sides at once
+    std::vector<double> rhs(n * 2);
+    for (size_t i = 0; i < n; ++i) {
+        rhs[i * 2] = std::sin(0.3 * i);
+        rhs[i * 2 + 1] = 1.0;
+    }
+    std::vector<double> x = rhs;
+    ASSERT_TRUE(solver.solve(x, 2));
+
+    for (size_t i = 0; i < n; ++i)
+        for (size_t c = 0; c < 2; ++c)
+        {
+            double ax = 0.0;
+            for (uint32_t k = offsets[i]; k < offsets[i + 1]; ++k) ax += values[k] * x[columns[k] * 2 + c];
+            EXPECT_NEAR(ax, rhs[i * 2 + c], 1e-10);
+        }
+
+    // a negative diagonal is not positive definite
+    values[offsets[5]] = -10.0;
+    for (uint32_t k = offsets[5]; k < offsets[6]; ++k)
+        if (columns[k] == 5) values[k] = -10.0;
+    EXPECT_FALSE(solver.factorize(values));
+    EXPECT_FALSE(solver.solve(x, 2));
+}
+
+TEST(SkylineCholesky, OrderingKeepsEnvelopeNarrow)
+{
+    // grid graph with shuffled labels: without reordering its envelope would be close to dense
+    const uint32_t side = 20, n = side * side;
+    std::vector<uint32_t> label(n);
+    std::iota(label.begin(), label.end(), 0u);
+    std::shuffle(label.begin(), label.end(), std::mt19937(7));
+
+    std::vector<std::vector<uint32_t>> rows(n);
+    for (uint32_t y = 0; y < side; ++y)
+        for (uint32_t x = 0; x < side; ++x)
+        {
+            const uint32_t v = label[y * side + x];
+            rows[v].push_back(v);
+            if (x + 1 < side) { rows[v].push_back(label[y * side + x + 1]); rows[label[y * side + x + 1]].push_back(v); }
+            if (y + 1 < side) { rows[v].push_back(label[(y + 1) * side + x]); rows[label[(y + 1) * side + x]].push_back(v); }
+        }
+    std::vector<uint32_t> offsets{0}, columns;
+    for (auto& row : rows) {
+        std::sort(row.begin(), row.end());
+        columns.insert(columns.end(), row.begin(), row.end());
+        offsets.push_back(static_cast<uint32_t>(columns.size()));
+    }
+
+    SkylineCholesky solver;
+    ASSERT_TRUE(solver.analyze(n, offsets, columns));
+    // a band of about one grid row per matrix row, far below the n(n+1)/2 of a dense factor
+    EXPECT_LT(solver.envelopeSize(), static_cast<size_t>(n) * (side + 2));
+}
+
+TEST(LaplacianDeformer, TranslatesWithItsHandles)
+{
+    IndexedMesh mesh = makeGrid(12);
+    LaplacianDeformer deformer;
+    ASSERT_TRUE(deformer.setup(mesh, {0, 11, 132, 143, 66}, 100.0f, 2));
+
+    const glm::vec3 shift(0.5f, -1.0f, 2.0f);
+    std::vector<glm::vec3> targets;
+    for (uint32_t h : deformer.handles()) targets.push_back(mesh.vertices()[h] + shift);
+
+    std::vector<glm::vec3> deformed;
+    ASSERT_TRUE(deformer.deform(targets, deformed));
+    ASSERT_EQ(deformed.size(), mesh.vertexCount());
+    for (size_t v = 0; v < deformed.size(); ++v)
+    {
+        const glm::vec3 d = deformed[v] - mesh.vertices()[v];
+        EXPECT_NEAR(d.x, shift.x, 1e-3f);
+        EXPECT_NEAR(d.y, shift.y, 1e-3f);
+        EXPECT_NEAR(d.z, shift.z, 1e-3f);
+    }
+}
+
+TEST(LaplacianDeformer, PullsTheSurfaceSmoothly)
+{
+    IndexedMesh mesh = makeGrid(15);
+    const uint32_t centre = 7 * 15 + 7;
+    LaplacianDeformer deformer;
+    ASSERT_TRUE(deformer.setup(mesh, {0, 14, 210, 224, centre}, 1000.0f, 2));
+
+    std::vector<glm::vec3> targets;
+    for (uint32_t h : deformer.handles()) targets.push_back(mesh.vertices()[h]);
+    targets.back().z = 1.0f;
+
+    std::vector<glm::vec3> deformed;
+    ASSERT_TRUE(deformer.deform(targets, deformed));
+    EXPECT_NEAR(deformed[centre].z, 1.0f, 0.01f);
+    EXPECT_NEAR(deformed[0].z, 0.0f, 0.01f);
+
+    // the bump falls off away from the centre handle
+    const float nearCentre = deformed[7 * 15 + 9].z;
+    const float farther = deformed[7 * 15 + 12].z;
+    EXPECT_GT(nearCentre, farther);
+    EXPECT_GT(farther, 0.0f);
+    EXPECT_LT(nearCentre, 1.0f);
+
+    // a weaker handle weight only refactorizes, and the handle no longer reaches its target
+    ASSERT_TRUE(deformer.setHandleWeight(0.01f));
+    ASSERT_TRUE(deformer.deform(targets, deformed));
+    EXPECT_LT(deformed[centre].z, 0.9f);
+}
+
+TEST(LaplacianDeformer, BatchMatchesSingleFrames)
+{
+    IndexedMesh mesh = makeGrid(10);
+    LaplacianDeformer deformer;
+    ASSERT_TRUE(deformer.setup(mesh, {0, 9, 90, 99, 44, 55}, 50.0f, 1));
+
+    std::vector<std::vector<glm::vec3>> clip;
+    for (int f = 0; f < 24; ++f)
+    {
+        std::vector<glm::vec3> targets;
+        for (size_t h = 0; h < deformer.handles().size(); ++h)
+            targets.push_back(mesh.vertices()[deformer.handles()[h]] + glm::vec3(0.0f, 0.0f, std::sin(0.2f * f + h)));
+        clip.push_back(targets);
+    }
+
+    std::vector<std::vector<glm::vec3>> frames;
+    ASSERT_TRUE(deformer.deformBatch(clip, frames, 4));
+    ASSERT_EQ(frames.size(), clip.size());
+    for (size_t f = 0; f < clip.size(); f += 7)
+    {
+        std::vector<glm::vec3> single;
+        ASSERT_TRUE(deformer.deform(clip[f], single));
+        for (size_t v = 0; v < single.size(); ++v) EXPECT_NEAR(frames[f][v].z, single[v].z, 1e-5f);
+    }
+
+    clip[3].pop_back();
+    EXPECT_FALSE(deformer.deformBatch(clip, frames));
+}
+
+TEST(LaplacianDeformer, RejectsInvalidSetup)
+{
+    IndexedMesh mesh = makeGrid(4);
+    LaplacianDeformer deformer;
+    EXPECT_FALSE(deformer.setup(mesh, {0, 16}));
+    EXPECT_FALSE(deformer.setup(mesh, {0}, 1.0f, 3));
+    EXPECT_FALSE(deformer.isReady());
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "LinearBlendSkinning.h"
+#include <glm/vec3.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+TEST(LinearBlendSkinning, BlendsTwoJoints)
+{
+    std::vector<glm::vec3> jointPositions = {{0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}};
+    std::vector<glm::vec3> rest = {{0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {2.0f, 1.0f, 0.0f}, {5.0f, 5.0f, 5.0f}};
+
+    LinearBlendSkinning skinning;
+    ASSERT_TRUE(skinning.setBindPoses(LinearBlendSkinning::translationPoses(jointPositions)));
+
+    // vertex 3 has no influences and must stay at rest
+    std::vector<JointInfluence> influences = {
+        {0, 0, 1.0f},
+        {1, 0, 0.5f}, {1, 1, 0.5f},
+        {2, 1, 2.0f},
+    };
+    ASSERT_TRUE(skinning.setWeights(rest.size(), influences));
+
+    // joint 1 moves up by one unit, joint 0 stays
+    std::vector<glm::mat4> pose = LinearBlendSkinning::translationPoses(jointPositions);
+    pose[1] = glm::translate(pose[1], glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<glm::vec3> deformed;
+    ASSERT_TRUE(skinning.deform(rest, pose, deformed));
+    ASSERT_EQ(deformed.size(), rest.size());
+
+    EXPECT_NEAR(deformed[0].y, 1.0f, 1e-5f);
+    EXPECT_NEAR(deformed[1].y, 1.5f, 1e-5f);
+    EXPECT_NEAR(deformed[2].y, 2.0f, 1e-5f);
+    EXPECT_EQ(deformed[3], rest[3]);
+}
+
+TEST(LinearBlendSkinning, RequiresBindPosesBeforeWeights)
+{
+    LinearBlendSkinning skinning;
+    std::vector<JointInfluence> influences = {{0, 0, 1.0f}};
+    EXPECT_FALSE(skinning.setWeights(1, influences));
+
+    ASSERT_TRUE(skinning.setBindPoses(LinearBlendSkinning::translationPoses({{0.0f, 0.0f, 0.0f}})));
+    EXPECT_TRUE(skinning.setWeights(1, influences));
+
+    // a joint index validated against two joints must not be read with one
+    const std::vector<glm::vec3> rest = {{0.0f, 0.0f, 0.0f}};
+    std::vector<glm::vec3> deformed;
+    ASSERT_TRUE(skinning.setBindPoses(LinearBlendSkinning::translationPoses({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}})));
+    ASSERT_TRUE(skinning.setWeights(1, {{0, 1, 1.0f}}));
+    EXPECT_TRUE(skinning.deform(rest, LinearBlendSkinning::translationPoses({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}), deformed));
+    ASSERT_TRUE(skinning.setBindPoses(LinearBlendSkinning::translationPoses({{0.0f, 0.0f, 0.0f}})));
+    EXPECT_FALSE(skinning.deform(rest, LinearBlendSkinning::translationPoses({{0.0f, 0.0f, 0.0f}}), deformed));
+}
+
+TEST(LinearBlendSkinning, KeepsStrongestInfluences)
+{
+    std::vector<glm::vec3> jointPositions(6, glm::vec3(0.0f));
+    LinearBlendSkinning skinning;
+    ASSERT_TRUE(skinning.setBindPoses(LinearBlendSkinning::translationPoses(jointPositions)));
+
+    // six influences on one vertex: the two weakest (joints 0 and 1) are dropped
+    std::vector<JointInfluence> influences;
+    for (int j = 0; j < 6; ++j) influences.push_back({0, j, 0.1f * static_cast<float>(j + 1)});
+    ASSERT_TRUE(skinning.setWeights(1, influences));
+
+    // only joints 0 and 1 move, so the vertex must not move at all
+    std::vector<glm::mat4> pose = LinearBlendSkinning::translationPoses(jointPositions);
+    pose[0] = glm::translate(pose[0], glm::vec3(1.0f, 0.0f, 0.0f));
+    pose[1] = glm::translate(pose[1], glm::vec3(1.0f, 0.0f, 0.0f));
+
+    std::vector<glm::vec3> rest = {{0.0f, 0.0f, 0.0f}};
+    std::vector<glm::vec3> deformed;
+    ASSERT_TRUE(skinning.deform(rest, pose, deformed));
+    EXPECT_NEAR(deformed[0].x, 0.0f, 1e-6f);
+
+    // out of range joints are rejected
+    EXPECT_FALSE(skinning.setWeights(1, {{0, 7, 1.0f}}));
+}
+
+TEST(LinearBlendSkinning, ParallelMatchesSerial)
+{
+    std::vector<glm::vec3> jointPositions;
+    for (int j = 0; j < 51; ++j) jointPositions.push_back({static_cast<float>(j % 7), static_cast<float>(j / 7), 0.0f});
+
+    std::vector<glm::vec3> rest;
+    for (int v = 0; v < 5000; ++v) rest.push_back({(v % 71) * 0.1f, (v / 71) * 0.1f, (v % 13) * 0.05f});
+
+    LinearBlendSkinning skinning;
+    ASSERT_TRUE(skinning.setBindPoses(LinearBlendSkinning::translationPoses(jointPositions)));
+    ASSERT_TRUE(skinning.setWeights(rest.size(), LinearBlendSkinning::computeDistanceWeights(rest, jointPositions)));
+
+    std::vector<glm::mat4> pose = LinearBlendSkinning::translationPoses(jointPositions);
+    for (size_t j = 0; j < pose.size(); ++j)
+        pose[j] = glm::rotate(pose[j], 0.01f * static_cast<float>(j), glm::vec3(0.0f, 0.0f, 1.0f));
+
+    std::vector<glm::vec3> serial;
+    std::vector<glm::vec3> parallel;
+    ASSERT_TRUE(skinning.deform(rest, pose, serial, 1));
+    ASSERT_TRUE(skinning.deform(rest, pose, parallel, 4));
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t v = 0; v < serial.size(); ++v) EXPECT_EQ(serial[v], parallel[v]) << "vertex " << v;
+}
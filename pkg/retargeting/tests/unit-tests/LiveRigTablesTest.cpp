@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "LiveRigTables.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+static const char* kDeltas = R"({"actionUnits":[
+    {"auId":1,"side":"left",
+     "activeMuscles":[{"muscleId":3,"deltas":[{"vertexIndex":1,"position":[0,0,0],"delta":[1,0,0]}]}],
+     "passiveMuscles":[]}]})";
+
+static const char* kMappings = R"({"mappings":[{"auId":1,"side":"left","landmarkIndices":[0,1]}]})";
+
+// Temporary data directory holding the delta and mapping tables.
+static std::filesystem::path makeDataDir(const std::string& name)
+{
+    auto dir = std::filesystem::temp_directory_path() / (name + "_" + std::to_string(::getpid()));
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "deltaTransfer.json") << kDeltas;
+    std::ofstream(dir / "landmarksActionUnits.json") << kMappings;
+    std::ofstream(dir / "landmarksPixelIndex.json") << "[10, 20, 30]";
+    return dir;
+}
+
+static RigTableSet loadTables(const std::filesystem::path& dir)
+{
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON((dir / "deltaTransfer.json").string().c_str());
+    facialLandmark.loadLandmarksActionUnitsMappingFromJson((dir / "landmarksActionUnits.json").string().c_str());
+    facialLandmark.loadLandmarksPixelIndexFromJSON((dir / "landmarksPixelIndex.json").string().c_str());
+    return RigTableSet::fromObjects(actionUnit, facialLandmark);
+}
+
+TEST(AtomicTable, ReadersKeepTheirSnapshot)
+{
+    AtomicTable<std::vector<int>> table(std::make_shared<const std::vector<int>>(std::vector<int>{1}));
+    auto snapshot = table.load();
+    table.store(std::make_shared<const std::vector<int>>(std::vector<int>{2, 3}));
+
+    EXPECT_EQ(table.version(), 1u);
+    EXPECT_EQ(snapshot->size(), 1u);
+    EXPECT_EQ(table.load()->size(), 2u);
+}
+
+TEST(LiveRigTables, ReloadReplacesOnlyTheChangedTable)
+{
+    auto dir = makeDataDir("pmx_live_reload");
+    LiveRigTables live(loadTables(dir));
+    auto before = live.rig();
+    auto tablesBefore = live.tables();
+    ASSERT_EQ(before->slotCount(), 1u);
+    EXPECT_EQ(live.version(), 1u);
+
+    std::ofstream(dir / "landmarksActionUnits.json") << R"({"mappings":[
+        {"auId":1,"side":"left","landmarkIndices":[0,1]},
+        {"auId":2,"side":"right","landmarkIndices":[1,2]}]})";
+    ASSERT_TRUE(live.reloadFile("landmarksActionUnits.json", (dir / "landmarksActionUnits.json").string()));
+
+    EXPECT_EQ(live.version(), 2u);
+    EXPECT_EQ(live.rig()->slotCount(), 2u);
+    EXPECT_EQ(live.rig()->landmarksActionUnitMap().size(), 2u);
+    // the delta table was not parsed again, the new set shares it
+    EXPECT_EQ(live.tables()->auDeltaTable, tablesBefore->auDeltaTable);
+    // a reader holding the previous rig is unaffected
+    EXPECT_EQ(before->slotCount(), 1u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LiveRigTables, RejectsInvalidTables)
+{
+    auto dir = makeDataDir("pmx_live_reject");
+    LiveRigTables live(loadTables(dir));
+
+    std::ofstream(dir / "deltaTransfer.json") << "{ truncated";
+    EXPECT_FALSE(live.reloadFile("deltaTransfer.json", (dir / "deltaTransfer.json").string()));
+
+    // landmark 7 is outside the 3 landmarks of the pixel table
+    std::ofstream(dir / "landmarksActionUnits.json") << R"({"mappings":[{"auId":1,"side":"left","landmarkIndices":[0,7]}]})";
+    EXPECT_FALSE(live.reloadFile("landmarksActionUnits.json", (dir / "landmarksActionUnits.json").string()));
+
+    EXPECT_FALSE(live.reloadFile("notATable.json", (dir / "deltaTransfer.json").string()));
+    EXPECT_EQ(live.version(), 1u);
+    EXPECT_EQ(live.rig()->slotCount(), 1u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LiveRigTables, WatcherReloadsSavedFile)
+{
+    auto dir = makeDataDir("pmx_live_watch");
+    LiveRigTables live(loadTables(dir));
+
+    std::atomic<int> accepted{0};
+    ASSERT_TRUE(live.watch(dir.string(), [&](const std::string& fileName, bool ok) {
+        if (ok && fileName == "deltaTransfer.json") ++accepted;
+    }));
+
+    // save through a temporary file and a rename, as editors do
+    std::ofstream(dir / "deltaTransfer.json.tmp") << R"({"actionUnits":[
+        {"auId":1,"side":"left","activeMuscles":[{"muscleId":3,"deltas":[{"vertexIndex":4,"position":[0,0,0],"delta":[0,1,0]}]}],"passiveMuscles":[]}]})";
+    std::filesystem::rename(dir / "deltaTransfer.json.tmp", dir / "deltaTransfer.json");
+
+    for (int i = 0; i < 300 && accepted.load() == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    live.stopWatching();
+
+    ASSERT_EQ(accepted.load(), 1);
+    EXPECT_EQ(live.rig()->requiredVertexCount(), 5u);
+
+    std::filesystem::remove_all(dir);
+}
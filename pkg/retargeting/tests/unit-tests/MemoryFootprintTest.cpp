@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "CompiledFaceRig.h"
+#include "FrameArena.h"
+#include "MemoryFootprint.h"
+#include "MetricsRegistry.h"
+#include "ParallelUtils.h"
+#include "RigTableSet.h"
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+TEST(MemoryFootprint, AccumulatesAndNestsTables)
+{
+    MemoryFootprint nested;
+    nested.add("offsets", 16);
+    nested.add("vertices", 64);
+
+    MemoryFootprint footprint;
+    footprint.add("slots", 40);
+    footprint.add("slots", 8);
+    footprint.add("musclePatches", nested);
+    EXPECT_EQ(footprint.tables().size(), 3u);
+    EXPECT_EQ(footprint.bytes("slots"), 48u);
+    EXPECT_EQ(footprint.bytes("musclePatches.vertices"), 64u);
+    EXPECT_EQ(footprint.bytes("missing"), 0u);
+    EXPECT_EQ(footprint.totalBytes(), 128u);
+
+    const nlohmann::json json = nlohmann::json::parse(footprint.toJSON());
+    EXPECT_EQ(json["totalBytes"], 128);
+    EXPECT_EQ(json["tables"]["musclePatches.offsets"], 16);
+}
+
+TEST(MemoryFootprint, CountsContainerBuffers)
+{
+    std::vector<glm::vec3> vertices;
+    vertices.reserve(100);
+    EXPECT_EQ(heapBytes(vertices), 100 * sizeof(glm::vec3));
+
+    EXPECT_EQ(heapBytes(std::string("AU12")), 0u);
+    const std::string path(200, 'x');
+    EXPECT_EQ(heapBytes(path), path.capacity() + 1);
+
+    std::unordered_map<int, std::vector<int>> map;
+    EXPECT_EQ(heapBytes(map), 0u);
+    map[1] = std::vector<int>(10);
+    map[2] = std::vector<int>(30);
+    EXPECT_GT(heapBytes(map), 2 * sizeof(std::pair<const int, std::vector<int>>));
+    EXPECT_EQ(heapBytesOfVectorMap(map), heapBytes(map) + 40 * sizeof(int));
+}
+
+TEST(MemoryFootprint, OwnersReportTheirTables)
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string deltaPath = (dir / "pmx_footprint_deltas.json").string();
+    const std::string mappingPath = (dir / "pmx_footprint_mappings.json").string();
+    std::ofstream(deltaPath) << R"({"actionUnits":[
+        {"auId":1,"side":"left","activeMuscles":[{"muscleId":3,"deltas":[{"vertexIndex":0,"position":[0,0,0],"delta":[1,0,0]},
+                                                                          {"vertexIndex":2,"position":[0,0,0],"delta":[0,0,1]}]}],"passiveMuscles":[]},
+        {"auId":2,"side":"center","activeMuscles":[{"muscleId":4,"deltas":[{"vertexIndex":1,"position":[0,0,0],"delta":[0,1,0]}]}],"passiveMuscles":[]}]})";
+    std::ofstream(mappingPath) << R"({"mappings":[
+        {"auId":1,"side":"left","landmarkIndices":[0,1,2,3]},
+        {"auId":2,"side":"center","landmarkIndices":[4,5]}]})";
+
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    EXPECT_EQ(actionUnit.memoryFootprint().bytes("auDeltaEntries"), 0u);
+    actionUnit.loadDeltaTransfersFromJSON(deltaPath.c_str());
+    ASSERT_TRUE(facialLandmark.loadLandmarksActionUnitsMappingFromJson(mappingPath.c_str()));
+
+    const MemoryFootprint auFootprint = actionUnit.memoryFootprint();
+    EXPECT_GE(auFootprint.bytes("auDeltaEntries"), 3 * sizeof(VertexDelta));
+    EXPECT_GE(auFootprint.bytes("auDeltaTable"), 2 * sizeof(ActionUnitDelta) + 2 * sizeof(MuscleDelta));
+    EXPECT_GE(facialLandmark.memoryFootprint().bytes("landmarksActionUnitMap"), 6 * sizeof(int) + 2 * sizeof(landmarksActionUnit));
+
+    auto rig = CompiledFaceRig::compile(actionUnit, facialLandmark);
+    ASSERT_TRUE(rig);
+    const MemoryFootprint rigFootprint = rig->memoryFootprint();
+    EXPECT_EQ(rigFootprint.bytes("deltaValues"), rig->deltaValues().capacity() * sizeof(glm::vec3));
+    EXPECT_EQ(rigFootprint.bytes("landmarkPairs"), rig->landmarkPairs().capacity() * sizeof(uint32_t));
+    EXPECT_EQ(rigFootprint.bytes("deltaTiles.deltas"), rig->deltaTiles().deltas().capacity() * sizeof(glm::vec3));
+    EXPECT_EQ(rigFootprint.bytes("musclePatches.offsets"), rig->musclePatches().offsets().capacity() * sizeof(uint32_t));
+
+    size_t total = 0;
+    for (const MemoryTable& table : rigFootprint.tables()) total += table.bytes;
+    EXPECT_EQ(rigFootprint.totalBytes(), total);
+
+    // the live tables report the same delta and mapping bytes as the objects they were snapshotted from
+    const MemoryFootprint tablesFootprint = RigTableSet::fromObjects(actionUnit, facialLandmark).memoryFootprint();
+    EXPECT_GE(tablesFootprint.bytes("deltaTransfer.auDeltaEntries"), 3 * sizeof(VertexDelta));
+    EXPECT_EQ(tablesFootprint.bytes("landmarksActionUnits"), facialLandmark.memoryFootprint().bytes("landmarksActionUnitMap"));
+
+    FrameArena arena(1024);
+    EXPECT_EQ(arena.memoryFootprint().bytes("block"), 1024u);
+
+    std::filesystem::remove(deltaPath);
+    std::filesystem::remove(mappingPath);
+}
+
+TEST(MemoryTracker, ScopesNestAndFollowParallelWorkers)
+{
+    EXPECT_EQ(MemoryTracker::current(), MemorySubsystem::other);
+    {
+        MemoryScope outer(MemorySubsystem::actionUnit);
+        {
+            MemoryScope inner(MemorySubsystem::facialMesh);
+            EXPECT_EQ(MemoryTracker::current(), MemorySubsystem::facialMesh);
+        }
+        EXPECT_EQ(MemoryTracker::current(), MemorySubsystem::actionUnit);
+
+        std::vector<MemorySubsystem> seen(8, MemorySubsystem::other);
+        parallelFor(0, seen.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) seen[i] = MemoryTracker::current();
+        }, 4, 1);
+        for (MemorySubsystem subsystem : seen) EXPECT_EQ(subsystem, MemorySubsystem::actionUnit);
+    }
+    EXPECT_EQ(MemoryTracker::current(), MemorySubsystem::other);
+    EXPECT_STREQ(MemoryTracker::name(MemorySubsystem::dccInterface), "dccInterface");
+
+    // only executables that link the tracking allocator report counts
+#ifdef PIXELMUX_TRACK_ALLOCATIONS
+    EXPECT_TRUE(MemoryTracker::enabled());
+#else
+    EXPECT_FALSE(MemoryTracker::enabled());
+#endif
+
+    const nlohmann::json json = nlohmann::json::parse(MemoryTracker::toJSON());
+    EXPECT_EQ(json["enabled"], MemoryTracker::enabled());
+    EXPECT_EQ(json["subsystems"].size(), static_cast<size_t>(MemorySubsystem::count));
+}
+
+TEST(MemoryTracker, ChargesAllocationsToTheirSubsystem)
+{
+    const int64_t before = MemoryTracker::liveBytes(MemorySubsystem::facialMesh);
+    std::vector<glm::vec3> buffer;
+    {
+        MemoryScope scope(MemorySubsystem::facialMesh);
+        buffer.resize(1 << 16);
+    }
+    const int64_t bytes = static_cast<int64_t>(buffer.capacity() * sizeof(glm::vec3));
+
+    if (!MemoryTracker::enabled())
+    {
+        EXPECT_EQ(MemoryTracker::liveBytes(MemorySubsystem::facialMesh), 0);
+        return;
+    }
+
+    // the buffer stays charged to facialMesh until it is freed, wherever that happens
+    EXPECT_EQ(MemoryTracker::liveBytes(MemorySubsystem::facialMesh) - before, bytes);
+    EXPECT_GE(MemoryTracker::peakBytes(MemorySubsystem::facialMesh), before + bytes);
+    std::vector<glm::vec3>().swap(buffer);
+    EXPECT_EQ(MemoryTracker::liveBytes(MemorySubsystem::facialMesh), before);
+
+    MemoryTracker::publishMetrics();
+    EXPECT_NE(MetricsRegistry::global().toPrometheus().find("pixelmux_heap_facialMesh_bytes"), std::string::npos);
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "MeshLODBuilder.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+static const int kGrid = 48;
+
+// Curved sheet of kGrid x kGrid vertices, two triangles per quad.
+static void makeSheet(std::vector<glm::vec3>& vertices, std::vector<uint32_t>& triangles)
+{
+    for (int y = 0; y < kGrid; ++y)
+        for (int x = 0; x < kGrid; ++x)
+        {
+            const float u = static_cast<float>(x) / (kGrid - 1);
+            const float v = static_cast<float>(y) / (kGrid - 1);
+            vertices.emplace_back(u, v, 0.2f * std::sin(3.0f * u) * std::cos(2.0f * v));
+        }
+    for (int y = 0; y + 1 < kGrid; ++y)
+        for (int x = 0; x + 1 < kGrid; ++x)
+        {
+            const uint32_t a = y * kGrid + x;
+            triangles.insert(triangles.end(), {a, a + 1, a + kGrid, a + 1, a + kGrid + 1, a + kGrid});
+        }
+}
+
+// AU 1 left moves every vertex along z by a smooth field; landmarks on three vertices.
+static std::shared_ptr<const CompiledFaceRig> makeSheetRig(const std::vector<glm::vec3>& vertices, const std::vector<int>& landmarks)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::ofstream deltas(dir / "meshLODDeltas.json");
+    deltas << R"({"actionUnits":[{"auId":1,"side":"left","activeMuscles":[{"muscleId":1,"deltas":[)";
+    for (size_t v = 0; v < vertices.size(); ++v)
+        deltas << (v ? "," : "") << R"({"vertexIndex":)" << v << R"(,"position":[0,0,0],"delta":[0,0,)" << vertices[v].x * vertices[v].y << "]}";
+    deltas << R"(]}],"passiveMuscles":[]}]})";
+    deltas.close();
+    std::ofstream landmarkFile(dir / "meshLODLandmarks.json");
+    landmarkFile << "[" << landmarks[0] << "," << landmarks[1] << "," << landmarks[2] << "]";
+    landmarkFile.close();
+
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON((dir / "meshLODDeltas.json").string().c_str());
+    facialLandmark.loadLandmarksMeshIndexFromJSON((dir / "meshLODLandmarks.json").string().c_str());
+    std::filesystem::remove(dir / "meshLODDeltas.json");
+    std::filesystem::remove(dir / "meshLODLandmarks.json");
+    return CompiledFaceRig::compile(actionUnit, facialLandmark);
+}
+
+TEST(MeshLODBuilder, DecimatesByClustering)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    makeSheet(vertices, triangles);
+    const std::vector<int> pinned = {5, 1000, 2001};
+
+    MeshLOD lod;
+    ASSERT_TRUE(MeshLODBuilder::decimate(vertices, triangles, vertices.size() / 8, pinned, lod));
+    EXPECT_LE(lod.vertices.size(), vertices.size() / 8);
+    EXPECT_GT(lod.vertices.size(), vertices.size() / 32);
+    EXPECT_LT(lod.triangles.size(), triangles.size() / 4);
+    ASSERT_EQ(lod.clusterOf.size(), vertices.size());
+
+    // proxy vertices are template vertices; pinned ones keep their own cluster
+    for (size_t p = 0; p < lod.vertices.size(); ++p)
+    {
+        EXPECT_EQ(lod.vertices[p], vertices[lod.sourceVertex[p]]);
+        EXPECT_EQ(lod.clusterOf[lod.sourceVertex[p]], p);
+    }
+    for (int v : pinned) EXPECT_EQ(lod.sourceVertex[lod.clusterOf[v]], static_cast<uint32_t>(v));
+
+    std::set<std::array<uint32_t, 3>> unique;
+    for (size_t t = 0; t < lod.triangles.size(); t += 3)
+    {
+        const std::array<uint32_t, 3> tri = {lod.triangles[t], lod.triangles[t + 1], lod.triangles[t + 2]};
+        for (uint32_t p : tri) ASSERT_LT(p, lod.vertices.size());
+        EXPECT_TRUE(tri[0] != tri[1] && tri[1] != tri[2] && tri[0] != tri[2]);
+        EXPECT_TRUE(unique.insert(tri).second);
+    }
+
+    MeshLOD full;
+    ASSERT_TRUE(MeshLODBuilder::decimate(vertices, triangles, vertices.size(), pinned, full));
+    EXPECT_EQ(full.vertices, vertices);
+    EXPECT_FALSE(MeshLODBuilder::decimate(vertices, {0, 1, static_cast<uint32_t>(vertices.size())}, 10, pinned, lod));
+}
+
+TEST(MeshLODBuilder, ResamplesTheRigOntoEveryLevel)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    makeSheet(vertices, triangles);
+    const std::vector<int> landmarks = {5, 1000, 2001};
+    auto rig = makeSheetRig(vertices, landmarks);
+    ASSERT_TRUE(rig);
+
+    const std::string cacheDir = (std::filesystem::temp_directory_path() / "meshLODCache").string();
+    std::filesystem::remove_all(cacheDir);
+    const std::vector<MeshLOD> levels = MeshLODBuilder::build(*rig, vertices, triangles, cacheDir);
+    ASSERT_EQ(levels.size(), 2u);
+    EXPECT_GT(levels[0].vertices.size(), levels[1].vertices.size());
+
+    CharacterDeformState hero(rig, vertices);
+    hero.setWeight(1, Side::left, 1.0f);
+    hero.evaluate();
+    for (const MeshLOD& lod : levels)
+    {
+        ASSERT_TRUE(lod.rig);
+        EXPECT_LE(lod.rig->requiredVertexCount(), lod.vertices.size());
+        ASSERT_EQ(lod.rig->landmarksMeshIndex().size(), landmarks.size());
+        for (size_t l = 0; l < landmarks.size(); ++l)
+            EXPECT_EQ(lod.sourceVertex[lod.rig->landmarksMeshIndex()[l]], static_cast<uint32_t>(landmarks[l]));
+
+        // the proxy deforms like the hero mesh at the vertices it keeps
+        CharacterDeformState proxy(lod.rig, lod.vertices);
+        proxy.setWeight(1, Side::left, 1.0f);
+        proxy.evaluate();
+        for (size_t p = 0; p < lod.vertices.size(); ++p)
+        {
+            const glm::vec3 expected = hero.deformedVertices()[lod.sourceVertex[p]];
+            EXPECT_NEAR(proxy.deformedVertices()[p].z, expected.z, 1e-4f) << "proxy vertex " << p;
+        }
+    }
+
+    // placed on the template itself, the proxy moves like the template vertices it kept
+    CharacterDeformState coarse(levels[0].rig, levels[0].vertices);
+    coarse.setWeight(1, Side::left, 1.0f);
+    coarse.evaluate();
+    MeshLODPlacement placement;
+    ASSERT_TRUE(MeshLODBuilder::place(levels[0], vertices, nullptr, placement));
+    std::vector<glm::vec3> points;
+    ASSERT_TRUE(MeshLODBuilder::moveProxy(levels[0], placement, coarse.deformedVertices(), points));
+    ASSERT_EQ(points.size(), levels[0].vertices.size());
+    for (size_t p = 0; p < levels[0].vertices.size(); ++p)
+    {
+        const uint32_t v = levels[0].sourceVertex[p];
+        EXPECT_NEAR(points[p].z, hero.deformedVertices()[v].z, 1e-4f) << "template vertex " << v;
+    }
+    EXPECT_FALSE(MeshLODBuilder::moveProxy(levels[0], placement, vertices, points));
+
+    // on a user mesh twice the template size, the proxy sits on the user mesh and its motion is in user units
+    std::vector<glm::vec3> userMesh(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) userMesh[v] = vertices[v] * 2.0f + glm::vec3(0.0f, 0.0f, 1.0f);
+    TopologyCorrespondence correspondence;
+    ASSERT_TRUE(correspondence.build(userMesh, vertices, std::vector<unsigned int>(triangles.begin(), triangles.end())));
+    ASSERT_TRUE(MeshLODBuilder::place(levels[0], userMesh, &correspondence, placement));
+    EXPECT_NEAR(placement.unitScale, 2.0f, 1e-4f);
+    ASSERT_TRUE(MeshLODBuilder::moveProxy(levels[0], placement, coarse.deformedVertices(), points));
+    for (size_t p = 0; p < levels[0].vertices.size(); ++p)
+    {
+        const uint32_t v = levels[0].sourceVertex[p];
+        EXPECT_NEAR(points[p].z, userMesh[v].z + 2.0f * (hero.deformedVertices()[v].z - vertices[v].z), 1e-3f) << "template vertex " << v;
+    }
+    EXPECT_FALSE(MeshLODBuilder::place(levels[0], levels[0].vertices, &correspondence, placement));
+
+    // the second build reads the correspondence sidecars
+    size_t sidecars = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(cacheDir)) sidecars += entry.is_regular_file();
+    EXPECT_EQ(sidecars, 2u);
+    const std::vector<MeshLOD> cached = MeshLODBuilder::build(*rig, vertices, triangles, cacheDir);
+    ASSERT_EQ(cached.size(), 2u);
+    EXPECT_EQ(cached[1].rig->deltaValues().size(), levels[1].rig->deltaValues().size());
+    std::filesystem::remove_all(cacheDir);
+}
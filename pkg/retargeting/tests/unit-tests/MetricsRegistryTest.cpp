@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "FacialLandmark.h"
+#include "MetricsRegistry.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+TEST(MetricsRegistry, RegistersEachNameOnce)
+{
+    auto registry = std::make_unique<MetricsRegistry>();
+    MetricCounter& frames = registry->counter("frames_total", "Frames");
+    EXPECT_EQ(&registry->counter("frames_total"), &frames);
+    registry->gauge("queue_depth");
+    registry->histogram("parse_seconds");
+    EXPECT_EQ(registry->size(), 3u);
+
+    // clashes and invalid names get a metric that is never exported
+    MetricGauge& clash = registry->gauge("frames_total");
+    clash.set(7);
+    registry->counter("1frames");
+    registry->counter("frames total");
+    registry->counter("");
+    EXPECT_EQ(registry->size(), 3u);
+    EXPECT_EQ(registry->toPrometheus().find(" 7\n"), std::string::npos);
+
+    // concurrent registrations of the same names agree, concurrent updates are not lost
+    std::vector<std::thread> threads;
+    std::vector<MetricCounter*> seen(8);
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&, t]() {
+            seen[t] = &registry->counter("shared_total");
+            for (int i = 0; i < 10000; ++i)
+            {
+                seen[t]->add();
+                registry->histogram("parse_seconds").observe(1e-5);
+            }
+        });
+    for (auto& thread : threads) thread.join();
+    for (MetricCounter* counter : seen) EXPECT_EQ(counter, seen[0]);
+    EXPECT_EQ(seen[0]->value(), 80000u);
+    EXPECT_EQ(registry->histogram("parse_seconds").count(), 80000u);
+
+    registry->reset();
+    EXPECT_EQ(seen[0]->value(), 0u);
+    EXPECT_EQ(registry->size(), 4u);
+}
+
+TEST(MetricsRegistry, HistogramBucketsAndGaugePeaks)
+{
+    MetricHistogram histogram;
+    histogram.observe(0.5e-6);
+    histogram.observe(1e-6);
+    histogram.observe(3e-6);
+    histogram.observe(4e-6);
+    histogram.observe(20.0);
+    EXPECT_EQ(histogram.bucket(0), 2u);
+    EXPECT_EQ(histogram.bucket(2), 2u);
+    EXPECT_EQ(histogram.bucket(MetricHistogram::kBucketCount), 1u);
+    EXPECT_EQ(histogram.count(), 5u);
+    EXPECT_NEAR(histogram.sum(), 20.0000085, 1e-8);
+    EXPECT_DOUBLE_EQ(histogram.quantile(0.4), 1e-6);
+    EXPECT_DOUBLE_EQ(histogram.quantile(0.8), 4e-6);
+    EXPECT_DOUBLE_EQ(MetricHistogram::bucketBound(3), 8e-6);
+
+    MetricGauge gauge;
+    gauge.add(3);
+    gauge.add(2);
+    gauge.add(-4);
+    gauge.set(2);
+    EXPECT_EQ(gauge.value(), 2);
+    EXPECT_EQ(gauge.peak(), 5);
+}
+
+TEST(MetricsRegistry, ExportsJSONAndPrometheusText)
+{
+    auto registry = std::make_unique<MetricsRegistry>();
+    registry->counter("table_cache_hits_total", "Table cache hits").add(3);
+    registry->counter("table_cache_misses_total", "Table cache misses").add(1);
+    registry->gauge("queue_depth", "Queued frames").set(4);
+    {
+        MetricTimer timer(registry->histogram("write_seconds", "Write time"));
+    }
+
+    const nlohmann::json json = nlohmann::json::parse(registry->toJSON());
+    EXPECT_EQ(json["counters"]["table_cache_hits_total"], 3);
+    EXPECT_EQ(json["gauges"]["queue_depth"]["peak"], 4);
+    EXPECT_EQ(json["histograms"]["write_seconds"]["count"], 1);
+    EXPECT_EQ(json["histograms"]["write_seconds"]["buckets"].size(), MetricHistogram::kBucketCount);
+    EXPECT_DOUBLE_EQ(json["hitRates"]["table_cache"].get<double>(), 0.75);
+
+    const std::string text = registry->toPrometheus();
+    EXPECT_NE(text.find("# HELP table_cache_hits_total Table cache hits\n# TYPE table_cache_hits_total counter\ntable_cache_hits_total 3\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE queue_depth gauge\nqueue_depth 4\n"), std::string::npos);
+    EXPECT_NE(text.find("queue_depth_peak 4\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE write_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("write_seconds_bucket{le=\"+Inf\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("write_seconds_count 1\n"), std::string::npos);
+    // names are exported in order
+    EXPECT_LT(text.find("queue_depth"), text.find("table_cache_hits_total"));
+
+    const auto dir = std::filesystem::temp_directory_path();
+    ASSERT_TRUE(registry->writeFile((dir / "pmx_metrics.json").string()));
+    ASSERT_TRUE(registry->writeFile((dir / "pmx_metrics.prom").string()));
+    std::ifstream jsonFile(dir / "pmx_metrics.json");
+    EXPECT_EQ(nlohmann::json::parse(jsonFile)["counters"]["table_cache_misses_total"], 1);
+    std::ifstream textFile(dir / "pmx_metrics.prom");
+    std::string firstLine;
+    std::getline(textFile, firstLine);
+    EXPECT_EQ(firstLine.rfind("# HELP", 0), 0u);
+    std::filesystem::remove(dir / "pmx_metrics.json");
+    std::filesystem::remove(dir / "pmx_metrics.prom");
+    EXPECT_FALSE(registry->writeFile((dir / "pmx_missing_dir" / "metrics.json").string()));
+}
+
+TEST(MetricsRegistry, LoadersReportParseTimeAndBytes)
+{
+    const auto path = std::filesystem::temp_directory_path() / "pmx_metrics_pixel_index.json";
+    std::ofstream(path) << "[10, 20, 30]";
+    const uint64_t bytes = PipelineMetrics::bytesLoaded().value();
+    const uint64_t parses = PipelineMetrics::parseSeconds().count();
+
+    FacialLandmark landmarks;
+    ASSERT_TRUE(landmarks.loadLandmarksPixelIndexFromJSON(path.string().c_str()));
+    EXPECT_EQ(PipelineMetrics::bytesLoaded().value() - bytes, std::filesystem::file_size(path));
+    EXPECT_EQ(PipelineMetrics::parseSeconds().count() - parses, 1u);
+    EXPECT_NE(MetricsRegistry::global().toPrometheus().find("pixelmux_bytes_loaded_total"), std::string::npos);
+    std::filesystem::remove(path);
+}
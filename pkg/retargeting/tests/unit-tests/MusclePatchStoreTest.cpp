@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "MusclePatchStore.h"
+#include "IndexedMesh.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+static std::string writeTemp(const std::string& name, const std::string& content)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream(path) << content;
+    return path;
+}
+
+// Flat n x n vertex grid in the XY plane, two triangles per cell.
+static IndexedMesh makeGrid(int n)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> triangles;
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x)
+            vertices.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    for (int y = 0; y + 1 < n; ++y)
+        for (int x = 0; x + 1 < n; ++x)
+        {
+            const uint32_t v = static_cast<uint32_t>(y * n + x);
+            triangles.insert(triangles.end(), {v, v + 1, v + n + 1, v, v + n + 1, v + n});
+        }
+    IndexedMesh mesh;
+    mesh.build(vertices, triangles);
+    return mesh;
+}
+
+TEST(MusclePatchStore, LoadsDenseCSR)
+{
+    const std::string path = writeTemp("musclePatchStore.json", R"({"10":[5,4,4],"3":[0,1],"1":[2]})");
+    MusclePatchStore store;
+    ASSERT_TRUE(store.loadFromJSON(path.c_str()));
+    std::remove(path.c_str());
+
+    ASSERT_EQ(store.muscleCount(), 3u);
+    EXPECT_EQ(store.muscleIds(), (std::vector<int>{1, 3, 10}));
+    EXPECT_EQ(store.offsets(), (std::vector<uint32_t>{0, 1, 3, 5}));
+    EXPECT_EQ(store.denseIndex(10), 2);
+    EXPECT_EQ(store.denseIndex(7), -1);
+    EXPECT_EQ(store.requiredVertexCount(), 6u);
+
+    // duplicates are dropped and indices sorted
+    MusclePatch patch = store.patch(2);
+    ASSERT_EQ(patch.size, 2u);
+    EXPECT_EQ(patch.vertices[0], 4u);
+    EXPECT_EQ(patch.vertices[1], 5u);
+
+    std::vector<glm::vec3> mesh = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}, {4, 0, 0}, {5, 0, 0}};
+    std::vector<glm::vec3> positions;
+    store.gather(1, mesh, positions);
+    ASSERT_EQ(positions.size(), 2u);
+    EXPECT_EQ(positions[1], glm::vec3(1, 0, 0));
+}
+
+TEST(MusclePatchStore, RejectsInvalidInput)
+{
+    MusclePatchStore store;
+    const std::string badKey = writeTemp("musclePatchBadKey.json", R"({"3a":[0,1]})");
+    EXPECT_FALSE(store.loadFromJSON(badKey.c_str()));
+    const std::string badIndex = writeTemp("musclePatchBadIndex.json", R"({"3":[0,-1]})");
+    EXPECT_FALSE(store.loadFromJSON(badIndex.c_str()));
+    const std::string twice = writeTemp("musclePatchTwice.json", R"({"7":[0],"07":[1]})");
+    EXPECT_FALSE(store.loadFromJSON(twice.c_str()));
+    std::remove(badKey.c_str());
+    std::remove(badIndex.c_str());
+    std::remove(twice.c_str());
+
+    EXPECT_FALSE(store.build({{1, {0, -2}}}));
+    EXPECT_EQ(store.muscleCount(), 0u);
+}
+
+TEST(MusclePatchStore, ComputesAggregatesInParallel)
+{
+    IndexedMesh mesh = makeGrid(20);
+
+    // one muscle per 2x2 block of the grid, plus one covering a whole row
+    std::unordered_map<int, std::vector<int>> patches;
+    for (int y = 0; y < 19; y += 2)
+        for (int x = 0; x < 19; x += 2)
+            patches[y * 20 + x] = {y * 20 + x, y * 20 + x + 1, (y + 1) * 20 + x, (y + 1) * 20 + x + 1};
+    std::vector<int> row;
+    for (int x = 0; x < 20; ++x) row.push_back(5 * 20 + x);
+    patches[1000] = row;
+
+    MusclePatchStore store;
+    ASSERT_TRUE(store.build(patches));
+    ASSERT_TRUE(store.computeStats(mesh, 4));
+    ASSERT_EQ(store.stats().size(), store.muscleCount());
+
+    // a unit square: 4 sides and 1 diagonal of the triangulation
+    const MuscleStats& square = store.stats()[store.denseIndex(0)];
+    EXPECT_EQ(square.centroid, glm::vec3(0.5f, 0.5f, 0.0f));
+    EXPECT_EQ(square.boundsMax, glm::vec3(1.0f, 1.0f, 0.0f));
+    EXPECT_EQ(square.edgeCount, 5u);
+    EXPECT_FLOAT_EQ(square.minEdgeLength, 1.0f);
+    EXPECT_NEAR(square.maxEdgeLength, std::sqrt(2.0f), 1e-6f);
+
+    const MuscleStats& line = store.stats()[store.denseIndex(1000)];
+    EXPECT_EQ(line.edgeCount, 19u);
+    EXPECT_FLOAT_EQ(line.meanEdgeLength, 1.0f);
+    EXPECT_FLOAT_EQ(line.centroid.y, 5.0f);
+
+    // same aggregates on one thread
+    std::vector<MuscleStats> parallel = store.stats();
+    ASSERT_TRUE(store.computeStats(mesh, 1));
+    for (size_t i = 0; i < parallel.size(); ++i)
+    {
+        EXPECT_EQ(parallel[i].centroid, store.stats()[i].centroid);
+        EXPECT_EQ(parallel[i].edgeCount, store.stats()[i].edgeCount);
+    }
+
+    // positions only: no adjacency, no edges
+    ASSERT_TRUE(store.computeStats(mesh.vertices()));
+    EXPECT_EQ(store.stats()[store.denseIndex(0)].edgeCount, 0u);
+    EXPECT_FALSE(store.computeStats(std::vector<glm::vec3>(10)));
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "NeutralProfile.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+TEST(NeutralProfile, ComputeSaveLoad)
+{
+    std::unordered_map<int, std::vector<landmarksActionUnit>> auMap;
+    auMap[1].push_back(landmarksActionUnit{1, Side::left, {0, 1, 0, 2}});
+    auMap[1].push_back(landmarksActionUnit{1, Side::right, {1, 2}});
+    auMap[5].push_back(landmarksActionUnit{5, Side::center, {0, 1, 2}});   // odd group is ignored
+
+    std::vector<glm::vec3> landmarks = {{0, 0, 0}, {3, 0, 0}, {0, 4, 0}};
+
+    NeutralProfile profile;
+    ASSERT_TRUE(profile.compute(auMap, landmarks));
+    ASSERT_EQ(profile.entries().size(), 2u);
+    EXPECT_FLOAT_EQ(profile.distance(1, Side::left), 3.5f);
+    EXPECT_FLOAT_EQ(profile.distance(1, Side::right), 5.0f);
+    EXPECT_LT(profile.distance(5, Side::center), 0.0f);
+    EXPECT_FLOAT_EQ(profile.scale(), 5.0f);
+
+    const std::string path = NeutralProfile::profilePath(std::filesystem::temp_directory_path().string(), "actor/NeutralFace.json");
+    ASSERT_TRUE(profile.save(path));
+
+    NeutralProfile loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+    EXPECT_FLOAT_EQ(loaded.distance(1, Side::left), 3.5f);
+    EXPECT_FLOAT_EQ(loaded.distance(1, Side::right), 5.0f);
+    EXPECT_FLOAT_EQ(loaded.scale(), 5.0f);
+    ASSERT_EQ(loaded.landmarks().size(), landmarks.size());
+    EXPECT_FLOAT_EQ(loaded.landmarks()[2].y, 4.0f);
+
+    EXPECT_FALSE(loaded.load(path));
+    EXPECT_FALSE(loaded.isValid());
+}
+
+static NeutralProfile makeProfile()
+{
+    std::unordered_map<int, std::vector<landmarksActionUnit>> auMap;
+    auMap[1].push_back(landmarksActionUnit{1, Side::left, {0, 1}});
+    NeutralProfile profile;
+    profile.compute(auMap, {{0, 0, 0}, {3, 0, 0}, {0, 4, 0}});
+    return profile;
+}
+
+TEST(NeutralProfile, RejectsCorruptFiles)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "pmx_corrupt.pmxn").string();
+    ASSERT_TRUE(makeProfile().save(path));
+    const auto size = std::filesystem::file_size(path);
+
+    // cut inside the landmarks
+    std::filesystem::resize_file(path, size - 4);
+    NeutralProfile loaded;
+    EXPECT_FALSE(loaded.load(path));
+    EXPECT_FALSE(loaded.isValid());
+
+    // a header announcing more entries than the file holds must fail before allocating them
+    ASSERT_TRUE(makeProfile().save(path));
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        NeutralProfileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.entryCount = 0x40000000u;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    EXPECT_FALSE(loaded.load(path));
+
+    // trailing bytes mean the counts do not describe the file either
+    ASSERT_TRUE(makeProfile().save(path));
+    std::ofstream(path, std::ios::binary | std::ios::app) << "junk";
+    EXPECT_FALSE(loaded.load(path));
+
+    std::filesystem::remove(path);
+}
+
+TEST(NeutralProfile, KeyFollowsCaptureAndRigTables)
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string neutralJson = (dir / "pmx_neutral_key.json").string();
+    std::ofstream(neutralJson) << "{}";
+
+    std::unordered_map<int, std::vector<landmarksActionUnit>> auMap;
+    auMap[1].push_back(landmarksActionUnit{1, Side::left, {0, 1}});
+    auMap[2].push_back(landmarksActionUnit{2, Side::right, {1, 2}});
+    const std::string key = NeutralProfile::profileKey(neutralJson, auMap);
+    EXPECT_EQ(NeutralProfile::profileKey(neutralJson, auMap), key);
+
+    const std::string path = NeutralProfile::profilePath(dir.string(), key);
+    ASSERT_TRUE(makeProfile().save(path));
+    NeutralProfile loaded;
+    EXPECT_TRUE(loaded.load(NeutralProfile::profilePath(dir.string(), key)));
+
+    // editing the rig's landmark/AU map selects another profile, which is a miss
+    auMap[2].front().landmarkIndices = {0, 2};
+    const std::string editedKey = NeutralProfile::profileKey(neutralJson, auMap);
+    EXPECT_NE(editedKey, key);
+    EXPECT_FALSE(loaded.load(NeutralProfile::profilePath(dir.string(), editedKey)));
+
+    // so does a new capture of the neutral face
+    std::ofstream(neutralJson) << "{\"landmarks\": []}";
+    EXPECT_NE(NeutralProfile::profileKey(neutralJson, auMap), editedKey);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(neutralJson);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "ParallelUtils.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+// Values over many magnitudes with both signs: the float sum depends on the order of the additions.
+static std::vector<float> makeValues(size_t count)
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> exponent(-12, 12);
+    std::vector<float> values(count);
+    for (float& v : values) v = std::ldexp(mantissa(random), exponent(random));
+    return values;
+}
+
+static float sumFloats(const std::vector<float>& values, unsigned int workerCount, ReductionMode mode)
+{
+    return parallelReduce(0, values.size(), 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) sum += values[i];
+        return sum;
+    }, [](float a, float b) { return a + b; }, workerCount, 256, mode);
+}
+
+static double sumCompensated(const std::vector<float>& values, unsigned int workerCount, ReductionMode mode)
+{
+    return parallelReduce(0, values.size(), NeumaierSum(), [&](size_t begin, size_t end) {
+        NeumaierSum sum;
+        for (size_t i = begin; i < end; ++i) sum.add(values[i]);
+        return sum;
+    }, [](NeumaierSum a, const NeumaierSum& b) { a.add(b); return a; }, workerCount, 256, mode).value();
+}
+
+TEST(ParallelReduce, NeumaierSumKeepsSmallTerms)
+{
+    NeumaierSum sum;
+    for (double v : {1.0, 1e100, 1.0, -1e100}) sum.add(v);
+    EXPECT_EQ(sum.value(), 2.0);
+
+    NeumaierSum left, right;
+    left.add(1e16);
+    right.add(1.0);
+    right.add(1.0);
+    left.add(right);
+    EXPECT_EQ(left.value(), 1e16 + 2.0);
+}
+
+TEST(ParallelReduce, DeterministicModeIsBitwiseIdenticalForAnyWorkerCount)
+{
+    const std::vector<float> values = makeValues(100003);
+    const float floatReference = sumFloats(values, 1, ReductionMode::deterministic);
+    const double compensatedReference = sumCompensated(values, 1, ReductionMode::deterministic);
+
+    for (unsigned int workers = 1; workers <= 8; ++workers)
+    {
+        const float floatSum = sumFloats(values, workers, ReductionMode::deterministic);
+        const double compensatedSum = sumCompensated(values, workers, ReductionMode::deterministic);
+        EXPECT_EQ(std::memcmp(&floatSum, &floatReference, sizeof(float)), 0) << workers << " workers";
+        EXPECT_EQ(std::memcmp(&compensatedSum, &compensatedReference, sizeof(double)), 0) << workers << " workers";
+
+        // the fast mode is only close
+        EXPECT_NEAR(sumCompensated(values, workers, ReductionMode::fast), compensatedReference, 1e-9);
+    }
+
+    // the default mode follows the process setting
+    setReductionMode(ReductionMode::deterministic);
+    const float viaSetting = sumFloats(values, 3, reductionMode());
+    setReductionMode(ReductionMode::fast);
+    EXPECT_EQ(std::memcmp(&viaSetting, &floatReference, sizeof(float)), 0);
+    EXPECT_EQ(parallelReduce(5, 5, 7, [](size_t, size_t) { return 0; }, [](int a, int b) { return a + b; }), 7);
+}
+
+TEST(ParallelReduce, DeterministicModeIsStableOnLargeInputs)
+{
+    // enough blocks for every worker count to split the tree differently
+    const std::vector<float> values = makeValues(1 << 20);
+    const double reference = sumCompensated(values, 1, ReductionMode::deterministic);
+    for (unsigned int workers : {2u, 4u, 7u, 16u})
+    {
+        const double sum = sumCompensated(values, workers, ReductionMode::deterministic);
+        EXPECT_EQ(std::memcmp(&sum, &reference, sizeof(double)), 0) << workers << " workers";
+    }
+}
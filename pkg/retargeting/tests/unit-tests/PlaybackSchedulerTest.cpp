@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "PlaybackScheduler.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// One slot (AU 1 left) moving vertex 0 by +1 in x at full weight.
+static std::shared_ptr<const CompiledFaceRig> makeOneSlotRig()
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "playbackSchedulerDeltas.json").string();
+    std::ofstream(path) << R"({"actionUnits":[{"auId":1,"side":"left","activeMuscles":[{"muscleId":1,"deltas":[
+        {"vertexIndex":0,"position":[0,0,0],"delta":[1,0,0]}]}],"passiveMuscles":[]}]})";
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    actionUnit.loadDeltaTransfersFromJSON(path.c_str());
+    std::remove(path.c_str());
+    return CompiledFaceRig::compile(actionUnit, facialLandmark);
+}
+
+// Clip whose frame i carries the AU weight i / count in its first landmark.
+static std::shared_ptr<const std::vector<LandmarkFrame>> makeClip(size_t count, double frameRate)
+{
+    auto frames = std::make_shared<std::vector<LandmarkFrame>>(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        (*frames)[i].index = static_cast<uint32_t>(i);
+        (*frames)[i].time = 10.0 + static_cast<double>(i) / frameRate;
+        (*frames)[i].landmarks.assign(1, glm::vec3(static_cast<float>(i) / static_cast<float>(count), 0.0f, 0.0f));
+    }
+    return frames;
+}
+
+// Simulated time: sleeping jumps forward and every evaluation costs a fixed amount.
+struct SimulatedTime {
+    double now = 100.0;
+    double evaluationCost = 0.001;
+
+    PlaybackClock clock()
+    {
+        PlaybackClock clock;
+        clock.now = [this]() { return now; };
+        clock.sleepUntil = [this](double time) { now = std::max(now, time); };
+        return clock;
+    }
+
+    PlaybackScheduler::EvaluateFn evaluator()
+    {
+        return [this](const LandmarkFrame& frame, std::vector<float>& weights) {
+            now += evaluationCost;
+            weights[0] = frame.landmarks[0].x;
+            return true;
+        };
+    }
+};
+
+TEST(PlaybackScheduler, HoldsTheRateWhenFramesAreCheap)
+{
+    SimulatedTime time;
+    PlaybackScheduler scheduler(makeOneSlotRig(), std::vector<glm::vec3>(4, glm::vec3(0.0f)));
+    scheduler.setClock(time.clock());
+
+    std::vector<uint32_t> shown;
+    ASSERT_TRUE(scheduler.run(PlaybackSource::fromClip(makeClip(30, 30.0)), time.evaluator(),
+        [&](const PlaybackFrame& frame) {
+            shown.push_back(frame.sourceIndex);
+            EXPECT_NEAR((*frame.vertices)[0].x, static_cast<float>(frame.sourceIndex) / 30.0f, 1e-6f);
+        }));
+
+    const PlaybackStats stats = scheduler.stats();
+    EXPECT_EQ(stats.framesPresented, 30u);
+    EXPECT_EQ(stats.sourceEvaluated, 30u);
+    EXPECT_EQ(stats.deadlinesMissed, 0u);
+    EXPECT_EQ(stats.ticksSkipped, 0u);
+    EXPECT_TRUE(stats.holdsFrameRate);
+    EXPECT_NEAR(stats.latencyP50Ms, 1.0, 0.05);
+    ASSERT_EQ(shown.size(), 30u);
+    for (uint32_t i = 0; i < 30; ++i) EXPECT_EQ(shown[i], i);
+}
+
+TEST(PlaybackScheduler, DropsSourceFramesBetweenTicks)
+{
+    SimulatedTime time;
+    PlaybackOptions options;
+    options.frameRate = 30.0;
+    PlaybackScheduler scheduler(makeOneSlotRig(), std::vector<glm::vec3>(4, glm::vec3(0.0f)), options);
+    scheduler.setClock(time.clock());
+
+    std::vector<uint32_t> shown;
+    ASSERT_TRUE(scheduler.run(PlaybackSource::fromClip(makeClip(60, 60.0)), time.evaluator(),
+        [&](const PlaybackFrame& frame) { shown.push_back(frame.sourceIndex); }));
+
+    // frame 59 is due at 0.983 s and shown by the tick at 1 s
+    const PlaybackStats stats = scheduler.stats();
+    EXPECT_EQ(stats.framesPresented, 31u);
+    EXPECT_EQ(stats.sourceEvaluated, 31u);
+    EXPECT_EQ(stats.sourceDropped, 29u);
+    for (uint32_t i = 0; i < shown.size(); ++i) EXPECT_EQ(shown[i], std::min(2 * i, 59u));
+}
+
+TEST(PlaybackScheduler, InterpolatesSlowSources)
+{
+    SimulatedTime time;
+    PlaybackOptions options;
+    options.frameRate = 30.0;
+    options.policy = PlaybackPolicy::interpolate;
+    PlaybackScheduler scheduler(makeOneSlotRig(), std::vector<glm::vec3>(4, glm::vec3(0.0f)), options);
+    scheduler.setClock(time.clock());
+
+    // 15 fps source: every other output frame lies halfway between two source frames
+    std::vector<PlaybackFrame> shown;
+    ASSERT_TRUE(scheduler.run(PlaybackSource::fromClip(makeClip(10, 15.0)), time.evaluator(),
+        [&](const PlaybackFrame& frame) { shown.push_back(frame); }));
+
+    const PlaybackStats stats = scheduler.stats();
+    EXPECT_EQ(stats.sourceEvaluated, 10u);
+    EXPECT_EQ(stats.framesInterpolated, 9u);
+    ASSERT_EQ(shown.size(), 19u);
+    EXPECT_TRUE(shown[3].interpolated);
+    EXPECT_NEAR((*shown[3].vertices)[0].x, 1.5f / 10.0f, 1e-5f);
+    EXPECT_NEAR((*shown[4].vertices)[0].x, 2.0f / 10.0f, 1e-5f);
+
+    // the drop policy repeats the last frame instead
+    SimulatedTime dropTime;
+    PlaybackScheduler dropScheduler(makeOneSlotRig(), std::vector<glm::vec3>(4, glm::vec3(0.0f)));
+    dropScheduler.setClock(dropTime.clock());
+    ASSERT_TRUE(dropScheduler.run(PlaybackSource::fromClip(makeClip(10, 15.0)), dropTime.evaluator(), {}));
+    EXPECT_EQ(dropScheduler.stats().framesHeld, 9u);
+    EXPECT_EQ(dropScheduler.stats().framesInterpolated, 0u);
+}
+
+TEST(PlaybackScheduler, ReportsMissedDeadlinesUnderLoad)
+{
+    SimulatedTime time;
+    time.evaluationCost = 0.050; // longer than the 33 ms frame budget
+    PlaybackScheduler scheduler(makeOneSlotRig(), std::vector<glm::vec3>(4, glm::vec3(0.0f)));
+    scheduler.setClock(time.clock());
+    ASSERT_TRUE(scheduler.run(PlaybackSource::fromClip(makeClip(60, 30.0)), time.evaluator(), {}));
+
+    const PlaybackStats stats = scheduler.stats();
+    EXPECT_FALSE(stats.holdsFrameRate);
+    EXPECT_GT(stats.deadlinesMissed, 0u);
+    EXPECT_GT(stats.ticksSkipped, 0u);
+    EXPECT_GT(stats.sourceDropped, 0u);
+    EXPECT_GE(stats.latencyP50Ms, 49.0);
+    EXPECT_LT(stats.achievedFrameRate, 30.0);
+    // the clip still ends on time instead of drifting: 2 s of source, one overrun at the end at most
+    EXPECT_LT(stats.elapsedSeconds, 2.1);
+}
+
+TEST(PlaybackScheduler, StopsARunningPlayback)
+{
+    PlaybackScheduler scheduler(makeOneSlotRig(), std::vector<glm::vec3>(4, glm::vec3(0.0f)));
+    std::atomic<int> presented{0};
+    ASSERT_TRUE(scheduler.start(PlaybackSource::fromClip(makeClip(6000, 60.0)),
+        [](const LandmarkFrame& frame, std::vector<float>& weights) { weights[0] = frame.landmarks[0].x; return true; },
+        [&](const PlaybackFrame&) { ++presented; }));
+    EXPECT_TRUE(scheduler.isRunning());
+    EXPECT_FALSE(scheduler.start(PlaybackSource::fromClip(makeClip(1, 60.0)), {}, {}));
+
+    while (presented.load() < 3) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    scheduler.stop();
+    EXPECT_FALSE(scheduler.isRunning());
+    EXPECT_LT(scheduler.stats().framesPresented, 6000u);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "PointCache.h"
+#include <glm/vec3.hpp>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// Builds a deterministic animated frame so every frame can be regenerated for comparison.
+static std::vector<glm::vec3> makeFrame(int frame, size_t vertexCount)
+{
+    std::vector<glm::vec3> vertices(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        float t = static_cast<float>(frame) * 0.1f + static_cast<float>(v) * 0.01f;
+        vertices[v] = {std::sin(t) * 10.0f, std::cos(t) * 5.0f, static_cast<float>(v) * 0.001f};
+    }
+    return vertices;
+}
+
+static void writeAndCheck(const PointCacheOptions& options, float tolerance)
+{
+    const size_t vertexCount = 101;
+    const int frames = 37;
+    std::string path = (std::filesystem::temp_directory_path() / "pixelmux_pointcache_test.pmxc").string();
+
+    PointCacheWriter writer;
+    ASSERT_TRUE(writer.open(path.c_str(), vertexCount, options));
+    for (int f = 0; f < frames; ++f) ASSERT_TRUE(writer.appendFrame(makeFrame(f, vertexCount)));
+    ASSERT_TRUE(writer.close());
+
+    PointCacheReader reader;
+    ASSERT_TRUE(reader.open(path.c_str()));
+    EXPECT_EQ(reader.frameCount(), static_cast<uint64_t>(frames));
+    EXPECT_EQ(reader.vertexCount(), vertexCount);
+
+    // random access in a non sequential order
+    std::vector<glm::vec3> decoded;
+    for (int f : {36, 0, 17, 5, 16, 31})
+    {
+        ASSERT_TRUE(reader.readFrame(f, decoded));
+        std::vector<glm::vec3> expected = makeFrame(f, vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            EXPECT_NEAR(decoded[v].x, expected[v].x, tolerance) << "frame " << f << " vertex " << v;
+            EXPECT_NEAR(decoded[v].y, expected[v].y, tolerance) << "frame " << f << " vertex " << v;
+            EXPECT_NEAR(decoded[v].z, expected[v].z, tolerance) << "frame " << f << " vertex " << v;
+        }
+    }
+    EXPECT_FALSE(reader.readFrame(frames, decoded));
+
+    reader.close();
+    std::filesystem::remove(path);
+}
+
+TEST(PointCache, Float32RoundTrip)
+{
+    writeAndCheck(PointCacheOptions{PointCacheEncoding::float32, false, 8, 30.0f}, 0.0f);
+}
+
+TEST(PointCache, Float32DeltaRoundTrip)
+{
+    writeAndCheck(PointCacheOptions{PointCacheEncoding::float32, true, 8, 30.0f}, 1e-5f);
+}
+
+TEST(PointCache, Float16DeltaRoundTrip)
+{
+    // half floats keep ~3 significant digits; values reach 10 so the absolute error stays below 1e-2
+    writeAndCheck(PointCacheOptions{PointCacheEncoding::float16, true, 8, 24.0f}, 1e-2f);
+}
+
+TEST(PointCache, HalfConversion)
+{
+    for (float value : {0.0f, 1.0f, -2.5f, 0.333f, 65504.0f, 6.1e-5f, 1e-7f})
+    {
+        float roundTrip = halfToFloat(floatToHalf(value));
+        EXPECT_NEAR(roundTrip, value, std::abs(value) * 1e-3f + 1e-7f) << "value " << value;
+    }
+    EXPECT_TRUE(std::isinf(halfToFloat(floatToHalf(1e6f))));
+}
+
+TEST(PointCache, RejectsUnfinishedFile)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "pixelmux_pointcache_bad.pmxc").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a cache";
+    }
+    PointCacheReader reader;
+    EXPECT_FALSE(reader.open(path.c_str()));
+    std::filesystem::remove(path);
+}
+
+TEST(PointCache, RejectsCacheWhoseWriterNeverClosed)
+{
+    const size_t vertexCount = 16;
+    std::string path = (std::filesystem::temp_directory_path() / "pixelmux_pointcache_unclosed.pmxc").string();
+    PointCacheWriter writer;
+    ASSERT_TRUE(writer.open(path.c_str(), vertexCount));
+    for (int f = 0; f < 4; ++f) ASSERT_TRUE(writer.appendFrame(makeFrame(f, vertexCount)));
+    ASSERT_TRUE(writer.close());
+
+    // what a crashed writer leaves behind: the header as written at open and the frames, without the index
+    std::vector<char> bytes(std::filesystem::file_size(path));
+    std::ifstream(path, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    PointCacheHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    bytes.resize(header.indexOffset);
+    header.indexOffset = 0;
+    header.frameCount = 0;
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+    PointCacheReader reader;
+    EXPECT_FALSE(reader.open(path.c_str()));
+
+    // a frame count that runs past the end of the file is rejected as well
+    header.indexOffset = bytes.size() - sizeof(uint64_t);
+    header.frameCount = 4;
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    EXPECT_FALSE(reader.open(path.c_str()));
+    std::filesystem::remove(path);
+}
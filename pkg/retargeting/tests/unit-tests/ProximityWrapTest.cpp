@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "ProximityWrap.h"
+#include "SurfaceQuery.h"
+#include <algorithm>
+#include <glm/vec3.hpp>
+#include <vector>
+
+// Unit square in the XY plane split into two triangles, used as a minimal muscle mesh.
+static void buildMusclePlane(std::vector<glm::vec3>& vertices, std::vector<unsigned int>& triangles)
+{
+    vertices = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    triangles = {0, 1, 2, 0, 2, 3};
+}
+
+TEST(SurfaceQuery, ClosestPointOnPlane)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<unsigned int> triangles;
+    buildMusclePlane(vertices, triangles);
+
+    SurfaceQuery query;
+    ASSERT_TRUE(query.build(vertices, triangles));
+
+    SurfaceHit hit = query.closestPoint({0.75f, 0.25f, 2.0f});
+    ASSERT_GE(hit.triangle, 0);
+    EXPECT_NEAR(hit.distance, 2.0f, 1e-5f);
+    EXPECT_NEAR(hit.point.x, 0.75f, 1e-5f);
+    EXPECT_NEAR(hit.point.y, 0.25f, 1e-5f);
+    EXPECT_NEAR(hit.barycentric.x + hit.barycentric.y + hit.barycentric.z, 1.0f, 1e-5f);
+
+    // a point beyond the corner snaps to the corner vertex
+    hit = query.closestPoint({-1.0f, -1.0f, 0.0f});
+    EXPECT_NEAR(hit.point.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(hit.point.y, 0.0f, 1e-5f);
+}
+
+TEST(ProximityWrap, RestPoseReproducesSkin)
+{
+    std::vector<glm::vec3> muscle;
+    std::vector<unsigned int> triangles;
+    buildMusclePlane(muscle, triangles);
+
+    std::vector<glm::vec3> skin = {{0.2f, 0.3f, 0.1f}, {0.9f, 0.1f, 0.05f}, {1.2f, 0.5f, 0.2f}, {0.5f, 0.5f, -0.1f}};
+
+    ProximityWrap wrap;
+    ASSERT_TRUE(wrap.bind(skin, muscle, triangles));
+    EXPECT_EQ(wrap.boundVertexCount(), skin.size());
+    // frames are rebuilt only for the triangles that hold skin vertices
+    EXPECT_GE(wrap.boundTriangleCount(), 1u);
+    EXPECT_LE(wrap.boundTriangleCount(), std::min(skin.size(), triangles.size() / 3));
+
+    std::vector<glm::vec3> result;
+    ASSERT_TRUE(wrap.apply(muscle, result));
+    ASSERT_EQ(result.size(), skin.size());
+    for (size_t i = 0; i < skin.size(); ++i)
+    {
+        EXPECT_NEAR(result[i].x, skin[i].x, 1e-5f) << "vertex " << i;
+        EXPECT_NEAR(result[i].y, skin[i].y, 1e-5f) << "vertex " << i;
+        EXPECT_NEAR(result[i].z, skin[i].z, 1e-5f) << "vertex " << i;
+    }
+}
+
+TEST(ProximityWrap, SkinFollowsDeformedMuscle)
+{
+    std::vector<glm::vec3> muscle;
+    std::vector<unsigned int> triangles;
+    buildMusclePlane(muscle, triangles);
+
+    std::vector<glm::vec3> skin = {{0.25f, 0.25f, 0.1f}, {0.75f, 0.5f, 0.1f}};
+
+    ProximityWrap wrap;
+    ASSERT_TRUE(wrap.bind(skin, muscle, triangles));
+
+    // translating the muscle translates the skin
+    std::vector<glm::vec3> moved = muscle;
+    for (auto& v : moved) v += glm::vec3(0.0f, 0.0f, 0.5f);
+
+    std::vector<glm::vec3> result;
+    ASSERT_TRUE(wrap.apply(moved, result));
+    EXPECT_NEAR(result[0].z, 0.6f, 1e-5f);
+    EXPECT_NEAR(result[1].z, 0.6f, 1e-5f);
+
+    // rotating the muscle 90 degrees about Y keeps the offset along the rotated normal
+    std::vector<glm::vec3> rotated = muscle;
+    for (auto& v : rotated) v = {v.z, v.y, -v.x};
+    ASSERT_TRUE(wrap.apply(rotated, result));
+    EXPECT_NEAR(result[0].x, 0.1f, 1e-5f);
+    EXPECT_NEAR(result[0].z, -0.25f, 1e-5f);
+
+    // a muscle buffer with the wrong vertex count is rejected
+    std::vector<glm::vec3> wrongSize(3);
+    EXPECT_FALSE(wrap.apply(wrongSize, result));
+}
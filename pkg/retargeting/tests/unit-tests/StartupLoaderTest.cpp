@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "LiveRigTables.h"
+#include "StartupLoader.h"
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+// Temporary data directory holding the five table files.
+static std::filesystem::path makeDataDir(const std::string& name)
+{
+    auto dir = std::filesystem::temp_directory_path() / (name + "_" + std::to_string(::getpid()));
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "musclePatches.json") << R"({"3":[1,2]})";
+    std::ofstream(dir / "deltaTransfer.json") << R"({"actionUnits":[
+        {"auId":1,"side":"left",
+         "activeMuscles":[{"muscleId":3,"deltas":[{"vertexIndex":1,"position":[0,0,0],"delta":[1,0,0]}]}],
+         "passiveMuscles":[]}]})";
+    std::ofstream(dir / "landmarksMeshIndex.json") << "[4, 5, 6]";
+    std::ofstream(dir / "landmarksPixelIndex.json") << "[10, 20, 30]";
+    std::ofstream(dir / "landmarksActionUnits.json") << R"({"mappings":[{"auId":1,"side":"left","landmarkIndices":[0,1]}]})";
+    return dir;
+}
+
+TEST(StartupLoader, LoadsEveryTableInTheBackground)
+{
+    auto dir = makeDataDir("pmx_startup_load");
+    StartupLoader loader;
+    ASSERT_TRUE(loader.start(dir.string()));
+
+    ASSERT_EQ(loader.tables().size(), RigTableSet::tableFiles().size());
+    auto rig = loader.rig().get();
+    ASSERT_TRUE(rig);
+    EXPECT_TRUE(loader.isFinished());
+    EXPECT_EQ(rig->slotCount(), 1u);
+    EXPECT_EQ(rig->landmarksMeshIndex(), (std::vector<int>{4, 5, 6}));
+
+    for (const StartupTable& table : loader.tables())
+    {
+        EXPECT_TRUE(table.result.get().parsed) << table.fileName;
+        EXPECT_GE(table.result.get().seconds, 0.0);
+    }
+    auto tables = loader.tableSet().get();
+    ASSERT_TRUE(tables);
+    EXPECT_EQ(tables->musclePatches->muscleCount(), 1u);
+    EXPECT_EQ(tables->landmarksPixelIndex->size(), 3u);
+
+    // the published tables take the precompiled rig as is
+    LiveRigTables live(tables, rig);
+    EXPECT_EQ(live.rig(), rig);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(StartupLoader, ReportsMissingAndInconsistentTables)
+{
+    auto dir = makeDataDir("pmx_startup_fail");
+    std::filesystem::remove(dir / "musclePatches.json");
+
+    // optional tables may be missing
+    {
+        StartupLoader loader;
+        ASSERT_TRUE(loader.start(dir.string(), {"musclePatches.json"}));
+        ASSERT_TRUE(loader.rig().get());
+        EXPECT_FALSE(loader.tableSet().get()->musclePatches);
+    }
+    {
+        StartupLoader loader;
+        ASSERT_TRUE(loader.start(dir.string()));
+        EXPECT_FALSE(loader.rig().get());
+        EXPECT_FALSE(loader.tables()[0].result.get().parsed);
+        EXPECT_TRUE(loader.tables()[1].result.get().parsed);
+    }
+
+    // each table parses on its own, the sizes only disagree once merged
+    std::ofstream(dir / "landmarksMeshIndex.json") << "[4, 5]";
+    StartupLoader loader;
+    ASSERT_TRUE(loader.start(dir.string(), {"musclePatches.json"}));
+    EXPECT_FALSE(loader.tableSet().get());
+    EXPECT_FALSE(loader.rig().get());
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "CompiledFaceRig.h"
+#include "SymmetryMap.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+// Symmetric point set across x = 0: mirrored pairs, points on the plane, and one point without a mirror (last).
+static std::vector<glm::vec3> makeSymmetricCloud()
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> value(0.05f, 1.0f);
+    std::vector<glm::vec3> points;
+    for (int i = 0; i < 400; ++i)
+    {
+        glm::vec3 p(value(random), value(random), value(random));
+        points.push_back(p);
+        points.emplace_back(-p.x, p.y, p.z);
+    }
+    for (int i = 0; i < 20; ++i) points.emplace_back(0.0f, value(random), value(random));
+    std::shuffle(points.begin(), points.end(), random);
+    points.emplace_back(0.5f, -1.0f, 0.5f);
+    points.emplace_back(-0.5f, 1.0f, 1.0f); // keeps the bounds centred on x = 0
+    points.emplace_back(0.5f, 1.0f, 1.0f);
+    return points;
+}
+
+static void writeOBJ(const std::filesystem::path& path, const std::vector<glm::vec3>& vertices)
+{
+    std::ofstream file(path);
+    for (const glm::vec3& v : vertices) file << "v " << v.x << " " << v.y << " " << v.z << "\n";
+    file << "f 1 2 3\n";
+}
+
+TEST(SymmetryMap, MirrorSidesPairUp)
+{
+    for (int s = static_cast<int>(Side::left); s <= static_cast<int>(Side::liptightenupright); ++s)
+    {
+        const Side side = static_cast<Side>(s);
+        EXPECT_EQ(mirrorSide(mirrorSide(side)), side);
+        if (side != Side::center) {
+            EXPECT_NE(mirrorSide(side), side);
+            EXPECT_NE(isRightSide(side), isRightSide(mirrorSide(side)));
+        }
+    }
+    EXPECT_EQ(mirrorSide(Side::lipfunnelupleft), Side::lipfunnelupright);
+    EXPECT_FALSE(isRightSide(Side::center));
+}
+
+TEST(SymmetryMap, PairsMirroredVertices)
+{
+    const std::vector<glm::vec3> points = makeSymmetricCloud();
+    SymmetryMap map;
+    ASSERT_TRUE(map.build(points, 1e-4f, 0, 4));
+    ASSERT_EQ(map.vertexCount(), points.size());
+
+    for (uint32_t v = 0; v < points.size(); ++v)
+    {
+        const int32_t m = map.mirror(v);
+        if (v == points.size() - 3) {
+            EXPECT_EQ(m, -1); // nothing at (-0.5, -1, 0.5)
+            continue;
+        }
+        ASSERT_GE(m, 0) << "vertex " << v;
+        EXPECT_EQ(map.mirror(static_cast<uint32_t>(m)), static_cast<int32_t>(v));
+        EXPECT_FLOAT_EQ(points[m].x, -points[v].x);
+        EXPECT_FLOAT_EQ(points[m].y, points[v].y);
+        if (points[v].x == 0.0f) {
+            EXPECT_EQ(m, static_cast<int32_t>(v));
+        }
+    }
+    EXPECT_EQ(map.pairedCount(), points.size() - 1);
+    EXPECT_EQ(map.reflect(glm::vec3(1.0f, 2.0f, 3.0f)), glm::vec3(-1.0f, 2.0f, 3.0f));
+
+    SymmetryMap serial;
+    ASSERT_TRUE(serial.build(points, 1e-4f, 0, 1));
+    EXPECT_EQ(serial.mirrorTable(), map.mirrorTable());
+}
+
+TEST(SymmetryMap, CachesTheMap)
+{
+    const std::vector<glm::vec3> points = makeSymmetricCloud();
+    const std::string path = (std::filesystem::temp_directory_path() / "symmetryMapTest.pmxs").string();
+    std::remove(path.c_str());
+
+    SymmetryMap built;
+    ASSERT_TRUE(built.loadOrBuild(points, path));
+    ASSERT_TRUE(std::filesystem::exists(path));
+
+    SymmetryMap cached;
+    ASSERT_TRUE(cached.load(path));
+    EXPECT_EQ(cached.mirrorTable(), built.mirrorTable());
+    EXPECT_EQ(cached.meshHash(), SymmetryMap::hashMesh(points, 1e-3f, 0));
+
+    // a different template does not reuse the cache
+    std::vector<glm::vec3> moved = points;
+    moved[0].x += 0.25f;
+    SymmetryMap rebuilt;
+    ASSERT_TRUE(rebuilt.loadOrBuild(moved, path));
+    EXPECT_NE(rebuilt.mirrorTable(), built.mirrorTable());
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(SymmetryMap().assign({1, 2, 0}));
+    EXPECT_FALSE(SymmetryMap().assign({0, 3}));
+}
+
+TEST(SymmetryMap, PreprocessesOneSideOfMirroredAUs)
+{
+    // neutral face: 3 vertices per side plus one on the plane
+    const std::vector<glm::vec3> neutral = {
+        {-1, 0, 0}, {-1, 1, 0}, {-2, 1, 0}, {0, 2, 0}, {1, 0, 0}, {1, 1, 0}, {2, 1, 0}};
+    const glm::vec3 lift(0.1f, 0.3f, 0.0f);
+    std::vector<glm::vec3> left = neutral, right = neutral;
+    for (int v : {0, 1, 2}) left[v] += glm::vec3(-lift.x, lift.y, lift.z) * static_cast<float>(v + 1);
+    for (int v : {4, 5, 6}) right[v] += lift * static_cast<float>(v - 3);
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "symmetryMapPreprocess";
+    std::filesystem::create_directories(dir);
+    writeOBJ(dir / "Neutral.obj", neutral);
+    writeOBJ(dir / "Smile_Left.obj", left);
+    writeOBJ(dir / "Smile_Right.obj", right);
+    writeOBJ(dir / "Chin.obj", neutral);
+    std::ofstream(dir / "musclePatches.json") << R"({"1":[0,1,2],"2":[4,5,6],"3":[3]})";
+    std::ofstream(dir / "modelsPath.json") << R"({
+        "NEUTRALFACE":{"path":"Neutral.obj","side":"center","active":[],"passive":[]},
+        "AU12L":{"path":"Smile_Left.obj","side":"left","active":[1],"passive":[]},
+        "AU12R":{"path":"Smile_Right.obj","side":"right","active":[2],"passive":[]},
+        "AU17":{"path":"Chin.obj","side":"center","active":[3],"passive":[]}})";
+
+    auto preprocess = [&](bool mirrored) {
+        ActionUnit actionUnit;
+        actionUnit.loadMuscleIndexMapFromJSON((dir / "musclePatches.json").string().c_str());
+        if (mirrored) actionUnit.setSymmetryCachePath((dir / "symmetry.pmxs").string());
+        actionUnit.loadModelPathsFromJSON((dir / "modelsPath.json").string().c_str(), dir.string().c_str());
+        actionUnit.saveDeltaTransfersToJSON((dir / (mirrored ? "mirrored.json" : "full.json")).string().c_str());
+        return actionUnit.getAuDeltaTable();
+    };
+    auto full = preprocess(false);
+    auto half = preprocess(true);
+    ASSERT_EQ(full.at(12).size(), 2u);
+    ASSERT_EQ(half.at(12).size(), 1u);
+    EXPECT_EQ(half.at(12)[0].side, Side::left);
+    EXPECT_TRUE(half.at(12)[0].mirrored);
+    EXPECT_FALSE(half.at(17)[0].mirrored);
+
+    // the mirrored file compiles to the same rig as the full one
+    FacialLandmark facialLandmark;
+    auto compileFile = [&](const char* name) {
+        ActionUnit actionUnit;
+        actionUnit.loadDeltaTransfersFromJSON((dir / name).string().c_str());
+        return CompiledFaceRig::compile(actionUnit, facialLandmark);
+    };
+    auto expected = compileFile("full.json");
+    auto synthesized = compileFile("mirrored.json");
+    std::filesystem::remove_all(dir);
+
+    ASSERT_EQ(synthesized->slotCount(), expected->slotCount());
+    EXPECT_EQ(synthesized->deltaVertices(), expected->deltaVertices());
+    for (size_t i = 0; i < expected->deltaValues().size(); ++i)
+    {
+        EXPECT_NEAR(synthesized->deltaValues()[i].x, expected->deltaValues()[i].x, 1e-6f);
+        EXPECT_NEAR(synthesized->deltaValues()[i].y, expected->deltaValues()[i].y, 1e-6f);
+    }
+    const int rightSlot = synthesized->findSlot(12, Side::right);
+    ASSERT_GE(rightSlot, 0);
+    EXPECT_EQ(synthesized->deltaVertices()[synthesized->slots()[rightSlot].deltaBegin], 4u);
+}
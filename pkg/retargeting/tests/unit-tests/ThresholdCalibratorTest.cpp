@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "ThresholdCalibrator.h"
+#include "ParallelUtils.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+TEST(QuantileSketch, QuantilesWithinRelativeAccuracy)
+{
+    QuantileSketch sketch(0.01);
+    std::vector<double> values;
+    std::mt19937 rng(7);
+    std::lognormal_distribution<double> distribution(0.0, 1.5);
+    for (int i = 0; i < 20000; ++i) {
+        double v = distribution(rng) * (i % 4 == 0 ? -1.0 : 1.0);
+        values.push_back(v);
+        sketch.add(v);
+    }
+    std::sort(values.begin(), values.end());
+
+    EXPECT_EQ(sketch.count(), values.size());
+    EXPECT_EQ(sketch.min(), values.front());
+    EXPECT_EQ(sketch.max(), values.back());
+    for (double q : {0.05, 0.25, 0.5, 0.75, 0.9, 0.99})
+    {
+        double exact = values[static_cast<size_t>(q * (values.size() - 1))];
+        EXPECT_NEAR(sketch.quantile(q), exact, std::abs(exact) * 0.0101) << "q " << q;
+    }
+}
+
+TEST(QuantileSketch, MergeEqualsSingleStreamAndMemoryIsBounded)
+{
+    QuantileSketch whole(0.02, 64), left(0.02, 64), right(0.02, 64);
+    for (int i = 1; i <= 10000; ++i) {
+        double v = 1e-6 * std::pow(1.003, i);   // spans far more buckets than the limit
+        whole.add(v);
+        (i % 2 ? left : right).add(v);
+    }
+    ASSERT_TRUE(left.merge(right));
+    EXPECT_EQ(left.count(), whole.count());
+    for (double q : {0.5, 0.9, 0.99}) EXPECT_DOUBLE_EQ(left.quantile(q), whole.quantile(q));
+
+    // the high quantiles keep their accuracy, only the smallest magnitudes were folded
+    double exact = 1e-6 * std::pow(1.003, 9900);   // value at rank 0.99 * (n - 1)
+    EXPECT_NEAR(whole.quantile(0.99), exact, exact * 0.0201);
+
+    QuantileSketch other(0.05, 64);
+    EXPECT_FALSE(left.merge(other));
+}
+
+// One AU with a landmark pair (0, 1) whose distance grows with the frame number.
+static std::shared_ptr<const CompiledFaceRig> buildCalibrationRig()
+{
+    const std::string mappingPath = (std::filesystem::temp_directory_path() / "calibrationMappings.json").string();
+    std::ofstream(mappingPath) << R"({"mappings":[{"auId":12,"side":"left","landmarkIndices":[0,1]}]})";
+    ActionUnit actionUnit;
+    FacialLandmark facialLandmark;
+    facialLandmark.loadLandmarksActionUnitsMappingFromJson(mappingPath.c_str());
+    std::remove(mappingPath.c_str());
+    return CompiledFaceRig::compile(actionUnit, facialLandmark);
+}
+
+TEST(ThresholdCalibrator, ShardedCalibrationAndRoundTrip)
+{
+    auto rig = buildCalibrationRig();
+    ASSERT_EQ(rig->slotCount(), 1u);
+
+    std::vector<glm::vec3> neutral = {{0, 0, 0}, {1, 0, 0}};
+    std::vector<std::vector<glm::vec3>> frames;
+    for (int f = 0; f <= 1000; ++f) frames.push_back({{0, 0, 0}, {1.0f + f * 0.001f, 0, 0}});
+
+    ThresholdCalibrator calibrator = ThresholdCalibrator::calibrateFrames(rig, neutral, frames, 4);
+    EXPECT_EQ(calibrator.sketch(0).count(), frames.size());
+
+    std::vector<AUThreshold> thresholds = calibrator.computeThresholds(0.5f, 0.9f);
+    ASSERT_EQ(thresholds.size(), 1u);
+    EXPECT_EQ(thresholds[0].auId, 12);
+    EXPECT_EQ(thresholds[0].side, Side::left);
+    EXPECT_NEAR(thresholds[0].minThreshold, 0.5f, 0.5f * 0.011f);
+    EXPECT_NEAR(thresholds[0].maxThreshold, 0.9f, 0.9f * 0.011f);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "calibrationRoundTrip.json").string();
+    ASSERT_TRUE(ThresholdCalibrator::saveCalibration(path.c_str(), thresholds));
+    std::vector<AUThreshold> loaded;
+    ASSERT_TRUE(ThresholdCalibrator::loadCalibration(path.c_str(), loaded));
+    std::remove(path.c_str());
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0].side, Side::left);
+    EXPECT_FLOAT_EQ(loaded[0].maxThreshold, thresholds[0].maxThreshold);
+    EXPECT_EQ(loaded[0].sampleCount, frames.size());
+}
+
+TEST(ThresholdCalibrator, SkipsSlotsWithTooFewSamples)
+{
+    auto rig = buildCalibrationRig();
+    std::vector<glm::vec3> neutral = {{0, 0, 0}, {1, 0, 0}};
+    std::vector<std::vector<glm::vec3>> frames = {{{0, 0, 0}, {1.1f, 0, 0}}, {{0, 0, 0}, {1.2f, 0, 0}}};
+
+    // two poses put both quantiles on the same rank: no calibration rather than a step function
+    ThresholdCalibrator calibrator = ThresholdCalibrator::calibrateFrames(rig, neutral, frames);
+    EXPECT_TRUE(calibrator.computeThresholds().empty());
+    EXPECT_EQ(calibrator.computeThresholds(0.75f, 0.98f, 2).size(), 1u);
+
+    for (int f = 0; f < static_cast<int>(ThresholdCalibrator::kMinSamples); ++f) calibrator.addSample(0, 0.001f * f);
+    const std::vector<AUThreshold> thresholds = calibrator.computeThresholds();
+    ASSERT_EQ(thresholds.size(), 1u);
+    EXPECT_GT(thresholds[0].maxThreshold - thresholds[0].minThreshold, 0.01f);
+}
+
+TEST(ThresholdCalibrator, DeterministicShardsAreIndependentOfWorkerCount)
+{
+    auto rig = buildCalibrationRig();
+    std::vector<glm::vec3> neutral = {{0, 0, 0}, {1, 0, 0}};
+    std::vector<std::vector<glm::vec3>> frames;
+    // spans enough magnitudes for the sketch to fold buckets, which makes the merge order visible
+    for (int f = 0; f < 3000; ++f) frames.push_back({{0, 0, 0}, {1.0f + 1e-4f * std::pow(1.004f, static_cast<float>(f)), 0, 0}});
+
+    setReductionMode(ReductionMode::deterministic);
+    const std::vector<AUThreshold> reference = ThresholdCalibrator::calibrateFrames(rig, neutral, frames, 1).computeThresholds(0.5f, 0.9f);
+    EXPECT_EQ(reference.size(), 1u);
+    for (unsigned int workers = 2; workers <= 8 && reference.size() == 1; ++workers)
+    {
+        const std::vector<AUThreshold> thresholds = ThresholdCalibrator::calibrateFrames(rig, neutral, frames, workers).computeThresholds(0.5f, 0.9f);
+        ASSERT_EQ(thresholds.size(), 1u);
+        EXPECT_EQ(thresholds[0].minThreshold, reference[0].minThreshold) << workers << " workers";
+        EXPECT_EQ(thresholds[0].maxThreshold, reference[0].maxThreshold) << workers << " workers";
+        EXPECT_EQ(thresholds[0].sampleCount, frames.size());
+    }
+    setReductionMode(ReductionMode::fast);
+}
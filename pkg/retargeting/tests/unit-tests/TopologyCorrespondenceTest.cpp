@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "TopologyCorrespondence.h"
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+// Regular grid in the XY plane with n x n vertices, spanning [0, size] and shifted by offset.
+static void buildGrid(int n, float size, const glm::vec3& offset,
+                      std::vector<glm::vec3>& vertices, std::vector<unsigned int>& triangles)
+{
+    vertices.clear();
+    triangles.clear();
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x)
+            vertices.push_back(offset + glm::vec3(size * x / (n - 1), size * y / (n - 1), 0.0f));
+    for (int y = 0; y + 1 < n; ++y)
+        for (int x = 0; x + 1 < n; ++x) {
+            unsigned int a = y * n + x;
+            triangles.insert(triangles.end(), {a, a + 1, a + n + 1, a, a + n + 1, a + n});
+        }
+}
+
+TEST(TopologyCorrespondence, ResampleLinearField)
+{
+    std::vector<glm::vec3> templateVertices, meshVertices;
+    std::vector<unsigned int> templateTriangles, meshTriangles;
+    buildGrid(5, 1.0f, glm::vec3(0.0f), templateVertices, templateTriangles);
+    // denser, twice as large and moved: the bounding box alignment brings it back onto the template
+    buildGrid(9, 2.0f, glm::vec3(3.0f, -1.0f, 0.0f), meshVertices, meshTriangles);
+
+    TopologyCorrespondence correspondence;
+    ASSERT_TRUE(correspondence.build(meshVertices, templateVertices, templateTriangles, 2));
+    EXPECT_EQ(correspondence.meshVertexCount(), meshVertices.size());
+    EXPECT_NEAR(correspondence.scale(), 0.5f, 1e-5f);
+
+    // a field linear in the template position is reproduced exactly by barycentric interpolation
+    std::vector<glm::vec3> field;
+    for (const auto& v : templateVertices) field.push_back(glm::vec3(v.x, 2.0f * v.y, v.x + v.y));
+    std::vector<glm::vec3> resampled = correspondence.resample(field);
+    ASSERT_EQ(resampled.size(), meshVertices.size());
+    for (size_t v = 0; v < meshVertices.size(); ++v)
+    {
+        glm::vec3 p = (meshVertices[v] - glm::vec3(3.0f, -1.0f, 0.0f)) * 0.5f;
+        EXPECT_NEAR(resampled[v].x, p.x, 1e-4f) << "vertex " << v;
+        EXPECT_NEAR(resampled[v].y, 2.0f * p.y, 1e-4f) << "vertex " << v;
+    }
+
+    // template corners map onto the mesh corners, out of range ids become -1
+    std::vector<int> remapped = correspondence.remapIndices({0, 4, 24, 99});
+    EXPECT_EQ(remapped[0], 0);
+    EXPECT_EQ(remapped[1], 8);
+    EXPECT_EQ(remapped[2], 80);
+    EXPECT_EQ(remapped[3], -1);
+
+    std::vector<int> region = correspondence.remapRegion({12});
+    EXPECT_FALSE(region.empty());
+    EXPECT_NE(std::find(region.begin(), region.end(), 40), region.end());
+}
+
+TEST(TopologyCorrespondence, SidecarRoundTrip)
+{
+    std::vector<glm::vec3> templateVertices, meshVertices;
+    std::vector<unsigned int> templateTriangles, meshTriangles;
+    buildGrid(6, 1.0f, glm::vec3(0.0f), templateVertices, templateTriangles);
+    buildGrid(4, 1.0f, glm::vec3(0.0f), meshVertices, meshTriangles);
+
+    const std::string cacheDir = (std::filesystem::temp_directory_path() / "pmxTopologyCacheTest").string();
+    std::filesystem::remove_all(cacheDir);
+
+    TopologyCorrespondence built;
+    ASSERT_TRUE(built.loadOrBuild(cacheDir, meshVertices, templateVertices, templateTriangles));
+    const std::string sidecar = TopologyCorrespondence::sidecarPath(cacheDir, TopologyCorrespondence::hashVertices(meshVertices));
+    ASSERT_TRUE(std::filesystem::exists(sidecar));
+
+    // every template vertex has a user vertex even though the mesh is coarser
+    std::vector<int> all(templateVertices.size());
+    for (size_t i = 0; i < all.size(); ++i) all[i] = static_cast<int>(i);
+    for (int v : built.remapIndices(all)) EXPECT_GE(v, 0);
+
+    TopologyCorrespondence loaded;
+    ASSERT_TRUE(loaded.load(sidecar, TopologyCorrespondence::hashVertices(meshVertices),
+                            TopologyCorrespondence::hashMesh(templateVertices, templateTriangles)));
+    EXPECT_EQ(loaded.indices(), built.indices());
+    EXPECT_EQ(loaded.weights(), built.weights());
+    EXPECT_EQ(loaded.remapIndices(all), built.remapIndices(all));
+
+    // a sidecar from another template is rejected, including one with the same vertices but other triangles
+    std::vector<unsigned int> flippedTriangles = templateTriangles;
+    std::swap(flippedTriangles[0], flippedTriangles[1]);
+    EXPECT_NE(TopologyCorrespondence::hashTriangles(flippedTriangles), TopologyCorrespondence::hashTriangles(templateTriangles));
+    EXPECT_FALSE(loaded.load(sidecar, TopologyCorrespondence::hashVertices(meshVertices),
+                             TopologyCorrespondence::hashMesh(templateVertices, flippedTriangles)));
+    EXPECT_FALSE(loaded.load(sidecar, TopologyCorrespondence::hashVertices(meshVertices), 42));
+    EXPECT_FALSE(loaded.isValid());
+
+    std::filesystem::remove_all(cacheDir);
+}